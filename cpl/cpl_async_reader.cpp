@@ -0,0 +1,661 @@
+/**********************************************************************
+ * $Id$
+ *
+ * Project:  CPL - Common Portability Library
+ * Purpose:  Batched asynchronous reads from a file (io_uring on Linux,
+ *           synchronous pread() elsewhere).
+ *
+ **********************************************************************
+ * Copyright (c) 2026, MITAB contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_async_reader.h"
+#include "cpl_conv.h"
+#include "cpl_multiproc.h"
+#include "cpl_string.h"
+#include "cpl_vsi.h"
+
+#if defined(HAVE_IO_URING) && defined(__linux__) && defined(__GNUC__)
+#  define CPL_USE_IO_URING
+#endif
+
+#if !defined(WIN32) && !defined(WIN32CE)
+#  include <unistd.h>
+#endif
+
+#ifdef CPL_USE_IO_URING
+#  include <errno.h>
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#  include <sys/uio.h>
+#  include <linux/io_uring.h>
+#endif
+
+CPL_CVSID("$Id$");
+
+#ifdef CPL_USE_IO_URING
+/* user_data of the IORING_OP_ASYNC_CANCEL requests. */
+#define CPL_ASYNC_CANCEL_TAG    ((__u64) -1)
+#endif
+
+typedef struct
+{
+    void               *pUserData;
+    int                 nResult;
+    int                 bInUse;
+#ifdef CPL_USE_IO_URING
+    struct iovec        sIOV;
+#endif
+} CPLAsyncRequest;
+
+struct _CPLAsyncReader
+{
+    FILE               *fp;
+    int                 nQueueDepth;
+    int                 nPending;
+    CPLAsyncRequest    *pasRequests;
+
+    /* Synchronous backend: FIFO of completed request indices. */
+    int                *panDone;
+    int                 nDoneFirst;
+    int                 nDoneCount;
+
+#ifdef CPL_USE_IO_URING
+    int                 hRing;          /* -1 if io_uring is not used */
+    int                 nToSubmit;
+    int                 bRingAborted;   /* no new reads, see AbortRing() */
+    int                 nInKernel;      /* reads an aborted ring still owns */
+
+    void               *pSQRing;
+    size_t              nSQRingSize;
+    void               *pCQRing;
+    size_t              nCQRingSize;
+    struct io_uring_sqe *pasSQEs;
+    size_t              nSQEsSize;
+
+    unsigned           *pnSQTail;
+    unsigned           *pnSQMask;
+    unsigned           *panSQArray;
+    unsigned           *pnCQHead;
+    unsigned           *pnCQTail;
+    unsigned           *pnCQMask;
+    struct io_uring_cqe *pasCQEs;
+#endif
+};
+
+/************************************************************************/
+/*                       CPLAsyncReaderReadSync()                       */
+/************************************************************************/
+
+static int CPLAsyncReaderReadSync( FILE *fp, long nOffset, int nSize,
+                                   void *pBuffer )
+
+{
+#if !defined(WIN32) && !defined(WIN32CE)
+    int nRead = 0;
+
+    /* pread() leaves the FILE position alone. */
+    while( nRead < nSize )
+    {
+        ssize_t nRet = pread( fileno(fp), (char *) pBuffer + nRead, 
+                              nSize - nRead, nOffset + nRead );
+        if( nRet <= 0 )
+            return nRet < 0 && nRead == 0 ? -1 : nRead;
+        nRead += (int) nRet;
+    }
+
+    return nRead;
+#else
+    if( VSIFSeek( fp, nOffset, SEEK_SET ) != 0 )
+        return -1;
+
+    return (int) VSIFRead( pBuffer, 1, nSize, fp );
+#endif
+}
+
+#ifdef CPL_USE_IO_URING
+
+/************************************************************************/
+/*                        CPLAsyncReaderSetupRing()                     */
+/*                                                                      */
+/*      Set up an io_uring instance through the raw system calls, so    */
+/*      that liburing is not needed.  Returns FALSE if the kernel does  */
+/*      not support it (or it is blocked, e.g. by seccomp).             */
+/************************************************************************/
+
+static int CPLAsyncReaderSetupRing( CPLAsyncReader *psReader )
+
+{
+    struct io_uring_params sParams;
+    GByte *pabySQ, *pabyCQ;
+
+    memset( &sParams, 0, sizeof(sParams) );
+
+    psReader->hRing = (int) syscall( __NR_io_uring_setup, 
+                                     psReader->nQueueDepth, &sParams );
+    if( psReader->hRing < 0 )
+    {
+        CPLDebug( "CPLAsyncReader", "io_uring_setup() failed: %d", errno );
+        psReader->hRing = -1;
+        return FALSE;
+    }
+
+    psReader->nSQRingSize = 
+        sParams.sq_off.array + sParams.sq_entries * sizeof(unsigned);
+    psReader->nCQRingSize = 
+        sParams.cq_off.cqes + sParams.cq_entries * sizeof(struct io_uring_cqe);
+    if( sParams.features & IORING_FEAT_SINGLE_MMAP )
+    {
+        psReader->nSQRingSize = MAX(psReader->nSQRingSize, 
+                                    psReader->nCQRingSize);
+        psReader->nCQRingSize = psReader->nSQRingSize;
+    }
+
+    psReader->pSQRing = mmap( NULL, psReader->nSQRingSize, 
+                              PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                              psReader->hRing, IORING_OFF_SQ_RING );
+    if( psReader->pSQRing == MAP_FAILED )
+        psReader->pSQRing = NULL;
+
+    if( sParams.features & IORING_FEAT_SINGLE_MMAP )
+        psReader->pCQRing = psReader->pSQRing;
+    else
+    {
+        psReader->pCQRing = mmap( NULL, psReader->nCQRingSize, 
+                                  PROT_READ | PROT_WRITE, 
+                                  MAP_SHARED | MAP_POPULATE,
+                                  psReader->hRing, IORING_OFF_CQ_RING );
+        if( psReader->pCQRing == MAP_FAILED )
+            psReader->pCQRing = NULL;
+    }
+
+    psReader->nSQEsSize = sParams.sq_entries * sizeof(struct io_uring_sqe);
+    psReader->pasSQEs = (struct io_uring_sqe *)
+        mmap( NULL, psReader->nSQEsSize, 
+              PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+              psReader->hRing, IORING_OFF_SQES );
+    if( psReader->pasSQEs == MAP_FAILED )
+        psReader->pasSQEs = NULL;
+
+    if( psReader->pSQRing == NULL || psReader->pCQRing == NULL
+        || psReader->pasSQEs == NULL )
+    {
+        CPLDebug( "CPLAsyncReader", "io_uring mmap() failed: %d", errno );
+        return FALSE;
+    }
+
+    pabySQ = (GByte *) psReader->pSQRing;
+    psReader->pnSQTail = (unsigned *) (pabySQ + sParams.sq_off.tail);
+    psReader->pnSQMask = (unsigned *) (pabySQ + sParams.sq_off.ring_mask);
+    psReader->panSQArray = (unsigned *) (pabySQ + sParams.sq_off.array);
+
+    pabyCQ = (GByte *) psReader->pCQRing;
+    psReader->pnCQHead = (unsigned *) (pabyCQ + sParams.cq_off.head);
+    psReader->pnCQTail = (unsigned *) (pabyCQ + sParams.cq_off.tail);
+    psReader->pnCQMask = (unsigned *) (pabyCQ + sParams.cq_off.ring_mask);
+    psReader->pasCQEs = 
+        (struct io_uring_cqe *) (pabyCQ + sParams.cq_off.cqes);
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                       CPLAsyncReaderCloseRing()                      */
+/************************************************************************/
+
+static void CPLAsyncReaderCloseRing( CPLAsyncReader *psReader )
+
+{
+    if( psReader->pasSQEs != NULL )
+        munmap( psReader->pasSQEs, psReader->nSQEsSize );
+    if( psReader->pCQRing != NULL && psReader->pCQRing != psReader->pSQRing )
+        munmap( psReader->pCQRing, psReader->nCQRingSize );
+    if( psReader->pSQRing != NULL )
+        munmap( psReader->pSQRing, psReader->nSQRingSize );
+    if( psReader->hRing >= 0 )
+        close( psReader->hRing );
+
+    psReader->pasSQEs = NULL;
+    psReader->pCQRing = psReader->pSQRing = NULL;
+    psReader->hRing = -1;
+}
+
+/************************************************************************/
+/*                        CPLAsyncReaderSetDone()                       */
+/*                                                                      */
+/*      Queue a completed request on the synchronous FIFO.              */
+/************************************************************************/
+
+static void CPLAsyncReaderSetDone( CPLAsyncReader *psReader, int iRequest,
+                                   int nResult )
+
+{
+    psReader->pasRequests[iRequest].nResult = nResult;
+    psReader->panDone[(psReader->nDoneFirst + psReader->nDoneCount) 
+                      % psReader->nQueueDepth] = iRequest;
+    psReader->nDoneCount++;
+}
+
+/************************************************************************/
+/*                       CPLAsyncReaderAbortRing()                      */
+/*                                                                      */
+/*      Give up on io_uring after a submission or wait failure: later   */
+/*      reads use the synchronous backend, and the reads that never     */
+/*      reached the kernel complete with a -1 result, so callers fall   */
+/*      back on their own synchronous read.  The kernel may still       */
+/*      write into the buffers of the other reads, so they are only     */
+/*      cancelled here: the ring is kept until their completions are    */
+/*      collected by CPLAsyncReaderDrainRing().                         */
+/************************************************************************/
+
+static void CPLAsyncReaderAbortRing( CPLAsyncReader *psReader, 
+                                     const char *pszReason )
+
+{
+    unsigned nTail = *(psReader->pnSQTail);
+    int      iRequest, i, nCancel = 0;
+
+    CPLError( CE_Failure, CPLE_FileIO, 
+              "%s, falling back to synchronous reads.", pszReason );
+
+    psReader->bRingAborted = TRUE;
+
+/* -------------------------------------------------------------------- */
+/*      Take back the entries the kernel has not consumed yet.          */
+/* -------------------------------------------------------------------- */
+    nTail -= psReader->nToSubmit;
+    for( i = 0; i < psReader->nToSubmit; i++ )
+    {
+        unsigned iSQE = (nTail + i) & *(psReader->pnSQMask);
+
+        CPLAsyncReaderSetDone( psReader, 
+                               (int) psReader->pasSQEs[iSQE].user_data, -1 );
+    }
+    __atomic_store_n( psReader->pnSQTail, nTail, __ATOMIC_RELEASE );
+    psReader->nToSubmit = 0;
+
+    psReader->nInKernel = psReader->nPending - psReader->nDoneCount;
+
+/* -------------------------------------------------------------------- */
+/*      Ask the kernel to cancel the others.  This is best effort: if   */
+/*      it fails too, we wait for them to complete normally.            */
+/* -------------------------------------------------------------------- */
+    for( iRequest = 0; iRequest < psReader->nQueueDepth; iRequest++ )
+    {
+        unsigned iSQE = nTail & *(psReader->pnSQMask);
+        struct io_uring_sqe *psSQE = psReader->pasSQEs + iSQE;
+
+        if( !psReader->pasRequests[iRequest].bInUse )
+            continue;
+
+        memset( psSQE, 0, sizeof(struct io_uring_sqe) );
+        psSQE->opcode = IORING_OP_ASYNC_CANCEL;
+        psSQE->fd = -1;
+        psSQE->addr = iRequest;
+        psSQE->user_data = CPL_ASYNC_CANCEL_TAG;
+
+        psReader->panSQArray[iSQE] = iSQE;
+        nTail++;
+        nCancel++;
+    }
+
+    if( psReader->nInKernel > 0 && nCancel > 0 )
+    {
+        __atomic_store_n( psReader->pnSQTail, nTail, __ATOMIC_RELEASE );
+        if( syscall( __NR_io_uring_enter, psReader->hRing, nCancel, 0, 0, 
+                     NULL, 0 ) < 0 )
+            CPLDebug( "CPLAsyncReader", 
+                      "IORING_OP_ASYNC_CANCEL failed: %d", errno );
+    }
+
+    if( psReader->nInKernel == 0 )
+        CPLAsyncReaderCloseRing( psReader );
+}
+
+/************************************************************************/
+/*                       CPLAsyncReaderDrainRing()                      */
+/*                                                                      */
+/*      Move the completions of an aborted ring to the synchronous      */
+/*      FIFO, waiting for one if bBlock is TRUE and the FIFO is empty.  */
+/*      The ring is closed once the kernel is done with all the         */
+/*      buffers.  Returns FALSE if nothing has completed.               */
+/************************************************************************/
+
+static int CPLAsyncReaderDrainRing( CPLAsyncReader *psReader, int bBlock )
+
+{
+    while( psReader->hRing >= 0 )
+    {
+        unsigned nHead = *(psReader->pnCQHead);
+        unsigned nTail = 
+            __atomic_load_n( psReader->pnCQTail, __ATOMIC_ACQUIRE );
+
+        for( ; nHead != nTail; nHead++ )
+        {
+            struct io_uring_cqe *psCQE = 
+                psReader->pasCQEs + (nHead & *(psReader->pnCQMask));
+
+            if( psCQE->user_data == CPL_ASYNC_CANCEL_TAG )
+                continue;
+
+            CPLAsyncReaderSetDone( psReader, (int) psCQE->user_data, 
+                                   psCQE->res < 0 ? -1 : psCQE->res );
+            psReader->nInKernel--;
+        }
+        __atomic_store_n( psReader->pnCQHead, nHead, __ATOMIC_RELEASE );
+
+        if( psReader->nInKernel == 0 )
+            CPLAsyncReaderCloseRing( psReader );
+        else if( psReader->nDoneCount == 0 && bBlock )
+        {
+            /* The kernel posts completions to the mapped ring even if */
+            /* io_uring_enter() is no longer usable: poll it then.      */
+            if( syscall( __NR_io_uring_enter, psReader->hRing, 0, 1, 
+                         IORING_ENTER_GETEVENTS, NULL, 0 ) < 0 
+                && errno != EINTR && errno != EAGAIN )
+                CPLSleep( 0.001 );
+            continue;
+        }
+
+        break;
+    }
+
+    return psReader->nDoneCount > 0;
+}
+
+#endif /* def CPL_USE_IO_URING */
+
+/************************************************************************/
+/*                        CPLAsyncReaderCreate()                        */
+/*                                                                      */
+/*      The io_uring backend can be disabled with the config option     */
+/*      CPL_IO_URING=NO.                                                */
+/************************************************************************/
+
+CPLAsyncReader *CPLAsyncReaderCreate( FILE *fp, int nQueueDepth )
+
+{
+    CPLAsyncReader *psReader;
+
+    if( fp == NULL || nQueueDepth < 1 )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined, 
+                  "CPLAsyncReaderCreate(): Invalid arguments." );
+        return NULL;
+    }
+
+    psReader = (CPLAsyncReader *) CPLCalloc( sizeof(CPLAsyncReader), 1 );
+    psReader->fp = fp;
+    psReader->nQueueDepth = nQueueDepth;
+    psReader->pasRequests = (CPLAsyncRequest *) 
+        CPLCalloc( sizeof(CPLAsyncRequest), nQueueDepth );
+    psReader->panDone = (int *) CPLCalloc( sizeof(int), nQueueDepth );
+
+#ifdef CPL_USE_IO_URING
+    psReader->hRing = -1;
+    if( CSLTestBoolean( CPLGetConfigOption( "CPL_IO_URING", "YES" ) )
+        && !CPLAsyncReaderSetupRing( psReader ) )
+        CPLAsyncReaderCloseRing( psReader );
+#endif
+
+    return psReader;
+}
+
+/************************************************************************/
+/*                       CPLAsyncReaderDestroy()                        */
+/*                                                                      */
+/*      Waits for the reads still in flight, since the kernel may       */
+/*      still write into their buffers.                                 */
+/************************************************************************/
+
+void CPLAsyncReaderDestroy( CPLAsyncReader *psReader )
+
+{
+    void *pUserData;
+    int   nBytesRead;
+
+    if( psReader == NULL )
+        return;
+
+    while( CPLAsyncReaderWait( psReader, TRUE, &pUserData, &nBytesRead ) ) {}
+
+#ifdef CPL_USE_IO_URING
+    CPLAsyncReaderCloseRing( psReader );
+#endif
+
+    CPLFree( psReader->pasRequests );
+    CPLFree( psReader->panDone );
+    CPLFree( psReader );
+}
+
+/************************************************************************/
+/*                      CPLAsyncReaderGetBackend()                      */
+/************************************************************************/
+
+const char *CPLAsyncReaderGetBackend( CPLAsyncReader *psReader )
+
+{
+#ifdef CPL_USE_IO_URING
+    if( psReader->hRing >= 0 && !psReader->bRingAborted )
+        return "io_uring";
+#endif
+    return "sync";
+}
+
+/************************************************************************/
+/*                        CPLAsyncReaderSubmit()                        */
+/*                                                                      */
+/*      Queue a read of nSize bytes at nOffset into pBuffer, which      */
+/*      must stay valid until the completion is returned by             */
+/*      CPLAsyncReaderWait().  Returns FALSE if nQueueDepth reads are   */
+/*      already pending.                                                */
+/************************************************************************/
+
+int CPLAsyncReaderSubmit( CPLAsyncReader *psReader, long nOffset, int nSize,
+                          void *pBuffer, void *pUserData )
+
+{
+    CPLAsyncRequest *psRequest = NULL;
+    int              iRequest;
+
+    if( psReader->nPending >= psReader->nQueueDepth )
+        return FALSE;
+
+    for( iRequest = 0; iRequest < psReader->nQueueDepth; iRequest++ )
+    {
+        if( !psReader->pasRequests[iRequest].bInUse )
+        {
+            psRequest = psReader->pasRequests + iRequest;
+            break;
+        }
+    }
+    CPLAssert( psRequest != NULL );
+
+    psRequest->bInUse = TRUE;
+    psRequest->pUserData = pUserData;
+    psReader->nPending++;
+
+#ifdef CPL_USE_IO_URING
+    if( psReader->hRing >= 0 && !psReader->bRingAborted )
+    {
+        unsigned nTail = *(psReader->pnSQTail);
+        unsigned iSQE = nTail & *(psReader->pnSQMask);
+        struct io_uring_sqe *psSQE = psReader->pasSQEs + iSQE;
+
+        psRequest->sIOV.iov_base = pBuffer;
+        psRequest->sIOV.iov_len = nSize;
+
+        memset( psSQE, 0, sizeof(struct io_uring_sqe) );
+        psSQE->opcode = IORING_OP_READV;
+        psSQE->fd = fileno( psReader->fp );
+        psSQE->addr = (unsigned long) &(psRequest->sIOV);
+        psSQE->len = 1;
+        psSQE->off = nOffset;
+        psSQE->user_data = iRequest;
+
+        psReader->panSQArray[iSQE] = iSQE;
+        __atomic_store_n( psReader->pnSQTail, nTail + 1, __ATOMIC_RELEASE );
+        psReader->nToSubmit++;
+
+        return TRUE;
+    }
+#endif
+
+    psRequest->nResult = 
+        CPLAsyncReaderReadSync( psReader->fp, nOffset, nSize, pBuffer );
+    psReader->panDone[(psReader->nDoneFirst + psReader->nDoneCount) 
+                      % psReader->nQueueDepth] = iRequest;
+    psReader->nDoneCount++;
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                        CPLAsyncReaderFlush()                         */
+/*                                                                      */
+/*      Hand the reads queued since the last call to the kernel.        */
+/*      If that fails, the pending reads complete with an error.        */
+/************************************************************************/
+
+void CPLAsyncReaderFlush( CPLAsyncReader *psReader )
+
+{
+#ifdef CPL_USE_IO_URING
+    while( psReader->nToSubmit > 0 )
+    {
+        int nRet = (int) syscall( __NR_io_uring_enter, psReader->hRing, 
+                                  psReader->nToSubmit, 0, 0, NULL, 0 );
+        if( nRet < 0 )
+        {
+            if( errno == EINTR || errno == EAGAIN || errno == EBUSY )
+                continue;
+
+            CPLAsyncReaderAbortRing( 
+                psReader, CPLSPrintf( "io_uring_enter() failed: %d", errno ) );
+            return;
+        }
+
+        /* Nothing consumed: retrying would loop forever. */
+        if( nRet == 0 )
+        {
+            CPLAsyncReaderAbortRing( 
+                psReader, "io_uring_enter() submitted no request" );
+            return;
+        }
+
+        psReader->nToSubmit -= nRet;
+    }
+#endif
+}
+
+/************************************************************************/
+/*                         CPLAsyncReaderWait()                         */
+/*                                                                      */
+/*      Fetch one completed read.  If none is available yet, wait for   */
+/*      one when bBlock is TRUE.  Returns FALSE if no read is pending,  */
+/*      or none has completed and bBlock is FALSE.  *pnBytesRead is     */
+/*      set to -1 on error.                                             */
+/************************************************************************/
+
+int CPLAsyncReaderWait( CPLAsyncReader *psReader, int bBlock,
+                        void **ppUserData, int *pnBytesRead )
+
+{
+    CPLAsyncRequest *psRequest;
+    int              iRequest;
+
+    if( psReader->nPending == 0 )
+        return FALSE;
+
+#ifdef CPL_USE_IO_URING
+    unsigned nHead = 0, nTail;
+
+    if( psReader->hRing >= 0 && !psReader->bRingAborted )
+        CPLAsyncReaderFlush( psReader );
+
+    /* The ring is aborted (and the pending reads failed) on error. */
+    while( psReader->hRing >= 0 && !psReader->bRingAborted )
+    {
+        nHead = *(psReader->pnCQHead);
+        nTail = __atomic_load_n( psReader->pnCQTail, __ATOMIC_ACQUIRE );
+        if( nHead != nTail )
+            break;
+
+        if( !bBlock )
+            return FALSE;
+
+        if( syscall( __NR_io_uring_enter, psReader->hRing, 0, 1, 
+                     IORING_ENTER_GETEVENTS, NULL, 0 ) < 0 
+            && errno != EINTR && errno != EAGAIN )
+        {
+            CPLAsyncReaderAbortRing( 
+                psReader, CPLSPrintf( "io_uring_enter() failed: %d", errno ) );
+        }
+    }
+
+    if( psReader->bRingAborted && psReader->nDoneCount == 0
+        && !CPLAsyncReaderDrainRing( psReader, bBlock ) )
+        return FALSE;
+
+    if( psReader->hRing >= 0 && !psReader->bRingAborted )
+    {
+        struct io_uring_cqe *psCQE = 
+            psReader->pasCQEs + (nHead & *(psReader->pnCQMask));
+
+        iRequest = (int) psCQE->user_data;
+        psReader->pasRequests[iRequest].nResult = 
+            psCQE->res < 0 ? -1 : psCQE->res;
+
+        __atomic_store_n( psReader->pnCQHead, nHead + 1, __ATOMIC_RELEASE );
+    }
+    else
+#endif
+    {
+        CPLAssert( psReader->nDoneCount > 0 );
+
+        iRequest = psReader->panDone[psReader->nDoneFirst];
+        psReader->nDoneFirst = 
+            (psReader->nDoneFirst + 1) % psReader->nQueueDepth;
+        psReader->nDoneCount--;
+    }
+
+    psRequest = psReader->pasRequests + iRequest;
+    *ppUserData = psRequest->pUserData;
+    *pnBytesRead = psRequest->nResult;
+
+    psRequest->bInUse = FALSE;
+    psReader->nPending--;
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                      CPLAsyncReaderGetPending()                      */
+/*                                                                      */
+/*      Number of reads submitted whose completion was not yet          */
+/*      returned by CPLAsyncReaderWait().                               */
+/************************************************************************/
+
+int CPLAsyncReaderGetPending( CPLAsyncReader *psReader )
+
+{
+    return psReader->nPending;
+}
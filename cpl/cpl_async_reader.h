@@ -0,0 +1,66 @@
+/**********************************************************************
+ * $Id$
+ *
+ * Project:  CPL - Common Portability Library
+ * Purpose:  Batched asynchronous reads from a file (io_uring on Linux,
+ *           synchronous pread() elsewhere).
+ *
+ **********************************************************************
+ * Copyright (c) 2026, MITAB contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef _CPL_ASYNC_READER_H_INCLUDED_
+#define _CPL_ASYNC_READER_H_INCLUDED_
+
+#include <stdio.h>
+#include "cpl_port.h"
+
+CPL_C_START
+
+/************************************************************************/
+/*      Up to nQueueDepth reads can be in flight at once.  Reads are    */
+/*      queued with CPLAsyncReaderSubmit(), sent to the kernel in one   */
+/*      call by CPLAsyncReaderFlush(), and their completions are        */
+/*      fetched in any order with CPLAsyncReaderWait().  The file       */
+/*      must not be written to while reads are in flight.               */
+/*                                                                      */
+/*      Without io_uring (not Linux, kernel too old, or not allowed)    */
+/*      the reads are done synchronously on submission and only        */
+/*      their completions are queued.                                   */
+/************************************************************************/
+
+typedef struct _CPLAsyncReader CPLAsyncReader;
+
+CPLAsyncReader CPL_DLL *CPLAsyncReaderCreate( FILE *fp, int nQueueDepth );
+void  CPL_DLL CPLAsyncReaderDestroy( CPLAsyncReader *psReader );
+const char CPL_DLL *CPLAsyncReaderGetBackend( CPLAsyncReader *psReader );
+
+int   CPL_DLL CPLAsyncReaderSubmit( CPLAsyncReader *psReader, 
+                                    long nOffset, int nSize, void *pBuffer,
+                                    void *pUserData );
+void  CPL_DLL CPLAsyncReaderFlush( CPLAsyncReader *psReader );
+int   CPL_DLL CPLAsyncReaderWait( CPLAsyncReader *psReader, int bBlock,
+                                  void **ppUserData, int *pnBytesRead );
+int   CPL_DLL CPLAsyncReaderGetPending( CPLAsyncReader *psReader );
+
+CPL_C_END
+
+#endif /* _CPL_ASYNC_READER_H_INCLUDED_ */
@@ -39,6 +39,17 @@ int CPLAtomicAdd(volatile int* ptr, int increment)
   return OSAtomicAdd32(increment, (int*)(ptr));
 }
 
+int CPLAtomicCompareAndExchange(volatile int* ptr, int oldval, int newval)
+{
+  return OSAtomicCompareAndSwap32Barrier(oldval, newval, (int*)(ptr));
+}
+
+int CPLAtomicCompareAndExchangePtr(void* volatile* ptr, 
+                                   void* oldval, void* newval)
+{
+  return OSAtomicCompareAndSwapPtrBarrier(oldval, newval, ptr);
+}
+
 #elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
 
 #include <windows.h>
@@ -52,6 +63,28 @@ int CPLAtomicAdd(volatile int* ptr, int increment)
 #endif
 }
 
+int CPLAtomicCompareAndExchange(volatile int* ptr, int oldval, int newval)
+{
+#if defined(_MSC_VER) && (_MSC_VER <= 1200)
+  return (int)InterlockedCompareExchange((PVOID*)(ptr), (PVOID)(newval),
+                                         (PVOID)(oldval)) == oldval;
+#else
+  return InterlockedCompareExchange((volatile LONG*)(ptr), (LONG)(newval),
+                                    (LONG)(oldval)) == (LONG)(oldval);
+#endif
+}
+
+int CPLAtomicCompareAndExchangePtr(void* volatile* ptr, 
+                                   void* oldval, void* newval)
+{
+#if defined(_MSC_VER) && (_MSC_VER <= 1200)
+  return InterlockedCompareExchange((PVOID*)(ptr), newval, oldval) == oldval;
+#else
+  return InterlockedCompareExchangePointer((PVOID volatile*)(ptr), newval, 
+                                           oldval) == oldval;
+#endif
+}
+
 #elif defined(__MINGW32__) && defined(__i386__)
 
 #include <windows.h>
@@ -61,6 +94,19 @@ int CPLAtomicAdd(volatile int* ptr, int increment)
   return InterlockedExchangeAdd((LONG*)(ptr), (LONG)(increment)) + increment;
 }
 
+int CPLAtomicCompareAndExchange(volatile int* ptr, int oldval, int newval)
+{
+  return InterlockedCompareExchange((LONG*)(ptr), (LONG)(newval),
+                                    (LONG)(oldval)) == (LONG)(oldval);
+}
+
+int CPLAtomicCompareAndExchangePtr(void* volatile* ptr, 
+                                   void* oldval, void* newval)
+{
+  return InterlockedCompareExchange((LONG*)(ptr), (LONG)(newval),
+                                    (LONG)(oldval)) == (LONG)(oldval);
+}
+
 #elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
 
 int CPLAtomicAdd(volatile int* ptr, int increment)
@@ -72,6 +118,25 @@ int CPLAtomicAdd(volatile int* ptr, int increment)
   return temp + increment;
 }
 
+int CPLAtomicCompareAndExchange(volatile int* ptr, int oldval, int newval)
+{
+  unsigned char ret;
+  __asm__ __volatile__("lock; cmpxchgl %3,%1\n\tsete %0"
+                       : "=q" (ret), "+m" (*ptr), "+a" (oldval)
+                       : "r" (newval) : "memory", "cc");
+  return ret;
+}
+
+int CPLAtomicCompareAndExchangePtr(void* volatile* ptr, 
+                                   void* oldval, void* newval)
+{
+  unsigned char ret;
+  __asm__ __volatile__("lock; cmpxchg %3,%1\n\tsete %0"
+                       : "=q" (ret), "+m" (*ptr), "+a" (oldval)
+                       : "r" (newval) : "memory", "cc");
+  return ret;
+}
+
 #elif defined(HAVE_GCC_ATOMIC_BUILTINS)
 /* Starting with GCC 4.1.0, built-in functions for atomic memory access are provided. */
 /* see http://gcc.gnu.org/onlinedocs/gcc-4.1.0/gcc/Atomic-Builtins.html */
@@ -86,6 +151,17 @@ int CPLAtomicAdd(volatile int* ptr, int increment)
     return __sync_sub_and_fetch(ptr, -increment);
 }
 
+int CPLAtomicCompareAndExchange(volatile int* ptr, int oldval, int newval)
+{
+  return __sync_bool_compare_and_swap(ptr, oldval, newval);
+}
+
+int CPLAtomicCompareAndExchangePtr(void* volatile* ptr, 
+                                   void* oldval, void* newval)
+{
+  return __sync_bool_compare_and_swap(ptr, oldval, newval);
+}
+
 #elif !defined(CPL_MULTIPROC_PTHREAD)
 #warning "Needs real lock API to implement properly atomic increment"
 
@@ -95,6 +171,23 @@ int CPLAtomicAdd(volatile int* ptr, int increment)
     (*ptr) += increment;
     return *ptr;
 }
+
+int CPLAtomicCompareAndExchange(volatile int* ptr, int oldval, int newval)
+{
+    if( *ptr != oldval )
+        return 0;
+    *ptr = newval;
+    return 1;
+}
+
+int CPLAtomicCompareAndExchangePtr(void* volatile* ptr, 
+                                   void* oldval, void* newval)
+{
+    if( *ptr != oldval )
+        return 0;
+    *ptr = newval;
+    return 1;
+}
 #else
 
 #include "cpl_multiproc.h"
@@ -109,4 +202,23 @@ int CPLAtomicAdd(volatile int* ptr, int increment)
     return *ptr;
 }
 
+int CPLAtomicCompareAndExchange(volatile int* ptr, int oldval, int newval)
+{
+    CPLMutexHolder oMutex(&hAtomicOpMutex);
+    if( *ptr != oldval )
+        return 0;
+    *ptr = newval;
+    return 1;
+}
+
+int CPLAtomicCompareAndExchangePtr(void* volatile* ptr, 
+                                   void* oldval, void* newval)
+{
+    CPLMutexHolder oMutex(&hAtomicOpMutex);
+    if( *ptr != oldval )
+        return 0;
+    *ptr = newval;
+    return 1;
+}
+
 #endif
@@ -60,6 +60,34 @@ CPL_C_START
   */
 int CPL_DLL CPLAtomicAdd(volatile int* ptr, int increment);
 
+/** Compares an integer with an expected value and, if they are equal,
+  * replaces it with a new value, atomically.
+  *
+  * This function is a full memory barrier on all platforms with an
+  * efficient implementation (see CPLAtomicAdd for the list).
+  * The variables for this function must be aligned on a 32-bit boundary.
+  *
+  * @param ptr a pointer to the integer to update
+  * @param oldval the value *ptr is expected to have
+  * @param newval the value to store in *ptr if it is equal to oldval
+  * @return TRUE if the exchange happened, FALSE if *ptr was not oldval
+  */
+int CPL_DLL CPLAtomicCompareAndExchange(volatile int* ptr, int oldval, 
+                                        int newval);
+
+/** Pointer version of CPLAtomicCompareAndExchange.
+  *
+  * @see CPLAtomicCompareAndExchange for the details and guarantees of this
+  *      atomic operation
+  *
+  * @param ptr a pointer to the pointer to update
+  * @param oldval the value *ptr is expected to have
+  * @param newval the value to store in *ptr if it is equal to oldval
+  * @return TRUE if the exchange happened, FALSE if *ptr was not oldval
+  */
+int CPL_DLL CPLAtomicCompareAndExchangePtr(void* volatile* ptr, 
+                                           void* oldval, void* newval);
+
 /** Increment of 1 the pointed integer in a thread and SMP-safe way
   * and return the resulting value of the operation.
   *
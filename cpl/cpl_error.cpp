@@ -73,7 +73,7 @@ static CPLErrorContext *CPLGetErrorContext()
 
 {
     CPLErrorContext *psCtx = 
-        (CPLErrorContext *) CPLGetTLS( CTLS_ERRORCONTEXT );
+        (CPLErrorContext *) CPLGetTLSFast( CTLS_ERRORCONTEXT );
 
     if( psCtx == NULL )
     {
@@ -86,6 +86,27 @@ static CPLErrorContext *CPLGetErrorContext()
     return psCtx;
 }
 
+/************************************************************************/
+/*                         CPLGetErrorCounterP()                        */
+/*                                                                      */
+/*      The counter is kept out of CPLErrorContext since the context    */
+/*      is reallocated when long messages are posted.                   */
+/************************************************************************/
+
+static GUInt32 *CPLGetErrorCounterP()
+
+{
+    GUInt32 *pnCounter = (GUInt32 *) CPLGetTLSFast( CTLS_ERRORCOUNTER );
+
+    if( pnCounter == NULL )
+    {
+        pnCounter = (GUInt32 *) CPLCalloc(sizeof(GUInt32),1);
+        CPLSetTLS( CTLS_ERRORCOUNTER, pnCounter, TRUE );
+    }
+
+    return pnCounter;
+}
+
 
 /**********************************************************************
  *                          CPLError()
@@ -209,6 +230,7 @@ void    CPLErrorV(CPLErr eErrClass, int err_no, const char *fmt, va_list args )
 /* -------------------------------------------------------------------- */
     psCtx->nLastErrNo = err_no;
     psCtx->eLastErrType = eErrClass;
+    (*CPLGetErrorCounterP())++;
 
     if( CPLGetConfigOption("CPL_LOG_ERRORS",NULL) != NULL )
         CPLDebug( "CPLError", "%s", psCtx->szLastErrMsg );
@@ -413,6 +435,46 @@ CPLErr CPL_STDCALL CPLGetLastErrorType()
     return psCtx->eLastErrType;
 }
 
+/**********************************************************************
+ *                          CPLGetErrorCounter()
+ **********************************************************************/
+
+/**
+ * Get the error counter.
+ *
+ * The counter of the current thread is incremented each time an error
+ * is posted with CPLError(), whatever its class, and is not affected by
+ * CPLErrorReset().  Comparing it with a value saved earlier tells whether
+ * a new error was posted in between.
+ *
+ * @return the number of errors posted so far in the current thread.
+ */
+
+GUInt32 CPL_STDCALL CPLGetErrorCounter()
+{
+    return *CPLGetErrorCounterP();
+}
+
+/**********************************************************************
+ *                          CPLGetErrorCounterPtr()
+ **********************************************************************/
+
+/**
+ * Get a pointer to the error counter.
+ *
+ * Same as CPLGetErrorCounter(), but for loops that want to check for new
+ * errors after each step: fetch the pointer once, then each check is a
+ * single load.  The pointer is only valid in the current thread, until
+ * CPLCleanupTLS() is called or the thread exits.
+ *
+ * @return a pointer to the error counter of the current thread.
+ */
+
+const GUInt32 * CPL_STDCALL CPLGetErrorCounterPtr()
+{
+    return CPLGetErrorCounterP();
+}
+
 /**********************************************************************
  *                          CPLGetLastErrorMsg()
  **********************************************************************/
@@ -60,6 +60,8 @@ void CPL_DLL CPL_STDCALL CPLErrorReset( void );
 int CPL_DLL CPL_STDCALL CPLGetLastErrorNo( void );
 CPLErr CPL_DLL CPL_STDCALL CPLGetLastErrorType( void );
 const char CPL_DLL * CPL_STDCALL CPLGetLastErrorMsg( void );
+GUInt32 CPL_DLL CPL_STDCALL CPLGetErrorCounter( void );
+const GUInt32 CPL_DLL * CPL_STDCALL CPLGetErrorCounterPtr( void );
 
 typedef void (CPL_STDCALL *CPLErrorHandler)(CPLErr, int, const char*);
 
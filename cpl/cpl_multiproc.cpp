@@ -33,6 +33,7 @@
 
 #include "cpl_multiproc.h"
 #include "cpl_conv.h"
+#include "cpl_atomic_ops.h"
 
 #if !defined(WIN32CE)
 #  include <time.h>
@@ -101,6 +102,41 @@ CPLMutexHolder::~CPLMutexHolder()
 }
 
 
+/************************************************************************/
+/*                          CPLRWLockHolder()                           */
+/*                                                                      */
+/*      Holds a readers/writer lock for the lifetime of the object.     */
+/*      Read locks should not be taken recursively: a waiting writer    */
+/*      may block the second acquisition.                               */
+/************************************************************************/
+
+CPLRWLockHolder::CPLRWLockHolder( void *hRWLockIn, int bWrite )
+
+{
+    hRWLock = hRWLockIn;
+
+    if( hRWLock == NULL )
+        return;
+
+    if( !(bWrite ? CPLAcquireRWLockWrite( hRWLock )
+                 : CPLAcquireRWLockRead( hRWLock )) )
+    {
+        CPLDebug( "CPLRWLockHolder", "failed to acquire lock!" );
+        hRWLock = NULL;
+    }
+}
+
+/************************************************************************/
+/*                          ~CPLRWLockHolder()                          */
+/************************************************************************/
+
+CPLRWLockHolder::~CPLRWLockHolder()
+
+{
+    if( hRWLock != NULL )
+        CPLReleaseRWLock( hRWLock );
+}
+
 /************************************************************************/
 /*                      CPLCreateOrAcquireMutex()                       */
 /************************************************************************/
@@ -373,6 +409,144 @@ int CPLCreateThread( CPLThreadFunc pfnMain, void *pArg )
     return -1;
 }
 
+/************************************************************************/
+/*                      CPLCreateJoinableThread()                       */
+/************************************************************************/
+
+void *CPLCreateJoinableThread( CPLThreadFunc pfnMain, void *pArg )
+
+{
+    CPLDebug( "CPLCreateJoinableThread", "Fails to dummy implementation" );
+
+    return NULL;
+}
+
+/************************************************************************/
+/*                           CPLJoinThread()                            */
+/************************************************************************/
+
+void CPLJoinThread( void *hJoinableThread )
+
+{
+}
+
+/************************************************************************/
+/*                           CPLGetNumCPUs()                            */
+/************************************************************************/
+
+int CPLGetNumCPUs()
+
+{
+    return 1;
+}
+
+/************************************************************************/
+/*                           CPLCreateCond()                            */
+/*                                                                      */
+/*      There is no other thread to wait for, so condition variables   */
+/*      are no-ops in the stub implementation.                          */
+/************************************************************************/
+
+void *CPLCreateCond()
+
+{
+    return NULL;
+}
+
+/************************************************************************/
+/*                            CPLCondWait()                             */
+/************************************************************************/
+
+void CPLCondWait( void *hCond, void *hMutex )
+
+{
+}
+
+/************************************************************************/
+/*                           CPLCondSignal()                            */
+/************************************************************************/
+
+void CPLCondSignal( void *hCond )
+
+{
+}
+
+/************************************************************************/
+/*                          CPLCondBroadcast()                          */
+/************************************************************************/
+
+void CPLCondBroadcast( void *hCond )
+
+{
+}
+
+/************************************************************************/
+/*                           CPLDestroyCond()                           */
+/************************************************************************/
+
+void CPLDestroyCond( void *hCond )
+
+{
+}
+
+/************************************************************************/
+/*                          CPLCreateRWLock()                           */
+/*                                                                      */
+/*      Only keeps a count of holders to catch unbalanced releases.     */
+/************************************************************************/
+
+void *CPLCreateRWLock()
+
+{
+    return CPLCalloc( sizeof(int), 1 );
+}
+
+/************************************************************************/
+/*                        CPLAcquireRWLockRead()                        */
+/************************************************************************/
+
+int CPLAcquireRWLockRead( void *hRWLock )
+
+{
+    (*(int *) hRWLock)++;
+    return TRUE;
+}
+
+/************************************************************************/
+/*                       CPLAcquireRWLockWrite()                        */
+/************************************************************************/
+
+int CPLAcquireRWLockWrite( void *hRWLock )
+
+{
+    (*(int *) hRWLock)++;
+    return TRUE;
+}
+
+/************************************************************************/
+/*                          CPLReleaseRWLock()                          */
+/************************************************************************/
+
+void CPLReleaseRWLock( void *hRWLock )
+
+{
+    if( *(int *) hRWLock < 1 )
+        CPLDebug( "CPLMultiProc", 
+                  "CPLReleaseRWLock() called on unlocked lock!" );
+    else
+        (*(int *) hRWLock)--;
+}
+
+/************************************************************************/
+/*                          CPLDestroyRWLock()                          */
+/************************************************************************/
+
+void CPLDestroyRWLock( void *hRWLock )
+
+{
+    CPLFree( hRWLock );
+}
+
 /************************************************************************/
 /*                              CPLSleep()                              */
 /************************************************************************/
@@ -623,6 +797,307 @@ int CPLCreateThread( CPLThreadFunc pfnMain, void *pThreadArg )
     return nThreadId;
 }
 
+/************************************************************************/
+/*                   CPLStdCallJoinableThreadJacket()                   */
+/************************************************************************/
+
+typedef struct {
+    void *pAppData;
+    CPLThreadFunc pfnMain;
+    HANDLE hThread;
+} CPLJoinableThreadInfo;
+
+static DWORD WINAPI CPLStdCallJoinableThreadJacket( void *pData )
+
+{
+    CPLJoinableThreadInfo *psInfo = (CPLJoinableThreadInfo *) pData;
+
+    psInfo->pfnMain( psInfo->pAppData );
+
+    CPLCleanupTLS();
+
+    return 0;
+}
+
+/************************************************************************/
+/*                      CPLCreateJoinableThread()                       */
+/*                                                                      */
+/*      Same as CPLCreateThread(), but the thread handle is kept so     */
+/*      that CPLJoinThread() can wait for it.  Returns NULL on          */
+/*      failure.                                                        */
+/************************************************************************/
+
+void *CPLCreateJoinableThread( CPLThreadFunc pfnMain, void *pThreadArg )
+
+{
+    DWORD  nThreadId;
+    CPLJoinableThreadInfo *psInfo;
+
+    psInfo = (CPLJoinableThreadInfo*) 
+        CPLCalloc(sizeof(CPLJoinableThreadInfo),1);
+    psInfo->pAppData = pThreadArg;
+    psInfo->pfnMain = pfnMain;
+
+    psInfo->hThread = CreateThread( NULL, 0, CPLStdCallJoinableThreadJacket, 
+                                    psInfo, 0, &nThreadId );
+
+    if( psInfo->hThread == NULL )
+    {
+        CPLFree( psInfo );
+        return NULL;
+    }
+
+    return psInfo;
+}
+
+/************************************************************************/
+/*                           CPLJoinThread()                            */
+/************************************************************************/
+
+void CPLJoinThread( void *hJoinableThread )
+
+{
+    CPLJoinableThreadInfo *psInfo = (CPLJoinableThreadInfo *) hJoinableThread;
+
+    if( psInfo == NULL )
+        return;
+
+    WaitForSingleObject( psInfo->hThread, INFINITE );
+    CloseHandle( psInfo->hThread );
+    CPLFree( psInfo );
+}
+
+/************************************************************************/
+/*                           CPLGetNumCPUs()                            */
+/************************************************************************/
+
+int CPLGetNumCPUs()
+
+{
+    SYSTEM_INFO info;
+
+    GetSystemInfo( &info );
+
+    return (info.dwNumberOfProcessors > 0) ? info.dwNumberOfProcessors : 1;
+}
+
+/************************************************************************/
+/*                           CPLCreateCond()                            */
+/*                                                                      */
+/*      Condition variables are emulated with a list of per-waiter      */
+/*      events since CONDITION_VARIABLE is not available before         */
+/*      Vista.                                                          */
+/************************************************************************/
+
+typedef struct _CPLWaiterItem
+{
+    HANDLE hEvent;
+    struct _CPLWaiterItem *psNext;
+} CPLWaiterItem;
+
+typedef struct
+{
+    void          *hInternalMutex;
+    CPLWaiterItem *psWaiterList;
+} CPLWin32Cond;
+
+void *CPLCreateCond()
+
+{
+    CPLWin32Cond *psCond = (CPLWin32Cond *) CPLMalloc(sizeof(CPLWin32Cond));
+
+    psCond->hInternalMutex = CPLCreateMutex();
+    CPLReleaseMutex( psCond->hInternalMutex );
+    psCond->psWaiterList = NULL;
+
+    return psCond;
+}
+
+/************************************************************************/
+/*                            CPLCondWait()                             */
+/************************************************************************/
+
+void CPLCondWait( void *hCond, void *hMutex )
+
+{
+    CPLWin32Cond  *psCond = (CPLWin32Cond *) hCond;
+    CPLWaiterItem *psItem;
+
+    psItem = (CPLWaiterItem *) CPLMalloc(sizeof(CPLWaiterItem));
+    psItem->hEvent = CreateEvent( NULL, FALSE, FALSE, NULL );
+
+    CPLAcquireMutex( psCond->hInternalMutex, 1000.0 );
+    psItem->psNext = psCond->psWaiterList;
+    psCond->psWaiterList = psItem;
+    CPLReleaseMutex( psCond->hInternalMutex );
+
+    CPLReleaseMutex( hMutex );
+    WaitForSingleObject( psItem->hEvent, INFINITE );
+    CPLAcquireMutex( hMutex, 1000.0 );
+
+    CloseHandle( psItem->hEvent );
+    CPLFree( psItem );
+}
+
+/************************************************************************/
+/*                           CPLCondSignal()                            */
+/************************************************************************/
+
+void CPLCondSignal( void *hCond )
+
+{
+    CPLWin32Cond  *psCond = (CPLWin32Cond *) hCond;
+    CPLWaiterItem *psItem;
+
+    CPLAcquireMutex( psCond->hInternalMutex, 1000.0 );
+    psItem = psCond->psWaiterList;
+    if( psItem != NULL )
+    {
+        psCond->psWaiterList = psItem->psNext;
+        SetEvent( psItem->hEvent );
+    }
+    CPLReleaseMutex( psCond->hInternalMutex );
+}
+
+/************************************************************************/
+/*                          CPLCondBroadcast()                          */
+/************************************************************************/
+
+void CPLCondBroadcast( void *hCond )
+
+{
+    CPLWin32Cond  *psCond = (CPLWin32Cond *) hCond;
+    CPLWaiterItem *psItem;
+
+    CPLAcquireMutex( psCond->hInternalMutex, 1000.0 );
+    for( psItem = psCond->psWaiterList; psItem != NULL; 
+         psItem = psItem->psNext )
+        SetEvent( psItem->hEvent );
+    psCond->psWaiterList = NULL;
+    CPLReleaseMutex( psCond->hInternalMutex );
+}
+
+/************************************************************************/
+/*                           CPLDestroyCond()                           */
+/************************************************************************/
+
+void CPLDestroyCond( void *hCond )
+
+{
+    CPLWin32Cond *psCond = (CPLWin32Cond *) hCond;
+
+    if( psCond == NULL )
+        return;
+
+    CPLDestroyMutex( psCond->hInternalMutex );
+    CPLFree( psCond );
+}
+
+/************************************************************************/
+/*                          CPLCreateRWLock()                           */
+/*                                                                      */
+/*      SRWLOCK is not available before Vista, so readers/writer        */
+/*      locks are built on a mutex and a condition.  Waiting writers    */
+/*      block new readers so they cannot be starved.                    */
+/************************************************************************/
+
+typedef struct
+{
+    void          *hMutex;
+    void          *hCond;
+    int            nReaders;
+    int            bWriter;
+    int            nWritersWaiting;
+} CPLWin32RWLock;
+
+void *CPLCreateRWLock()
+
+{
+    CPLWin32RWLock *psLock = 
+        (CPLWin32RWLock *) CPLCalloc(sizeof(CPLWin32RWLock), 1);
+
+    psLock->hMutex = CPLCreateMutex();
+    CPLReleaseMutex( psLock->hMutex );
+    psLock->hCond = CPLCreateCond();
+
+    return psLock;
+}
+
+/************************************************************************/
+/*                        CPLAcquireRWLockRead()                        */
+/************************************************************************/
+
+int CPLAcquireRWLockRead( void *hRWLock )
+
+{
+    CPLWin32RWLock *psLock = (CPLWin32RWLock *) hRWLock;
+
+    CPLAcquireMutex( psLock->hMutex, 1000.0 );
+    while( psLock->bWriter || psLock->nWritersWaiting > 0 )
+        CPLCondWait( psLock->hCond, psLock->hMutex );
+    psLock->nReaders++;
+    CPLReleaseMutex( psLock->hMutex );
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                       CPLAcquireRWLockWrite()                        */
+/************************************************************************/
+
+int CPLAcquireRWLockWrite( void *hRWLock )
+
+{
+    CPLWin32RWLock *psLock = (CPLWin32RWLock *) hRWLock;
+
+    CPLAcquireMutex( psLock->hMutex, 1000.0 );
+    psLock->nWritersWaiting++;
+    while( psLock->bWriter || psLock->nReaders > 0 )
+        CPLCondWait( psLock->hCond, psLock->hMutex );
+    psLock->nWritersWaiting--;
+    psLock->bWriter = TRUE;
+    CPLReleaseMutex( psLock->hMutex );
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                          CPLReleaseRWLock()                          */
+/************************************************************************/
+
+void CPLReleaseRWLock( void *hRWLock )
+
+{
+    CPLWin32RWLock *psLock = (CPLWin32RWLock *) hRWLock;
+
+    CPLAcquireMutex( psLock->hMutex, 1000.0 );
+    if( psLock->bWriter )
+        psLock->bWriter = FALSE;
+    else
+        psLock->nReaders--;
+
+    if( psLock->nReaders == 0 )
+        CPLCondBroadcast( psLock->hCond );
+    CPLReleaseMutex( psLock->hMutex );
+}
+
+/************************************************************************/
+/*                          CPLDestroyRWLock()                          */
+/************************************************************************/
+
+void CPLDestroyRWLock( void *hRWLock )
+
+{
+    CPLWin32RWLock *psLock = (CPLWin32RWLock *) hRWLock;
+
+    if( psLock == NULL )
+        return;
+
+    CPLDestroyCond( psLock->hCond );
+    CPLDestroyMutex( psLock->hMutex );
+    CPLFree( psLock );
+}
+
 /************************************************************************/
 /*                              CPLSleep()                              */
 /************************************************************************/
@@ -633,8 +1108,7 @@ void CPLSleep( double dfWaitInSeconds )
     Sleep( (DWORD) (dfWaitInSeconds * 1000.0) );
 }
 
-static int           bTLSKeySetup = FALSE;
-static DWORD         nTLSKey;
+static volatile int  nTLSKey = (int) TLS_OUT_OF_INDEXES;
 
 /************************************************************************/
 /*                           CPLGetTLSList()                            */
@@ -645,15 +1119,23 @@ static void **CPLGetTLSList()
 {
     void **papTLSList;
 
-    if( !bTLSKeySetup )
+/* -------------------------------------------------------------------- */
+/*      Several threads may get here first at the same time: only one   */
+/*      of the keys they allocate is kept.                              */
+/* -------------------------------------------------------------------- */
+    if( nTLSKey == (int) TLS_OUT_OF_INDEXES )
     {
-        nTLSKey = TlsAlloc();
-        if( nTLSKey == TLS_OUT_OF_INDEXES )
+        DWORD nNewKey = TlsAlloc();
+
+        if( nNewKey == TLS_OUT_OF_INDEXES )
         {
             CPLError( CE_Fatal, CPLE_AppDefined, 
                       "TlsAlloc() failed!" );
         }
-        bTLSKeySetup = TRUE;
+
+        if( !CPLAtomicCompareAndExchange( &nTLSKey, (int) TLS_OUT_OF_INDEXES,
+                                          (int) nNewKey ) )
+            TlsFree( nNewKey );
     }
 
     papTLSList = (void **) TlsGetValue( nTLSKey );
@@ -679,7 +1161,7 @@ void CPLCleanupTLS()
 {
     void **papTLSList;
 
-    if( !bTLSKeySetup )
+    if( nTLSKey == (int) TLS_OUT_OF_INDEXES )
         return;
 
     papTLSList = (void **) TlsGetValue( nTLSKey );
@@ -695,6 +1177,7 @@ void CPLCleanupTLS()
 
 #ifdef CPL_MULTIPROC_PTHREAD
 #include <pthread.h>
+#include <unistd.h>
 #include <time.h>
 
   /************************************************************************/
@@ -935,6 +1418,232 @@ int CPLCreateThread( CPLThreadFunc pfnMain, void *pThreadArg )
     return 1; /* can we return the actual thread pid? */
 }
 
+/************************************************************************/
+/*                       CPLJoinableThreadJacket()                      */
+/************************************************************************/
+
+typedef struct {
+    void *pAppData;
+    CPLThreadFunc pfnMain;
+    pthread_t hThread;
+} CPLJoinableThreadInfo;
+
+static void *CPLJoinableThreadJacket( void *pData )
+
+{
+    CPLJoinableThreadInfo *psInfo = (CPLJoinableThreadInfo *) pData;
+
+    psInfo->pfnMain( psInfo->pAppData );
+
+    return NULL;
+}
+
+/************************************************************************/
+/*                      CPLCreateJoinableThread()                       */
+/*                                                                      */
+/*      Same as CPLCreateThread(), but the thread is not detached:      */
+/*      the returned handle must be passed to CPLJoinThread() which     */
+/*      waits for the thread to terminate.  Returns NULL on failure.    */
+/************************************************************************/
+
+void *CPLCreateJoinableThread( CPLThreadFunc pfnMain, void *pThreadArg )
+
+{
+    CPLJoinableThreadInfo *psInfo;
+
+    psInfo = (CPLJoinableThreadInfo*) 
+        CPLCalloc(sizeof(CPLJoinableThreadInfo),1);
+    psInfo->pAppData = pThreadArg;
+    psInfo->pfnMain = pfnMain;
+
+    if( pthread_create( &(psInfo->hThread), NULL, 
+                        CPLJoinableThreadJacket, (void *) psInfo ) != 0 )
+    {
+        CPLFree( psInfo );
+        return NULL;
+    }
+
+    return psInfo;
+}
+
+/************************************************************************/
+/*                           CPLJoinThread()                            */
+/************************************************************************/
+
+void CPLJoinThread( void *hJoinableThread )
+
+{
+    CPLJoinableThreadInfo *psInfo = (CPLJoinableThreadInfo *) hJoinableThread;
+
+    if( psInfo == NULL )
+        return;
+
+    pthread_join( psInfo->hThread, NULL );
+    CPLFree( psInfo );
+}
+
+/************************************************************************/
+/*                           CPLGetNumCPUs()                            */
+/************************************************************************/
+
+int CPLGetNumCPUs()
+
+{
+#ifdef _SC_NPROCESSORS_ONLN
+    int nCPUs = (int) sysconf( _SC_NPROCESSORS_ONLN );
+
+    return (nCPUs > 0) ? nCPUs : 1;
+#else
+    return 1;
+#endif
+}
+
+/************************************************************************/
+/*                           CPLCreateCond()                            */
+/************************************************************************/
+
+void *CPLCreateCond()
+
+{
+    pthread_cond_t *pCond;
+
+    pCond = (pthread_cond_t *) malloc(sizeof(pthread_cond_t));
+    if( pCond != NULL && pthread_cond_init( pCond, NULL ) != 0 )
+    {
+        free( pCond );
+        pCond = NULL;
+    }
+
+    return pCond;
+}
+
+/************************************************************************/
+/*                            CPLCondWait()                             */
+/*                                                                      */
+/*      hMutex must be held exactly once by the calling thread since    */
+/*      pthread_cond_wait() only releases one level of a recursive      */
+/*      mutex.                                                          */
+/************************************************************************/
+
+void CPLCondWait( void *hCond, void *hMutex )
+
+{
+    pthread_cond_wait( (pthread_cond_t *) hCond, (pthread_mutex_t *) hMutex );
+}
+
+/************************************************************************/
+/*                           CPLCondSignal()                            */
+/************************************************************************/
+
+void CPLCondSignal( void *hCond )
+
+{
+    pthread_cond_signal( (pthread_cond_t *) hCond );
+}
+
+/************************************************************************/
+/*                          CPLCondBroadcast()                          */
+/************************************************************************/
+
+void CPLCondBroadcast( void *hCond )
+
+{
+    pthread_cond_broadcast( (pthread_cond_t *) hCond );
+}
+
+/************************************************************************/
+/*                           CPLDestroyCond()                           */
+/************************************************************************/
+
+void CPLDestroyCond( void *hCond )
+
+{
+    if( hCond == NULL )
+        return;
+
+    pthread_cond_destroy( (pthread_cond_t *) hCond );
+    free( hCond );
+}
+
+/************************************************************************/
+/*                          CPLCreateRWLock()                           */
+/************************************************************************/
+
+void *CPLCreateRWLock()
+
+{
+    pthread_rwlock_t *pRWLock;
+
+    pRWLock = (pthread_rwlock_t *) malloc(sizeof(pthread_rwlock_t));
+    if( pRWLock != NULL && pthread_rwlock_init( pRWLock, NULL ) != 0 )
+    {
+        free( pRWLock );
+        pRWLock = NULL;
+    }
+
+    return pRWLock;
+}
+
+/************************************************************************/
+/*                        CPLAcquireRWLockRead()                        */
+/************************************************************************/
+
+int CPLAcquireRWLockRead( void *hRWLock )
+
+{
+    int err = pthread_rwlock_rdlock( (pthread_rwlock_t *) hRWLock );
+
+    if( err != 0 )
+    {
+        CPLDebug( "CPLAcquireRWLockRead", "Error = %d", err );
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                       CPLAcquireRWLockWrite()                        */
+/************************************************************************/
+
+int CPLAcquireRWLockWrite( void *hRWLock )
+
+{
+    int err = pthread_rwlock_wrlock( (pthread_rwlock_t *) hRWLock );
+
+    if( err != 0 )
+    {
+        CPLDebug( "CPLAcquireRWLockWrite", "Error = %d", err );
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                          CPLReleaseRWLock()                          */
+/************************************************************************/
+
+void CPLReleaseRWLock( void *hRWLock )
+
+{
+    pthread_rwlock_unlock( (pthread_rwlock_t *) hRWLock );
+}
+
+/************************************************************************/
+/*                          CPLDestroyRWLock()                          */
+/************************************************************************/
+
+void CPLDestroyRWLock( void *hRWLock )
+
+{
+    if( hRWLock == NULL )
+        return;
+
+    pthread_rwlock_destroy( (pthread_rwlock_t *) hRWLock );
+    free( hRWLock );
+}
+
 /************************************************************************/
 /*                              CPLSleep()                              */
 /************************************************************************/
@@ -949,9 +1658,48 @@ void CPLSleep( double dfWaitInSeconds )
     nanosleep( &sRequest, &sRemain );
 }
 
+static pthread_once_t oTLSKeyOnce = PTHREAD_ONCE_INIT;
 static int           bTLSKeySetup = FALSE;
 static pthread_key_t oTLSKey;
 
+#ifdef CPL_THREAD_LOCAL
+CPL_THREAD_LOCAL void **papCPLTLSListCache = NULL;
+#endif
+
+/************************************************************************/
+/*                        CPLTLSKeyDestructor()                         */
+/*                                                                      */
+/*      Runs in the exiting thread, so the cache can be reset for any   */
+/*      other key destructor that would still call CPLGetTLS().         */
+/************************************************************************/
+
+static void CPLTLSKeyDestructor( void *papTLSList )
+
+{
+#ifdef CPL_THREAD_LOCAL
+    papCPLTLSListCache = NULL;
+#endif
+    CPLCleanupTLSList( (void **) papTLSList );
+}
+
+/************************************************************************/
+/*                           CPLMakeTLSKey()                            */
+/*                                                                      */
+/*      Run through pthread_once(), as threads may race to be the       */
+/*      first one to use TLS.                                           */
+/************************************************************************/
+
+static void CPLMakeTLSKey()
+
+{
+    if( pthread_key_create( &oTLSKey, CPLTLSKeyDestructor ) != 0 )
+    {
+        CPLError( CE_Fatal, CPLE_AppDefined, 
+                  "pthread_key_create() failed!" );
+    }
+    bTLSKeySetup = TRUE;
+}
+
 /************************************************************************/
 /*                           CPLCleanupTLS()                            */
 /************************************************************************/
@@ -969,6 +1717,9 @@ void CPLCleanupTLS()
         return;
 
     pthread_setspecific( oTLSKey, NULL );
+#ifdef CPL_THREAD_LOCAL
+    papCPLTLSListCache = NULL;
+#endif
 
     CPLCleanupTLSList( papTLSList );
 }
@@ -982,16 +1733,12 @@ static void **CPLGetTLSList()
 {
     void **papTLSList;
 
-    if( !bTLSKeySetup )
-    {
-        if( pthread_key_create( &oTLSKey, 
-                                (void (*)(void*)) CPLCleanupTLSList ) != 0 )
-        {
-            CPLError( CE_Fatal, CPLE_AppDefined, 
-                      "pthread_key_create() failed!" );
-        }
-        bTLSKeySetup = TRUE;
-    }
+#ifdef CPL_THREAD_LOCAL
+    if( papCPLTLSListCache != NULL )
+        return papCPLTLSListCache;
+#endif
+
+    pthread_once( &oTLSKeyOnce, CPLMakeTLSKey );
 
     papTLSList = (void **) pthread_getspecific( oTLSKey );
     if( papTLSList == NULL )
@@ -1004,6 +1751,10 @@ static void **CPLGetTLSList()
         }
     }
 
+#ifdef CPL_THREAD_LOCAL
+    papCPLTLSListCache = papTLSList;
+#endif
+
     return papTLSList;
 }
 
@@ -65,6 +65,22 @@ GIntBig CPL_DLL CPLGetPID();
 int   CPL_DLL CPLCreateThread( CPLThreadFunc pfnMain, void *pArg );
 void  CPL_DLL CPLSleep( double dfWaitInSeconds );
 
+void CPL_DLL *CPLCreateJoinableThread( CPLThreadFunc pfnMain, void *pArg );
+void  CPL_DLL CPLJoinThread( void *hJoinableThread );
+int   CPL_DLL CPLGetNumCPUs();
+
+void CPL_DLL *CPLCreateCond();
+void  CPL_DLL CPLCondWait( void *hCond, void *hMutex );
+void  CPL_DLL CPLCondSignal( void *hCond );
+void  CPL_DLL CPLCondBroadcast( void *hCond );
+void  CPL_DLL CPLDestroyCond( void *hCond );
+
+void CPL_DLL *CPLCreateRWLock();
+int   CPL_DLL CPLAcquireRWLockRead( void *hRWLock );
+int   CPL_DLL CPLAcquireRWLockWrite( void *hRWLock );
+void  CPL_DLL CPLReleaseRWLock( void *hRWLock );
+void  CPL_DLL CPLDestroyRWLock( void *hRWLock );
+
 const char CPL_DLL *CPLGetThreadingModel();
 
 CPL_C_END
@@ -87,6 +103,17 @@ class CPL_DLL CPLMutexHolder
                     int nLine = __LINE__ );
     ~CPLMutexHolder();
 };
+
+class CPL_DLL CPLRWLockHolder
+{
+  private:
+    void       *hRWLock;
+
+  public:
+
+    CPLRWLockHolder( void *hRWLock, int bWrite );
+    ~CPLRWLockHolder();
+};
 #endif /* def __cplusplus */
 
 /* -------------------------------------------------------------------- */
@@ -108,6 +135,8 @@ class CPL_DLL CPLMutexHolder
 #define CTLS_VERSIONINFO_LICENCE       13         /* gdal_misc.cpp */
 #define CTLS_CONFIGOPTIONS             14         /* cpl_conv.cpp */
 #define CTLS_FINDFILE                  15         /* cpl_findfile.cpp */
+#define CTLS_WORKERTHREAD              16         /* cpl_worker_thread_pool.cpp */
+#define CTLS_ERRORCOUNTER              17         /* cpl_error.cpp */
 
 #define CTLS_MAX                       32         
 
@@ -115,6 +144,26 @@ CPL_C_START
 void CPL_DLL * CPLGetTLS( int nIndex );
 void CPL_DLL CPLSetTLS( int nIndex, void *pData, int bFreeOnExit );
 void CPL_DLL CPLCleanupTLS();
+
+/* -------------------------------------------------------------------- */
+/*      With compiler thread local storage the current thread's TLS     */
+/*      list is cached in a __thread variable, so CPLGetTLSFast() is    */
+/*      an inline load rather than a pthread_getspecific() call.        */
+/*      Define CPL_NO_COMPILER_TLS to disable.                          */
+/* -------------------------------------------------------------------- */
+#if defined(CPL_MULTIPROC_PTHREAD) && defined(__GNUC__) \
+    && !defined(CPL_NO_COMPILER_TLS)
+#  define CPL_THREAD_LOCAL __thread
+#endif
+
+#ifdef CPL_THREAD_LOCAL
+extern CPL_DLL CPL_THREAD_LOCAL void **papCPLTLSListCache;
+#  define CPLGetTLSFast(nIndex) \
+    (papCPLTLSListCache != NULL ? papCPLTLSListCache[nIndex] \
+                                : CPLGetTLS(nIndex))
+#else
+#  define CPLGetTLSFast(nIndex) CPLGetTLS(nIndex)
+#endif
 CPL_C_END
 
 #endif /* _CPL_MULTIPROC_H_INCLUDED_ */
@@ -0,0 +1,464 @@
+/**********************************************************************
+ * $Id$
+ *
+ * Name:     cpl_multiproc_test.cpp
+ * Project:  CPL - Common Portability Library
+ * Language: C++
+ * Purpose:  Test mainline for the atomic compare-and-exchange, the
+ *           read/write locks and the SPMC queue.
+ *
+ **********************************************************************
+ * Copyright (c) 2026, MITAB contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cpl_multiproc.h"
+#include "cpl_atomic_ops.h"
+#include "cpl_spmc_queue.h"
+#include "cpl_conv.h"
+
+#define NUM_THREADS     4
+#define NUM_CAS_ITER    100000
+#define NUM_RW_ITER     20000
+#define NUM_QUEUE_ITEMS 200000
+#define QUEUE_CAPACITY  64
+
+/************************************************************************/
+/*                              TestFailed()                            */
+/************************************************************************/
+
+static void TestFailed( const char *pszTest, const char *pszMsg )
+
+{
+    printf( "%s: FAILED, %s\n", pszTest, pszMsg );
+    exit( 1 );
+}
+
+/************************************************************************/
+/*                              TestCAS()                               */
+/*                                                                      */
+/*      The exchange only happens when the current value is the         */
+/*      expected one.                                                   */
+/************************************************************************/
+
+static void TestCAS()
+
+{
+    volatile int  nValue = 5;
+    char          achTarget[2];
+    void * volatile pValue = achTarget;
+
+    if( CPLAtomicCompareAndExchange( &nValue, 4, 6 ) || nValue != 5 )
+        TestFailed( "TestCAS", "exchanged with a wrong old value" );
+    if( !CPLAtomicCompareAndExchange( &nValue, 5, 6 ) || nValue != 6 )
+        TestFailed( "TestCAS", "did not exchange with the right old value" );
+
+    if( CPLAtomicCompareAndExchangePtr( &pValue, achTarget + 1, NULL )
+        || pValue != achTarget )
+        TestFailed( "TestCAS", "exchanged pointer with a wrong old value" );
+    if( !CPLAtomicCompareAndExchangePtr( &pValue, achTarget, achTarget + 1 )
+        || pValue != achTarget + 1 )
+        TestFailed( "TestCAS",
+                    "did not exchange pointer with the right old value" );
+
+    printf( "TestCAS: OK\n" );
+}
+
+/************************************************************************/
+/*                             TestRWLock()                             */
+/*                                                                      */
+/*      Locks are balanced and can be taken again once released.       */
+/************************************************************************/
+
+static void TestRWLock()
+
+{
+    void *hRWLock = CPLCreateRWLock();
+
+    if( hRWLock == NULL )
+        TestFailed( "TestRWLock", "CPLCreateRWLock() failed" );
+
+    if( !CPLAcquireRWLockRead( hRWLock ) )
+        TestFailed( "TestRWLock", "CPLAcquireRWLockRead() failed" );
+    CPLReleaseRWLock( hRWLock );
+
+    if( !CPLAcquireRWLockWrite( hRWLock ) )
+        TestFailed( "TestRWLock", "CPLAcquireRWLockWrite() failed" );
+    CPLReleaseRWLock( hRWLock );
+
+    {
+        CPLRWLockHolder oHolder( hRWLock, FALSE );
+    }
+    {
+        CPLRWLockHolder oHolder( hRWLock, TRUE );
+    }
+
+    if( !CPLAcquireRWLockWrite( hRWLock ) )
+        TestFailed( "TestRWLock", "lock not released by CPLRWLockHolder" );
+    CPLReleaseRWLock( hRWLock );
+
+    CPLDestroyRWLock( hRWLock );
+
+    printf( "TestRWLock: OK\n" );
+}
+
+/************************************************************************/
+/*                             TestQueue()                              */
+/*                                                                      */
+/*      Single threaded: capacity is rounded up to a power of two,      */
+/*      Push() fails when full, Pop() fails when empty, and items come  */
+/*      out in order while the indices wrap around the ring many times. */
+/************************************************************************/
+
+static void TestQueue()
+
+{
+    CPLSPMCQueue *psQueue = CPLSPMCQueueCreate( 3 );
+    void         *pItem;
+    int           iRound, i, nNext = 0;
+
+    for( iRound = 0; iRound < 1000; iRound++ )
+    {
+        /* Alternate between filling the queue and keeping it short */
+        /* so that the head and tail land on every slot.            */
+        int nFill = (iRound % 2) ? 4 : 1 + iRound % 4;
+
+        for( i = 0; i < nFill; i++ )
+        {
+            if( !CPLSPMCQueuePush( psQueue, (void *) (size_t) (nNext + i) ) )
+                TestFailed( "TestQueue", "Push() failed before capacity" );
+        }
+
+        if( nFill == 4 && CPLSPMCQueuePush( psQueue, NULL ) )
+            TestFailed( "TestQueue", "Push() succeeded on a full queue" );
+
+        for( i = 0; i < nFill; i++ )
+        {
+            if( !CPLSPMCQueuePop( psQueue, &pItem ) )
+                TestFailed( "TestQueue", "Pop() failed on a non-empty queue" );
+            if( (size_t) pItem != (size_t) (nNext + i) )
+                TestFailed( "TestQueue", "items popped out of order" );
+        }
+        nNext += nFill;
+
+        if( CPLSPMCQueuePop( psQueue, &pItem ) )
+            TestFailed( "TestQueue", "Pop() succeeded on an empty queue" );
+    }
+
+    CPLSPMCQueueDestroy( psQueue );
+
+    printf( "TestQueue: OK\n" );
+}
+
+#ifndef CPL_MULTIPROC_STUB
+
+/************************************************************************/
+/*                          RunThreads()                                */
+/************************************************************************/
+
+static void RunThreads( const char *pszTest, int nThreads,
+                        CPLThreadFunc pfnMain, void **papArg )
+
+{
+    void *ahThreads[NUM_THREADS];
+    int   i;
+
+    for( i = 0; i < nThreads; i++ )
+    {
+        ahThreads[i] = CPLCreateJoinableThread( pfnMain, papArg[i] );
+        if( ahThreads[i] == NULL )
+            TestFailed( pszTest, "CPLCreateJoinableThread() failed" );
+    }
+
+    for( i = 0; i < nThreads; i++ )
+        CPLJoinThread( ahThreads[i] );
+}
+
+/************************************************************************/
+/*                         TestTLSFirstUse()                            */
+/*                                                                      */
+/*      Threads released together that all use TLS for the first time  */
+/*      in the process each get their own slots.  Must run before       */
+/*      anything else uses TLS.                                         */
+/************************************************************************/
+
+#define CTLS_TEST       (CTLS_MAX - 1)
+
+static volatile int nTLSReady = 0;
+static volatile int nTLSMismatches = 0;
+
+static void TLSThreadMain( void *pData )
+{
+    int i;
+
+    CPLAtomicInc( &nTLSReady );
+    while( CPLAtomicAdd( &nTLSReady, 0 ) < NUM_THREADS )
+        CPLSleep( 0.0001 );
+
+    CPLSetTLS( CTLS_TEST, pData, FALSE );
+    for( i = 0; i < 100; i++ )
+    {
+        if( CPLGetTLS( CTLS_TEST ) != pData )
+            CPLAtomicInc( &nTLSMismatches );
+        CPLSleep( 0.0001 );
+    }
+}
+
+static void TestTLSFirstUse()
+
+{
+    int   anData[NUM_THREADS];
+    void *apArg[NUM_THREADS];
+    int   i;
+
+    for( i = 0; i < NUM_THREADS; i++ )
+        apArg[i] = anData + i;
+
+    RunThreads( "TestTLSFirstUse", NUM_THREADS, TLSThreadMain, apArg );
+
+    if( nTLSMismatches != 0 )
+        TestFailed( "TestTLSFirstUse", "threads shared TLS slots" );
+
+    printf( "TestTLSFirstUse: OK\n" );
+}
+
+/************************************************************************/
+/*                       TestCASContention()                            */
+/*                                                                      */
+/*      Counters only incremented through compare-and-exchange retry    */
+/*      loops lose no increment.                                        */
+/************************************************************************/
+
+static volatile int   nCASCounter = 0;
+static char           achPtrCounter[NUM_THREADS * NUM_CAS_ITER + 1];
+static void * volatile pCASCounter = achPtrCounter;
+
+static void CASThreadMain( void *pData )
+{
+    int   i, nOld;
+    void *pOld;
+
+    for( i = 0; i < NUM_CAS_ITER; i++ )
+    {
+        do {
+            nOld = nCASCounter;
+        } while( !CPLAtomicCompareAndExchange( &nCASCounter, nOld, nOld+1 ) );
+
+        do {
+            pOld = pCASCounter;
+        } while( !CPLAtomicCompareAndExchangePtr( &pCASCounter, pOld,
+                                                  (char *) pOld + 1 ) );
+    }
+}
+
+static void TestCASContention()
+
+{
+    void *apArg[NUM_THREADS] = { NULL };
+
+    RunThreads( "TestCASContention", NUM_THREADS, CASThreadMain, apArg );
+
+    if( nCASCounter != NUM_THREADS * NUM_CAS_ITER )
+        TestFailed( "TestCASContention", "integer counter lost updates" );
+    if( pCASCounter != achPtrCounter + NUM_THREADS * NUM_CAS_ITER )
+        TestFailed( "TestCASContention", "pointer counter lost updates" );
+
+    printf( "TestCASContention: OK\n" );
+}
+
+/************************************************************************/
+/*                       TestRWLockContention()                         */
+/*                                                                      */
+/*      Mixed readers and writers: a writer never holds the lock        */
+/*      together with a reader or another writer.                       */
+/************************************************************************/
+
+static void        *hContendedRWLock = NULL;
+static volatile int nActiveReaders = 0;
+static volatile int nActiveWriters = 0;
+static volatile int nRWViolations = 0;
+static int          anShared[2] = { 0, 0 };
+
+static void RWThreadMain( void *pData )
+{
+    int iThread = (int) (size_t) pData;
+    int i;
+
+    for( i = 0; i < NUM_RW_ITER; i++ )
+    {
+        /* Thread i writes on every (i+2)th iteration. */
+        if( i % (iThread + 2) == 0 )
+        {
+            CPLRWLockHolder oHolder( hContendedRWLock, TRUE );
+
+            if( CPLAtomicInc( &nActiveWriters ) != 1
+                || nActiveReaders != 0 )
+                CPLAtomicInc( &nRWViolations );
+            anShared[0]++;
+            anShared[1]++;
+            CPLAtomicDec( &nActiveWriters );
+        }
+        else
+        {
+            CPLRWLockHolder oHolder( hContendedRWLock, FALSE );
+
+            CPLAtomicInc( &nActiveReaders );
+            if( nActiveWriters != 0 || anShared[0] != anShared[1] )
+                CPLAtomicInc( &nRWViolations );
+            CPLAtomicDec( &nActiveReaders );
+        }
+    }
+}
+
+static void TestRWLockContention()
+
+{
+    void *apArg[NUM_THREADS];
+    int   i, nExpectedWrites = 0;
+
+    for( i = 0; i < NUM_THREADS; i++ )
+    {
+        apArg[i] = (void *) (size_t) i;
+        nExpectedWrites += (NUM_RW_ITER + i + 1) / (i + 2);
+    }
+
+    hContendedRWLock = CPLCreateRWLock();
+
+    RunThreads( "TestRWLockContention", NUM_THREADS, RWThreadMain, apArg );
+
+    CPLDestroyRWLock( hContendedRWLock );
+    hContendedRWLock = NULL;
+
+    if( nRWViolations != 0 )
+        TestFailed( "TestRWLockContention",
+                    "writer held the lock with other holders" );
+    if( anShared[0] != nExpectedWrites || anShared[1] != nExpectedWrites )
+        TestFailed( "TestRWLockContention", "writes were lost" );
+
+    printf( "TestRWLockContention: OK\n" );
+}
+
+/************************************************************************/
+/*                        TestQueueConsumers()                          */
+/*                                                                      */
+/*      One producer, several consumers, a small ring: every item is    */
+/*      delivered to exactly one consumer.                              */
+/************************************************************************/
+
+static CPLSPMCQueue  *psContendedQueue = NULL;
+static unsigned char *pabyDelivered = NULL;
+static volatile int   nDelivered = 0;
+static volatile int   nDuplicates = 0;
+
+static void ConsumerThreadMain( void *pData )
+{
+    void *pItem;
+
+    while( nDelivered < NUM_QUEUE_ITEMS )
+    {
+        /* Back off when empty, the producer may share our CPU. */
+        if( !CPLSPMCQueuePop( psContendedQueue, &pItem ) )
+        {
+            CPLSleep( 0.0001 );
+            continue;
+        }
+
+        /* Each item has its own byte, so only duplicates race here. */
+        if( pabyDelivered[(size_t) pItem]++ != 0 )
+            CPLAtomicInc( &nDuplicates );
+        CPLAtomicInc( &nDelivered );
+    }
+}
+
+static void TestQueueConsumers()
+
+{
+    void *ahThreads[NUM_THREADS - 1];
+    int   i, nFull = 0;
+
+    psContendedQueue = CPLSPMCQueueCreate( QUEUE_CAPACITY );
+    pabyDelivered = (unsigned char *) CPLCalloc( NUM_QUEUE_ITEMS, 1 );
+
+    for( i = 0; i < NUM_THREADS - 1; i++ )
+    {
+        ahThreads[i] = CPLCreateJoinableThread( ConsumerThreadMain, NULL );
+        if( ahThreads[i] == NULL )
+            TestFailed( "TestQueueConsumers",
+                        "CPLCreateJoinableThread() failed" );
+    }
+
+    for( i = 0; i < NUM_QUEUE_ITEMS; i++ )
+    {
+        while( !CPLSPMCQueuePush( psContendedQueue, (void *) (size_t) i ) )
+        {
+            nFull++;
+            CPLSleep( 0.0001 );
+        }
+    }
+
+    for( i = 0; i < NUM_THREADS - 1; i++ )
+        CPLJoinThread( ahThreads[i] );
+
+    if( nDuplicates != 0 )
+        TestFailed( "TestQueueConsumers", "an item was delivered twice" );
+    for( i = 0; i < NUM_QUEUE_ITEMS; i++ )
+    {
+        if( pabyDelivered[i] != 1 )
+            TestFailed( "TestQueueConsumers", "an item was not delivered" );
+    }
+
+    CPLFree( pabyDelivered );
+    pabyDelivered = NULL;
+    CPLSPMCQueueDestroy( psContendedQueue );
+    psContendedQueue = NULL;
+
+    CPLDebug( "CPL", "TestQueueConsumers: queue was full %d times.", nFull );
+    printf( "TestQueueConsumers: OK\n" );
+}
+
+#endif /* ndef CPL_MULTIPROC_STUB */
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main( int nArgc, char ** papszArgv )
+
+{
+#ifndef CPL_MULTIPROC_STUB
+    TestTLSFirstUse();
+#endif
+    TestCAS();
+    TestRWLock();
+    TestQueue();
+
+#ifndef CPL_MULTIPROC_STUB
+    TestCASContention();
+    TestRWLockContention();
+    TestQueueConsumers();
+#endif
+
+    printf( "All multiprocessing primitive tests passed.\n" );
+
+    exit( 0 );
+}
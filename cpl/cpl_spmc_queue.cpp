@@ -0,0 +1,146 @@
+/**********************************************************************
+ * $Id$
+ *
+ * Project:  CPL - Common Portability Library
+ * Purpose:  Lock-free bounded single producer / multiple consumers queue.
+ *
+ **********************************************************************
+ * Copyright (c) 2026, MITAB contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_spmc_queue.h"
+#include "cpl_atomic_ops.h"
+#include "cpl_conv.h"
+
+CPL_CVSID("$Id$");
+
+/* 
+ * Items live in a power of two ring indexed by free running counters.
+ * The producer owns nTail, consumers claim an item by advancing nHead
+ * with a compare-and-swap.  The producer only reuses a slot once nHead
+ * has moved past it, so a consumer whose CAS succeeds read a slot that
+ * could not have been overwritten.
+ */
+struct _CPLSPMCQueue
+{
+    void              **papItems;
+    unsigned int        nMask;
+
+    volatile int        nHead;          /* next item to pop */
+    volatile int        nTail;          /* next slot to fill */
+
+    int                 nHeadCache;     /* producer's view of nHead */
+};
+
+/************************************************************************/
+/*                         CPLSPMCQueueCreate()                         */
+/*                                                                      */
+/*      nCapacity is rounded up to a power of two.                      */
+/************************************************************************/
+
+CPLSPMCQueue *CPLSPMCQueueCreate( int nCapacity )
+
+{
+    CPLSPMCQueue *psQueue;
+    unsigned int  nSize = 2;
+
+    while( (int) nSize < nCapacity && nSize < 0x40000000U )
+        nSize *= 2;
+
+    psQueue = (CPLSPMCQueue *) CPLCalloc( sizeof(CPLSPMCQueue), 1 );
+    psQueue->papItems = (void **) CPLCalloc( sizeof(void*), nSize );
+    psQueue->nMask = nSize - 1;
+
+    return psQueue;
+}
+
+/************************************************************************/
+/*                        CPLSPMCQueueDestroy()                         */
+/************************************************************************/
+
+void CPLSPMCQueueDestroy( CPLSPMCQueue *psQueue )
+
+{
+    if( psQueue == NULL )
+        return;
+
+    CPLFree( psQueue->papItems );
+    CPLFree( psQueue );
+}
+
+/************************************************************************/
+/*                          CPLSPMCQueuePush()                          */
+/*                                                                      */
+/*      Producer thread only.  Returns FALSE if the queue is full.      */
+/************************************************************************/
+
+int CPLSPMCQueuePush( CPLSPMCQueue *psQueue, void *pItem )
+
+{
+    unsigned int nTail = (unsigned int) psQueue->nTail;
+
+    if( nTail - (unsigned int) psQueue->nHeadCache > psQueue->nMask )
+    {
+        /* Adding 0 reads nHead with a full barrier, so the slot is */
+        /* not written before the consumer that took it read it.   */
+        psQueue->nHeadCache = CPLAtomicAdd( &(psQueue->nHead), 0 );
+        if( nTail - (unsigned int) psQueue->nHeadCache > psQueue->nMask )
+            return FALSE;
+    }
+
+    psQueue->papItems[nTail & psQueue->nMask] = pItem;
+
+    /* Publish the slot. */
+    CPLAtomicInc( &(psQueue->nTail) );
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                          CPLSPMCQueuePop()                           */
+/*                                                                      */
+/*      Any thread.  Returns FALSE if the queue is empty.               */
+/************************************************************************/
+
+int CPLSPMCQueuePop( CPLSPMCQueue *psQueue, void **ppItem )
+
+{
+    while( TRUE )
+    {
+        int   nHead = psQueue->nHead;
+        /* Barrier: the slot read below sees what the producer stored */
+        /* before publishing nTail.                                    */
+        int   nTail = CPLAtomicAdd( &(psQueue->nTail), 0 );
+        void *pItem;
+
+        if( nHead == nTail )
+            return FALSE;
+
+        pItem = psQueue->papItems[(unsigned int) nHead & psQueue->nMask];
+
+        if( CPLAtomicCompareAndExchange( &(psQueue->nHead), nHead, 
+                                         (int) ((unsigned int) nHead + 1) ) )
+        {
+            *ppItem = pItem;
+            return TRUE;
+        }
+    }
+}
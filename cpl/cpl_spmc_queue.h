@@ -0,0 +1,52 @@
+/**********************************************************************
+ * $Id$
+ *
+ * Project:  CPL - Common Portability Library
+ * Purpose:  Lock-free bounded single producer / multiple consumers queue.
+ *
+ **********************************************************************
+ * Copyright (c) 2026, MITAB contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef _CPL_SPMC_QUEUE_H_INCLUDED_
+#define _CPL_SPMC_QUEUE_H_INCLUDED_
+
+#include "cpl_port.h"
+
+CPL_C_START
+
+/************************************************************************/
+/*      Bounded FIFO of pointers.  Only one thread may push, any        */
+/*      number of threads may pop concurrently.  Neither operation      */
+/*      blocks: Push fails when the queue is full, Pop when it is       */
+/*      empty.                                                          */
+/************************************************************************/
+
+typedef struct _CPLSPMCQueue CPLSPMCQueue;
+
+CPLSPMCQueue CPL_DLL *CPLSPMCQueueCreate( int nCapacity );
+void  CPL_DLL CPLSPMCQueueDestroy( CPLSPMCQueue *psQueue );
+int   CPL_DLL CPLSPMCQueuePush( CPLSPMCQueue *psQueue, void *pItem );
+int   CPL_DLL CPLSPMCQueuePop( CPLSPMCQueue *psQueue, void **ppItem );
+
+CPL_C_END
+
+#endif /* _CPL_SPMC_QUEUE_H_INCLUDED_ */
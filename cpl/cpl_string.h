@@ -168,6 +168,14 @@ wchar_t CPL_DLL *CPLRecodeToWChar( const char *pszSource,
 int CPL_DLL CPLIsUTF8(const char* pabyData, int nLen);
 char CPL_DLL *CPLForceToASCII(const char* pabyData, int nLen, char chReplacementChar);
 
+const unsigned short CPL_DLL *CPLGetSingleByteToUCSTable( const char *pszEncoding );
+int CPL_DLL CPLRecodeSingleByteToUTF8( const char *pszSource, int nSrcLen,
+                                       const unsigned short *panTable,
+                                       char *pszDest, int nDestSize );
+int CPL_DLL CPLRecodeUTF8ToSingleByte( const char *pszSource,
+                                       const unsigned short *panTable,
+                                       char *pszDest, int nDestSize );
+
 CPL_C_END
 
 /************************************************************************/
@@ -84,6 +84,7 @@ int CPL_DLL     VSIFSeek( FILE *, long, int );
 long CPL_DLL    VSIFTell( FILE * );
 void CPL_DLL    VSIRewind( FILE * );
 void CPL_DLL    VSIFFlush( FILE * );
+int CPL_DLL     VSIFAdviseRead( FILE *, long, long );
 
 size_t CPL_DLL  VSIFRead( void *, size_t, size_t, FILE * );
 size_t CPL_DLL  VSIFWrite( const void *, size_t, size_t, FILE * );
@@ -58,6 +58,7 @@ CPL_CVSID("$Id: cpl_vsisimple.cpp 18568 2010-01-17 02:49:31Z rouault $");
 /* Unix or Windows NT/2000/XP */
 #if !defined(WIN32) && !defined(WIN32CE)
 #  include <unistd.h>
+#  include <fcntl.h>
 #elif !defined(WIN32CE) /* not Win32 platform */
 #  include <io.h>
 #  include <fcntl.h>
@@ -211,6 +212,30 @@ void VSIFFlush( FILE * fp )
     fflush( fp );
 }
 
+/************************************************************************/
+/*                           VSIFAdviseRead()                           */
+/*                                                                      */
+/*      Hint that nLength bytes at nOffset will be read soon, so the    */
+/*      OS can start fetching them in the background.  Returns TRUE     */
+/*      if the hint was passed on, FALSE if not supported.              */
+/************************************************************************/
+
+int VSIFAdviseRead( FILE * fp, long nOffset, long nLength )
+
+{
+#if defined(POSIX_FADV_WILLNEED)
+    int     nResult = posix_fadvise( fileno(fp), (off_t) nOffset, 
+                                     (off_t) nLength, POSIX_FADV_WILLNEED );
+
+    VSIDebug4( "VSIFAdviseRead(%p,%ld,%ld) = %d", 
+               fp, nOffset, nLength, nResult );
+
+    return nResult == 0;
+#else
+    return FALSE;
+#endif
+}
+
 /************************************************************************/
 /*                              VSIFGets()                              */
 /************************************************************************/
@@ -0,0 +1,439 @@
+/**********************************************************************
+ * $Id$
+ *
+ * Project:  CPL - Common Portability Library
+ * Purpose:  Pool of worker threads with per-worker work-stealing job 
+ *           queues.
+ *
+ **********************************************************************
+ * Copyright (c) 2026, MITAB contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_worker_thread_pool.h"
+#include "cpl_conv.h"
+
+CPL_CVSID("$Id$");
+
+typedef struct
+{
+    CPLThreadFunc       pfnFunc;
+    void               *pData;
+} CPLWorkerJob;
+
+/* Ring buffer of jobs.  The owner works at the back, thieves at the front. */
+struct _CPLWorkerJobDeque
+{
+    void               *hMutex;
+    CPLWorkerJob       *pasJobs;
+    int                 nAlloc;
+    int                 nFirst;
+    int                 nCount;
+};
+
+struct _CPLWorkerThread
+{
+    CPLWorkerThreadPool *poPool;
+    int                 iThread;
+    void               *hThread;
+    CPLThreadFunc       pfnInitFunc;
+    void               *pInitData;
+    CPLWorkerJobDeque   sDeque;
+};
+
+/************************************************************************/
+/*                        CPLWorkerThreadPool()                         */
+/************************************************************************/
+
+CPLWorkerThreadPool::CPLWorkerThreadPool()
+
+{
+    hMutex = NULL;
+    hCondJobs = NULL;
+    hCondDone = NULL;
+
+    nThreads = 0;
+    pasThreads = NULL;
+    nNextThread = 0;
+
+    nQueuedJobs = 0;
+    nPendingJobs = 0;
+    nWaitingThreads = 0;
+    nInitDone = 0;
+    bStop = FALSE;
+}
+
+/************************************************************************/
+/*                        ~CPLWorkerThreadPool()                        */
+/*                                                                      */
+/*      Waits for the submitted jobs to complete, then stops the        */
+/*      worker threads.                                                 */
+/************************************************************************/
+
+CPLWorkerThreadPool::~CPLWorkerThreadPool()
+
+{
+    int i;
+
+    if( nThreads > 0 )
+    {
+        WaitCompletion();
+
+        CPLAcquireMutex( hMutex, 1000.0 );
+        bStop = TRUE;
+        CPLCondBroadcast( hCondJobs );
+        CPLReleaseMutex( hMutex );
+
+        for( i = 0; i < nThreads; i++ )
+            CPLJoinThread( pasThreads[i].hThread );
+    }
+
+    if( pasThreads != NULL )
+    {
+        for( i = 0; pasThreads[i].poPool != NULL; i++ )
+        {
+            CPLDestroyMutex( pasThreads[i].sDeque.hMutex );
+            CPLFree( pasThreads[i].sDeque.pasJobs );
+        }
+        CPLFree( pasThreads );
+    }
+
+    if( hCondJobs != NULL )
+        CPLDestroyCond( hCondJobs );
+    if( hCondDone != NULL )
+        CPLDestroyCond( hCondDone );
+    if( hMutex != NULL )
+        CPLDestroyMutex( hMutex );
+}
+
+/************************************************************************/
+/*                               Setup()                                */
+/*                                                                      */
+/*      Start nThreads worker threads (one per CPU if nThreads <= 0).   */
+/*      If pfnInitFunc is not NULL, each worker calls it once before    */
+/*      running any job, with papInitData[iThread] as argument (or      */
+/*      NULL if papInitData is NULL), e.g. to set up thread local       */
+/*      state.  Returns once all workers are initialized.               */
+/*                                                                      */
+/*      Returns FALSE if no thread could be started, in which case      */
+/*      the pool runs the jobs in the submitting thread.                */
+/************************************************************************/
+
+int CPLWorkerThreadPool::Setup( int nThreadsIn, CPLThreadFunc pfnInitFunc,
+                                void **papInitData )
+
+{
+    int i;
+
+    if( hMutex != NULL )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "CPLWorkerThreadPool::Setup() called twice." );
+        return FALSE;
+    }
+
+    if( nThreadsIn <= 0 )
+        nThreadsIn = CPLGetNumCPUs();
+
+    hMutex = CPLCreateMutex();
+    hCondJobs = CPLCreateCond();
+    hCondDone = CPLCreateCond();
+
+    if( hCondJobs == NULL || hCondDone == NULL )
+    {
+        /* No thread support: pfnInitFunc would run in our own thread. */
+        CPLReleaseMutex( hMutex );
+        return FALSE;
+    }
+
+    /* One extra zeroed entry marks the end of the array. */
+    pasThreads = (CPLWorkerThread *) 
+        CPLCalloc( sizeof(CPLWorkerThread), nThreadsIn + 1 );
+
+    for( i = 0; i < nThreadsIn; i++ )
+    {
+        CPLWorkerThread *psThread = pasThreads + i;
+
+        psThread->poPool = this;
+        psThread->iThread = i;
+        psThread->pfnInitFunc = pfnInitFunc;
+        psThread->pInitData = papInitData ? papInitData[i] : NULL;
+        psThread->sDeque.hMutex = CPLCreateMutex();
+        CPLReleaseMutex( psThread->sDeque.hMutex );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Start the workers.  We still hold hMutex from its creation so   */
+/*      they wait for nThreads to be final before running any job.      */
+/* -------------------------------------------------------------------- */
+    for( i = 0; i < nThreadsIn; i++ )
+    {
+        pasThreads[i].hThread = 
+            CPLCreateJoinableThread( WorkerThreadMain, pasThreads + i );
+        if( pasThreads[i].hThread == NULL )
+            break;
+        nThreads++;
+    }
+
+    while( nInitDone < nThreads )
+        CPLCondWait( hCondDone, hMutex );
+
+    CPLReleaseMutex( hMutex );
+
+    if( nThreads < nThreadsIn )
+        CPLDebug( "CPL", "Started only %d of %d worker threads.",
+                  nThreads, nThreadsIn );
+
+    return nThreads > 0;
+}
+
+/************************************************************************/
+/*                          WorkerThreadMain()                          */
+/************************************************************************/
+
+void CPLWorkerThreadPool::WorkerThreadMain( void *pData )
+
+{
+    CPLWorkerThread     *psSelf = (CPLWorkerThread *) pData;
+    CPLWorkerThreadPool *poPool = psSelf->poPool;
+    CPLThreadFunc        pfnFunc;
+    void                *pJobData;
+
+    CPLSetTLS( CTLS_WORKERTHREAD, psSelf, FALSE );
+
+    if( psSelf->pfnInitFunc != NULL )
+        psSelf->pfnInitFunc( psSelf->pInitData );
+
+    CPLAcquireMutex( poPool->hMutex, 1000.0 );
+    poPool->nInitDone++;
+    CPLCondBroadcast( poPool->hCondDone );
+
+    while( TRUE )
+    {
+        while( !poPool->bStop && poPool->nQueuedJobs <= 0 )
+        {
+            poPool->nWaitingThreads++;
+            CPLCondWait( poPool->hCondJobs, poPool->hMutex );
+            poPool->nWaitingThreads--;
+        }
+
+        if( poPool->nQueuedJobs <= 0 )
+            break;
+
+        CPLReleaseMutex( poPool->hMutex );
+
+        if( poPool->PopJob( psSelf, &pfnFunc, &pJobData ) )
+        {
+            pfnFunc( pJobData );
+
+            CPLAcquireMutex( poPool->hMutex, 1000.0 );
+            if( --poPool->nPendingJobs == 0 )
+                CPLCondBroadcast( poPool->hCondDone );
+        }
+        else
+        {
+            /* Another worker got it first. */
+            CPLAcquireMutex( poPool->hMutex, 1000.0 );
+        }
+    }
+
+    CPLReleaseMutex( poPool->hMutex );
+}
+
+/************************************************************************/
+/*                               PopJob()                               */
+/*                                                                      */
+/*      Take the newest job of our own deque, or else the oldest job    */
+/*      of another worker.  Called without hMutex held.                 */
+/************************************************************************/
+
+int CPLWorkerThreadPool::PopJob( CPLWorkerThread *psSelf, 
+                                 CPLThreadFunc *ppfnFunc, void **ppData )
+
+{
+    CPLWorkerJobDeque *psDeque = &(psSelf->sDeque);
+    CPLWorkerJob      *psJob = NULL;
+    CPLWorkerJob       sJob;
+    int                i;
+
+    CPLAcquireMutex( psDeque->hMutex, 1000.0 );
+    if( psDeque->nCount > 0 )
+    {
+        psDeque->nCount--;
+        sJob = psDeque->pasJobs[(psDeque->nFirst + psDeque->nCount) 
+                                % psDeque->nAlloc];
+        psJob = &sJob;
+    }
+    CPLReleaseMutex( psDeque->hMutex );
+
+    for( i = 1; psJob == NULL && i < nThreads; i++ )
+    {
+        psDeque = &(pasThreads[(psSelf->iThread + i) % nThreads].sDeque);
+
+        CPLAcquireMutex( psDeque->hMutex, 1000.0 );
+        if( psDeque->nCount > 0 )
+        {
+            sJob = psDeque->pasJobs[psDeque->nFirst];
+            psDeque->nFirst = (psDeque->nFirst + 1) % psDeque->nAlloc;
+            psDeque->nCount--;
+            psJob = &sJob;
+        }
+        CPLReleaseMutex( psDeque->hMutex );
+    }
+
+    if( psJob == NULL )
+        return FALSE;
+
+    CPLAcquireMutex( hMutex, 1000.0 );
+    nQueuedJobs--;
+    CPLReleaseMutex( hMutex );
+
+    *ppfnFunc = psJob->pfnFunc;
+    *ppData = psJob->pData;
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                              PushJob()                               */
+/*                                                                      */
+/*      Add a job at the back of a deque.  Called with hMutex held.     */
+/************************************************************************/
+
+void CPLWorkerThreadPool::PushJob( CPLWorkerJobDeque *psDeque,
+                                   CPLThreadFunc pfnFunc, void *pData )
+
+{
+    CPLWorkerJob *psJob;
+
+    CPLAcquireMutex( psDeque->hMutex, 1000.0 );
+
+    if( psDeque->nCount == psDeque->nAlloc )
+    {
+        int nNewAlloc = psDeque->nAlloc * 2 + 16, i;
+        CPLWorkerJob *pasNewJobs = (CPLWorkerJob *)
+            CPLMalloc( sizeof(CPLWorkerJob) * nNewAlloc );
+
+        for( i = 0; i < psDeque->nCount; i++ )
+            pasNewJobs[i] = 
+                psDeque->pasJobs[(psDeque->nFirst + i) % psDeque->nAlloc];
+
+        CPLFree( psDeque->pasJobs );
+        psDeque->pasJobs = pasNewJobs;
+        psDeque->nAlloc = nNewAlloc;
+        psDeque->nFirst = 0;
+    }
+
+    psJob = psDeque->pasJobs 
+        + (psDeque->nFirst + psDeque->nCount) % psDeque->nAlloc;
+    psJob->pfnFunc = pfnFunc;
+    psJob->pData = pData;
+    psDeque->nCount++;
+
+    CPLReleaseMutex( psDeque->hMutex );
+
+    nPendingJobs++;
+    nQueuedJobs++;
+}
+
+/************************************************************************/
+/*                           GetTargetDeque()                           */
+/*                                                                      */
+/*      Jobs submitted by one of our workers go to its own deque,       */
+/*      others are spread round robin.  Called with hMutex held.        */
+/************************************************************************/
+
+CPLWorkerJobDeque *CPLWorkerThreadPool::GetTargetDeque()
+
+{
+    CPLWorkerThread *psSelf = (CPLWorkerThread *) CPLGetTLS(CTLS_WORKERTHREAD);
+
+    if( psSelf != NULL && psSelf->poPool == this )
+        return &(psSelf->sDeque);
+
+    nNextThread = (nNextThread + 1) % nThreads;
+
+    return &(pasThreads[nNextThread].sDeque);
+}
+
+/************************************************************************/
+/*                             SubmitJob()                              */
+/*                                                                      */
+/*      Queue pfnFunc(pData) to run on a worker thread.                 */
+/************************************************************************/
+
+int CPLWorkerThreadPool::SubmitJob( CPLThreadFunc pfnFunc, void *pData )
+
+{
+    return SubmitJobs( pfnFunc, &pData, 1 );
+}
+
+/************************************************************************/
+/*                             SubmitJobs()                             */
+/*                                                                      */
+/*      Queue pfnFunc(papData[i]) for each of the nJobs entries.        */
+/************************************************************************/
+
+int CPLWorkerThreadPool::SubmitJobs( CPLThreadFunc pfnFunc, 
+                                     void **papData, int nJobs )
+
+{
+    int i;
+
+    if( nThreads == 0 )
+    {
+        for( i = 0; i < nJobs; i++ )
+            pfnFunc( papData[i] );
+        return TRUE;
+    }
+
+    CPLAcquireMutex( hMutex, 1000.0 );
+
+    for( i = 0; i < nJobs; i++ )
+        PushJob( GetTargetDeque(), pfnFunc, papData[i] );
+
+    if( nWaitingThreads > 1 && nJobs > 1 )
+        CPLCondBroadcast( hCondJobs );
+    else if( nWaitingThreads > 0 )
+        CPLCondSignal( hCondJobs );
+
+    CPLReleaseMutex( hMutex );
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                           WaitCompletion()                           */
+/*                                                                      */
+/*      Wait until all the submitted jobs have completed.  Must not be  */
+/*      called from a job of this pool.                                 */
+/************************************************************************/
+
+void CPLWorkerThreadPool::WaitCompletion()
+
+{
+    if( nThreads == 0 )
+        return;
+
+    CPLAcquireMutex( hMutex, 1000.0 );
+    while( nPendingJobs > 0 )
+        CPLCondWait( hCondDone, hMutex );
+    CPLReleaseMutex( hMutex );
+}
@@ -0,0 +1,91 @@
+/**********************************************************************
+ * $Id$
+ *
+ * Project:  CPL - Common Portability Library
+ * Purpose:  Pool of worker threads with per-worker work-stealing job 
+ *           queues.
+ *
+ **********************************************************************
+ * Copyright (c) 2026, MITAB contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef _CPL_WORKER_THREAD_POOL_H_INCLUDED_
+#define _CPL_WORKER_THREAD_POOL_H_INCLUDED_
+
+#include "cpl_multiproc.h"
+
+/************************************************************************/
+/*                         CPLWorkerThreadPool                          */
+/*                                                                      */
+/*      Fixed set of worker threads running submitted jobs.  Each       */
+/*      worker has its own job deque: jobs submitted from outside the   */
+/*      pool are spread over the workers, jobs submitted by a job are   */
+/*      pushed on the deque of the worker running it.  A worker runs    */
+/*      the most recent job of its own deque first, and when it is      */
+/*      empty steals the oldest job of another worker.                  */
+/*                                                                      */
+/*      If no thread can be started (e.g. stub threading model),        */
+/*      submitted jobs are run immediately in the calling thread.       */
+/************************************************************************/
+
+typedef struct _CPLWorkerJobDeque CPLWorkerJobDeque;
+typedef struct _CPLWorkerThread   CPLWorkerThread;
+
+class CPL_DLL CPLWorkerThreadPool
+{
+    void               *hMutex;
+    void               *hCondJobs;         /* jobs available, or stop */
+    void               *hCondDone;         /* jobs completed, or init done */
+
+    int                 nThreads;
+    CPLWorkerThread    *pasThreads;
+    int                 nNextThread;       /* round robin for submissions */
+
+    int                 nQueuedJobs;       /* in deques, not started */
+    int                 nPendingJobs;      /* submitted, not completed */
+    int                 nWaitingThreads;
+    int                 nInitDone;
+    int                 bStop;
+
+    static void         WorkerThreadMain( void * );
+    int                 PopJob( CPLWorkerThread *psSelf, 
+                                CPLThreadFunc *ppfnFunc, void **ppData );
+    void                PushJob( CPLWorkerJobDeque *psDeque,
+                                 CPLThreadFunc pfnFunc, void *pData );
+    CPLWorkerJobDeque  *GetTargetDeque();
+
+  public:
+                        CPLWorkerThreadPool();
+                        ~CPLWorkerThreadPool();
+
+    int                 Setup( int nThreads, 
+                               CPLThreadFunc pfnInitFunc = NULL,
+                               void **papInitData = NULL );
+
+    int                 SubmitJob( CPLThreadFunc pfnFunc, void *pData );
+    int                 SubmitJobs( CPLThreadFunc pfnFunc, 
+                                    void **papData, int nJobs );
+    void                WaitCompletion();
+
+    int                 GetThreadCount() { return nThreads; }
+};
+
+#endif /* _CPL_WORKER_THREAD_POOL_H_INCLUDED_ */
@@ -0,0 +1,366 @@
+/**********************************************************************
+ * $Id$
+ *
+ * Name:     cpl_worker_thread_pool_test.cpp
+ * Project:  CPL - Common Portability Library
+ * Language: C++
+ * Purpose:  Test mainline for CPLWorkerThreadPool.
+ *
+ **********************************************************************
+ * Copyright (c) 2026, MITAB contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cpl_worker_thread_pool.h"
+#include "cpl_atomic_ops.h"
+#include "cpl_conv.h"
+
+#define NUM_JOBS        1000
+#define NUM_SLOW_JOBS   20
+#define NUM_CHILD_JOBS  10
+#define NUM_THREADS     4
+
+/************************************************************************/
+/*                              TestFailed()                            */
+/************************************************************************/
+
+static void TestFailed( const char *pszTest, const char *pszMsg )
+
+{
+    printf( "%s: FAILED, %s\n", pszTest, pszMsg );
+    exit( 1 );
+}
+
+/************************************************************************/
+/*                           Job functions                              */
+/************************************************************************/
+
+typedef struct
+{
+    volatile int        nRunCount;
+    GIntBig             nPID;
+} JobRecord;
+
+static void CountJob( void *pData )
+{
+    CPLAtomicInc( &((JobRecord *) pData)->nRunCount );
+}
+
+#ifdef CPL_MULTIPROC_STUB
+
+/************************************************************************/
+/*                           TestStubInline()                           */
+/*                                                                      */
+/*      Without thread support Setup() fails and jobs are run in the    */
+/*      calling thread before SubmitJob() returns.                      */
+/************************************************************************/
+
+static void TestStubInline()
+
+{
+    CPLWorkerThreadPool oPool;
+    JobRecord           asJobs[3];
+    void               *apData[2];
+    int                 i;
+
+    memset( asJobs, 0, sizeof(asJobs) );
+
+    if( oPool.Setup( NUM_THREADS ) )
+        TestFailed( "TestStubInline",
+                    "Setup() succeeded in the stub threading model" );
+
+    oPool.SubmitJob( CountJob, asJobs + 0 );
+    if( asJobs[0].nRunCount != 1 )
+        TestFailed( "TestStubInline", "SubmitJob() did not run the job" );
+
+    apData[0] = asJobs + 1;
+    apData[1] = asJobs + 2;
+    oPool.SubmitJobs( CountJob, apData, 2 );
+    for( i = 1; i < 3; i++ )
+    {
+        if( asJobs[i].nRunCount != 1 )
+            TestFailed( "TestStubInline",
+                        "SubmitJobs() did not run the jobs" );
+    }
+
+    oPool.WaitCompletion();
+
+    printf( "TestStubInline: OK\n" );
+}
+
+#else /* ndef CPL_MULTIPROC_STUB */
+
+/************************************************************************/
+/*                            WaitForCount()                            */
+/*                                                                      */
+/*      Wait for *pnCount to reach nTarget, giving up after 10s so a    */
+/*      broken pool fails the test rather than hanging it.  The count   */
+/*      is read atomically, as other threads update it.                 */
+/************************************************************************/
+
+static int WaitForCount( volatile int *pnCount, int nTarget )
+
+{
+    int i;
+
+    for( i = 0; i < 10000 && CPLAtomicAdd( pnCount, 0 ) < nTarget; i++ )
+        CPLSleep( 0.001 );
+
+    return CPLAtomicAdd( pnCount, 0 ) >= nTarget;
+}
+
+static void InitFunc( void *pData )
+{
+    CPLAtomicInc( (volatile int *) pData );
+}
+
+static volatile int nSlowDone = 0;
+
+static void SlowJob( void *pData )
+{
+    CPLSleep( 0.01 );
+    CPLAtomicInc( &nSlowDone );
+}
+
+/* Nested submission: job A submits children while job B keeps the    */
+/* other worker busy, so only A's worker can run them.                 */
+
+static CPLWorkerThreadPool *poNestedPool = NULL;
+static volatile int nBlockerRunning = 0;
+static volatile int nReleaseBlocker = 0;
+static volatile int nChildrenDone = 0;
+static GIntBig      nParentPID = 0;
+static int          anChildOrder[NUM_CHILD_JOBS];
+static JobRecord    asChildren[NUM_CHILD_JOBS];
+
+static void BlockerJob( void *pData )
+{
+    CPLAtomicInc( &nBlockerRunning );
+    while( CPLAtomicAdd( &nReleaseBlocker, 0 ) == 0 )
+        CPLSleep( 0.001 );
+}
+
+static void ChildJob( void *pData )
+{
+    JobRecord *psRecord = (JobRecord *) pData;
+    int        iOrder = CPLAtomicInc( &nChildrenDone ) - 1;
+
+    psRecord->nPID = CPLGetPID();
+    anChildOrder[iOrder] = (int) (psRecord - asChildren);
+    CPLAtomicInc( &psRecord->nRunCount );
+}
+
+static void ParentJob( void *pData )
+{
+    int i;
+
+    nParentPID = CPLGetPID();
+    for( i = 0; i < NUM_CHILD_JOBS; i++ )
+        poNestedPool->SubmitJob( ChildJob, asChildren + i );
+}
+
+/************************************************************************/
+/*                              TestInit()                              */
+/*                                                                      */
+/*      Each worker's init callback receives its own papInitData[i]     */
+/*      and Setup() only returns once all of them have run.             */
+/************************************************************************/
+
+static void TestInit()
+
+{
+    CPLWorkerThreadPool oPool;
+    volatile int        anInitCount[NUM_THREADS];
+    void               *apInitData[NUM_THREADS];
+    int                 i;
+
+    for( i = 0; i < NUM_THREADS; i++ )
+    {
+        anInitCount[i] = 0;
+        apInitData[i] = (void *) (anInitCount + i);
+    }
+
+    if( !oPool.Setup( NUM_THREADS, InitFunc, apInitData ) )
+        TestFailed( "TestInit", "Setup() returned FALSE" );
+
+    if( oPool.GetThreadCount() != NUM_THREADS )
+        TestFailed( "TestInit", "unexpected thread count" );
+
+    for( i = 0; i < NUM_THREADS; i++ )
+    {
+        if( anInitCount[i] != 1 )
+            TestFailed( "TestInit",
+                        "init callback did not get papInitData[i] once" );
+    }
+
+    printf( "TestInit: OK\n" );
+}
+
+/************************************************************************/
+/*                            TestRunOnce()                             */
+/*                                                                      */
+/*      Jobs submitted one at a time and in a batch all run exactly     */
+/*      once.                                                           */
+/************************************************************************/
+
+static void TestRunOnce()
+
+{
+    CPLWorkerThreadPool oPool;
+    JobRecord          *pasJobs;
+    void              **papData;
+    int                 i;
+
+    pasJobs = (JobRecord *) CPLCalloc( sizeof(JobRecord), 2 * NUM_JOBS );
+    papData = (void **) CPLMalloc( sizeof(void*) * NUM_JOBS );
+
+    if( !oPool.Setup( NUM_THREADS ) )
+        TestFailed( "TestRunOnce", "Setup() returned FALSE" );
+
+    for( i = 0; i < NUM_JOBS; i++ )
+    {
+        if( !oPool.SubmitJob( CountJob, pasJobs + i ) )
+            TestFailed( "TestRunOnce", "SubmitJob() failed" );
+        papData[i] = pasJobs + NUM_JOBS + i;
+    }
+
+    if( !oPool.SubmitJobs( CountJob, papData, NUM_JOBS ) )
+        TestFailed( "TestRunOnce", "SubmitJobs() failed" );
+
+    oPool.WaitCompletion();
+
+    for( i = 0; i < 2 * NUM_JOBS; i++ )
+    {
+        if( pasJobs[i].nRunCount != 1 )
+            TestFailed( "TestRunOnce", "a job did not run exactly once" );
+    }
+
+    CPLFree( papData );
+    CPLFree( pasJobs );
+
+    printf( "TestRunOnce: OK\n" );
+}
+
+/************************************************************************/
+/*                         TestWaitCompletion()                         */
+/*                                                                      */
+/*      WaitCompletion() does not return while jobs are still running.  */
+/************************************************************************/
+
+static void TestWaitCompletion()
+
+{
+    CPLWorkerThreadPool oPool;
+    int                 i;
+
+    if( !oPool.Setup( NUM_THREADS ) )
+        TestFailed( "TestWaitCompletion", "Setup() returned FALSE" );
+
+    nSlowDone = 0;
+    for( i = 0; i < NUM_SLOW_JOBS; i++ )
+        oPool.SubmitJob( SlowJob, NULL );
+
+    oPool.WaitCompletion();
+
+    if( nSlowDone != NUM_SLOW_JOBS )
+        TestFailed( "TestWaitCompletion",
+                    "returned before all jobs completed" );
+
+    /* Waiting on an idle pool returns immediately. */
+    oPool.WaitCompletion();
+
+    printf( "TestWaitCompletion: OK\n" );
+}
+
+/************************************************************************/
+/*                          TestNestedSubmit()                          */
+/*                                                                      */
+/*      Jobs submitted by a job go on the deque of the worker running   */
+/*      it: with the other worker blocked they all run on the parent's  */
+/*      thread, newest first.  Had they been spread round robin, the    */
+/*      ones stolen back from the blocked worker's deque would run      */
+/*      oldest first.                                                   */
+/************************************************************************/
+
+static void TestNestedSubmit()
+
+{
+    CPLWorkerThreadPool oPool;
+    int                 i;
+
+    if( !oPool.Setup( 2 ) )
+        TestFailed( "TestNestedSubmit", "Setup() returned FALSE" );
+
+    poNestedPool = &oPool;
+
+    oPool.SubmitJob( BlockerJob, NULL );
+    if( !WaitForCount( &nBlockerRunning, 1 ) )
+        TestFailed( "TestNestedSubmit", "blocker job never started" );
+
+    oPool.SubmitJob( ParentJob, NULL );
+    if( !WaitForCount( &nChildrenDone, NUM_CHILD_JOBS ) )
+        TestFailed( "TestNestedSubmit", "child jobs never completed" );
+
+    CPLAtomicInc( &nReleaseBlocker );
+    oPool.WaitCompletion();
+
+    for( i = 0; i < NUM_CHILD_JOBS; i++ )
+    {
+        if( asChildren[i].nRunCount != 1 )
+            TestFailed( "TestNestedSubmit",
+                        "a child job did not run exactly once" );
+        if( asChildren[i].nPID != nParentPID )
+            TestFailed( "TestNestedSubmit",
+                        "a child job ran outside the parent's worker" );
+        if( anChildOrder[i] != NUM_CHILD_JOBS - 1 - i )
+            TestFailed( "TestNestedSubmit",
+                        "child jobs were not queued on the parent's deque" );
+    }
+
+    poNestedPool = NULL;
+
+    printf( "TestNestedSubmit: OK\n" );
+}
+
+#endif /* ndef CPL_MULTIPROC_STUB */
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main( int nArgc, char ** papszArgv )
+
+{
+#ifdef CPL_MULTIPROC_STUB
+    TestStubInline();
+#else
+    TestInit();
+    TestRunOnce();
+    TestWaitCompletion();
+    TestNestedSubmit();
+#endif
+
+    printf( "All CPLWorkerThreadPool tests passed.\n" );
+
+    exit( 0 );
+}
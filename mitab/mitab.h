@@ -172,6 +172,8 @@ class IMapInfoFile : public OGRLayer
 
     char                *m_pszCharset;
 
+    const unsigned short *GetReadRecodeTable();
+
   public:
     IMapInfoFile() ;
     virtual ~IMapInfoFile();
@@ -211,6 +213,8 @@ class IMapInfoFile : public OGRLayer
 
     virtual TABFieldType GetNativeFieldType(int nFieldId) = 0;
 
+    virtual int SetSelectedFields(char **papszFieldNames);
+
     virtual int GetBounds(double &dXMin, double &dYMin, 
                           double &dXMax, double &dYMax,
                           GBool bForce = TRUE ) = 0;
@@ -264,8 +268,14 @@ class IMapInfoFile : public OGRLayer
  * class to open a TAB dataset and read/write features from/to it.
  *
  *--------------------------------------------------------------------*/
+class TABFileCursor;
+class TABParallelScan;
+
 class TABFile: public IMapInfoFile
 {
+  friend class TABFileCursor;
+  friend class TABParallelScan;
+
   private:
     char        *m_pszFname;
     TABAccess   m_eAccessMode;
@@ -284,14 +294,27 @@ class TABFile: public IMapInfoFile
 
     int         m_nLastFeatureId;
 
-    long        *m_panMatchingFIDs;
+    long        *m_panMatchingFIDs;     // From EvaluateAgainstIndices()
     int         m_iMatchingFID;
+    GBool       m_bMatchingFIDsTried;
+
+    GUInt32     *m_panMatchingFIDBitmap; // From TABDATFile::ScanRecords()
+    GBool       m_bMatchingFIDBitmapTried;
+
+    GUInt32     *m_panLiveFIDBitmap;    // Features with geometry or attributes
+    int         m_nLiveFeatureCount;
+    GBool       m_bLiveFIDBitmapTried;
 
     ///////////////
     // Private Read access specific stuff
     //
     int         ParseTABFileFirstPass(GBool bTestOpenNoError);
     int         ParseTABFileFields();
+    GUInt32     *BuildMatchingFIDBitmap();
+    int         GetIndexedFeatureCount(int bForce);
+    int         BuildLiveFIDBitmap();
+    int         ReadLiveFIDBitmapSidecar();
+    int         WriteLiveFIDBitmapSidecar();
 
      ///////////////
     // Private Write access specific stuff
@@ -379,12 +402,149 @@ class TABFile: public IMapInfoFile
 
     int         WriteFeature(TABFeature *poFeature, int nFeatureId /*=-1*/);
 
+    TABFileCursor *CreateCursor();
+    TABParallelScan *CreateParallelScan(int nWorkers = 0, 
+                                        GBool bOrdered = FALSE);
+
 #ifdef DEBUG
     virtual void Dump(FILE *fpOut = NULL);
 #endif
 };
 
 
+/*---------------------------------------------------------------------
+ *                      class TABFileCursor
+ *
+ * Independent read cursor over a TABFile opened for read, created with
+ * TABFile::CreateCursor().
+ *
+ * Each cursor has its own .MAP/.ID/.DAT file handles and block buffers,
+ * current feature and filters, and shares the header, drawing tool defs,
+ * field defs and live FID bitmap of its TABFile.  Several cursors on the
+ * same TABFile can thus be read concurrently from different threads.
+ * The TABFile itself must not be used for reading while cursors are 
+ * in use from other threads, and must be closed only after all its
+ * cursors have been deleted.
+ *--------------------------------------------------------------------*/
+class TABFileCursor: public OGRLayer
+{
+  friend class TABParallelScan;
+
+  private:
+    TABFile     *m_poParent;
+    TABMAPFile  *m_poMAPFile;
+    TABDATFile  *m_poDATFile;
+
+    OGRFeatureDefn *m_poDefn;
+    OGRSpatialReference *m_poSpatialRef;
+
+    int         m_nCurFeatureId;
+    TABFeature  *m_poCurFeature;
+    GBool       m_bUseSpatialTraversal;
+
+    GUInt32     *m_panMatchingFIDBitmap; // From TABDATFile::ScanRecords()
+    GBool       m_bMatchingFIDBitmapTried;
+
+    int         m_nFirstRangeId;        // From SetFeatureIdRange()
+    int         m_nLastRangeId;
+    const int   *m_panFeatureIdList;    // From SetFeatureIdList()
+    int         m_nFeatureIdListSize;
+    int         m_iFeatureIdList;
+
+  public:
+    TABFileCursor();
+    virtual ~TABFileCursor();
+
+    int         Open(TABFile *poParent);
+    int         Close();
+
+    virtual void        ResetReading();
+    virtual void        SetSpatialFilter( OGRGeometry * );
+    virtual OGRFeature *GetNextFeature();
+    virtual OGRFeature *GetFeature(long nFeatureId);
+    virtual OGRFeatureDefn *GetLayerDefn() { return m_poDefn; }
+    virtual OGRSpatialReference *GetSpatialRef() { return m_poSpatialRef; }
+    virtual int         TestCapability( const char * pszCap );
+
+    int         GetNextFeatureId(int nPrevId);
+    TABFeature *GetFeatureRef(int nFeatureId);
+
+    void        SetFeatureIdRange(int nFirstId, int nLastId);
+    void        SetFeatureIdList(const int *panFeatureIds, int nCount);
+};
+
+
+/*---------------------------------------------------------------------
+ *                      class TABParallelScan
+ *
+ * Multithreaded read of all the features of a TABFile opened for read, 
+ * created with TABFile::CreateParallelScan().
+ *
+ * The feature ids are split in chunks of consecutive ids which are 
+ * read by worker threads, each with its own TABFileCursor.  When a 
+ * spatial filter requires it, the chunks are made of the ids found in
+ * the spatial index instead.  Decoded chunks are returned by 
+ * GetNextFeature() either in feature id order or in the order they 
+ * complete.  The number of chunks in flight is bounded, so workers 
+ * wait when the caller does not keep up.
+ *
+ * The spatial and attribute filters of the TABFile at the time of 
+ * creation apply, and must not be changed until the scan is deleted.
+ * If no thread can be created, the chunks are read by the calling thread.
+ *--------------------------------------------------------------------*/
+typedef struct
+{
+    int         nChunk;         // -1 when the batch is free
+    GBool       bReady;
+    int         nFeatures;
+    int         nMaxFeatures;
+    OGRFeature  **papoFeatures;
+} TABScanBatch;
+
+class TABParallelScan
+{
+  private:
+    TABFile     *m_poParent;
+    OGRFeatureQuery *m_poAttrQuery;     // Owned by m_poParent
+    GBool       m_bOrdered;
+
+    int         *m_panFeatureIds;       // From the spatial index, or NULL
+    int         m_nFeatureIds;
+    int         m_nChunks;
+    int         m_nNextChunk;           // Next chunk to be read
+    int         m_nChunksDone;          // Chunks returned to the caller
+
+    int         m_nCursors;
+    TABFileCursor **m_papoCursors;
+    int         m_nThreads;
+    void        **m_pahThreads;
+
+    void        *m_hMutex;
+    void        *m_hCond;
+    GBool       m_bStop;
+    GBool       m_bError;
+
+    int         m_nBatches;
+    TABScanBatch *m_pasBatches;
+    TABScanBatch *m_psCurBatch;
+    int         m_iCurFeature;
+
+    static void WorkerThread(void *pData);
+    TABScanBatch *ClaimChunk();
+    int         ReadChunk(TABFileCursor *poCursor, TABScanBatch *psBatch);
+
+  public:
+    TABParallelScan();
+    ~TABParallelScan();
+
+    int         Open(TABFile *poParent, int nWorkers = 0, 
+                     GBool bOrdered = FALSE);
+    int         Close();
+
+    OGRFeature *GetNextFeature();
+};
+
+
 /*---------------------------------------------------------------------
  *                      class TABView
  *
@@ -668,6 +828,7 @@ class MIFFile: public IMapInfoFile
 
     int         m_nPreloadedId;  // preloaded mif line is for this feature id
     MIDDATAFile  *m_poMIDFile;   // Mid file
+    GByte       *m_pabySelectedFields; // See SetSelectedFields()
     MIDDATAFile  *m_poMIFFile;   // Mif File
 
     OGRFeatureDefn *m_poDefn;
@@ -724,6 +885,8 @@ class MIFFile: public IMapInfoFile
 
     virtual TABFieldType GetNativeFieldType(int nFieldId);
 
+    virtual int SetSelectedFields(char **papszFieldNames);
+
     virtual int GetBounds(double &dXMin, double &dYMin, 
                           double &dXMax, double &dYMax,
                           GBool bForce = TRUE );
@@ -925,11 +1088,12 @@ class ITABFeaturePen
   protected:
     int         m_nPenDefIndex;
     TABPenDef   m_sPenDef;
+    GBool       m_bPenDefChanged;   // Modified since read from file
   public:
     ITABFeaturePen();
     ~ITABFeaturePen() {};
     int         GetPenDefIndex() {return m_nPenDefIndex;};
-    TABPenDef  *GetPenDefRef() {return &m_sPenDef;};
+    TABPenDef  *GetPenDefRef() {m_bPenDefChanged=TRUE; return &m_sPenDef;};
 
     GByte       GetPenWidthPixel();
     double      GetPenWidthPoint();
@@ -941,8 +1105,10 @@ class ITABFeaturePen
     void        SetPenWidthPoint(double val);
     void        SetPenWidthMIF(int val);
 
-    void        SetPenPattern(GByte val) {m_sPenDef.nLinePattern=val;};
-    void        SetPenColor(GInt32 clr)  {m_sPenDef.rgbColor = clr;};
+    void        SetPenPattern(GByte val) {m_sPenDef.nLinePattern=val;
+                                          m_bPenDefChanged=TRUE;};
+    void        SetPenColor(GInt32 clr)  {m_sPenDef.rgbColor = clr;
+                                          m_bPenDefChanged=TRUE;};
 
     const char *GetPenStyleString();
     void        SetPenFromStyleString(const char *pszStyleString);
@@ -955,22 +1121,28 @@ class ITABFeatureBrush
   protected:
     int         m_nBrushDefIndex;
     TABBrushDef m_sBrushDef;
+    GBool       m_bBrushDefChanged; // Modified since read from file
   public:
     ITABFeatureBrush();
     ~ITABFeatureBrush() {};
     int         GetBrushDefIndex() {return m_nBrushDefIndex;};
-    TABBrushDef *GetBrushDefRef() {return &m_sBrushDef;};
+    TABBrushDef *GetBrushDefRef() {m_bBrushDefChanged=TRUE;
+                                   return &m_sBrushDef;};
 
     GInt32      GetBrushFGColor()     {return m_sBrushDef.rgbFGColor;};
     GInt32      GetBrushBGColor()     {return m_sBrushDef.rgbBGColor;};
     GByte       GetBrushPattern()     {return m_sBrushDef.nFillPattern;};
     GByte       GetBrushTransparent() {return m_sBrushDef.bTransparentFill;};
 
-    void        SetBrushFGColor(GInt32 clr)  { m_sBrushDef.rgbFGColor = clr;};
-    void        SetBrushBGColor(GInt32 clr)  { m_sBrushDef.rgbBGColor = clr;};
-    void        SetBrushPattern(GByte val)   { m_sBrushDef.nFillPattern=val;};
+    void        SetBrushFGColor(GInt32 clr)  { m_sBrushDef.rgbFGColor = clr;
+                                               m_bBrushDefChanged=TRUE;};
+    void        SetBrushBGColor(GInt32 clr)  { m_sBrushDef.rgbBGColor = clr;
+                                               m_bBrushDefChanged=TRUE;};
+    void        SetBrushPattern(GByte val)   { m_sBrushDef.nFillPattern=val;
+                                               m_bBrushDefChanged=TRUE;};
     void        SetBrushTransparent(GByte val)
-                                          {m_sBrushDef.bTransparentFill=val;};
+                                          {m_sBrushDef.bTransparentFill=val;
+                                           m_bBrushDefChanged=TRUE;};
 
     const char *GetBrushStyleString();
     void        SetBrushFromStyleString(const char *pszStyleString);
@@ -1001,19 +1173,24 @@ class ITABFeatureSymbol
   protected:
     int         m_nSymbolDefIndex;
     TABSymbolDef m_sSymbolDef;
+    GBool       m_bSymbolDefChanged; // Modified since read from file
   public:
     ITABFeatureSymbol();
     ~ITABFeatureSymbol() {};
     int         GetSymbolDefIndex() {return m_nSymbolDefIndex;};
-    TABSymbolDef *GetSymbolDefRef() {return &m_sSymbolDef;};
+    TABSymbolDef *GetSymbolDefRef() {m_bSymbolDefChanged=TRUE;
+                                     return &m_sSymbolDef;};
 
     GInt16      GetSymbolNo()    {return m_sSymbolDef.nSymbolNo;};
     GInt16      GetSymbolSize()  {return m_sSymbolDef.nPointSize;};
     GInt32      GetSymbolColor() {return m_sSymbolDef.rgbColor;};
 
-    void        SetSymbolNo(GInt16 val)     { m_sSymbolDef.nSymbolNo = val;};
-    void        SetSymbolSize(GInt16 val)   { m_sSymbolDef.nPointSize = val;};
-    void        SetSymbolColor(GInt32 clr)  { m_sSymbolDef.rgbColor = clr;};
+    void        SetSymbolNo(GInt16 val)     { m_sSymbolDef.nSymbolNo = val;
+                                              m_bSymbolDefChanged=TRUE;};
+    void        SetSymbolSize(GInt16 val)   { m_sSymbolDef.nPointSize = val;
+                                              m_bSymbolDefChanged=TRUE;};
+    void        SetSymbolColor(GInt32 clr)  { m_sSymbolDef.rgbColor = clr;
+                                              m_bSymbolDefChanged=TRUE;};
 
     const char *GetSymbolStyleString(double dfAngle = 0.0);
     void        SetSymbolFromStyleString(const char *pszStyleString);
@@ -1064,6 +1241,13 @@ class TABFeature: public OGRFeature
 
     virtual int UpdateMBR(TABMAPFile *poMapFile = NULL);
 
+    // Style string shared in the TABMAPFile cache, see GetStyleString()
+    const char  *m_pszStyleStringRef;
+    GBool       m_bStyleStringRefOwned;
+
+    void        SetStyleStringRef(const char *pszStyleStringRef);
+    GBool       CopyStyleStringRef();
+
   public:
              TABFeature(OGRFeatureDefn *poDefnIn );
     virtual ~TABFeature();
@@ -1080,6 +1264,8 @@ class TABFeature: public OGRFeature
     GBool       IsRecordDeleted() { return m_bDeletedFlag; };
     void        SetRecordDeleted(GBool bDeleted) { m_bDeletedFlag=bDeleted; };
 
+    void        DetachStyleStringRef();
+
     /*-----------------------------------------------------------------
      * TAB Support
      *----------------------------------------------------------------*/
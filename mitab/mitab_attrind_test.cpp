@@ -0,0 +1,190 @@
+/**********************************************************************
+ * $Id$
+ *
+ * Name:     mitab_attrind_test.cpp
+ * Project:  MapInfo TAB Read/Write library
+ * Language: C++
+ * Purpose:  Test mainline for attribute queries using .IND indexes.
+ *
+ **********************************************************************
+ * Copyright (c) 2026, MITAB contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mitab.h"
+
+/* Field values, in CP1252 (the WindowsLatin1 charset). */
+static const char *apszValues[] = {
+    "Montr\xe9" "al", "montr\xe9" "al", "Montreal", "Qu\xe9" "bec",
+    "Quebec", "Z\xfc" "rich", "Zurich", "\x80" "uro", "Mont", NULL };
+
+/* Queries, in UTF-8, and the number of features each should return.  */
+/* String comparisons ignore the case of ASCII letters only.           */
+static const struct
+{
+    const char *pszWhere;
+    int         nExpected;
+} asQueries[] = {
+    { "NAME = 'Montr\xc3\xa9" "al'", 2 },
+    { "NAME = 'MONTR\xc3\xa9" "AL'", 2 },
+    { "NAME = 'MONTR\xc3\x89" "AL'", 0 },
+    { "NAME = 'Montreal'", 1 },
+    { "NAME IN ('Qu\xc3\xa9" "bec', 'Z\xc3\xbc" "rich')", 2 },
+    { "NAME = '\xe2\x82\xac" "uro'", 1 },
+    { "NAME LIKE 'Montr\xc3\xa9" "%'", 2 },
+    { "NAME LIKE 'Qu\xc3\xa9" "%'", 1 },
+    { "NAME LIKE 'Mont%'", 4 },
+    /* \xc5\x81 (L with stroke) does not exist in CP1252 */
+    { "NAME = '\xc5\x81" "odz'", 0 },
+    { "NAME LIKE '\xc5\x81" "%'", 0 },
+    { NULL, 0 } };
+
+/************************************************************************/
+/*                              TestFailed()                            */
+/************************************************************************/
+
+static void TestFailed( const char *pszWhere, const char *pszMsg )
+
+{
+    printf( "%s: FAILED, %s\n", pszWhere, pszMsg );
+    exit( 1 );
+}
+
+/************************************************************************/
+/*                             CreateFile()                             */
+/************************************************************************/
+
+static void CreateFile( const char *pszFname, int bIndexed )
+
+{
+    TABFile     oFile;
+    int         i;
+
+    if( oFile.Open( pszFname, "wb" ) != 0 )
+        TestFailed( pszFname, "cannot create file" );
+
+    oFile.SetCharset( "WindowsLatin1" );
+    oFile.SetBounds( 0, 0, 100, 100 );
+    if( oFile.AddFieldNative( "NAME", TABFChar, 20, 0, bIndexed ) != 0 )
+        TestFailed( pszFname, "cannot add field" );
+
+    for( i = 0; apszValues[i] != NULL; i++ )
+    {
+        TABPoint oFeature( oFile.GetLayerDefn() );
+
+        oFeature.SetGeometryDirectly( new OGRPoint( i, i ) );
+        oFeature.SetField( 0, apszValues[i] );
+        if( oFile.CreateFeature( &oFeature ) != OGRERR_NONE )
+            TestFailed( pszFname, "cannot write feature" );
+    }
+
+    oFile.Close();
+}
+
+/************************************************************************/
+/*                             QueryFIDs()                              */
+/*                                                                      */
+/*      Comma separated list of the FIDs matching pszWhere.             */
+/************************************************************************/
+
+static CPLString QueryFIDs( IMapInfoFile *poFile, const char *pszWhere )
+
+{
+    CPLString   osFIDs;
+    OGRFeature *poFeature;
+
+    if( poFile->SetAttributeFilter( pszWhere ) != OGRERR_NONE )
+        TestFailed( pszWhere, "invalid query" );
+
+    poFile->ResetReading();
+    while( (poFeature = poFile->GetNextFeature()) != NULL )
+    {
+        osFIDs += CPLSPrintf( "%ld,", poFeature->GetFID() );
+        delete poFeature;
+    }
+
+    return osFIDs;
+}
+
+/************************************************************************/
+/*                                main()                                */
+/*                                                                      */
+/*      With MITAB_RECODE_TO_UTF8=YES, queries on UTF-8 values must     */
+/*      return the same features with and without the .IND index.      */
+/************************************************************************/
+
+int main( int nArgc, char ** papszArgv )
+
+{
+    CPLString   osIndexed = CPLGenerateTempFilename( "ind" );
+    CPLString   osPlain = CPLGenerateTempFilename( "noind" );
+    TABFile     oIndexed, oPlain;
+    int         i, j;
+
+    osIndexed += ".tab";
+    osPlain += ".tab";
+
+    CreateFile( osIndexed, TRUE );
+    CreateFile( osPlain, FALSE );
+
+    CPLSetConfigOption( "MITAB_RECODE_TO_UTF8", "YES" );
+
+    if( oIndexed.Open( osIndexed, "rb" ) != 0
+        || oPlain.Open( osPlain, "rb" ) != 0 )
+        TestFailed( "main", "cannot open test files" );
+
+    if( oIndexed.GetIndex() == NULL || oPlain.GetIndex() != NULL )
+        TestFailed( "main", "unexpected index configuration" );
+
+    for( i = 0; asQueries[i].pszWhere != NULL; i++ )
+    {
+        const char *pszWhere = asQueries[i].pszWhere;
+        CPLString   osWithIndex = QueryFIDs( &oIndexed, pszWhere );
+        CPLString   osWithout = QueryFIDs( &oPlain, pszWhere );
+        int         nCount = 0;
+
+        for( j = 0; j < (int) osWithout.size(); j++ )
+            nCount += (osWithout[j] == ',');
+
+        if( nCount != asQueries[i].nExpected )
+            TestFailed( pszWhere, "wrong feature count without index" );
+        if( osWithIndex != osWithout )
+            TestFailed( pszWhere, "indexed results differ" );
+    }
+
+    oIndexed.Close();
+    oPlain.Close();
+
+    for( i = 0; i < 2; i++ )
+    {
+        const char *pszFname = (i == 0) ? osIndexed.c_str() : osPlain.c_str();
+        const char *apszExt[] = { "tab", "dat", "map", "id", "ind", NULL };
+
+        for( j = 0; apszExt[j] != NULL; j++ )
+            VSIUnlink( CPLResetExtension( pszFname, apszExt[j] ) );
+    }
+
+    printf( "All attribute index tests passed.\n" );
+
+    exit( 0 );
+}
@@ -687,6 +687,41 @@ mitab_c_destroy_feature( mitab_feature feature )
         delete poFeature;
 }
 
+/************************************************************************/
+/*                    mitab_c_set_selected_fields()                     */
+/************************************************************************/
+
+/**
+ * Restrict the attributes read by mitab_c_read_feature() to some fields.
+ * The other fields are left empty in the features read.  Currently only
+ * supported for MIF/MID datasets opened for read.
+ *
+ * @param handle the mitab_handle of the dataset opened for read.
+ * @param field_names comma-delimited list of field names, or NULL or an
+ *        empty string to read all fields again.
+ * @return 0 on success, -1 on error (see mitab_c_getlasterrormsg()).
+ */
+
+int MITAB_STDCALL
+mitab_c_set_selected_fields( mitab_handle handle, const char * field_names )
+
+{
+    IMapInfoFile        *poFile = (IMapInfoFile *) handle;
+    char                **papszFieldNames = NULL;
+    int                 nStatus;
+
+    if( field_names != NULL && field_names[0] != '\0' )
+        papszFieldNames = 
+            CSLTokenizeString2( field_names, ",", 
+                                CSLT_STRIPLEADSPACES | CSLT_STRIPENDSPACES );
+
+    nStatus = poFile->SetSelectedFields( papszFieldNames );
+
+    CSLDestroy( papszFieldNames );
+
+    return nStatus;
+}
+
 /************************************************************************/
 /*                      mitab_c_next_feature_id()                       */
 /*                                                                      */
@@ -262,6 +262,9 @@ int MITAB_DLL MITAB_STDCALL mitab_c_set_charset( mitab_handle handle, const char
 int MITAB_DLL MITAB_STDCALL
 mitab_c_write_feature( mitab_handle handle, mitab_feature feature );
 
+int MITAB_DLL MITAB_STDCALL
+mitab_c_set_selected_fields( mitab_handle handle, const char * field_names );
+
 int MITAB_DLL MITAB_STDCALL
 mitab_c_next_feature_id( mitab_handle handle, int last_feature_id );
 
@@ -104,6 +104,7 @@
  **********************************************************************/
 
 #include "mitab.h"
+#include "mitab_utils.h"
 
 /*=====================================================================
  *                      class TABDATFile
@@ -142,6 +143,8 @@ TABDATFile::TABDATFile()
     m_nCurRecordId = -1;
     m_bCurRecordDeletedFlag = FALSE;
     m_bWriteHeaderInitialized = FALSE;
+
+    m_panRecodeTable = NULL;
 }
 
 /**********************************************************************
@@ -290,6 +293,67 @@ int TABDATFile::Open(const char *pszFname, const char *pszAccess,
     return 0;
 }
 
+/**********************************************************************
+ *                   TABDATFile::OpenReadCursor()
+ *
+ * Open this object as an independent read cursor on the same file as
+ * poSrcFile, which must be opened for read.  The header values and field
+ * definitions are copied from poSrcFile, and the cursor gets its own
+ * file handle and record block.
+ *
+ * Returns 0 on success, -1 on error.
+ **********************************************************************/
+int TABDATFile::OpenReadCursor(TABDATFile *poSrcFile)
+{
+    if (m_fp)
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "OpenReadCursor() failed: object already contains an "
+                 "open file");
+        return -1;
+    }
+
+    if (poSrcFile == NULL || poSrcFile->m_eAccessMode != TABRead ||
+        poSrcFile->m_fp == NULL)
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "OpenReadCursor() requires a .DAT file opened for read.");
+        return -1;
+    }
+
+    m_pszFname = CPLStrdup(poSrcFile->m_pszFname);
+    m_fp = VSIFOpen(m_pszFname, "rb");
+
+    if (m_fp == NULL)
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "OpenReadCursor() failed for %s", m_pszFname);
+        CPLFree(m_pszFname);
+        m_pszFname = NULL;
+        return -1;
+    }
+
+    m_eAccessMode = TABRead;
+    m_eTableType = poSrcFile->m_eTableType;
+    m_numRecords = poSrcFile->m_numRecords;
+    m_nFirstRecordPtr = poSrcFile->m_nFirstRecordPtr;
+    m_nRecordSize = poSrcFile->m_nRecordSize;
+    m_nBlockSize = poSrcFile->m_nBlockSize;
+    m_panRecodeTable = poSrcFile->m_panRecodeTable;
+
+    m_numFields = poSrcFile->m_numFields;
+    m_pasFieldDef = (TABDATFieldDef*)CPLMalloc(MAX(1, m_numFields) * 
+                                               sizeof(TABDATFieldDef));
+    memcpy(m_pasFieldDef, poSrcFile->m_pasFieldDef, 
+           m_numFields * sizeof(TABDATFieldDef));
+
+    m_poRecordBlock = new TABRawBinBlock(m_eAccessMode, FALSE);
+    m_poRecordBlock->InitNewBlock(m_fp, m_nBlockSize);
+    m_poRecordBlock->SetFirstBlockPtr(m_nFirstRecordPtr);
+
+    return 0;
+}
+
 /**********************************************************************
  *                   TABDATFile::Close()
  *
@@ -603,6 +667,332 @@ int  TABDATFile::CommitRecordToFile()
     return m_poRecordBlock->CommitToFile();
 }
 
+/**********************************************************************
+ *                   TABDATFile::ReadRecordChunk()
+ *
+ * Read numRecords consecutive raw records starting at nFirstRecordId
+ * directly from the file into pabyBuf, bypassing m_poRecordBlock.
+ * pabyBuf must be at least numRecords*m_nRecordSize bytes.
+ *
+ * Returns 0 on success, -1 on error.
+ **********************************************************************/
+int TABDATFile::ReadRecordChunk(int nFirstRecordId, int numRecords,
+                                GByte *pabyBuf)
+{
+    if (m_fp == NULL || nFirstRecordId < 1 ||
+        nFirstRecordId+numRecords-1 > m_numRecords)
+        return -1;
+
+    if (VSIFSeek(m_fp, m_nFirstRecordPtr+(nFirstRecordId-1)*m_nRecordSize,
+                 SEEK_SET) != 0 ||
+        VSIFRead(pabyBuf, m_nRecordSize, numRecords, m_fp) !=
+                                                     (size_t)numRecords)
+        return -1;
+
+    return 0;
+}
+
+/**********************************************************************
+ *                   TABDATFile::BuildActiveRecordBitmap()
+ *
+ * Read the deleted flag of every record in a single pass over the file
+ * and return a FID bitmap (see TAB_FIDBITMAP_*) with one bit set for
+ * every active (i.e. not deleted) record.
+ *
+ * The caller should free the bitmap with CPLFree().
+ *
+ * Returns NULL if the file is not opened for read or cannot be read.
+ **********************************************************************/
+GUInt32 *TABDATFile::BuildActiveRecordBitmap()
+{
+    int         i, nRecordId, numChunkRecords;
+    GByte       *pabyChunk;
+    GUInt32     *panBitmap;
+
+    if (m_eAccessMode != TABRead || m_fp == NULL || m_nRecordSize <= 0)
+        return NULL;
+
+    numChunkRecords = MAX(1, 65536 / m_nRecordSize);
+    pabyChunk = (GByte*)CPLMalloc(numChunkRecords*m_nRecordSize);
+    panBitmap = (GUInt32*)CPLCalloc(TAB_FIDBITMAP_WORDS(m_numRecords),
+                                    sizeof(GUInt32));
+
+    for(nRecordId=1; nRecordId<=m_numRecords; nRecordId+=numChunkRecords)
+    {
+        int numRecords = MIN(numChunkRecords, m_numRecords-nRecordId+1);
+
+        if (ReadRecordChunk(nRecordId, numRecords, pabyChunk) != 0)
+        {
+            CPLFree(panBitmap);
+            panBitmap = NULL;
+            break;
+        }
+
+        for(i=0; i<numRecords; i++)
+        {
+            // Same test as in GetRecordBlock()
+            if (pabyChunk[i*m_nRecordSize] == ' ')
+                TAB_FIDBITMAP_SET(panBitmap, nRecordId+i);
+        }
+    }
+
+    CPLFree(pabyChunk);
+
+    return panBitmap;
+}
+
+/**********************************************************************
+ *                   TABDATFile::ScanRecords()
+ *
+ * Evaluate a set of simple predicates (ANDed together) directly against
+ * the raw .DAT records, without going through GetRecordBlock() and the
+ * Read*Field() methods for every record.
+ *
+ * Records are read in large chunks and each condition is applied to the
+ * whole chunk at once, one field column at a time.  Deleted records are
+ * always reported as candidates: the caller is expected to evaluate its
+ * full query on the records that pass, so this is only a pre-filter.
+ *
+ * Only native tables in read mode are supported, and only Char,
+ * Integer, SmallInt, Float, Decimal and Date fields can be scanned.
+ *
+ * Returns a newly allocated FID bitmap (see TAB_FIDBITMAP_*) with one
+ * bit set for every record id that may match, or NULL if the scan could
+ * not be done.  The caller should free the bitmap with CPLFree().
+ **********************************************************************/
+GUInt32 *TABDATFile::ScanRecords(int numConds, const TABDATScanCond *pasConds)
+{
+    int         i, iCond, nRecordId, numChunkRecords;
+    int         *panFieldOffset;
+    GByte       *pabyChunk, *pabyPass;
+    GUInt32     *panBitmap;
+    char        szValue[3*256];
+
+    if (m_eAccessMode != TABRead || m_eTableType != TABTableNative ||
+        m_fp == NULL || m_pasFieldDef == NULL || m_nRecordSize <= 0 ||
+        numConds < 1)
+        return NULL;
+
+    for(iCond=0; iCond<numConds; iCond++)
+    {
+        TABFieldType eType;
+
+        if (pasConds[iCond].nFieldId < 0 ||
+            pasConds[iCond].nFieldId >= m_numFields)
+            return NULL;
+
+        eType = m_pasFieldDef[pasConds[iCond].nFieldId].eTABType;
+        if (eType != TABFChar && eType != TABFInteger &&
+            eType != TABFSmallInt && eType != TABFFloat &&
+            eType != TABFDecimal && eType != TABFDate)
+            return NULL;
+    }
+
+    /*-----------------------------------------------------------------
+     * Offset of each field within a record (the first byte of each
+     * record is the deleted flag).
+     *----------------------------------------------------------------*/
+    panFieldOffset = (int*)CPLMalloc(m_numFields*sizeof(int));
+    panFieldOffset[0] = 1;
+    for(i=1; i<m_numFields; i++)
+        panFieldOffset[i] = panFieldOffset[i-1] + m_pasFieldDef[i-1].byLength;
+
+    numChunkRecords = MAX(1, 65536 / m_nRecordSize);
+    pabyChunk = (GByte*)CPLMalloc(numChunkRecords*m_nRecordSize);
+    pabyPass = (GByte*)CPLMalloc(numChunkRecords);
+    panBitmap = (GUInt32*)CPLCalloc(TAB_FIDBITMAP_WORDS(m_numRecords),
+                                    sizeof(GUInt32));
+
+    for(nRecordId=1; nRecordId<=m_numRecords; nRecordId+=numChunkRecords)
+    {
+        int numRecords = MIN(numChunkRecords, m_numRecords-nRecordId+1);
+
+        if (ReadRecordChunk(nRecordId, numRecords, pabyChunk) != 0)
+        {
+            CPLFree(panBitmap);
+            panBitmap = NULL;
+            break;
+        }
+
+        memset(pabyPass, 1, numRecords);
+
+        for(iCond=0; iCond<numConds; iCond++)
+        {
+            const TABDATScanCond *psCond = pasConds + iCond;
+            TABFieldType eType = m_pasFieldDef[psCond->nFieldId].eTABType;
+            int         nWidth = m_pasFieldDef[psCond->nFieldId].byLength;
+            GByte       *pabyRec = pabyChunk+panFieldOffset[psCond->nFieldId];
+
+            for(i=0; i<numRecords; i++, pabyRec+=m_nRecordSize)
+            {
+                double  dValue = 0.0;
+                GBool   bNumeric = TRUE;
+
+                if (!pabyPass[i] || pabyChunk[i*m_nRecordSize] != ' ')
+                    continue;   // Already rejected, or deleted record
+
+                /*-----------------------------------------------------
+                 * Decode the field value
+                 *----------------------------------------------------*/
+                if (eType == TABFInteger)
+                {
+                    GInt32 nValue;
+                    memcpy(&nValue, pabyRec, 4);
+#ifdef CPL_MSB
+                    nValue = (GInt32)CPL_SWAP32(nValue);
+#endif
+                    dValue = nValue;
+                }
+                else if (eType == TABFSmallInt)
+                {
+                    GInt16 nValue;
+                    memcpy(&nValue, pabyRec, 2);
+#ifdef CPL_MSB
+                    nValue = (GInt16)CPL_SWAP16(nValue);
+#endif
+                    dValue = nValue;
+                }
+                else if (eType == TABFFloat)
+                {
+                    memcpy(&dValue, pabyRec, 8);
+#ifdef CPL_MSB
+                    CPL_SWAPDOUBLE(&dValue);
+#endif
+                }
+                else if (eType == TABFDecimal)
+                {
+                    dValue = TABParseDecimal((const char*)pabyRec, nWidth);
+                }
+                else if (eType == TABFChar && m_panRecodeTable != NULL)
+                {
+                    // Compare with the same UTF-8 value ReadCharField()
+                    // would return
+                    bNumeric = FALSE;
+                    CPLRecodeSingleByteToUTF8((const char*)pabyRec, nWidth,
+                                              m_panRecodeTable,
+                                              szValue, sizeof(szValue));
+                }
+                else if (eType == TABFChar)
+                {
+                    bNumeric = FALSE;
+                    memcpy(szValue, pabyRec, nWidth);
+                    szValue[nWidth] = '\0';
+                }
+                else /* if (eType == TABFDate) */
+                {
+                    GInt16 nYear;
+                    int nMonth = pabyRec[2], nDay = pabyRec[3];
+
+                    bNumeric = FALSE;
+                    memcpy(&nYear, pabyRec, 2);
+#ifdef CPL_MSB
+                    nYear = (GInt16)CPL_SWAP16(nYear);
+#endif
+                    if (nYear == 0 && nMonth == 0 && nDay == 0)
+                        szValue[0] = '\0';
+                    else
+                        TABFormatDate(szValue, nYear, nMonth, nDay);
+                }
+
+                /*-----------------------------------------------------
+                 * ... and compare it.  This must follow the semantics
+                 * of OGRFeatureQuery::Evaluate(): EQUAL() for string
+                 * equality and IN, strcmp() for string ordering.
+                 *----------------------------------------------------*/
+                if (bNumeric)
+                {
+                    switch(psCond->eOp)
+                    {
+                      case TABScanEQ:
+                        pabyPass[i] = (dValue == psCond->dValue);
+                        break;
+                      case TABScanNE:
+                        pabyPass[i] = (dValue != psCond->dValue);
+                        break;
+                      case TABScanLT:
+                        pabyPass[i] = (dValue < psCond->dValue);
+                        break;
+                      case TABScanLE:
+                        pabyPass[i] = (dValue <= psCond->dValue);
+                        break;
+                      case TABScanGT:
+                        pabyPass[i] = (dValue > psCond->dValue);
+                        break;
+                      case TABScanGE:
+                        pabyPass[i] = (dValue >= psCond->dValue);
+                        break;
+                      case TABScanIN:
+                      {
+                        int iVal;
+                        pabyPass[i] = 0;
+                        for(iVal=0; iVal<psCond->numValues; iVal++)
+                        {
+                            if (dValue == psCond->padfValues[iVal])
+                            {
+                                pabyPass[i] = 1;
+                                break;
+                            }
+                        }
+                        break;
+                      }
+                    }
+                }
+                else
+                {
+                    switch(psCond->eOp)
+                    {
+                      case TABScanEQ:
+                        pabyPass[i] = EQUAL(szValue, psCond->pszValue);
+                        break;
+                      case TABScanNE:
+                        pabyPass[i] = !EQUAL(szValue, psCond->pszValue);
+                        break;
+                      case TABScanLT:
+                        pabyPass[i] = (strcmp(szValue, psCond->pszValue) < 0);
+                        break;
+                      case TABScanLE:
+                        pabyPass[i] = (strcmp(szValue, psCond->pszValue) <= 0);
+                        break;
+                      case TABScanGT:
+                        pabyPass[i] = (strcmp(szValue, psCond->pszValue) > 0);
+                        break;
+                      case TABScanGE:
+                        pabyPass[i] = (strcmp(szValue, psCond->pszValue) >= 0);
+                        break;
+                      case TABScanIN:
+                      {
+                        const char *pszSrc = psCond->pszValue;
+                        pabyPass[i] = 0;
+                        while(*pszSrc != '\0')
+                        {
+                            if (EQUAL(pszSrc, szValue))
+                            {
+                                pabyPass[i] = 1;
+                                break;
+                            }
+                            pszSrc += strlen(pszSrc) + 1;
+                        }
+                        break;
+                      }
+                    }
+                }
+            }
+        }
+
+        for(i=0; i<numRecords; i++)
+        {
+            if (pabyPass[i])
+                TAB_FIDBITMAP_SET(panBitmap, nRecordId+i);
+        }
+    }
+
+    CPLFree(panFieldOffset);
+    CPLFree(pabyChunk);
+    CPLFree(pabyPass);
+
+    return panBitmap;
+}
+
 
 /**********************************************************************
  *                   TABDATFile::ValidateFieldInfoFromTAB()
@@ -867,10 +1257,24 @@ const char *TABDATFile::ReadCharField(int nWidth)
         return "";
     }
 
-    if (m_poRecordBlock->ReadBytes(nWidth, (GByte*)m_szBuffer) != 0)
-        return "";
+    if (m_panRecodeTable != NULL)
+    {
+        // Recode to UTF-8... pure ASCII values are simply copied
+        char szRawValue[256];
 
-    m_szBuffer[nWidth] = '\0';
+        if (m_poRecordBlock->ReadBytes(nWidth, (GByte*)szRawValue) != 0)
+            return "";
+
+        CPLRecodeSingleByteToUTF8(szRawValue, nWidth, m_panRecodeTable,
+                                  m_szBuffer, sizeof(m_szBuffer));
+    }
+    else
+    {
+        if (m_poRecordBlock->ReadBytes(nWidth, (GByte*)m_szBuffer) != 0)
+            return "";
+
+        m_szBuffer[nWidth] = '\0';
+    }
 
     // NATIVE tables are padded with '\0' chars, but DBF tables are padded
     // with spaces... get rid of the trailing spaces.
@@ -1042,7 +1446,7 @@ const char *TABDATFile::ReadDateField(int nWidth)
     if ((status = ReadDateField(nWidth, &nYear, &nMonth, &nDay)) == -1)
        return "";
 
-    sprintf(m_szBuffer, "%4.4d%2.2d%2.2d", nYear, nMonth, nDay);
+    TABFormatDate(m_szBuffer, nYear, nMonth, nDay);
   
     return m_szBuffer;
 }
@@ -1106,7 +1510,7 @@ const char *TABDATFile::ReadTimeField(int nWidth)
     if ((status = ReadTimeField(nWidth, &nHour, &nMinute, &nSecond, &nMS)) == -1)
        return "";
 
-    sprintf(m_szBuffer, "%2.2d%2.2d%2.2d%3.3d", nHour, nMinute, nSecond, nMS);
+    TABFormatTime(m_szBuffer, nHour, nMinute, nSecond, nMS);
     
     return m_szBuffer;
 }
@@ -1179,8 +1583,8 @@ const char *TABDATFile::ReadDateTimeField(int nWidth)
                                     &nMinute, &nSecond, &nMS)) == -1)
        return "";
 
-    sprintf(m_szBuffer, "%4.4d%2.2d%2.2d%2.2d%2.2d%2.2d%3.3d", 
-            nYear, nMonth, nDay, nHour, nMinute, nSecond, nMS);
+    TABFormatTime(TABFormatDate(m_szBuffer, nYear, nMonth, nDay),
+                  nHour, nMinute, nSecond, nMS);
 
     return m_szBuffer;
 }
@@ -1255,7 +1659,7 @@ double TABDATFile::ReadDecimalField(int nWidth)
 
     pszVal = ReadCharField(nWidth);
 
-    return atof(pszVal);
+    return TABParseDecimal(pszVal, -1);
 }
 
 
@@ -1476,13 +1880,18 @@ int TABDATFile::WriteDateField(const char *pszValue,
         /*-------------------------------------------------------------
          * "YYYYMMDD"
          *------------------------------------------------------------*/
-        char szBuf[9];
-        strcpy(szBuf, pszValue);
-        nDay = atoi(szBuf+6);
-        szBuf[6] = '\0';
-        nMonth = atoi(szBuf+4);
-        szBuf[4] = '\0';
-        nYear = atoi(szBuf);
+        if (!TABParseDigits(pszValue, 4, &nYear) ||
+            !TABParseDigits(pszValue+4, 2, &nMonth) ||
+            !TABParseDigits(pszValue+6, 2, &nDay))
+        {
+            char szBuf[9];
+            strcpy(szBuf, pszValue);
+            nDay = atoi(szBuf+6);
+            szBuf[6] = '\0';
+            nMonth = atoi(szBuf+4);
+            szBuf[4] = '\0';
+            nYear = atoi(szBuf);
+        }
     }
     else if (strlen(pszValue) == 10 &&
              (papszTok = CSLTokenizeStringComplex(pszValue, "/", 
@@ -1603,22 +2012,28 @@ int TABDATFile::WriteTimeField(const char *pszValue,
         /*-------------------------------------------------------------
          * "HHMMSSmmm"
          *------------------------------------------------------------*/
-        char szBuf[4];
-        strncpy(szBuf,pszValue,2);
-        szBuf[2]=0;
-        nHour = atoi(szBuf);
-
-        strncpy(szBuf,pszValue+2,2);
-        szBuf[2]=0;
-        nMin = atoi(szBuf);
-
-        strncpy(szBuf,pszValue+4,2);
-        szBuf[2]=0;
-        nSec = atoi(szBuf);
-
-        strncpy(szBuf,pszValue+6,3);
-        szBuf[3]=0;
-        nMS = atoi(szBuf);
+        if (!TABParseDigits(pszValue, 2, &nHour) ||
+            !TABParseDigits(pszValue+2, 2, &nMin) ||
+            !TABParseDigits(pszValue+4, 2, &nSec) ||
+            !TABParseDigits(pszValue+6, 3, &nMS))
+        {
+            char szBuf[4];
+            strncpy(szBuf,pszValue,2);
+            szBuf[2]=0;
+            nHour = atoi(szBuf);
+
+            strncpy(szBuf,pszValue+2,2);
+            szBuf[2]=0;
+            nMin = atoi(szBuf);
+
+            strncpy(szBuf,pszValue+4,2);
+            szBuf[2]=0;
+            nSec = atoi(szBuf);
+
+            strncpy(szBuf,pszValue+6,3);
+            szBuf[3]=0;
+            nMS = atoi(szBuf);
+        }
     }
     else if (strlen(pszValue) == 0)
     {
@@ -1708,21 +2123,30 @@ int TABDATFile::WriteDateTimeField(const char *pszValue,
         /*-------------------------------------------------------------
          * "YYYYMMDDhhmmssmmm"
          *------------------------------------------------------------*/
-        char szBuf[18];
-        strcpy(szBuf, pszValue);
-        nMS  = atoi(szBuf+14);
-        szBuf[14]=0;
-        nSec = atoi(szBuf+12);
-        szBuf[12]=0;
-        nMin = atoi(szBuf+10);
-        szBuf[10]=0;
-        nHour = atoi(szBuf+8);
-        szBuf[8]=0;
-        nDay = atoi(szBuf+6);
-        szBuf[6] = 0;
-        nMonth = atoi(szBuf+4);
-        szBuf[4] = 0;
-        nYear = atoi(szBuf);
+        if (!TABParseDigits(pszValue, 4, &nYear) ||
+            !TABParseDigits(pszValue+4, 2, &nMonth) ||
+            !TABParseDigits(pszValue+6, 2, &nDay) ||
+            !TABParseDigits(pszValue+8, 2, &nHour) ||
+            !TABParseDigits(pszValue+10, 2, &nMin) ||
+            !TABParseDigits(pszValue+12, 2, &nSec) ||
+            !TABParseDigits(pszValue+14, 3, &nMS))
+        {
+            char szBuf[18];
+            strcpy(szBuf, pszValue);
+            nMS  = atoi(szBuf+14);
+            szBuf[14]=0;
+            nSec = atoi(szBuf+12);
+            szBuf[12]=0;
+            nMin = atoi(szBuf+10);
+            szBuf[10]=0;
+            nHour = atoi(szBuf+8);
+            szBuf[8]=0;
+            nDay = atoi(szBuf+6);
+            szBuf[6] = 0;
+            nMonth = atoi(szBuf+4);
+            szBuf[4] = 0;
+            nYear = atoi(szBuf);
+        }
     }
     else if (strlen(pszValue) == 19 &&
              (papszTok = CSLTokenizeStringComplex(pszValue, "/ :", 
@@ -1828,21 +2252,29 @@ int TABDATFile::WriteDateTimeField(int nYear, int nMonth, int nDay,
 int TABDATFile::WriteDecimalField(double dValue, int nWidth, int nPrec,
                                   TABINDFile *poINDFile, int nIndexNo)
 {
-    const char *pszVal;
+    char        szVal[256];
+
+    if (nWidth < 1 || nWidth > 255)
+    {
+        CPLError(CE_Failure, CPLE_AssertionFailed,
+                 "Illegal width for a decimal field: %d", nWidth);
+        return -1;
+    }
 
-    pszVal = CPLSPrintf("%*.*f", nWidth, nPrec, dValue);
-    if ((int)strlen(pszVal) > nWidth)
-        pszVal += strlen(pszVal) - nWidth;
+    TABFormatDecimal(szVal, dValue, nWidth, nPrec);
 
     // Update Index
+    // The key is built from the value as it is stored, i.e. rounded to
+    // nPrec decimals, so that it matches the value read back.
     if (poINDFile && nIndexNo > 0)
     {
-        GByte *pKey = poINDFile->BuildKey(nIndexNo, dValue);
+        GByte *pKey = poINDFile->BuildKey(nIndexNo, 
+                                          TABParseDecimal(szVal, nWidth));
         if (poINDFile->AddEntry(nIndexNo, pKey, m_nCurRecordId) != 0)
             return -1;
     }
 
-    return m_poRecordBlock->WriteBytes(nWidth, (GByte*)pszVal);
+    return m_poRecordBlock->WriteBytes(nWidth, (GByte*)szVal);
 }
 
 
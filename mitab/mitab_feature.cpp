@@ -190,6 +190,9 @@ TABFeature::TABFeature(OGRFeatureDefn *poDefnIn):
     m_nMapInfoType = TAB_GEOM_NONE;
     m_bDeletedFlag = FALSE;
 
+    m_pszStyleStringRef = NULL;
+    m_bStyleStringRefOwned = FALSE;
+
     SetMBR(0.0, 0.0, 0.0, 0.0);
 }
 
@@ -200,6 +203,72 @@ TABFeature::TABFeature(OGRFeatureDefn *poDefnIn):
  **********************************************************************/
 TABFeature::~TABFeature()
 {
+    SetStyleStringRef(NULL);
+}
+
+/**********************************************************************
+ *                   TABFeature::SetStyleStringRef()
+ *
+ * Used by ReadGeometryFromMAPFile() to keep a reference to the style
+ * string cached by the TABMAPFile for the feature's drawing tools.  The
+ * string is copied only if GetStyleString() is called, see
+ * CopyStyleStringRef().
+ *
+ * The reference is owned by the TABMAPFile and is valid only until the 
+ * file is closed: DetachStyleStringRef() must be called before passing
+ * the feature to a caller who may keep it longer.
+ **********************************************************************/
+void TABFeature::SetStyleStringRef(const char *pszStyleStringRef)
+{
+    if (m_bStyleStringRefOwned)
+        CPLFree((char*)m_pszStyleStringRef);
+
+    m_pszStyleStringRef = pszStyleStringRef;
+    m_bStyleStringRefOwned = FALSE;
+}
+
+/**********************************************************************
+ *                   TABFeature::DetachStyleStringRef()
+ *
+ * Replace the reference to the TABMAPFile style string cache by a copy
+ * owned by the feature, so that the feature can outlive the file.  Used
+ * when the ownership of a feature is passed to the caller, e.g. by
+ * GetNextFeature().
+ **********************************************************************/
+void TABFeature::DetachStyleStringRef()
+{
+    if (m_pszStyleStringRef != NULL && !m_bStyleStringRefOwned)
+    {
+        m_pszStyleStringRef = CPLStrdup(m_pszStyleStringRef);
+        m_bStyleStringRefOwned = TRUE;
+    }
+}
+
+/**********************************************************************
+ *                   TABFeature::CopyStyleStringRef()
+ *
+ * Used by GetStyleString() to set m_pszStyleString from the style string
+ * reference set at read time.  The caller is responsible for checking
+ * that the drawing tools have not been modified since then.
+ *
+ * Returns TRUE if m_pszStyleString was set, FALSE if there is no 
+ * reference and the style string has to be built by the caller.
+ **********************************************************************/
+GBool TABFeature::CopyStyleStringRef()
+{
+    if (m_pszStyleStringRef == NULL)
+        return FALSE;
+
+    CPLFree(m_pszStyleString);
+    if (m_bStyleStringRefOwned)
+        m_pszStyleString = (char*)m_pszStyleStringRef;
+    else
+        m_pszStyleString = CPLStrdup(m_pszStyleStringRef);
+
+    m_pszStyleStringRef = NULL;
+    m_bStyleStringRefOwned = FALSE;
+
+    return TRUE;
 }
 
 
@@ -1057,6 +1126,7 @@ int TABPoint::ReadGeometryFromMAPFile(TABMAPFile *poMapFile,
     m_nSymbolDefIndex = poPointHdr->m_nSymbolId;   // Symbol index
 
     poMapFile->ReadSymbolDef(m_nSymbolDefIndex, &m_sSymbolDef);
+    SetStyleStringRef(poMapFile->GetSymbolStyleStringRef(m_nSymbolDefIndex));
     
     /*-----------------------------------------------------------------
      * Create and fill geometry object
@@ -1201,7 +1271,8 @@ const char *TABPoint::GetStyleString()
 {
     if (m_pszStyleString == NULL)
     {
-        m_pszStyleString = CPLStrdup(GetSymbolStyleString());
+        if (m_bSymbolDefChanged || !CopyStyleStringRef())
+            m_pszStyleString = CPLStrdup(GetSymbolStyleString());
     }
 
     return m_pszStyleString;
@@ -1701,6 +1772,7 @@ int TABCustomPoint::ReadGeometryFromMAPFile(TABMAPFile *poMapFile,
 
     m_nSymbolDefIndex = poPointHdr->m_nSymbolId;   // Symbol index
     poMapFile->ReadSymbolDef(m_nSymbolDefIndex, &m_sSymbolDef);
+    SetStyleStringRef(poMapFile->GetSymbolStyleStringRef(m_nSymbolDefIndex));
 
     m_nFontDefIndex = poPointHdr->m_nFontId;    // Font index
     poMapFile->ReadFontDef(m_nFontDefIndex, &m_sFontDef);
@@ -1801,7 +1873,8 @@ const char *TABCustomPoint::GetStyleString()
 {
     if (m_pszStyleString == NULL)
     {
-        m_pszStyleString = CPLStrdup(GetSymbolStyleString());
+        if (m_bSymbolDefChanged || !CopyStyleStringRef())
+            m_pszStyleString = CPLStrdup(GetSymbolStyleString());
     }
 
     return m_pszStyleString;
@@ -2106,6 +2179,8 @@ int TABPolyline::ReadGeometryFromMAPFile(TABMAPFile *poMapFile,
         {
             m_nPenDefIndex = poLineHdr->m_nPenId;      // Pen index
             poMapFile->ReadPenDef(m_nPenDefIndex, &m_sPenDef);
+            SetStyleStringRef(
+                          poMapFile->GetPenStyleStringRef(m_nPenDefIndex));
         }
     }
     else if (m_nMapInfoType == TAB_GEOM_PLINE ||
@@ -2147,6 +2222,8 @@ int TABPolyline::ReadGeometryFromMAPFile(TABMAPFile *poMapFile,
         {
             m_nPenDefIndex = poPLineHdr->m_nPenId;        // Pen index
             poMapFile->ReadPenDef(m_nPenDefIndex, &m_sPenDef);
+            SetStyleStringRef(
+                          poMapFile->GetPenStyleStringRef(m_nPenDefIndex));
         }
 
         /*-------------------------------------------------------------
@@ -2235,6 +2312,8 @@ int TABPolyline::ReadGeometryFromMAPFile(TABMAPFile *poMapFile,
         {
             m_nPenDefIndex = poPLineHdr->m_nPenId;        // Pen index
             poMapFile->ReadPenDef(m_nPenDefIndex, &m_sPenDef);
+            SetStyleStringRef(
+                          poMapFile->GetPenStyleStringRef(m_nPenDefIndex));
         }
 
         /*-------------------------------------------------------------
@@ -2691,7 +2770,8 @@ const char *TABPolyline::GetStyleString()
 {
     if (m_pszStyleString == NULL)
     {
-        m_pszStyleString = CPLStrdup(GetPenStyleString());
+        if (m_bPenDefChanged || !CopyStyleStringRef())
+            m_pszStyleString = CPLStrdup(GetPenStyleString());
     }
 
     return m_pszStyleString;
@@ -3053,6 +3133,8 @@ int TABRegion::ReadGeometryFromMAPFile(TABMAPFile *poMapFile,
             poMapFile->ReadPenDef(m_nPenDefIndex, &m_sPenDef);
             m_nBrushDefIndex = poPLineHdr->m_nBrushId;    // Brush index
             poMapFile->ReadBrushDef(m_nBrushDefIndex, &m_sBrushDef);
+            SetStyleStringRef(poMapFile->GetPenBrushStyleStringRef(
+                                           m_nPenDefIndex, m_nBrushDefIndex));
         }
 
         /*-------------------------------------------------------------
@@ -3691,7 +3773,8 @@ GBool TABRegion::IsInteriorRing(int nRequestedRingIndex)
  **********************************************************************/
 const char *TABRegion::GetStyleString()
 {
-    if (m_pszStyleString == NULL)
+    if (m_pszStyleString == NULL &&
+        (m_bPenDefChanged || m_bBrushDefChanged || !CopyStyleStringRef()))
     {
         // Since GetPen/BrushStyleString() use CPLSPrintf(), we need 
         // to use temporary buffers
@@ -4074,6 +4157,8 @@ int TABRectangle::ReadGeometryFromMAPFile(TABMAPFile *poMapFile,
 
     m_nBrushDefIndex = poRectHdr->m_nBrushId;   // Brush index
     poMapFile->ReadBrushDef(m_nBrushDefIndex, &m_sBrushDef);
+    SetStyleStringRef(poMapFile->GetPenBrushStyleStringRef(m_nPenDefIndex,
+                                                           m_nBrushDefIndex));
 
     /*-----------------------------------------------------------------
      * Call SetMBR() and GetMBR() now to make sure that min values are
@@ -4215,7 +4300,8 @@ int TABRectangle::WriteGeometryToMAPFile(TABMAPFile *poMapFile,
  **********************************************************************/
 const char *TABRectangle::GetStyleString()
 {
-    if (m_pszStyleString == NULL)
+    if (m_pszStyleString == NULL &&
+        (m_bPenDefChanged || m_bBrushDefChanged || !CopyStyleStringRef()))
     {
         // Since GetPen/BrushStyleString() use CPLSPrintf(), we need 
         // to use temporary buffers
@@ -4520,6 +4606,8 @@ int TABEllipse::ReadGeometryFromMAPFile(TABMAPFile *poMapFile,
 
     m_nBrushDefIndex = poRectHdr->m_nBrushId;   // Brush index
     poMapFile->ReadBrushDef(m_nBrushDefIndex, &m_sBrushDef);
+    SetStyleStringRef(poMapFile->GetPenBrushStyleStringRef(m_nPenDefIndex,
+                                                           m_nBrushDefIndex));
 
     /*-----------------------------------------------------------------
      * Save info about the ellipse def. inside class members
@@ -4631,7 +4719,8 @@ int TABEllipse::WriteGeometryToMAPFile(TABMAPFile *poMapFile,
  **********************************************************************/
 const char *TABEllipse::GetStyleString()
 {
-    if (m_pszStyleString == NULL)
+    if (m_pszStyleString == NULL &&
+        (m_bPenDefChanged || m_bBrushDefChanged || !CopyStyleStringRef()))
     {
         // Since GetPen/BrushStyleString() use CPLSPrintf(), we need 
         // to use temporary buffers
@@ -5044,6 +5133,7 @@ int TABArc::ReadGeometryFromMAPFile(TABMAPFile *poMapFile,
 
     m_nPenDefIndex = poArcHdr->m_nPenId;        // Pen index
     poMapFile->ReadPenDef(m_nPenDefIndex, &m_sPenDef);
+    SetStyleStringRef(poMapFile->GetPenStyleStringRef(m_nPenDefIndex));
 
 
     /*-----------------------------------------------------------------
@@ -5176,7 +5266,8 @@ const char *TABArc::GetStyleString()
 {
     if (m_pszStyleString == NULL)
     {
-        m_pszStyleString = CPLStrdup(GetPenStyleString());
+        if (m_bPenDefChanged || !CopyStyleStringRef())
+            m_pszStyleString = CPLStrdup(GetPenStyleString());
     }
 
     return m_pszStyleString;
@@ -6482,6 +6573,8 @@ int TABMultiPoint::ReadGeometryFromMAPFile(TABMAPFile *poMapFile,
         {
             m_nSymbolDefIndex = poMPointHdr->m_nSymbolId;   // Symbol index
             poMapFile->ReadSymbolDef(m_nSymbolDefIndex, &m_sSymbolDef);
+            SetStyleStringRef(
+                      poMapFile->GetSymbolStyleStringRef(m_nSymbolDefIndex));
         }
 
         // Centroid/label point
@@ -6760,7 +6853,8 @@ const char *TABMultiPoint::GetStyleString()
 {
     if (m_pszStyleString == NULL)
     {
-        m_pszStyleString = CPLStrdup(GetSymbolStyleString());
+        if (m_bSymbolDefChanged || !CopyStyleStringRef())
+            m_pszStyleString = CPLStrdup(GetSymbolStyleString());
     }
 
     return m_pszStyleString;
@@ -8140,6 +8234,7 @@ ITABFeaturePen::ITABFeaturePen()
 
     /* MI default is PEN(1,2,0) */
     m_sPenDef = csDefaultPen;
+    m_bPenDefChanged = FALSE;
 }
 
 
@@ -8176,6 +8271,7 @@ void  ITABFeaturePen::SetPenWidthPixel(GByte val)
 {
     m_sPenDef.nPixelWidth = MIN(MAX(val, 1), 7);
     m_sPenDef.nPointWidth = 0;
+    m_bPenDefChanged = TRUE;
 }
 
 double ITABFeaturePen::GetPenWidthPoint()
@@ -8188,6 +8284,7 @@ void  ITABFeaturePen::SetPenWidthPoint(double val)
 {
     m_sPenDef.nPointWidth = MIN(MAX(((int)(val*10)), 1), 2037);
     m_sPenDef.nPixelWidth = 1;
+    m_bPenDefChanged = TRUE;
 }
 
 /**********************************************************************
@@ -8216,6 +8313,7 @@ void  ITABFeaturePen::SetPenWidthMIF(int val)
         m_sPenDef.nPixelWidth = (GByte)MIN(MAX(val, 1), 7);
         m_sPenDef.nPointWidth = 0;
     }
+    m_bPenDefChanged = TRUE;
 }
 
 /**********************************************************************
@@ -8394,6 +8492,8 @@ void  ITABFeaturePen::SetPenFromStyleString(const char *pszStyleString)
     OGRStyleMgr *poStyleMgr = new OGRStyleMgr(NULL);
     OGRStyleTool *poStylePart;
 
+    m_bPenDefChanged = TRUE;
+
     // Init the StyleMgr with the StyleString.
     poStyleMgr->InitStyleString(pszStyleString);
 
@@ -8576,6 +8676,7 @@ ITABFeatureBrush::ITABFeatureBrush()
 
     /* MI default is BRUSH(2,16777215,16777215) */
     m_sBrushDef = csDefaultBrush;
+    m_bBrushDefChanged = FALSE;
 }
 
 
@@ -8649,6 +8750,8 @@ void  ITABFeatureBrush::SetBrushFromStyleString(const char *pszStyleString)
     OGRStyleMgr *poStyleMgr = new OGRStyleMgr(NULL);
     OGRStyleTool *poStylePart;
 
+    m_bBrushDefChanged = TRUE;
+
     // Init the StyleMgr with the StyleString.
     poStyleMgr->InitStyleString(pszStyleString);
 
@@ -8819,6 +8922,7 @@ ITABFeatureSymbol::ITABFeatureSymbol()
 
     /* MI default is Symbol(35,0,12) */
     m_sSymbolDef = csDefaultSymbol;
+    m_bSymbolDefChanged = FALSE;
 }
 
 /**********************************************************************
@@ -8919,6 +9023,8 @@ void ITABFeatureSymbol::SetSymbolFromStyleString(const char *pszStyleString)
     OGRStyleMgr *poStyleMgr = new OGRStyleMgr(NULL);
     OGRStyleTool *poStylePart;
 
+    m_bSymbolDefChanged = TRUE;
+
     // Init the StyleMgr with the StyleString.
     poStyleMgr->InitStyleString(pszStyleString);
 
@@ -174,55 +174,6 @@
  *                      class TABFeature
  *====================================================================*/
 
-/************************************************************************/
-/*                            MIDTokenize()                             */
-/*                                                                      */
-/*      We implement a special tokenize function so we can handle       */
-/*      multibyte delimeters (ie. MITAB bug 1266).                      */
-/*                                                                      */
-/*      http://bugzilla.maptools.org/show_bug.cgi?id=1266               */
-/************************************************************************/
-static char **MIDTokenize( const char *pszLine, const char *pszDelim )
-
-{
-    char **papszResult = NULL;
-    int iChar, iTokenChar = 0, bInQuotes = FALSE;
-    char *pszToken = (char *) CPLMalloc(strlen(pszLine)+1);
-    int nDelimLen = strlen(pszDelim);
-
-    for( iChar = 0; pszLine[iChar] != '\0'; iChar++ )
-    {
-        if( bInQuotes && pszLine[iChar] == '"' && pszLine[iChar+1] == '"' )
-        {
-            pszToken[iTokenChar++] = '"';
-            iChar++;
-        }
-        else if( pszLine[iChar] == '"' )
-        {
-            bInQuotes = !bInQuotes;
-        }
-        else if( !bInQuotes && strncmp(pszLine+iChar,pszDelim,nDelimLen) == 0 )
-        {
-            pszToken[iTokenChar++] = '\0';
-            papszResult = CSLAddString( papszResult, pszToken );
-            
-            iChar += strlen(pszDelim) - 1;
-            iTokenChar = 0;
-        }
-        else
-        {
-            pszToken[iTokenChar++] = pszLine[iChar];
-        }
-    }
-
-    pszToken[iTokenChar++] = '\0';
-    papszResult = CSLAddString( papszResult, pszToken );
-
-    CPLFree( pszToken );
-
-    return papszResult;
-}
-
 /**********************************************************************
  *                   TABFeature::ReadRecordFromMIDFile()
  *
@@ -234,9 +185,8 @@ static char **MIDTokenize( const char *pszLine, const char *pszDelim )
  **********************************************************************/
 int TABFeature::ReadRecordFromMIDFile(MIDDATAFile *fp)
 {
-    const char       *pszLine;
     char            **papszToken;
-    int               nFields,i;
+    int               nFields, nTokens, i;
     OGRFieldDefn        *poFDefn = NULL;
 #ifdef MITAB_USE_OFTDATETIME
     int nYear, nMonth, nDay, nHour, nMin, nSec, nMS, nTZFlag;
@@ -245,34 +195,32 @@ int TABFeature::ReadRecordFromMIDFile(MIDDATAFile *fp)
 
     nFields = GetFieldCount();
     
-    pszLine = fp->GetLastLine();
+    // The line is split in place: papszToken points into the MID read
+    // buffer and is only valid until the fp->GetLine() below.
+    papszToken = fp->SplitLastLine(&nTokens);
 
-    if (pszLine == NULL)
+    if (papszToken == NULL)
     {
         CPLError(CE_Failure, CPLE_FileIO,
                "Unexpected EOF while reading attribute record from MID file.");
         return -1;
     }
 
-    papszToken = MIDTokenize( pszLine, fp->GetDelimiter() );
-
-    // Ensure that a blank line in a mid file is treated as one field 
-    // containing an empty string.
-    if( nFields == 1 && CSLCount(papszToken) == 0 && pszLine[0] == '\0' )
-        papszToken = CSLAddString(papszToken,"");
-
     // Make sure we found at least the expected number of field values.
     // Note that it is possible to have a stray delimiter at the end of
     // the line (mif/mid files from Geomedia), so don't produce an error
     // if we find more tokens than expected.
-    if (CSLCount(papszToken) < nFields)
+    if (nTokens < nFields)
     {
-        CSLDestroy(papszToken);
         return -1;
     }
 
     for (i=0;i<nFields;i++)
     {
+        // Fields not selected with MIFFile::SetSelectedFields() are unset
+        if (!fp->IsFieldSelected(i))
+            continue;
+
         poFDefn = GetFieldDefnRef(i);
         switch(poFDefn->GetType())
         {
@@ -307,6 +255,14 @@ int TABFeature::ReadRecordFromMIDFile(MIDDATAFile *fp)
             }
 #endif
   
+          case OFTString:
+             SetField(i,fp->RecodeString(papszToken[i]));
+             break;
+
+          case OFTReal:
+             SetField(i,TABAtof(papszToken[i]));
+             break;
+
           default:
              SetField(i,papszToken[i]);
        }
@@ -314,8 +270,6 @@ int TABFeature::ReadRecordFromMIDFile(MIDDATAFile *fp)
     
     fp->GetLine();
 
-    CSLDestroy(papszToken);
-
     return 0;
 }
 
@@ -503,39 +457,33 @@ int TABPoint::ReadGeometryFromMIFFile(MIDDATAFile *fp)
 {  
     OGRGeometry         *poGeometry;
     
-    char               **papszToken;
+    TABToken             asToken[TAB_MAX_MIF_TOKENS];
+    int                  nTokens;
     const char *pszLine;
     double dfX,dfY;
-    papszToken = CSLTokenizeString2(fp->GetSavedLine(), 
-                                    " \t", CSLT_HONOURSTRINGS);
+    nTokens = TABTokenizeLine(fp->GetSavedLine(), " \t",
+                              asToken, TAB_MAX_MIF_TOKENS);
      
-    if (CSLCount(papszToken) !=3)
+    if (nTokens !=3)
     {
-        CSLDestroy(papszToken);
         return -1;
     }
     
-    dfX = fp->GetXTrans(atof(papszToken[1]));
-    dfY = fp->GetYTrans(atof(papszToken[2]));
-
-    CSLDestroy(papszToken);
-    papszToken = NULL;
+    dfX = fp->GetXTrans(TABAtof(asToken[1].pszStart));
+    dfY = fp->GetYTrans(TABAtof(asToken[2].pszStart));
 
     // Read optional SYMBOL line...
     pszLine = fp->GetLastLine();
     if( pszLine != NULL )
-        papszToken = CSLTokenizeStringComplex(pszLine," ,()\t",
-                                              TRUE,FALSE);
-    if (CSLCount(papszToken) == 4 && EQUAL(papszToken[0], "SYMBOL") )
+        nTokens = TABTokenizeLine(pszLine, " ,()\t",
+                                  asToken, TAB_MAX_MIF_TOKENS);
+    if (nTokens == 4 && TABTokenEQUAL(&asToken[0], "SYMBOL") )
     {
-        SetSymbolNo((GInt16)atoi(papszToken[1]));
-        SetSymbolColor((GInt32)atoi(papszToken[2]));
-        SetSymbolSize((GInt16)atoi(papszToken[3]));
+        SetSymbolNo((GInt16)atoi(asToken[1].pszStart));
+        SetSymbolColor((GInt32)atoi(asToken[2].pszStart));
+        SetSymbolSize((GInt16)atoi(asToken[3].pszStart));
     }
 
-    CSLDestroy(papszToken); 
-    papszToken = NULL;
-
     // scan until we reach 1st line of next feature
     // Since SYMBOL is optional, we have to test IsValidFeature() on that
     // line as well.
@@ -589,41 +537,37 @@ int TABFontPoint::ReadGeometryFromMIFFile(MIDDATAFile *fp)
 {   
     OGRGeometry         *poGeometry;
     
-    char               **papszToken;
+    TABToken             asToken[TAB_MAX_MIF_TOKENS];
+    int                  nTokens;
+    char                 szFontName[33];
     const char *pszLine;
     double dfX,dfY;
-    papszToken = CSLTokenizeString2(fp->GetSavedLine(), 
-                                    " \t", CSLT_HONOURSTRINGS);
+    nTokens = TABTokenizeLine(fp->GetSavedLine(), " \t",
+                              asToken, TAB_MAX_MIF_TOKENS);
 
-    if (CSLCount(papszToken) !=3)
+    if (nTokens !=3)
     {
-        CSLDestroy(papszToken);
         return -1;
     }
 
-    dfX = fp->GetXTrans(atof(papszToken[1]));
-    dfY = fp->GetYTrans(atof(papszToken[2]));
-    
-    CSLDestroy(papszToken);
+    dfX = fp->GetXTrans(TABAtof(asToken[1].pszStart));
+    dfY = fp->GetYTrans(TABAtof(asToken[2].pszStart));
     
-    papszToken = CSLTokenizeStringComplex(fp->GetLastLine()," ,()\t",
-                                          TRUE,FALSE);
+    nTokens = TABTokenizeLine(fp->GetLastLine(), " ,()\t",
+                              asToken, TAB_MAX_MIF_TOKENS);
 
-    if (CSLCount(papszToken) !=7)
+    if (nTokens !=7)
     {
-        CSLDestroy(papszToken);
         return -1;
     }
     
-    SetSymbolNo((GInt16)atoi(papszToken[1]));
-    SetSymbolColor((GInt32)atoi(papszToken[2]));
-    SetSymbolSize((GInt16)atoi(papszToken[3]));
-    SetFontName(papszToken[4]);
-    SetFontStyleMIFValue(atoi(papszToken[5]));
-    SetSymbolAngle(atof(papszToken[6]));
-
-    CSLDestroy(papszToken);
-    
+    SetSymbolNo((GInt16)atoi(asToken[1].pszStart));
+    SetSymbolColor((GInt32)atoi(asToken[2].pszStart));
+    SetSymbolSize((GInt16)atoi(asToken[3].pszStart));
+    SetFontName(TABTokenCopy(&asToken[4], szFontName, sizeof(szFontName)));
+    SetFontStyleMIFValue(atoi(asToken[5].pszStart));
+    SetSymbolAngle(TABAtof(asToken[6].pszStart));
+
     poGeometry = new OGRPoint(dfX, dfY);
     
     SetGeometryDirectly(poGeometry);
@@ -675,40 +619,36 @@ int TABCustomPoint::ReadGeometryFromMIFFile(MIDDATAFile *fp)
 {   
     OGRGeometry         *poGeometry;
     
-    char               **papszToken;
+    TABToken             asToken[TAB_MAX_MIF_TOKENS];
+    int                  nTokens;
+    char                 szFontName[33];
     const char          *pszLine;
     double               dfX,dfY;
 
-    papszToken = CSLTokenizeString2(fp->GetSavedLine(), 
-                                    " \t", CSLT_HONOURSTRINGS);
+    nTokens = TABTokenizeLine(fp->GetSavedLine(), " \t",
+                              asToken, TAB_MAX_MIF_TOKENS);
 
     
-    if (CSLCount(papszToken) !=3)
+    if (nTokens !=3)
     {
-        CSLDestroy(papszToken);
         return -1;
     }
 
-    dfX = fp->GetXTrans(atof(papszToken[1]));
-    dfY = fp->GetYTrans(atof(papszToken[2]));
+    dfX = fp->GetXTrans(TABAtof(asToken[1].pszStart));
+    dfY = fp->GetYTrans(TABAtof(asToken[2].pszStart));
 
-    CSLDestroy(papszToken);
-    
-    papszToken = CSLTokenizeStringComplex(fp->GetLastLine()," ,()\t",
-                                          TRUE,FALSE);
-    if (CSLCount(papszToken) !=5)
+    nTokens = TABTokenizeLine(fp->GetLastLine(), " ,()\t",
+                              asToken, TAB_MAX_MIF_TOKENS);
+    if (nTokens !=5)
     {
         
-        CSLDestroy(papszToken);
         return -1;
     }
     
-    SetFontName(papszToken[1]);
-    SetSymbolColor((GInt32)atoi(papszToken[2]));
-    SetSymbolSize((GInt16)atoi(papszToken[3]));
-    m_nCustomStyle = (GByte)atoi(papszToken[4]);
-    
-    CSLDestroy(papszToken);
+    SetFontName(TABTokenCopy(&asToken[1], szFontName, sizeof(szFontName)));
+    SetSymbolColor((GInt32)atoi(asToken[2].pszStart));
+    SetSymbolSize((GInt16)atoi(asToken[3].pszStart));
+    m_nCustomStyle = (GByte)atoi(asToken[4].pszStart);
     
     poGeometry = new OGRPoint(dfX, dfY);
     
@@ -761,7 +701,8 @@ int TABCustomPoint::WriteGeometryToMIFFile(MIDDATAFile *fp)
 int TABPolyline::ReadGeometryFromMIFFile(MIDDATAFile *fp)
 {
     const char          *pszLine;
-    char               **papszToken;
+    TABToken             asToken[TAB_MAX_MIF_TOKENS];
+    int                  nTokens;
     OGRLineString       *poLine;
     OGRMultiLineString  *poMultiLine;
     GBool                bMultiple = FALSE;
@@ -769,33 +710,32 @@ int TABPolyline::ReadGeometryFromMIFFile(MIDDATAFile *fp)
     OGREnvelope          sEnvelope;
     
 
-    papszToken = CSLTokenizeString2(fp->GetLastLine(), 
-                                    " \t", CSLT_HONOURSTRINGS);
+    nTokens = TABTokenizeLine(fp->GetLastLine(), " \t",
+                              asToken, TAB_MAX_MIF_TOKENS);
     
-    if (CSLCount(papszToken) < 1)
+    if (nTokens < 1)
     {
-        CSLDestroy(papszToken);
         return -1;
     }
 
-    if (EQUALN(papszToken[0],"LINE",4))
+    if (EQUALN(asToken[0].pszStart,"LINE",4))
     {
-        if (CSLCount(papszToken) != 5)
+        if (nTokens != 5)
           return -1;
 
         poLine = new OGRLineString();
         poLine->setNumPoints(2);
-        poLine->setPoint(0, fp->GetXTrans(atof(papszToken[1])),
-                         fp->GetYTrans(atof(papszToken[2])));
-        poLine->setPoint(1, fp->GetXTrans(atof(papszToken[3])),
-                         fp->GetYTrans(atof(papszToken[4])));
+        poLine->setPoint(0, fp->GetXTrans(TABAtof(asToken[1].pszStart)),
+                         fp->GetYTrans(TABAtof(asToken[2].pszStart)));
+        poLine->setPoint(1, fp->GetXTrans(TABAtof(asToken[3].pszStart)),
+                         fp->GetYTrans(TABAtof(asToken[4].pszStart)));
         SetGeometryDirectly(poLine);
         poLine->getEnvelope(&sEnvelope);
         SetMBR(sEnvelope.MinX, sEnvelope.MinY,sEnvelope.MaxX,sEnvelope.MaxY);
     }
-    else if (EQUALN(papszToken[0],"PLINE",5))
+    else if (EQUALN(asToken[0].pszStart,"PLINE",5))
     {
-        switch (CSLCount(papszToken))
+        switch (nTokens)
         {
           case 1:
             bMultiple = FALSE;
@@ -804,39 +744,36 @@ int TABPolyline::ReadGeometryFromMIFFile(MIDDATAFile *fp)
             break;
           case 2:
             bMultiple = FALSE;
-            nNumPoints = atoi(papszToken[1]);
+            nNumPoints = atoi(asToken[1].pszStart);
             break;
           case 3:
-            if (EQUALN(papszToken[1],"MULTIPLE",8))
+            if (EQUALN(asToken[1].pszStart,"MULTIPLE",8))
             {
                 bMultiple = TRUE;
-                nNumSec = atoi(papszToken[2]);
+                nNumSec = atoi(asToken[2].pszStart);
                 pszLine = fp->GetLine();
                 nNumPoints = atoi(pszLine);
                 break;
             }
             else
             {
-              CSLDestroy(papszToken);
               return -1;
             }
             break;
           case 4:
-            if (EQUALN(papszToken[1],"MULTIPLE",8))
+            if (EQUALN(asToken[1].pszStart,"MULTIPLE",8))
             {
                 bMultiple = TRUE;
-                nNumSec = atoi(papszToken[2]);
-                nNumPoints = atoi(papszToken[3]);
+                nNumSec = atoi(asToken[2].pszStart);
+                nNumPoints = atoi(asToken[3].pszStart);
                 break;
             }
             else
             {
-                CSLDestroy(papszToken);
                 return -1;
             }
             break;
           default:
-            CSLDestroy(papszToken);
             return -1;
             break;
         }
@@ -859,11 +796,16 @@ int TABPolyline::ReadGeometryFromMIFFile(MIDDATAFile *fp)
                 poLine->setNumPoints(nNumPoints);
                 for (i=0;i<nNumPoints;i++)
                 {
-                    CSLDestroy(papszToken);
-                    papszToken = CSLTokenizeString2(fp->GetLine(), 
-                                                    " \t", CSLT_HONOURSTRINGS);
-                    poLine->setPoint(i,fp->GetXTrans(atof(papszToken[0])),
-                                     fp->GetYTrans(atof(papszToken[1])));
+                    nTokens = TABTokenizeLine(fp->GetLine(), " \t",
+                                              asToken, TAB_MAX_MIF_TOKENS);
+                    if (nTokens != 2)
+                    {
+                        delete poLine;
+                        delete poMultiLine;
+                        return -1;
+                    }
+                    poLine->setPoint(i,fp->GetXTrans(TABAtof(asToken[0].pszStart)),
+                                     fp->GetYTrans(TABAtof(asToken[1].pszStart)));
                 }
                 if (poMultiLine->addGeometryDirectly(poLine) != OGRERR_NONE)
                 {
@@ -884,14 +826,13 @@ int TABPolyline::ReadGeometryFromMIFFile(MIDDATAFile *fp)
             poLine->setNumPoints(nNumPoints);
             for (i=0;i<nNumPoints;i++)
             {
-                CSLDestroy(papszToken);
-                papszToken = CSLTokenizeString2(fp->GetLine(), 
-                                                " \t", CSLT_HONOURSTRINGS);
+                nTokens = TABTokenizeLine(fp->GetLine(), " \t",
+                                          asToken, TAB_MAX_MIF_TOKENS);
     
-                if (CSLCount(papszToken) != 2)
+                if (nTokens != 2)
                   return -1;
-                poLine->setPoint(i,fp->GetXTrans(atof(papszToken[0])),
-                                 fp->GetYTrans(atof(papszToken[1])));
+                poLine->setPoint(i,fp->GetXTrans(TABAtof(asToken[0].pszStart)),
+                                 fp->GetYTrans(TABAtof(asToken[1].pszStart)));
             }
             SetGeometryDirectly(poLine);
             poLine->getEnvelope(&sEnvelope);
@@ -900,34 +841,30 @@ int TABPolyline::ReadGeometryFromMIFFile(MIDDATAFile *fp)
         }
     }    
     
-    CSLDestroy(papszToken);
-    papszToken = NULL;
-    
     while (((pszLine = fp->GetLine()) != NULL) && 
            fp->IsValidFeature(pszLine) == FALSE)
     {
-        papszToken = CSLTokenizeStringComplex(pszLine,"() ,",
-                                              TRUE,FALSE);
+        nTokens = TABTokenizeLine(pszLine, "() ,",
+                                  asToken, TAB_MAX_MIF_TOKENS);
         
-        if (CSLCount(papszToken) >= 1)
+        if (nTokens >= 1)
         {
-            if (EQUALN(papszToken[0],"PEN",3))
+            if (EQUALN(asToken[0].pszStart,"PEN",3))
             {
                 
-                if (CSLCount(papszToken) == 4)
+                if (nTokens == 4)
                 {                   
-                    SetPenWidthMIF(atoi(papszToken[1]));
-                    SetPenPattern((GByte)atoi(papszToken[2]));
-                    SetPenColor((GInt32)atoi(papszToken[3]));
+                    SetPenWidthMIF(atoi(asToken[1].pszStart));
+                    SetPenPattern((GByte)atoi(asToken[2].pszStart));
+                    SetPenColor((GInt32)atoi(asToken[3].pszStart));
                 }
                 
             }
-            else if (EQUALN(papszToken[0],"SMOOTH",6))
+            else if (EQUALN(asToken[0].pszStart,"SMOOTH",6))
             {
                 m_bSmooth = TRUE;
             }             
         }
-        CSLDestroy(papszToken);
     }
     return 0; 
 }
@@ -1033,7 +970,8 @@ int TABRegion::ReadGeometryFromMIFFile(MIDDATAFile *fp)
     OGRGeometry         *poGeometry = NULL;
     OGRPolygon          **tabPolygons = NULL;
     int                  i,iSection, numLineSections=0;
-    char               **papszToken;
+    TABToken             asToken[TAB_MAX_MIF_TOKENS];
+    int                  nTokens;
     const char          *pszLine;
     OGREnvelope          sEnvelope;
 
@@ -1041,13 +979,11 @@ int TABRegion::ReadGeometryFromMIFFile(MIDDATAFile *fp)
     /*=============================================================
      * REGION (Similar to PLINE MULTIPLE)
      *============================================================*/
-    papszToken = CSLTokenizeString2(fp->GetLastLine(), 
-                                    " \t", CSLT_HONOURSTRINGS);
+    nTokens = TABTokenizeLine(fp->GetLastLine(), " \t",
+                              asToken, TAB_MAX_MIF_TOKENS);
     
-    if (CSLCount(papszToken) ==2)
-      numLineSections = atoi(papszToken[1]);
-    CSLDestroy(papszToken);
-    papszToken = NULL;
+    if (nTokens ==2)
+      numLineSections = atoi(asToken[1].pszStart);
 
     if (numLineSections > 0) 
         tabPolygons = new OGRPolygon*[numLineSections];
@@ -1071,16 +1007,14 @@ int TABRegion::ReadGeometryFromMIFFile(MIDDATAFile *fp)
             pszLine = fp->GetLine();
             if (pszLine)
             {
-                papszToken = CSLTokenizeStringComplex(pszLine," ,\t",
-                                                      TRUE,FALSE);
-                if (CSLCount(papszToken) == 2)
+                nTokens = TABTokenizeLine(pszLine, " ,\t",
+                                          asToken, TAB_MAX_MIF_TOKENS);
+                if (nTokens == 2)
                 {              
-                    dX = fp->GetXTrans(atof(papszToken[0]));
-                    dY = fp->GetYTrans(atof(papszToken[1]));
+                    dX = fp->GetXTrans(TABAtof(asToken[0].pszStart));
+                    dY = fp->GetYTrans(TABAtof(asToken[1].pszStart));
                     poRing->setPoint(i, dX, dY);
                 }
-                CSLDestroy(papszToken);
-                papszToken = NULL;
             }   
         }
 
@@ -1118,47 +1052,45 @@ int TABRegion::ReadGeometryFromMIFFile(MIDDATAFile *fp)
     while (((pszLine = fp->GetLine()) != NULL) && 
            fp->IsValidFeature(pszLine) == FALSE)
     {
-        papszToken = CSLTokenizeStringComplex(pszLine,"() ,",
-                                              TRUE,FALSE);
+        nTokens = TABTokenizeLine(pszLine, "() ,",
+                                  asToken, TAB_MAX_MIF_TOKENS);
         
-        if (CSLCount(papszToken) > 1)
+        if (nTokens > 1)
         {
-            if (EQUALN(papszToken[0],"PEN",3))
+            if (EQUALN(asToken[0].pszStart,"PEN",3))
             {
                 
-                if (CSLCount(papszToken) == 4)
+                if (nTokens == 4)
                 {           
-                    SetPenWidthMIF(atoi(papszToken[1]));
-                    SetPenPattern((GByte)atoi(papszToken[2]));
-                    SetPenColor((GInt32)atoi(papszToken[3]));
+                    SetPenWidthMIF(atoi(asToken[1].pszStart));
+                    SetPenPattern((GByte)atoi(asToken[2].pszStart));
+                    SetPenColor((GInt32)atoi(asToken[3].pszStart));
                 }
                 
             }
-            else if (EQUALN(papszToken[0],"BRUSH", 5))
+            else if (EQUALN(asToken[0].pszStart,"BRUSH", 5))
             {
-                if (CSLCount(papszToken) >= 3)
+                if (nTokens >= 3)
                 {
-                    SetBrushFGColor((GInt32)atoi(papszToken[2]));
-                    SetBrushPattern((GByte)atoi(papszToken[1]));
+                    SetBrushFGColor((GInt32)atoi(asToken[2].pszStart));
+                    SetBrushPattern((GByte)atoi(asToken[1].pszStart));
                     
-                    if (CSLCount(papszToken) == 4)
-                       SetBrushBGColor(atoi(papszToken[3]));
+                    if (nTokens == 4)
+                       SetBrushBGColor(atoi(asToken[3].pszStart));
                     else
                       SetBrushTransparent(TRUE);
                 }
                 
             }
-            else if (EQUALN(papszToken[0],"CENTER",6))
+            else if (EQUALN(asToken[0].pszStart,"CENTER",6))
             {
-                if (CSLCount(papszToken) == 3)
+                if (nTokens == 3)
                 {
-                    SetCenter(fp->GetXTrans(atof(papszToken[1])),
-                              fp->GetYTrans(atof(papszToken[2])) );
+                    SetCenter(fp->GetXTrans(TABAtof(asToken[1].pszStart)),
+                              fp->GetYTrans(TABAtof(asToken[2].pszStart)) );
                 }
             }
         }
-        CSLDestroy(papszToken);
-        papszToken = NULL;
     }
     
     
@@ -1255,24 +1187,24 @@ int TABRegion::WriteGeometryToMIFFile(MIDDATAFile *fp)
 int TABRectangle::ReadGeometryFromMIFFile(MIDDATAFile *fp)
 {
     const char          *pszLine;
-    char               **papszToken;
+    TABToken             asToken[TAB_MAX_MIF_TOKENS];
+    int                  nTokens;
     double               dXMin, dYMin, dXMax, dYMax;
     OGRPolygon          *poPolygon;
     OGRLinearRing       *poRing;
 
-    papszToken = CSLTokenizeString2(fp->GetLastLine(), 
-                                    " \t", CSLT_HONOURSTRINGS);
+    nTokens = TABTokenizeLine(fp->GetLastLine(), " \t",
+                              asToken, TAB_MAX_MIF_TOKENS);
 
-    if (CSLCount(papszToken) <  5)
+    if (nTokens <  5)
     {
-        CSLDestroy(papszToken);
         return -1;
     }
 
-    dXMin = fp->GetXTrans(atof(papszToken[1]));
-    dXMax = fp->GetXTrans(atof(papszToken[3]));
-    dYMin = fp->GetYTrans(atof(papszToken[2]));
-    dYMax = fp->GetYTrans(atof(papszToken[4]));
+    dXMin = fp->GetXTrans(TABAtof(asToken[1].pszStart));
+    dXMax = fp->GetXTrans(TABAtof(asToken[3].pszStart));
+    dYMin = fp->GetYTrans(TABAtof(asToken[2].pszStart));
+    dYMax = fp->GetYTrans(TABAtof(asToken[4].pszStart));
     
     /*-----------------------------------------------------------------
      * Call SetMBR() and GetMBR() now to make sure that min values are
@@ -1285,22 +1217,19 @@ int TABRectangle::ReadGeometryFromMIFFile(MIDDATAFile *fp)
     m_dRoundXRadius  = 0.0;
     m_dRoundYRadius  = 0.0;
     
-    if (EQUALN(papszToken[0],"ROUNDRECT",9))
+    if (EQUALN(asToken[0].pszStart,"ROUNDRECT",9))
     {
         m_bRoundCorners = TRUE;
-        if (CSLCount(papszToken) == 6)
-          m_dRoundXRadius = m_dRoundYRadius = atof(papszToken[5])/2.0;
+        if (nTokens == 6)
+          m_dRoundXRadius = m_dRoundYRadius = TABAtof(asToken[5].pszStart)/2.0;
         else
         {
-            CSLDestroy(papszToken);
-            papszToken = CSLTokenizeString2(fp->GetLine(), 
-                                            " \t", CSLT_HONOURSTRINGS);
-            if (CSLCount(papszToken) !=1 )
-              m_dRoundXRadius = m_dRoundYRadius = atof(papszToken[1])/2.0;
+            nTokens = TABTokenizeLine(fp->GetLine(), " \t",
+                                      asToken, TAB_MAX_MIF_TOKENS);
+            if (nTokens > 1)
+              m_dRoundXRadius = m_dRoundYRadius = TABAtof(asToken[1].pszStart)/2.0;
         }
     }
-    CSLDestroy(papszToken);
-    papszToken = NULL;
 
     /*-----------------------------------------------------------------
      * Create and fill geometry object
@@ -1353,38 +1282,36 @@ int TABRectangle::ReadGeometryFromMIFFile(MIDDATAFile *fp)
    while (((pszLine = fp->GetLine()) != NULL) && 
           fp->IsValidFeature(pszLine) == FALSE)
    {
-       papszToken = CSLTokenizeStringComplex(pszLine,"() ,",
-                                             TRUE,FALSE);
+       nTokens = TABTokenizeLine(pszLine, "() ,",
+                                 asToken, TAB_MAX_MIF_TOKENS);
 
-       if (CSLCount(papszToken) > 1)
+       if (nTokens > 1)
        {
-           if (EQUALN(papszToken[0],"PEN",3))
+           if (EQUALN(asToken[0].pszStart,"PEN",3))
            {       
-               if (CSLCount(papszToken) == 4)
+               if (nTokens == 4)
                {   
-                   SetPenWidthMIF(atoi(papszToken[1]));
-                   SetPenPattern((GByte)atoi(papszToken[2]));
-                   SetPenColor((GInt32)atoi(papszToken[3]));
+                   SetPenWidthMIF(atoi(asToken[1].pszStart));
+                   SetPenPattern((GByte)atoi(asToken[2].pszStart));
+                   SetPenColor((GInt32)atoi(asToken[3].pszStart));
                }
               
            }
-           else if (EQUALN(papszToken[0],"BRUSH", 5))
+           else if (EQUALN(asToken[0].pszStart,"BRUSH", 5))
            {
-               if (CSLCount(papszToken) >=3)
+               if (nTokens >=3)
                {
-                   SetBrushFGColor((GInt32)atoi(papszToken[2]));
-                   SetBrushPattern((GByte)atoi(papszToken[1]));
+                   SetBrushFGColor((GInt32)atoi(asToken[2].pszStart));
+                   SetBrushPattern((GByte)atoi(asToken[1].pszStart));
 
-                   if (CSLCount(papszToken) == 4)
-                       SetBrushBGColor(atoi(papszToken[3]));
+                   if (nTokens == 4)
+                       SetBrushBGColor(atoi(asToken[3].pszStart));
                    else
                       SetBrushTransparent(TRUE);
                }
               
            }
        }
-       CSLDestroy(papszToken);
-       papszToken = NULL;
    }
  
    return 0; 
@@ -1455,27 +1382,24 @@ int TABRectangle::WriteGeometryToMIFFile(MIDDATAFile *fp)
 int TABEllipse::ReadGeometryFromMIFFile(MIDDATAFile *fp)
 {   
     const char *pszLine;
-    char **papszToken;
+    TABToken            asToken[TAB_MAX_MIF_TOKENS];
+    int                 nTokens;
     double              dXMin, dYMin, dXMax, dYMax;
     OGRPolygon          *poPolygon;
     OGRLinearRing       *poRing;
 
-    papszToken = CSLTokenizeString2(fp->GetLastLine(), 
-                                    " \t", CSLT_HONOURSTRINGS);
+    nTokens = TABTokenizeLine(fp->GetLastLine(), " \t",
+                              asToken, TAB_MAX_MIF_TOKENS);
 
-    if (CSLCount(papszToken) != 5)
+    if (nTokens != 5)
     {
-        CSLDestroy(papszToken);
         return -1;
     }
 
-    dXMin = fp->GetXTrans(atof(papszToken[1]));
-    dXMax = fp->GetXTrans(atof(papszToken[3]));
-    dYMin = fp->GetYTrans(atof(papszToken[2]));
-    dYMax = fp->GetYTrans(atof(papszToken[4]));
-
-    CSLDestroy(papszToken);
-    papszToken = NULL;
+    dXMin = fp->GetXTrans(TABAtof(asToken[1].pszStart));
+    dXMax = fp->GetXTrans(TABAtof(asToken[3].pszStart));
+    dYMin = fp->GetYTrans(TABAtof(asToken[2].pszStart));
+    dYMax = fp->GetYTrans(TABAtof(asToken[4].pszStart));
 
      /*-----------------------------------------------------------------
      * Save info about the ellipse def. inside class members
@@ -1509,30 +1433,30 @@ int TABEllipse::ReadGeometryFromMIFFile(MIDDATAFile *fp)
     while (((pszLine = fp->GetLine()) != NULL) && 
            fp->IsValidFeature(pszLine) == FALSE)
     {
-        papszToken = CSLTokenizeStringComplex(pszLine,"() ,",
-                                              TRUE,FALSE);
+        nTokens = TABTokenizeLine(pszLine, "() ,",
+                                  asToken, TAB_MAX_MIF_TOKENS);
         
-        if (CSLCount(papszToken) > 1)
+        if (nTokens > 1)
         {
-            if (EQUALN(papszToken[0],"PEN",3))
+            if (EQUALN(asToken[0].pszStart,"PEN",3))
             {       
-                if (CSLCount(papszToken) == 4)
+                if (nTokens == 4)
                 {   
-                    SetPenWidthMIF(atoi(papszToken[1]));
-                    SetPenPattern((GByte)atoi(papszToken[2]));
-                    SetPenColor((GInt32)atoi(papszToken[3]));
+                    SetPenWidthMIF(atoi(asToken[1].pszStart));
+                    SetPenPattern((GByte)atoi(asToken[2].pszStart));
+                    SetPenColor((GInt32)atoi(asToken[3].pszStart));
                 }
                 
             }
-            else if (EQUALN(papszToken[0],"BRUSH", 5))
+            else if (EQUALN(asToken[0].pszStart,"BRUSH", 5))
             {
-                if (CSLCount(papszToken) >= 3)
+                if (nTokens >= 3)
                 {
-                    SetBrushFGColor((GInt32)atoi(papszToken[2]));
-                    SetBrushPattern((GByte)atoi(papszToken[1]));
+                    SetBrushFGColor((GInt32)atoi(asToken[2].pszStart));
+                    SetBrushPattern((GByte)atoi(asToken[1].pszStart));
                     
-                    if (CSLCount(papszToken) == 4)
-                      SetBrushBGColor(atoi(papszToken[3]));
+                    if (nTokens == 4)
+                      SetBrushBGColor(atoi(asToken[3].pszStart));
                     else
                       SetBrushTransparent(TRUE);
                     
@@ -1540,8 +1464,6 @@ int TABEllipse::ReadGeometryFromMIFFile(MIDDATAFile *fp)
                 
             }
         }
-        CSLDestroy(papszToken);
-        papszToken = NULL;
     }
     return 0; 
 }
@@ -1591,50 +1513,45 @@ int TABArc::ReadGeometryFromMIFFile(MIDDATAFile *fp)
 {
     const char          *pszLine;
     OGRLineString       *poLine;
-    char               **papszToken;
+    TABToken             asToken[TAB_MAX_MIF_TOKENS];
+    int                  nTokens;
     double               dXMin,dXMax, dYMin,dYMax;
     int                  numPts;
     
-    papszToken = CSLTokenizeString2(fp->GetLastLine(), 
-                                    " \t", CSLT_HONOURSTRINGS);
+    nTokens = TABTokenizeLine(fp->GetLastLine(), " \t",
+                              asToken, TAB_MAX_MIF_TOKENS);
 
-    if (CSLCount(papszToken) == 5)
+    if (nTokens == 5)
     {
-        dXMin = fp->GetXTrans(atof(papszToken[1]));
-        dXMax = fp->GetXTrans(atof(papszToken[3]));
-        dYMin = fp->GetYTrans(atof(papszToken[2]));
-        dYMax = fp->GetYTrans(atof(papszToken[4]));
+        dXMin = fp->GetXTrans(TABAtof(asToken[1].pszStart));
+        dXMax = fp->GetXTrans(TABAtof(asToken[3].pszStart));
+        dYMin = fp->GetYTrans(TABAtof(asToken[2].pszStart));
+        dYMax = fp->GetYTrans(TABAtof(asToken[4].pszStart));
 
-        CSLDestroy(papszToken);
-        papszToken = CSLTokenizeString2(fp->GetLine(), 
-                                        " \t", CSLT_HONOURSTRINGS);
-        if (CSLCount(papszToken) != 2)
+        nTokens = TABTokenizeLine(fp->GetLine(), " \t",
+                                  asToken, TAB_MAX_MIF_TOKENS);
+        if (nTokens != 2)
         {
-            CSLDestroy(papszToken);
             return -1;
         }
 
-        m_dStartAngle = atof(papszToken[0]);
-        m_dEndAngle = atof(papszToken[1]);
+        m_dStartAngle = TABAtof(asToken[0].pszStart);
+        m_dEndAngle = TABAtof(asToken[1].pszStart);
     }
-    else if (CSLCount(papszToken) == 7)
+    else if (nTokens == 7)
     {
-        dXMin = fp->GetXTrans(atof(papszToken[1]));
-        dXMax = fp->GetXTrans(atof(papszToken[3]));
-        dYMin = fp->GetYTrans(atof(papszToken[2]));
-        dYMax = fp->GetYTrans(atof(papszToken[4]));
-        m_dStartAngle = atof(papszToken[5]);
-        m_dEndAngle = atof(papszToken[6]);
+        dXMin = fp->GetXTrans(TABAtof(asToken[1].pszStart));
+        dXMax = fp->GetXTrans(TABAtof(asToken[3].pszStart));
+        dYMin = fp->GetYTrans(TABAtof(asToken[2].pszStart));
+        dYMax = fp->GetYTrans(TABAtof(asToken[4].pszStart));
+        m_dStartAngle = TABAtof(asToken[5].pszStart);
+        m_dEndAngle = TABAtof(asToken[6].pszStart);
     }
     else
     {
-        CSLDestroy(papszToken);
         return -1;
     }
 
-    CSLDestroy(papszToken);
-    papszToken = NULL;
-
     /*-------------------------------------------------------------
      * Start/End angles
      * Since the angles are specified for integer coordinates, and
@@ -1681,25 +1598,23 @@ int TABArc::ReadGeometryFromMIFFile(MIDDATAFile *fp)
     while (((pszLine = fp->GetLine()) != NULL) && 
            fp->IsValidFeature(pszLine) == FALSE)
     {
-        papszToken = CSLTokenizeStringComplex(pszLine,"() ,",
-                                              TRUE,FALSE);
+        nTokens = TABTokenizeLine(pszLine, "() ,",
+                                  asToken, TAB_MAX_MIF_TOKENS);
         
-        if (CSLCount(papszToken) > 1)
+        if (nTokens > 1)
         {
-            if (EQUALN(papszToken[0],"PEN",3))
+            if (EQUALN(asToken[0].pszStart,"PEN",3))
             {
                 
-                if (CSLCount(papszToken) == 4)
+                if (nTokens == 4)
                 {    
-                    SetPenWidthMIF(atoi(papszToken[1]));
-                    SetPenPattern((GByte)atoi(papszToken[2]));
-                    SetPenColor((GInt32)atoi(papszToken[3]));
+                    SetPenWidthMIF(atoi(asToken[1].pszStart));
+                    SetPenPattern((GByte)atoi(asToken[2].pszStart));
+                    SetPenColor((GInt32)atoi(asToken[3].pszStart));
                 }
                 
             }
         }
-        CSLDestroy(papszToken);
-        papszToken = NULL;
    }
    return 0; 
 }
@@ -1740,46 +1655,45 @@ int TABText::ReadGeometryFromMIFFile(MIDDATAFile *fp)
     double               dXMin, dYMin, dXMax, dYMax;
     OGRGeometry         *poGeometry;
     const char          *pszLine;
-    char               **papszToken;
-    const char          *pszString;
+    TABToken             asToken[TAB_MAX_MIF_TOKENS];
+    int                  nTokens;
+    const TABToken      *psString;
+    char                 szFontName[33];
     char                *pszTmpString;
     int                  bXYBoxRead = 0;
     int                  tokenLen;
 
-    papszToken = CSLTokenizeString2(fp->GetLastLine(), 
-                                    " \t", CSLT_HONOURSTRINGS);
-    if (CSLCount(papszToken) == 1)
+    nTokens = TABTokenizeLine(fp->GetLastLine(), " \t",
+                              asToken, TAB_MAX_MIF_TOKENS);
+    if (nTokens == 1)
     {
-        CSLDestroy(papszToken);
-        papszToken = CSLTokenizeString2(fp->GetLine(), 
-                                        " \t", CSLT_HONOURSTRINGS);
-        tokenLen = CSLCount(papszToken);
+        nTokens = TABTokenizeLine(fp->GetLine(), " \t",
+                                  asToken, TAB_MAX_MIF_TOKENS);
+        tokenLen = nTokens;
         if (tokenLen == 4)
         {
-           pszString = NULL;
+           psString = NULL;
            bXYBoxRead = 1;
         }
         else if (tokenLen == 0)
         {
-            pszString = NULL;
+            psString = NULL;
         }
         else if (tokenLen != 1)
         {
-            CSLDestroy(papszToken);
             return -1;
         }
         else
         {
-          pszString = papszToken[0];
+          psString = &asToken[0];
         }
     }
-    else if (CSLCount(papszToken) == 2)
+    else if (nTokens == 2)
     {
-        pszString = papszToken[1];
+        psString = &asToken[1];
     }
     else
     {
-        CSLDestroy(papszToken);
         return -1;
     }
 
@@ -1788,29 +1702,33 @@ int TABText::ReadGeometryFromMIFFile(MIDDATAFile *fp)
      * sstore them in memory in the UnEscaped form to be OGR 
      * compliant. See Maptools bug 1107 for more details.
      *------------------------------------------------------------*/
-    pszTmpString = CPLStrdup(pszString);
+    if (psString != NULL)
+    {
+        pszTmpString = (char*)CPLMalloc(psString->nLen+1);
+        TABTokenCopy(psString, pszTmpString, psString->nLen+1);
+    }
+    else
+        pszTmpString = CPLStrdup("");
     m_pszString = TABUnEscapeString(pszTmpString, TRUE);
     if (pszTmpString != m_pszString)
         CPLFree(pszTmpString);
 
     if (!bXYBoxRead)
     {
-        CSLDestroy(papszToken);
-        papszToken = CSLTokenizeString2(fp->GetLine(), 
-                                        " \t", CSLT_HONOURSTRINGS);
+        nTokens = TABTokenizeLine(fp->GetLine(), " \t",
+                                  asToken, TAB_MAX_MIF_TOKENS);
     }
 
-    if (CSLCount(papszToken) != 4)
+    if (nTokens != 4)
     {
-        CSLDestroy(papszToken);
         return -1;
     }
     else
     {
-        dXMin = fp->GetXTrans(atof(papszToken[0]));
-        dXMax = fp->GetXTrans(atof(papszToken[2]));
-        dYMin = fp->GetYTrans(atof(papszToken[1]));
-        dYMax = fp->GetYTrans(atof(papszToken[3]));
+        dXMin = fp->GetXTrans(TABAtof(asToken[0].pszStart));
+        dXMax = fp->GetXTrans(TABAtof(asToken[2].pszStart));
+        dYMin = fp->GetYTrans(TABAtof(asToken[1].pszStart));
+        dYMax = fp->GetYTrans(TABAtof(asToken[3].pszStart));
 
         m_dHeight = dYMax - dYMin;  //SetTextBoxHeight(dYMax - dYMin);
         m_dWidth  = dXMax - dXMin;  //SetTextBoxWidth(dXMax - dXMin);
@@ -1821,9 +1739,6 @@ int TABText::ReadGeometryFromMIFFile(MIDDATAFile *fp)
           m_dWidth*=-1.0;
     }
 
-    CSLDestroy(papszToken);
-    papszToken = NULL;
-
     /* Set/retrieve the MBR to make sure Mins are smaller than Maxs
      */
 
@@ -1833,71 +1748,72 @@ int TABText::ReadGeometryFromMIFFile(MIDDATAFile *fp)
     while (((pszLine = fp->GetLine()) != NULL) && 
            fp->IsValidFeature(pszLine) == FALSE)
     {
-        papszToken = CSLTokenizeStringComplex(pszLine,"() ,",
-                                              TRUE,FALSE);
+        nTokens = TABTokenizeLine(pszLine, "() ,",
+                                  asToken, TAB_MAX_MIF_TOKENS);
         
-        if (CSLCount(papszToken) > 1)
+        if (nTokens > 1)
         {
-            if (EQUALN(papszToken[0],"FONT",4))
+            if (EQUALN(asToken[0].pszStart,"FONT",4))
             {
-                if (CSLCount(papszToken) >= 5)
+                if (nTokens >= 5)
                 {    
-                    SetFontName(papszToken[1]);
-                    SetFontFGColor(atoi(papszToken[4]));
-                    if (CSLCount(papszToken) ==6)
+                    SetFontName(TABTokenCopy(&asToken[1], szFontName,
+                                             sizeof(szFontName)));
+                    SetFontFGColor(atoi(asToken[4].pszStart));
+                    if (nTokens ==6)
                     {
-                        SetFontBGColor(atoi(papszToken[5]));
-                        SetFontStyleMIFValue(atoi(papszToken[2]),TRUE);
+                        SetFontBGColor(atoi(asToken[5].pszStart));
+                        SetFontStyleMIFValue(atoi(asToken[2].pszStart),TRUE);
                     }
                     else
-                      SetFontStyleMIFValue(atoi(papszToken[2]));
+                      SetFontStyleMIFValue(atoi(asToken[2].pszStart));
 
                     // papsztoken[3] = Size ???
                 }
                 
             }
-            else if (EQUALN(papszToken[0],"SPACING",7))
+            else if (EQUALN(asToken[0].pszStart,"SPACING",7))
             {
-                if (CSLCount(papszToken) >= 2)
+                if (nTokens >= 2)
                 {   
-                    if (EQUALN(papszToken[1],"2",1))
+                    if (EQUALN(asToken[1].pszStart,"2",1))
                     {
                         SetTextSpacing(TABTSDouble);
                     }
-                    else if (EQUALN(papszToken[1],"1.5",3))
+                    else if (EQUALN(asToken[1].pszStart,"1.5",3))
                     {
                         SetTextSpacing(TABTS1_5);
                     }
                 }
                 
-                if (CSLCount(papszToken) == 7)
+                if (nTokens == 7)
                 {
-                    if (EQUALN(papszToken[2],"LAbel",5))
+                    if (EQUALN(asToken[2].pszStart,"LAbel",5))
                     {
-                        if (EQUALN(papszToken[4],"simple",6))
+                        if (EQUALN(asToken[4].pszStart,"simple",6))
                         {
                             SetTextLineType(TABTLSimple);
-                            SetTextLineEndPoint(fp->GetXTrans(atof(papszToken[5])),
-                                                fp->GetYTrans(atof(papszToken[6])));
+                            SetTextLineEndPoint(fp->GetXTrans(TABAtof(asToken[5].pszStart)),
+                                                fp->GetYTrans(TABAtof(asToken[6].pszStart)));
                         }
-                        else if (EQUALN(papszToken[4],"arrow", 5))
+                        else if (EQUALN(asToken[4].pszStart,"arrow", 5))
                         {
                             SetTextLineType(TABTLArrow);
-                            SetTextLineEndPoint(fp->GetXTrans(atof(papszToken[5])),
-                                                fp->GetYTrans(atof(papszToken[6])));
+                            SetTextLineEndPoint(fp->GetXTrans(TABAtof(asToken[5].pszStart)),
+                                                fp->GetYTrans(TABAtof(asToken[6].pszStart)));
                         }
                     }
                 }               
             }
-            else if (EQUALN(papszToken[0],"Justify",7))
+            else if (EQUALN(asToken[0].pszStart,"Justify",7))
             {
-                if (CSLCount(papszToken) == 2)
+                if (nTokens == 2)
                 {
-                    if (EQUALN( papszToken[1],"Center",6))
+                    if (EQUALN( asToken[1].pszStart,"Center",6))
                     {
                         SetTextJustification(TABTJCenter);
                     }
-                    else  if (EQUALN( papszToken[1],"Right",5))
+                    else  if (EQUALN( asToken[1].pszStart,"Right",5))
                     {
                         SetTextJustification(TABTJRight);
                     }
@@ -1905,29 +1821,29 @@ int TABText::ReadGeometryFromMIFFile(MIDDATAFile *fp)
                 }
                 
             }
-            else if (EQUALN(papszToken[0],"Angle",5))
+            else if (EQUALN(asToken[0].pszStart,"Angle",5))
             {
-                if (CSLCount(papszToken) == 2)
+                if (nTokens == 2)
                 {    
-                    SetTextAngle(atof(papszToken[1]));
+                    SetTextAngle(TABAtof(asToken[1].pszStart));
                 }
                 
             }
-            else if (EQUALN(papszToken[0],"LAbel",5))
+            else if (EQUALN(asToken[0].pszStart,"LAbel",5))
             {
-                if (CSLCount(papszToken) == 5)
+                if (nTokens == 5)
                 {    
-                    if (EQUALN(papszToken[2],"simple",6))
+                    if (EQUALN(asToken[2].pszStart,"simple",6))
                     {
                         SetTextLineType(TABTLSimple);
-                        SetTextLineEndPoint(fp->GetXTrans(atof(papszToken[3])),
-                                           fp->GetYTrans(atof(papszToken[4])));
+                        SetTextLineEndPoint(fp->GetXTrans(TABAtof(asToken[3].pszStart)),
+                                           fp->GetYTrans(TABAtof(asToken[4].pszStart)));
                     }
-                    else if (EQUALN(papszToken[2],"arrow", 5))
+                    else if (EQUALN(asToken[2].pszStart,"arrow", 5))
                     {
                         SetTextLineType(TABTLArrow);
-                        SetTextLineEndPoint(fp->GetXTrans(atof(papszToken[3])),
-                                           fp->GetYTrans(atof(papszToken[4])));
+                        SetTextLineEndPoint(fp->GetXTrans(TABAtof(asToken[3].pszStart)),
+                                           fp->GetYTrans(TABAtof(asToken[4].pszStart)));
                     }
                 }
                 
@@ -1935,8 +1851,6 @@ int TABText::ReadGeometryFromMIFFile(MIDDATAFile *fp)
                 // What I do with the XY coordonate
             }
         }
-        CSLDestroy(papszToken);
-        papszToken = NULL;
     }
     /*-----------------------------------------------------------------
      * Create an OGRPoint Geometry... 
@@ -2097,41 +2011,37 @@ int TABMultiPoint::ReadGeometryFromMIFFile(MIDDATAFile *fp)
 {
     OGRPoint            *poPoint;
     OGRMultiPoint       *poMultiPoint;
-    char                **papszToken;
+    TABToken             asToken[TAB_MAX_MIF_TOKENS];
+    int                  nTokens;
     const char          *pszLine;
     int                 nNumPoint, i;
     double              dfX,dfY;
     OGREnvelope         sEnvelope;
 
-    papszToken = CSLTokenizeString2(fp->GetLastLine(), 
-                                    " \t", CSLT_HONOURSTRINGS);
+    nTokens = TABTokenizeLine(fp->GetLastLine(), " \t",
+                              asToken, TAB_MAX_MIF_TOKENS);
      
-    if (CSLCount(papszToken) !=2)
+    if (nTokens !=2)
     {
-        CSLDestroy(papszToken);
         return -1;
     }
     
-    nNumPoint = atoi(papszToken[1]);
+    nNumPoint = atoi(asToken[1].pszStart);
     poMultiPoint = new OGRMultiPoint;
 
-    CSLDestroy(papszToken);
-    papszToken = NULL;
-
     // Get each point and add them to the multipoint feature
     for(i=0; i<nNumPoint; i++)
     {
         pszLine = fp->GetLine();
-        papszToken = CSLTokenizeString2(fp->GetLastLine(), 
-                                        " \t", CSLT_HONOURSTRINGS);
-        if (CSLCount(papszToken) !=2)
+        nTokens = TABTokenizeLine(fp->GetLastLine(), " \t",
+                                  asToken, TAB_MAX_MIF_TOKENS);
+        if (nTokens !=2)
         {
-            CSLDestroy(papszToken);
             return -1;
         }
 
-        dfX = fp->GetXTrans(atof(papszToken[0]));
-        dfY = fp->GetXTrans(atof(papszToken[1]));
+        dfX = fp->GetXTrans(TABAtof(asToken[0].pszStart));
+        dfY = fp->GetXTrans(TABAtof(asToken[1].pszStart));
         poPoint = new OGRPoint(dfX, dfY);
         if ( poMultiPoint->addGeometryDirectly( poPoint ) != OGRERR_NONE)
         {
@@ -2143,7 +2053,6 @@ int TABMultiPoint::ReadGeometryFromMIFFile(MIDDATAFile *fp)
         {
             SetCenter( dfX, dfY );
         }
-        CSLDestroy(papszToken);
     }
 
     if( SetGeometryDirectly( poMultiPoint ) != OGRERR_NONE)
@@ -2160,15 +2069,14 @@ int TABMultiPoint::ReadGeometryFromMIFFile(MIDDATAFile *fp)
     while (((pszLine = fp->GetLine()) != NULL) && 
            fp->IsValidFeature(pszLine) == FALSE)
     {
-        papszToken = CSLTokenizeStringComplex(pszLine," ,()\t",
-                                              TRUE,FALSE);
-        if (CSLCount(papszToken) == 4 && EQUAL(papszToken[0], "SYMBOL") )
+        nTokens = TABTokenizeLine(pszLine, " ,()\t",
+                                  asToken, TAB_MAX_MIF_TOKENS);
+        if (nTokens == 4 && TABTokenEQUAL(&asToken[0], "SYMBOL") )
         {
-            SetSymbolNo((GInt16)atoi(papszToken[1]));
-            SetSymbolColor((GInt32)atoi(papszToken[2]));
-            SetSymbolSize((GInt16)atoi(papszToken[3]));
+            SetSymbolNo((GInt16)atoi(asToken[1].pszStart));
+            SetSymbolColor((GInt32)atoi(asToken[2].pszStart));
+            SetSymbolSize((GInt16)atoi(asToken[3].pszStart));
         }
-        CSLDestroy(papszToken);
     }
 
     return 0; 
@@ -2227,7 +2135,8 @@ int TABMultiPoint::WriteGeometryToMIFFile(MIDDATAFile *fp)
  **********************************************************************/
 int TABCollection::ReadGeometryFromMIFFile(MIDDATAFile *fp)
 {
-    char                **papszToken;
+    TABToken             asToken[TAB_MAX_MIF_TOKENS];
+    int                  nTokens;
     const char          *pszLine;
     int                 numParts, i;
     OGREnvelope         sEnvelope;
@@ -2235,18 +2144,15 @@ int TABCollection::ReadGeometryFromMIFFile(MIDDATAFile *fp)
     /*-----------------------------------------------------------------
      * Fetch number of parts in "COLLECTION %d" line
      *----------------------------------------------------------------*/
-    papszToken = CSLTokenizeString2(fp->GetLastLine(), 
-                                    " \t", CSLT_HONOURSTRINGS);
+    nTokens = TABTokenizeLine(fp->GetLastLine(), " \t",
+                              asToken, TAB_MAX_MIF_TOKENS);
      
-    if (CSLCount(papszToken) !=2)
+    if (nTokens !=2)
     {
-        CSLDestroy(papszToken);
         return -1;
     }
     
-    numParts = atoi(papszToken[1]);
-    CSLDestroy(papszToken);
-    papszToken = NULL;
+    numParts = atoi(asToken[1].pszStart);
 
     // Make sure collection is empty
     EmptyCollection();
@@ -282,6 +282,7 @@ OGRFeature *IMapInfoFile::GetNextFeature()
         {
             // Avoid cloning feature... return the copy owned by the class
             CPLAssert(poFeatureRef == m_poCurFeature);
+            ((TABFeature*)poFeatureRef)->DetachStyleStringRef();
             m_poCurFeature = NULL;  
             return poFeatureRef;
         }
@@ -421,6 +422,7 @@ OGRFeature *IMapInfoFile::GetFeature(long nFeatureId)
     {
         // Avoid cloning feature... return the copy owned by the class
         CPLAssert(poFeatureRef == m_poCurFeature);
+        ((TABFeature*)poFeatureRef)->DetachStyleStringRef();
         m_poCurFeature = NULL;  
 
         return poFeatureRef;
@@ -517,3 +519,39 @@ int IMapInfoFile::SetCharset(const char* pszCharset)
     return -1;
 }
 
+
+/**********************************************************************
+ *                   IMapInfoFile::SetSelectedFields()
+ *
+ * Restrict the attributes read to the named fields (NULL for all fields).
+ * Only implemented by the classes that can skip the other fields, i.e.
+ * MIFFile for now.
+ *
+ * Returns 0 on success, -1 on error.
+ **********************************************************************/
+int IMapInfoFile::SetSelectedFields(char ** /* papszFieldNames */)
+{
+    CPLError(CE_Failure, CPLE_NotSupported,
+             "SetSelectedFields() not supported for this type of dataset.");
+    return -1;
+}
+
+
+/**********************************************************************
+ *                   IMapInfoFile::GetReadRecodeTable()
+ *
+ * Return the table to use to recode the text attributes read from this
+ * dataset to UTF-8 (see CPLRecodeSingleByteToUTF8()), or NULL if values 
+ * should be returned as is.
+ *
+ * Text values are returned in the dataset's charset unless the
+ * MITAB_RECODE_TO_UTF8 config option is set to YES and the charset is
+ * a supported single byte codepage.
+ **********************************************************************/
+const unsigned short *IMapInfoFile::GetReadRecodeTable()
+{
+    if (!CSLTestBoolean(CPLGetConfigOption("MITAB_RECODE_TO_UTF8", "NO")))
+        return NULL;
+
+    return CPLGetSingleByteToUCSTable(TABCharsetToEncoding(m_pszCharset));
+}
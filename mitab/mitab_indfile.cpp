@@ -101,6 +101,9 @@ TABINDFile::TABINDFile()
     m_numIndexes = 0;
     m_papoIndexRootNodes = NULL;
     m_papbyKeyBuffers = NULL;
+    m_papbyRangeMaxKeys = NULL;
+    m_panRangeMaxKeyLength = NULL;
+    m_papsBulkBuilds = NULL;
 }
 
 /**********************************************************************
@@ -251,6 +254,13 @@ int TABINDFile::Close()
      *----------------------------------------------------------------*/
     if (m_eAccessMode == TABWrite || m_eAccessMode == TABReadWrite)
     {
+        // Build the indexes created in this session
+        for(int iIndex=0; m_papsBulkBuilds && iIndex<m_numIndexes; iIndex++)
+        {
+            if (m_papsBulkBuilds[iIndex])
+                BuildBulkIndex(iIndex+1);
+        }
+
         WriteHeader();
 
         for(int iIndex=0; iIndex<m_numIndexes; iIndex++)
@@ -272,11 +282,20 @@ int TABINDFile::Close()
             delete m_papoIndexRootNodes[iIndex];
         if (m_papbyKeyBuffers && m_papbyKeyBuffers[iIndex])
             CPLFree(m_papbyKeyBuffers[iIndex]);
+        if (m_papbyRangeMaxKeys && m_papbyRangeMaxKeys[iIndex])
+            CPLFree(m_papbyRangeMaxKeys[iIndex]);
+        FreeBulkBuild(iIndex+1);
     }
     CPLFree(m_papoIndexRootNodes);
     m_papoIndexRootNodes = NULL;
     CPLFree(m_papbyKeyBuffers);
     m_papbyKeyBuffers = NULL;
+    CPLFree(m_papbyRangeMaxKeys);
+    m_papbyRangeMaxKeys = NULL;
+    CPLFree(m_panRangeMaxKeyLength);
+    m_panRangeMaxKeyLength = NULL;
+    CPLFree(m_papsBulkBuilds);
+    m_papsBulkBuilds = NULL;
     m_numIndexes = 0;
 
     /*-----------------------------------------------------------------
@@ -563,6 +582,22 @@ int TABINDFile::SetIndexUnique(int nIndexNumber, GBool bUnique/*=TRUE*/)
     return 0;
 }
 
+/**********************************************************************
+ *                   TABINDFile::GetKeyLength()
+ *
+ * Return the key length (in bytes) of the specified index, or -1 if the
+ * index number is invalid.
+ *
+ * Note that index numbers are positive values starting at 1.
+ **********************************************************************/
+int TABINDFile::GetKeyLength(int nIndexNumber)
+{
+    if (ValidateIndexNo(nIndexNumber) != 0)
+        return -1;
+
+    return m_papoIndexRootNodes[nIndexNumber-1]->GetKeyLength();
+}
+
 /**********************************************************************
  *                   TABINDFile::BuildKey()
  *
@@ -695,6 +730,11 @@ GInt32 TABINDFile::FindFirst(int nIndexNumber, GByte *pKeyValue)
     if (ValidateIndexNo(nIndexNumber) != 0)
         return -1;
 
+    // Entries that are still pending have to be in the tree to be found
+    if (m_papsBulkBuilds && m_papsBulkBuilds[nIndexNumber-1] &&
+        BuildBulkIndex(nIndexNumber) != 0)
+        return -1;
+
     return m_papoIndexRootNodes[nIndexNumber-1]->FindFirst(pKeyValue);
 }
 
@@ -721,6 +761,105 @@ GInt32 TABINDFile::FindNext(int nIndexNumber, GByte *pKeyValue)
 }
 
 
+/**********************************************************************
+ *                   TABINDFile::FindFirstInRange()
+ *
+ * Start a range search in one of the indexes: returns the records whose
+ * key is >= pMinKey and <= pMaxKey, in key order.  pMinKey/pMaxKey can
+ * be NULL for no lower/upper bound.  Keys are built with BuildKey()
+ * and pMaxKey is copied internally, so BuildKey() can be called again
+ * before FindNextInRange().
+ *
+ * If nMaxKeyLength > 0 then only the first nMaxKeyLength bytes of the
+ * keys are compared to pMaxKey... e.g. for a prefix search on a char
+ * index, pass the prefix as both pMinKey and pMaxKey with nMaxKeyLength
+ * set to the length of the prefix.
+ *
+ * Note that index numbers are positive values starting at 1, and that
+ * range searches are supported in read access only.
+ *
+ * Return value:
+ *  - the key's corresponding record number in the .DAT file (greater than 0)
+ *  - 0 if no key is in the range
+ *  - or -1 if an error happened
+ **********************************************************************/
+GInt32 TABINDFile::FindFirstInRange(int nIndexNumber, GByte *pMinKey,
+                                    GByte *pMaxKey, int nMaxKeyLength /*=0*/)
+{
+    if (ValidateIndexNo(nIndexNumber) != 0)
+        return -1;
+
+    if (m_eAccessMode != TABRead)
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "FindFirstInRange() can be used only with Read access.");
+        return -1;
+    }
+
+    int nKeyLength = m_papoIndexRootNodes[nIndexNumber-1]->GetKeyLength();
+    if (nMaxKeyLength <= 0 || nMaxKeyLength > nKeyLength)
+        nMaxKeyLength = nKeyLength;
+
+    /*-----------------------------------------------------------------
+     * Keep a copy of the upper bound for the FindNextInRange() calls
+     *----------------------------------------------------------------*/
+    if (m_papbyRangeMaxKeys == NULL)
+    {
+        m_papbyRangeMaxKeys = (GByte **)CPLCalloc(m_numIndexes, 
+                                                  sizeof(GByte*));
+        m_panRangeMaxKeyLength = (int *)CPLCalloc(m_numIndexes, sizeof(int));
+    }
+    if (m_papbyRangeMaxKeys[nIndexNumber-1] == NULL)
+        m_papbyRangeMaxKeys[nIndexNumber-1] = (GByte *)CPLCalloc(nKeyLength+1,
+                                                              sizeof(GByte));
+
+    GByte *pabyMaxKey = NULL;
+    m_panRangeMaxKeyLength[nIndexNumber-1] = 0;
+    if (pMaxKey)
+    {
+        pabyMaxKey = m_papbyRangeMaxKeys[nIndexNumber-1];
+        memcpy(pabyMaxKey, pMaxKey, nMaxKeyLength);
+        m_panRangeMaxKeyLength[nIndexNumber-1] = nMaxKeyLength;
+    }
+
+    return m_papoIndexRootNodes[nIndexNumber-1]->FindFirstInRange(pMinKey,
+                                                                  pabyMaxKey,
+                                                                nMaxKeyLength);
+}
+
+/**********************************************************************
+ *                   TABINDFile::FindNextInRange()
+ *
+ * Continue the range search previously started by FindFirstInRange().
+ * NOTE: FindFirstInRange() MUST have been previously called for this 
+ *       call to work...
+ *
+ * Return value:
+ *  - the key's corresponding record number in the .DAT file (greater than 0)
+ *  - 0 if there are no more keys in the range
+ *  - or -1 if an error happened
+ **********************************************************************/
+GInt32 TABINDFile::FindNextInRange(int nIndexNumber)
+{
+    if (ValidateIndexNo(nIndexNumber) != 0)
+        return -1;
+
+    if (m_papbyRangeMaxKeys == NULL)
+    {
+        CPLError(CE_Failure, CPLE_AssertionFailed,
+                 "FindNextInRange(): FindFirstInRange() was not called.");
+        return -1;
+    }
+
+    int nMaxKeyLength = m_panRangeMaxKeyLength[nIndexNumber-1];
+
+    return m_papoIndexRootNodes[nIndexNumber-1]->FindNextInRange(
+                         nMaxKeyLength > 0 ? 
+                                  m_papbyRangeMaxKeys[nIndexNumber-1] : NULL,
+                         nMaxKeyLength);
+}
+
+
 /**********************************************************************
  *                   TABINDFile::CreateIndex()
  *
@@ -822,6 +961,16 @@ int TABINDFile::CreateIndex(TABFieldType eType, int nFieldSize)
     m_papbyKeyBuffers[nNewIndexNo] = (GByte *)CPLCalloc(nKeyLength+1,
                                                         sizeof(GByte));
 
+    // The new index is empty: collect its entries and build the whole
+    // tree at once in Close() instead of inserting them one by one.
+    if (m_papsBulkBuilds == NULL)
+        m_papsBulkBuilds = (TABINDBulkBuild **)CPLCalloc(29, 
+                                                 sizeof(TABINDBulkBuild*));
+    FreeBulkBuild(nNewIndexNo+1);
+    m_papsBulkBuilds[nNewIndexNo] = 
+                  (TABINDBulkBuild *)CPLCalloc(1, sizeof(TABINDBulkBuild));
+    m_papsBulkBuilds[nNewIndexNo]->nEntrySize = nKeyLength+4;
+
     // Return 1-based index number
     return nNewIndexNo+1;
 }
@@ -835,6 +984,9 @@ int TABINDFile::CreateIndex(TABFieldType eType, int nFieldSize)
  * Note that index numbers are positive values starting at 1.
  * nRecordNo is the .DAT record number, record numbers start at 1.
  *
+ * Entries of indexes created by CreateIndex() are only collected here,
+ * the index tree is built by BuildBulkIndex() when the file is closed.
+ *
  * Returns 0 on success, -1 on error
  **********************************************************************/
 int TABINDFile::AddEntry(int nIndexNumber, GByte *pKeyValue, GInt32 nRecordNo)
@@ -843,10 +995,575 @@ int TABINDFile::AddEntry(int nIndexNumber, GByte *pKeyValue, GInt32 nRecordNo)
         ValidateIndexNo(nIndexNumber) != 0)
         return -1;
 
+    if (m_papsBulkBuilds && m_papsBulkBuilds[nIndexNumber-1])
+        return BulkAddEntry(nIndexNumber, pKeyValue, nRecordNo);
+
     return m_papoIndexRootNodes[nIndexNumber-1]->AddEntry(pKeyValue,nRecordNo);
 }
 
 
+/**********************************************************************
+ *                   TABINDBulkSort()
+ *
+ * Sort numEntries fixed size (key, record no) entries in ascending
+ * order.  The record no is stored MSB first after the key, so comparing
+ * whole entries with memcmp() orders duplicate keys by record no.
+ *
+ * This is a bottom-up merge sort, pabyTmp must be as large as
+ * pabyEntries.
+ **********************************************************************/
+static void TABINDBulkSort(GByte *pabyEntries, GByte *pabyTmp,
+                           int numEntries, int nEntrySize)
+{
+    GByte *pabySrc = pabyEntries, *pabyDst = pabyTmp, *pabySwap;
+    int    nWidth;
+
+    for(nWidth = 1; nWidth < numEntries; nWidth *= 2)
+    {
+        for(int iStart = 0; iStart < numEntries; iStart += 2*nWidth)
+        {
+            int i = iStart, iEnd1 = MIN(iStart+nWidth, numEntries);
+            int j = iEnd1,  iEnd2 = MIN(iStart+2*nWidth, numEntries);
+            GByte *pabyOut = pabyDst + iStart*nEntrySize;
+
+            while(i < iEnd1 && j < iEnd2)
+            {
+                if (memcmp(pabySrc + j*nEntrySize, pabySrc + i*nEntrySize,
+                           nEntrySize) < 0)
+                    memcpy(pabyOut, pabySrc + (j++)*nEntrySize, nEntrySize);
+                else
+                    memcpy(pabyOut, pabySrc + (i++)*nEntrySize, nEntrySize);
+                pabyOut += nEntrySize;
+            }
+            if (i < iEnd1)
+                memcpy(pabyOut, pabySrc + i*nEntrySize, (iEnd1-i)*nEntrySize);
+            else if (j < iEnd2)
+                memcpy(pabyOut, pabySrc + j*nEntrySize, (iEnd2-j)*nEntrySize);
+        }
+
+        pabySwap = pabySrc;
+        pabySrc = pabyDst;
+        pabyDst = pabySwap;
+    }
+
+    if (pabySrc != pabyEntries)
+        memcpy(pabyEntries, pabySrc, numEntries*nEntrySize);
+}
+
+/**********************************************************************
+ *                   TABINDFile::BulkAddEntry()
+ *
+ * (private method)
+ * Append a (key, record no) pair to the pending entries of an index that
+ * will be built by BuildBulkIndex().  When the buffer is full, its sorted
+ * contents are spilled as a new run in the temporary file.
+ *
+ * Returns 0 on success, -1 on error
+ **********************************************************************/
+int TABINDFile::BulkAddEntry(int nIndexNumber, GByte *pKeyValue, 
+                             GInt32 nRecordNo)
+{
+    TABINDBulkBuild *psBuild = m_papsBulkBuilds[nIndexNumber-1];
+
+    if (psBuild->numEntries == psBuild->nMaxEntries)
+    {
+        // Half of the budget is kept for the scratch buffer of the sort
+        int nLimit = MAX(2, TAB_IND_BULK_BUFFER_SIZE/2/psBuild->nEntrySize);
+
+        if (psBuild->nMaxEntries < nLimit)
+        {
+            psBuild->nMaxEntries = MIN(nLimit, 
+                                       MAX(1024, psBuild->nMaxEntries*2));
+            psBuild->pabyEntries = (GByte*)CPLRealloc(psBuild->pabyEntries, 
+                                                     psBuild->nMaxEntries*
+                                                     psBuild->nEntrySize);
+        }
+        else if (BulkSpillRun(psBuild) != 0)
+            return -1;
+    }
+
+    GByte *pabyEntry = psBuild->pabyEntries + 
+                                psBuild->numEntries*psBuild->nEntrySize;
+    int nKeyLength = psBuild->nEntrySize - 4;
+
+    memcpy(pabyEntry, pKeyValue, nKeyLength);
+    pabyEntry[nKeyLength]   = (GByte)((nRecordNo >> 24) & 0xff);
+    pabyEntry[nKeyLength+1] = (GByte)((nRecordNo >> 16) & 0xff);
+    pabyEntry[nKeyLength+2] = (GByte)((nRecordNo >> 8) & 0xff);
+    pabyEntry[nKeyLength+3] = (GByte)(nRecordNo & 0xff);
+
+    psBuild->numEntries++;
+
+    return 0;
+}
+
+/**********************************************************************
+ *                   TABINDFile::BulkSpillRun()
+ *
+ * (private method)
+ * Sort the pending entries and append them as a new run at the end of
+ * the temporary file, which is created the first time.
+ *
+ * Returns 0 on success, -1 on error
+ **********************************************************************/
+int TABINDFile::BulkSpillRun(TABINDBulkBuild *psBuild)
+{
+    GByte *pabyTmp;
+
+    if (psBuild->fpTmp == NULL)
+    {
+        psBuild->pszTmpFname = CPLStrdup(CPLGenerateTempFilename("tabind"));
+        psBuild->fpTmp = VSIFOpen(psBuild->pszTmpFname, "wb+");
+        if (psBuild->fpTmp == NULL)
+        {
+            CPLError(CE_Failure, CPLE_FileIO,
+                     "Failed creating temporary file %s", 
+                     psBuild->pszTmpFname);
+            return -1;
+        }
+    }
+
+    pabyTmp = (GByte*)CPLMalloc(psBuild->numEntries*psBuild->nEntrySize);
+    TABINDBulkSort(psBuild->pabyEntries, pabyTmp, 
+                   psBuild->numEntries, psBuild->nEntrySize);
+    CPLFree(pabyTmp);
+
+    if (VSIFSeek(psBuild->fpTmp, 0, SEEK_END) != 0 ||
+        VSIFWrite(psBuild->pabyEntries, psBuild->nEntrySize, 
+                  psBuild->numEntries, psBuild->fpTmp) != 
+                                             (size_t)psBuild->numEntries)
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Failed writing %d index entries to %s",
+                 psBuild->numEntries, psBuild->pszTmpFname);
+        return -1;
+    }
+
+    psBuild->panRunEntries = (int*)CPLRealloc(psBuild->panRunEntries,
+                                              (psBuild->numRuns+1)*sizeof(int));
+    psBuild->panRunEntries[psBuild->numRuns++] = psBuild->numEntries;
+    psBuild->numEntries = 0;
+
+    return 0;
+}
+
+/**********************************************************************
+ * The following structures and functions write a tree from its sorted
+ * leaf entries, one level at a time from the bottom up.  Each level has
+ * one node being filled; when it is full it is written and its first key
+ * is added to the node being filled in the level above it.
+ *
+ * The number of nodes in each level is known in advance, so the block of
+ * the next node in a level can be allocated when a node is written and
+ * the prev/next node chain is written in the same pass.
+ **********************************************************************/
+typedef struct TABINDBulkLevel_t
+{
+    GByte       abyNode[512];
+    int         numEntries;
+    int         numNodesLeft;
+    GInt32      nBlockPtr;
+    GInt32      nPrevNodePtr;
+} TABINDBulkLevel;
+
+typedef struct TABINDBulkWriter_t
+{
+    FILE               *fp;
+    TABBinBlockManager *poBlockManager;
+    int                 nKeyLength;
+    int                 nMaxEntries;
+    int                 numLevels;
+    TABINDBulkLevel    *pasLevels;
+} TABINDBulkWriter;
+
+static int TABINDBulkAddToLevel(TABINDBulkWriter *psWriter, int iLevel,
+                                const GByte *pKeyValue, GInt32 nValue);
+
+/**********************************************************************
+ *                   TABINDBulkFlushLevel()
+ *
+ * Write the node being filled at iLevel and start the next one.
+ **********************************************************************/
+static int TABINDBulkFlushLevel(TABINDBulkWriter *psWriter, int iLevel)
+{
+    TABINDBulkLevel *psLevel = psWriter->pasLevels + iLevel;
+    GInt32 nNextNodePtr = 0, nValue;
+
+    if (--psLevel->numNodesLeft > 0)
+        nNextNodePtr = psWriter->poBlockManager->AllocNewBlock();
+
+    nValue = CPL_LSBWORD32(psLevel->numEntries);
+    memcpy(psLevel->abyNode, &nValue, 4);
+    nValue = CPL_LSBWORD32(psLevel->nPrevNodePtr);
+    memcpy(psLevel->abyNode+4, &nValue, 4);
+    nValue = CPL_LSBWORD32(nNextNodePtr);
+    memcpy(psLevel->abyNode+8, &nValue, 4);
+
+    if (VSIFSeek(psWriter->fp, psLevel->nBlockPtr, SEEK_SET) != 0 ||
+        VSIFWrite(psLevel->abyNode, 1, 512, psWriter->fp) != 512)
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Failed writing index node at offset %d.", 
+                 psLevel->nBlockPtr);
+        return -1;
+    }
+
+    if (iLevel+1 < psWriter->numLevels &&
+        TABINDBulkAddToLevel(psWriter, iLevel+1, psLevel->abyNode+12,
+                             psLevel->nBlockPtr) != 0)
+        return -1;
+
+    psLevel->nPrevNodePtr = psLevel->nBlockPtr;
+    psLevel->nBlockPtr = nNextNodePtr;
+    psLevel->numEntries = 0;
+    memset(psLevel->abyNode, 0, 512);
+
+    return 0;
+}
+
+/**********************************************************************
+ *                   TABINDBulkAddToLevel()
+ *
+ * Add a (key, value) entry to the node being filled at iLevel.  The value
+ * is a record no at the leaf level and a child node ptr above it.
+ **********************************************************************/
+static int TABINDBulkAddToLevel(TABINDBulkWriter *psWriter, int iLevel,
+                                const GByte *pKeyValue, GInt32 nValue)
+{
+    TABINDBulkLevel *psLevel = psWriter->pasLevels + iLevel;
+
+    if (psLevel->numEntries == psWriter->nMaxEntries &&
+        TABINDBulkFlushLevel(psWriter, iLevel) != 0)
+        return -1;
+
+    GByte *pabyEntry = psLevel->abyNode + 12 + 
+                          psLevel->numEntries*(psWriter->nKeyLength+4);
+
+    memcpy(pabyEntry, pKeyValue, psWriter->nKeyLength);
+    nValue = CPL_LSBWORD32(nValue);
+    memcpy(pabyEntry+psWriter->nKeyLength, &nValue, 4);
+
+    psLevel->numEntries++;
+
+    return 0;
+}
+
+/**********************************************************************
+ *                   TABINDBulkWriteEntry()
+ *
+ * Add a sorted entry (in the TABINDBulkBuild format) to the leaf level.
+ **********************************************************************/
+static int TABINDBulkWriteEntry(TABINDBulkWriter *psWriter, 
+                                const GByte *pabyEntry)
+{
+    const GByte *pabyRecNo = pabyEntry + psWriter->nKeyLength;
+
+    return TABINDBulkAddToLevel(psWriter, 0, pabyEntry,
+                                (GInt32)(((GUInt32)pabyRecNo[0] << 24) |
+                                         ((GUInt32)pabyRecNo[1] << 16) |
+                                         ((GUInt32)pabyRecNo[2] << 8) |
+                                         (GUInt32)pabyRecNo[3]));
+}
+
+/**********************************************************************
+ * A sorted run of entries in the temporary file, read through a buffer
+ * while the runs are merged.
+ **********************************************************************/
+typedef struct TABINDBulkRun_t
+{
+    GByte       *pabyBuf;
+    GByte       *pabyCurEntry;
+    int         numBufEntries;
+    int         numLeft;        // Entries not read yet from the file
+    long        nOffset;        // Offset of the next entry to read
+} TABINDBulkRun;
+
+/**********************************************************************
+ *                   TABINDBulkReadRun()
+ *
+ * Read the next entries of a run in its buffer.
+ **********************************************************************/
+static int TABINDBulkReadRun(TABINDBulkBuild *psBuild, TABINDBulkRun *psRun,
+                             int nMaxBufEntries)
+{
+    int nCount = MIN(nMaxBufEntries, psRun->numLeft);
+
+    if (VSIFSeek(psBuild->fpTmp, psRun->nOffset, SEEK_SET) != 0 ||
+        (int)VSIFRead(psRun->pabyBuf, psBuild->nEntrySize, nCount,
+                      psBuild->fpTmp) != nCount)
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Failed reading index entries from %s",
+                 psBuild->pszTmpFname);
+        return -1;
+    }
+
+    psRun->pabyCurEntry = psRun->pabyBuf;
+    psRun->numBufEntries = nCount;
+    psRun->numLeft -= nCount;
+    psRun->nOffset += (long)nCount*psBuild->nEntrySize;
+
+    return 0;
+}
+
+/**********************************************************************
+ *                   TABINDBulkSiftDown()
+ *
+ * Move down the run at position i of the heap of runs being merged,
+ * ordered by their current entry.
+ **********************************************************************/
+static void TABINDBulkSiftDown(TABINDBulkRun **papsHeap, int nHeapSize, 
+                               int i, int nEntrySize)
+{
+    while(TRUE)
+    {
+        int iMin = i, iChild = 2*i+1;
+
+        if (iChild < nHeapSize &&
+            memcmp(papsHeap[iChild]->pabyCurEntry, 
+                   papsHeap[iMin]->pabyCurEntry, nEntrySize) < 0)
+            iMin = iChild;
+        iChild++;
+        if (iChild < nHeapSize &&
+            memcmp(papsHeap[iChild]->pabyCurEntry, 
+                   papsHeap[iMin]->pabyCurEntry, nEntrySize) < 0)
+            iMin = iChild;
+
+        if (iMin == i)
+            break;
+
+        TABINDBulkRun *psTmp = papsHeap[i];
+        papsHeap[i] = papsHeap[iMin];
+        papsHeap[iMin] = psTmp;
+        i = iMin;
+    }
+}
+
+/**********************************************************************
+ *                   TABINDFile::BuildBulkIndex()
+ *
+ * (private method)
+ * Write the tree of an index from its pending entries, with fully packed
+ * leaf and index nodes.  The top level of the tree is written in the
+ * root node block that was allocated by CreateIndex().
+ *
+ * Once the tree is written, the index is a regular index again and 
+ * further entries are inserted one at a time by AddEntry().
+ *
+ * Returns 0 on success, -1 on error
+ **********************************************************************/
+int TABINDFile::BuildBulkIndex(int nIndexNumber)
+{
+    TABINDBulkBuild *psBuild = m_papsBulkBuilds[nIndexNumber-1];
+    TABINDNode      *poRootNode = m_papoIndexRootNodes[nIndexNumber-1];
+    TABINDBulkWriter sWriter;
+    int     nEntrySize = psBuild->nEntrySize;
+    int     iLevel, iRun, numEntries, numNodes, nStatus = 0;
+
+    /*-----------------------------------------------------------------
+     * Sort the entries: in memory if they all fit, otherwise the
+     * last entries become one more run in the temporary file.
+     *----------------------------------------------------------------*/
+    if (psBuild->numRuns > 0 && psBuild->numEntries > 0 &&
+        BulkSpillRun(psBuild) != 0)
+    {
+        FreeBulkBuild(nIndexNumber);
+        return -1;
+    }
+
+    numEntries = psBuild->numEntries;
+    for(iRun=0; iRun < psBuild->numRuns; iRun++)
+        numEntries += psBuild->panRunEntries[iRun];
+
+    if (numEntries == 0)
+    {
+        // Nothing to do, the empty root node will be written as is.
+        FreeBulkBuild(nIndexNumber);
+        return 0;
+    }
+
+    if (psBuild->numRuns == 0)
+    {
+        GByte *pabyTmp = (GByte*)CPLMalloc(numEntries*nEntrySize);
+        TABINDBulkSort(psBuild->pabyEntries, pabyTmp, numEntries, nEntrySize);
+        CPLFree(pabyTmp);
+    }
+
+    /*-----------------------------------------------------------------
+     * Compute the number of nodes in each level.  The top level is a 
+     * single node: the root.
+     *----------------------------------------------------------------*/
+    sWriter.fp = m_fp;
+    sWriter.poBlockManager = &m_oBlockManager;
+    sWriter.nKeyLength = nEntrySize - 4;
+    sWriter.nMaxEntries = poRootNode->GetMaxNumEntries();
+    sWriter.numLevels = 0;
+    sWriter.pasLevels = NULL;
+
+    numNodes = numEntries;
+    do
+    {
+        numNodes = (numNodes + sWriter.nMaxEntries - 1)/sWriter.nMaxEntries;
+        sWriter.pasLevels = (TABINDBulkLevel*)CPLRealloc(sWriter.pasLevels,
+                                                    (sWriter.numLevels+1)*
+                                                    sizeof(TABINDBulkLevel));
+        memset(sWriter.pasLevels + sWriter.numLevels, 0, 
+               sizeof(TABINDBulkLevel));
+        sWriter.pasLevels[sWriter.numLevels++].numNodesLeft = numNodes;
+    } while(numNodes > 1);
+
+    for(iLevel=0; iLevel < sWriter.numLevels; iLevel++)
+    {
+        if (iLevel == sWriter.numLevels-1)
+            sWriter.pasLevels[iLevel].nBlockPtr = 
+                                          poRootNode->GetNodeBlockPtr();
+        else
+            sWriter.pasLevels[iLevel].nBlockPtr = 
+                                          m_oBlockManager.AllocNewBlock();
+    }
+
+    /*-----------------------------------------------------------------
+     * Feed the leaf level with the sorted entries
+     *----------------------------------------------------------------*/
+    if (psBuild->numRuns == 0)
+    {
+        for(int i=0; nStatus == 0 && i < numEntries; i++)
+            nStatus = TABINDBulkWriteEntry(&sWriter, 
+                                           psBuild->pabyEntries+i*nEntrySize);
+    }
+    else
+    {
+        /*-------------------------------------------------------------
+         * Merge the runs from the temporary file.  Each run gets an
+         * equal part of the memory budget as a read buffer.
+         *------------------------------------------------------------*/
+        int     numRuns = psBuild->numRuns, nHeapSize = 0;
+        int     nMaxBufEntries = MAX(1, TAB_IND_BULK_BUFFER_SIZE/
+                                                  (numRuns*nEntrySize));
+        long    nOffset = 0;
+        GByte   *pabyBuf;
+        TABINDBulkRun *pasRuns, **papsHeap;
+
+        CPLFree(psBuild->pabyEntries);
+        psBuild->pabyEntries = NULL;
+        psBuild->nMaxEntries = psBuild->numEntries = 0;
+
+        pabyBuf = (GByte*)CPLMalloc(numRuns*nMaxBufEntries*nEntrySize);
+        pasRuns = (TABINDBulkRun*)CPLCalloc(numRuns, sizeof(TABINDBulkRun));
+        papsHeap = (TABINDBulkRun**)CPLCalloc(numRuns, 
+                                              sizeof(TABINDBulkRun*));
+
+        for(iRun=0; nStatus == 0 && iRun < numRuns; iRun++)
+        {
+            pasRuns[iRun].pabyBuf = pabyBuf + iRun*nMaxBufEntries*nEntrySize;
+            pasRuns[iRun].numLeft = psBuild->panRunEntries[iRun];
+            pasRuns[iRun].nOffset = nOffset;
+            nOffset += (long)psBuild->panRunEntries[iRun]*nEntrySize;
+
+            nStatus = TABINDBulkReadRun(psBuild, pasRuns+iRun, 
+                                        nMaxBufEntries);
+            papsHeap[nHeapSize++] = pasRuns+iRun;
+        }
+
+        for(int i=nHeapSize/2-1; i >= 0; i--)
+            TABINDBulkSiftDown(papsHeap, nHeapSize, i, nEntrySize);
+
+        while(nStatus == 0 && nHeapSize > 0)
+        {
+            TABINDBulkRun *psRun = papsHeap[0];
+
+            nStatus = TABINDBulkWriteEntry(&sWriter, psRun->pabyCurEntry);
+
+            psRun->pabyCurEntry += nEntrySize;
+            if (--psRun->numBufEntries == 0)
+            {
+                if (psRun->numLeft > 0)
+                {
+                    if (nStatus == 0)
+                        nStatus = TABINDBulkReadRun(psBuild, psRun, 
+                                                    nMaxBufEntries);
+                }
+                else
+                    papsHeap[0] = papsHeap[--nHeapSize];
+            }
+
+            TABINDBulkSiftDown(papsHeap, nHeapSize, 0, nEntrySize);
+        }
+
+        CPLFree(pabyBuf);
+        CPLFree(pasRuns);
+        CPLFree(papsHeap);
+    }
+
+    /*-----------------------------------------------------------------
+     * Write the last node of each level, from the bottom up.
+     *----------------------------------------------------------------*/
+    for(iLevel=0; nStatus == 0 && iLevel < sWriter.numLevels; iLevel++)
+    {
+        if (sWriter.pasLevels[iLevel].numEntries > 0)
+            nStatus = TABINDBulkFlushLevel(&sWriter, iLevel);
+        CPLAssert(sWriter.pasLevels[iLevel].numNodesLeft == 0);
+    }
+
+    CPLFree(sWriter.pasLevels);
+    FreeBulkBuild(nIndexNumber);
+
+    if (nStatus != 0)
+        return -1;
+
+    /*-----------------------------------------------------------------
+     * Reload the root node from the file with its new tree depth.
+     *----------------------------------------------------------------*/
+    GInt32       nRootNodePtr = poRootNode->GetNodeBlockPtr();
+    int          nKeyLength = poRootNode->GetKeyLength();
+    TABFieldType eFieldType = poRootNode->GetFieldType();
+    GBool        bUnique = poRootNode->IsUnique();
+
+    delete poRootNode;
+    poRootNode = new TABINDNode(m_eAccessMode);
+    m_papoIndexRootNodes[nIndexNumber-1] = poRootNode;
+
+    if (poRootNode->InitNode(m_fp, nRootNodePtr, nKeyLength, 
+                             sWriter.numLevels, bUnique, 
+                             &m_oBlockManager) != 0 ||
+        poRootNode->SetFieldType(eFieldType) != 0)
+    {
+        // CPLError has already been called
+        return -1;
+    }
+
+    return 0;
+}
+
+/**********************************************************************
+ *                   TABINDFile::FreeBulkBuild()
+ *
+ * (private method)
+ * Release the pending entries of an index and delete its temporary file.
+ **********************************************************************/
+void TABINDFile::FreeBulkBuild(int nIndexNumber)
+{
+    TABINDBulkBuild *psBuild;
+
+    if (m_papsBulkBuilds == NULL || 
+        (psBuild = m_papsBulkBuilds[nIndexNumber-1]) == NULL)
+        return;
+
+    if (psBuild->fpTmp)
+        VSIFClose(psBuild->fpTmp);
+    if (psBuild->pszTmpFname)
+    {
+        VSIUnlink(psBuild->pszTmpFname);
+        CPLFree(psBuild->pszTmpFname);
+    }
+    CPLFree(psBuild->pabyEntries);
+    CPLFree(psBuild->panRunEntries);
+    CPLFree(psBuild);
+
+    m_papsBulkBuilds[nIndexNumber-1] = NULL;
+}
+
+
 /**********************************************************************
  *                   TABINDFile::Dump()
  *
@@ -914,6 +1631,10 @@ TABINDNode::TABINDNode(TABAccess eAccessMode /*=TABRead*/)
     m_poParentNodeRef = NULL;
     m_bUnique = FALSE;
 
+    m_papsPinnedNodes = NULL;
+    m_numPinnedNodes = 0;
+    m_pabyPinnedEntries = NULL;
+
     m_eAccessMode = eAccessMode;
 }
 
@@ -929,6 +1650,10 @@ TABINDNode::~TABINDNode()
 
     if (m_poDataBlock)
         delete m_poDataBlock;
+
+    for(int i=0; i<m_numPinnedNodes; i++)
+        CPLFree(m_papsPinnedNodes[i]);
+    CPLFree(m_papsPinnedNodes);
 }
 
 /**********************************************************************
@@ -962,6 +1687,8 @@ int TABINDNode::InitNode(FILE *fp, int nBlockPtr,
     if (m_fp == fp && nBlockPtr> 0 && m_nCurDataBlockPtr == nBlockPtr)
         return 0;
 
+    TABINDPinnedNode *psPinnedNode = NULL;
+
     // Keep track of some info
     m_fp = fp;
     m_nKeyLength = nKeyLength;
@@ -981,6 +1708,7 @@ int TABINDNode::InitNode(FILE *fp, int nBlockPtr,
     m_nNextNodePtr = nNextNodePtr;
 
     m_nCurIndexEntry = 0;
+    m_pabyPinnedEntries = NULL;
 
     /*-----------------------------------------------------------------
      * Init RawBinBlock
@@ -1003,6 +1731,17 @@ int TABINDNode::InitNode(FILE *fp, int nBlockPtr,
         m_poDataBlock->WriteInt32( m_nPrevNodePtr );
         m_poDataBlock->WriteInt32( m_nNextNodePtr );
     }
+    else if (m_eAccessMode == TABRead && m_nSubTreeDepth > 1 &&
+             (psPinnedNode = GetPinnedNode(m_nCurDataBlockPtr)) != NULL)
+    {
+        /*-------------------------------------------------------------
+         * Read access to an upper level node that is already in memory
+         *------------------------------------------------------------*/
+        m_numEntriesInNode = psPinnedNode->numEntries;
+        m_nPrevNodePtr = psPinnedNode->nPrevNodePtr;
+        m_nNextNodePtr = psPinnedNode->nNextNodePtr;
+        m_pabyPinnedEntries = psPinnedNode->abyEntries;
+    }
     else
     {
         CPLAssert(m_nCurDataBlockPtr > 0);
@@ -1020,13 +1759,117 @@ int TABINDNode::InitNode(FILE *fp, int nBlockPtr,
         m_numEntriesInNode = m_poDataBlock->ReadInt32();
         m_nPrevNodePtr = m_poDataBlock->ReadInt32();
         m_nNextNodePtr = m_poDataBlock->ReadInt32();
+
+        /*-------------------------------------------------------------
+         * In read access, keep upper level nodes in memory so that
+         * the next lookups only have to read the leaf blocks.
+         *------------------------------------------------------------*/
+        if (m_eAccessMode == TABRead && m_nSubTreeDepth > 1 &&
+            (psPinnedNode = PinCurrentNode()) != NULL)
+            m_pabyPinnedEntries = psPinnedNode->abyEntries;
     }
 
     // m_poDataBlock is now positioned at the beginning of the key entries
+    // (unless the node is pinned, in which case it is not used anymore)
 
     return 0;
 }
 
+/**********************************************************************
+ *                   TABFindPinnedNode()
+ *
+ * Binary search the pinned nodes of the root node for nBlockPtr.
+ *
+ * Returns the position where the node is (or would be inserted) in the
+ * root's sorted array of pinned nodes.
+ **********************************************************************/
+static int TABFindPinnedNode(TABINDPinnedNode **papsNodes, int numNodes,
+                             GInt32 nBlockPtr)
+{
+    int nLow = 0, nHigh = numNodes;
+
+    while(nLow < nHigh)
+    {
+        int nMid = (nLow + nHigh) / 2;
+        if (papsNodes[nMid]->nBlockPtr < nBlockPtr)
+            nLow = nMid + 1;
+        else
+            nHigh = nMid;
+    }
+
+    return nLow;
+}
+
+/**********************************************************************
+ *                   TABINDNode::GetPinnedNode()
+ *
+ * Return the in-memory copy of the upper level node at nBlockPtr, or
+ * NULL if that node has not been pinned by PinCurrentNode().
+ *
+ * The pinned nodes are shared by all the nodes of an index tree and
+ * are owned by its root node.  Used in read access only.
+ **********************************************************************/
+TABINDPinnedNode *TABINDNode::GetPinnedNode(GInt32 nBlockPtr)
+{
+    TABINDNode *poRoot = this;
+    while(poRoot->m_poParentNodeRef)
+        poRoot = poRoot->m_poParentNodeRef;
+
+    int i = TABFindPinnedNode(poRoot->m_papsPinnedNodes, 
+                              poRoot->m_numPinnedNodes, nBlockPtr);
+    if (i < poRoot->m_numPinnedNodes &&
+        poRoot->m_papsPinnedNodes[i]->nBlockPtr == nBlockPtr)
+        return poRoot->m_papsPinnedNodes[i];
+
+    return NULL;
+}
+
+/**********************************************************************
+ *                   TABINDNode::PinCurrentNode()
+ *
+ * Add a copy of the node that was just read in m_poDataBlock to the
+ * pinned nodes of the root node.
+ *
+ * Returns the new pinned node, or NULL if the node could not be pinned
+ * (TAB_IND_MAX_PINNED_NODES reached, or invalid entry count) in which
+ * case the node is simply used from m_poDataBlock as usual.
+ **********************************************************************/
+TABINDPinnedNode *TABINDNode::PinCurrentNode()
+{
+    TABINDNode *poRoot = this;
+    while(poRoot->m_poParentNodeRef)
+        poRoot = poRoot->m_poParentNodeRef;
+
+    if (poRoot->m_numPinnedNodes >= TAB_IND_MAX_PINNED_NODES ||
+        m_numEntriesInNode < 0 || m_numEntriesInNode > GetMaxNumEntries())
+        return NULL;
+
+    int i = TABFindPinnedNode(poRoot->m_papsPinnedNodes, 
+                              poRoot->m_numPinnedNodes, m_nCurDataBlockPtr);
+
+    TABINDPinnedNode *psNode = 
+        (TABINDPinnedNode*)CPLMalloc(sizeof(TABINDPinnedNode));
+    psNode->nBlockPtr = m_nCurDataBlockPtr;
+    psNode->numEntries = m_numEntriesInNode;
+    psNode->nPrevNodePtr = m_nPrevNodePtr;
+    psNode->nNextNodePtr = m_nNextNodePtr;
+    m_poDataBlock->GotoByteInBlock(12);
+    memcpy(psNode->abyEntries, m_poDataBlock->GetCurDataPtr(), 512-12);
+
+    if (poRoot->m_numPinnedNodes % 64 == 0)
+        poRoot->m_papsPinnedNodes = (TABINDPinnedNode**)
+            CPLRealloc(poRoot->m_papsPinnedNodes,
+                       (poRoot->m_numPinnedNodes+64)*
+                                            sizeof(TABINDPinnedNode*));
+    memmove(poRoot->m_papsPinnedNodes + i + 1,
+            poRoot->m_papsPinnedNodes + i,
+            (poRoot->m_numPinnedNodes - i)*sizeof(TABINDPinnedNode*));
+    poRoot->m_papsPinnedNodes[i] = psNode;
+    poRoot->m_numPinnedNodes++;
+
+    return psNode;
+}
+
 
 /**********************************************************************
  *                   TABINDNode::GotoNodePtr()
@@ -1067,7 +1910,17 @@ int TABINDNode::GotoNodePtr(GInt32 nNewNodePtr)
 GInt32 TABINDNode::ReadIndexEntry(int nEntryNo, GByte *pKeyValue)
 {
     GInt32 nRecordPtr = 0;
-    if (nEntryNo >= 0 && nEntryNo < m_numEntriesInNode)
+    if (nEntryNo >= 0 && nEntryNo < m_numEntriesInNode && m_pabyPinnedEntries)
+    {
+        const GByte *pabyEntry = m_pabyPinnedEntries + 
+                                            nEntryNo*(m_nKeyLength+4);
+        if (pKeyValue)
+            memcpy(pKeyValue, pabyEntry, m_nKeyLength);
+
+        memcpy(&nRecordPtr, pabyEntry + m_nKeyLength, 4);
+        CPL_LSBPTR32(&nRecordPtr);
+    }
+    else if (nEntryNo >= 0 && nEntryNo < m_numEntriesInNode)
     {
         if (pKeyValue)
         {
@@ -1096,15 +1949,60 @@ GInt32 TABINDNode::ReadIndexEntry(int nEntryNo, GByte *pKeyValue)
  *
  * nEntryNo is the 0-based index of the index entry that we are interested
  * in inside the current node.
+ *
+ * If nCmpLength > 0 then only the first nCmpLength bytes of the keys are
+ * compared (used for prefix searches).
  **********************************************************************/
-int   TABINDNode::IndexKeyCmp(GByte *pKeyValue, int nEntryNo)
+int   TABINDNode::IndexKeyCmp(GByte *pKeyValue, int nEntryNo,
+                              int nCmpLength /*=0*/)
 {
     CPLAssert(pKeyValue);
     CPLAssert(nEntryNo >= 0 && nEntryNo < m_numEntriesInNode);
 
+    if (nCmpLength <= 0 || nCmpLength > m_nKeyLength)
+        nCmpLength = m_nKeyLength;
+
+    if (m_pabyPinnedEntries)
+        return memcmp(pKeyValue, m_pabyPinnedEntries + 
+                                 nEntryNo*(m_nKeyLength+4), nCmpLength);
+
     m_poDataBlock->GotoByteInBlock(12 + nEntryNo*(m_nKeyLength+4));
 
-    return memcmp(pKeyValue, m_poDataBlock->GetCurDataPtr(), m_nKeyLength);
+    return memcmp(pKeyValue, m_poDataBlock->GetCurDataPtr(), nCmpLength);
+}
+
+/**********************************************************************
+ *                   TABINDNode::FindFirstKeyGE()
+ *
+ * Binary search the entries of the current node for the first index
+ * key >= pKeyValue.  Keys inside a node are sorted and have a fixed 
+ * size, so there is no need to walk them one by one.
+ *
+ * Returns the 0-based entry number, or m_numEntriesInNode if all keys
+ * in the node are smaller than pKeyValue.  *pnCmpStatus is set to the
+ * result of IndexKeyCmp() for the returned entry (or 1 if none).
+ **********************************************************************/
+int TABINDNode::FindFirstKeyGE(GByte *pKeyValue, int *pnCmpStatus)
+{
+    int nLow = 0, nHigh = m_numEntriesInNode;
+
+    *pnCmpStatus = 1;
+    while(nLow < nHigh)
+    {
+        int nMid = (nLow + nHigh) / 2;
+        int nCmpStatus = IndexKeyCmp(pKeyValue, nMid);
+        if (nCmpStatus > 0)
+        {
+            nLow = nMid + 1;
+        }
+        else
+        {
+            nHigh = nMid;
+            *pnCmpStatus = nCmpStatus;
+        }
+    }
+
+    return nLow;
 }
 
 /**********************************************************************
@@ -1193,25 +2091,17 @@ GInt32 TABINDNode::FindFirst(GByte *pKeyValue)
         /*-------------------------------------------------------------
          * Leaf node level... we look for an exact match
          *------------------------------------------------------------*/
-        while(m_nCurIndexEntry < m_numEntriesInNode)
+        int nCmpStatus;
+        m_nCurIndexEntry = FindFirstKeyGE(pKeyValue, &nCmpStatus);
+
+        if (m_nCurIndexEntry < m_numEntriesInNode && nCmpStatus == 0)
         {
-            int nCmpStatus = IndexKeyCmp(pKeyValue, m_nCurIndexEntry);
-            if (nCmpStatus > 0)
-            {
-                /* Not there yet... (pKey > IndexEntry) */
-                m_nCurIndexEntry++;
-            }
-            else if (nCmpStatus == 0)
-            {
-                /* Found it!  Return the record number */
-                return ReadIndexEntry(m_nCurIndexEntry, NULL);
-            }
-            else
-            {
-                /* Item does not exist... return 0 */
-                return 0;
-            }
+            /* Found it!  Return the record number */
+            return ReadIndexEntry(m_nCurIndexEntry, NULL);
         }
+
+        /* Item does not exist... return 0 */
+        return 0;
     }
     else
     {
@@ -1237,105 +2127,87 @@ GInt32 TABINDNode::FindFirst(GByte *pKeyValue)
          * we won't bother searching the next node since this should also
          * be taken care of by our parent.
          *------------------------------------------------------------*/
-        while(m_nCurIndexEntry < m_numEntriesInNode)
+        if (m_numEntriesInNode > 0)
         {
-            int nCmpStatus = IndexKeyCmp(pKeyValue, m_nCurIndexEntry);
+            int nCmpStatus;
+            m_nCurIndexEntry = FindFirstKeyGE(pKeyValue, &nCmpStatus);
 
-            if (nCmpStatus > 0 && m_nCurIndexEntry+1 < m_numEntriesInNode)
+            if (m_nCurIndexEntry == m_numEntriesInNode)
             {
-                /* Not there yet... (pKey > IndexEntry) */
-                m_nCurIndexEntry++;
+                /* All keys are < pKeyValue... use the last entry */
+                m_nCurIndexEntry--;
+                nCmpStatus = 1;
             }
-            else
+
+            /*-----------------------------------------------------
+             * We either found an indexkey >= pKeyValue or reached 
+             * the last entry in this node... still have to decide 
+             * what we're going to do... 
+             *----------------------------------------------------*/
+            if (nCmpStatus < 0 && m_nCurIndexEntry == 0)
             {
-                /*-----------------------------------------------------
-                 * We either found an indexkey >= pKeyValue or reached 
-                 * the last entry in this node... still have to decide 
-                 * what we're going to do... 
-                 *----------------------------------------------------*/
-                if (nCmpStatus < 0 && m_nCurIndexEntry == 0)
+                /*-------------------------------------------------
+                 * First indexkey in block is > pKeyValue...
+                 * the key definitely does not exist in our children.
+                 * However, we still want to drill down the rest of the
+                 * tree because this function is also used when looking
+                 * for a node to insert a new value.
+                 *-------------------------------------------------*/
+                // Nothing special to do... just continue processing.
+            }
+
+            /*-----------------------------------------------------
+             * If we found an node for which pKeyValue < indexkey 
+             * (or pKeyValue <= indexkey for non-unique indexes) then 
+             * we access the preceding child node.
+             *
+             * Note that for indexkey == pKeyValue in non-unique indexes
+             * we also check in the preceding node because when keys
+             * are not unique then there are chances that the requested
+             * key could also be found at the end of the preceding node.
+             * In this case, if we don't find the key in the preceding
+             * node then we'll do a second search in the current node.
+             *----------------------------------------------------*/
+            int numChildrenToVisit=1;
+            if (m_nCurIndexEntry > 0 &&
+                (nCmpStatus < 0 || (nCmpStatus==0 && !m_bUnique)) )
+            {
+                m_nCurIndexEntry--;
+                if (nCmpStatus == 0)
+                    numChildrenToVisit = 2;
+            }
+
+            /*-----------------------------------------------------
+             * OK, now it's time to load/access the candidate child nodes.
+             *----------------------------------------------------*/
+            int nRetValue = 0;
+            for(int iChild=0; nRetValue==0 && 
+                              iChild<numChildrenToVisit; iChild++)
+            {
+                // If we're doing a second pass then jump to next entry
+                if (iChild > 0)
+                    m_nCurIndexEntry++;
+
+                int nChildNodePtr = ReadIndexEntry(m_nCurIndexEntry, NULL);
+                if (nChildNodePtr == 0)
                 {
-                    /*-------------------------------------------------
-                     * First indexkey in block is > pKeyValue...
-                     * the key definitely does not exist in our children.
-                     * However, we still want to drill down the rest of the
-                     * tree because this function is also used when looking
-                     * for a node to insert a new value.
-                     *-------------------------------------------------*/
-                    // Nothing special to do... just continue processing.
+                    /* Invalid child node??? */
+                    nRetValue = 0;
+                    continue;
                 }
 
-                /*-----------------------------------------------------
-                 * If we found an node for which pKeyValue < indexkey 
-                 * (or pKeyValue <= indexkey for non-unique indexes) then 
-                 * we access the preceding child node.
-                 *
-                 * Note that for indexkey == pKeyValue in non-unique indexes
-                 * we also check in the preceding node because when keys
-                 * are not unique then there are chances that the requested
-                 * key could also be found at the end of the preceding node.
-                 * In this case, if we don't find the key in the preceding
-                 * node then we'll do a second search in the current node.
-                 *----------------------------------------------------*/
-                int numChildrenToVisit=1;
-                if (m_nCurIndexEntry > 0 &&
-                    (nCmpStatus < 0 || (nCmpStatus==0 && !m_bUnique)) )
+                if (GotoChildNode(nChildNodePtr) != 0)
                 {
-                    m_nCurIndexEntry--;
-                    if (nCmpStatus == 0)
-                        numChildrenToVisit = 2;
+                    // An error happened and has already been reported
+                    return -1;
                 }
 
-                /*-----------------------------------------------------
-                 * OK, now it's time to load/access the candidate child nodes.
-                 *----------------------------------------------------*/
-                int nRetValue = 0;
-                for(int iChild=0; nRetValue==0 && 
-                                  iChild<numChildrenToVisit; iChild++)
-                {
-                    // If we're doing a second pass then jump to next entry
-                    if (iChild > 0)
-                        m_nCurIndexEntry++;
-
-                    int nChildNodePtr = ReadIndexEntry(m_nCurIndexEntry, NULL);
-                    if (nChildNodePtr == 0)
-                    {
-                        /* Invalid child node??? */
-                        nRetValue = 0;
-                        continue;
-                    }
-                    else if (m_poCurChildNode == NULL)
-                    {
-                        /* Child node has never been initialized...do it now!*/
-
-                        m_poCurChildNode = new TABINDNode(m_eAccessMode);
-                        if ( m_poCurChildNode->InitNode(m_fp, nChildNodePtr, 
-                                                        m_nKeyLength, 
-                                                        m_nSubTreeDepth-1,
-                                                        m_bUnique,
-                                                        m_poBlockManagerRef, 
-                                                        this) != 0 ||
-                             m_poCurChildNode->SetFieldType(m_eFieldType)!=0)
-                        {
-                            // An error happened... and was already reported
-                            return -1;
-                        }
-                    }
-
-                    if (m_poCurChildNode->GotoNodePtr(nChildNodePtr) != 0)
-                    {
-                        // An error happened and has already been reported
-                        return -1;
-                    }
-
-                    nRetValue = m_poCurChildNode->FindFirst(pKeyValue);
-                }/*for iChild*/
-
-                return nRetValue;
-
-            }/*else*/
-
-        }/*while numEntries*/
+                nRetValue = m_poCurChildNode->FindFirst(pKeyValue);
+            }/*for iChild*/
+
+            return nRetValue;
+
+        }/*if numEntries*/
 
         // No node was found that contains the key value.
         // We should never get here... only leaf nodes should return 0
@@ -1346,6 +2218,37 @@ GInt32 TABINDNode::FindFirst(GByte *pKeyValue)
     return 0;  // Not found
 }
 
+/**********************************************************************
+ *                   TABINDNode::GotoChildNode()
+ *
+ * Load the child node at nChildNodePtr in m_poCurChildNode, creating
+ * the child node object the first time.
+ *
+ * Returns 0 on success, -1 on error.
+ **********************************************************************/
+int TABINDNode::GotoChildNode(GInt32 nChildNodePtr)
+{
+    if (m_poCurChildNode == NULL)
+    {
+        /* Child node has never been initialized...do it now!*/
+
+        m_poCurChildNode = new TABINDNode(m_eAccessMode);
+        if ( m_poCurChildNode->InitNode(m_fp, nChildNodePtr, 
+                                        m_nKeyLength, 
+                                        m_nSubTreeDepth-1,
+                                        m_bUnique,
+                                        m_poBlockManagerRef, 
+                                        this) != 0 ||
+             m_poCurChildNode->SetFieldType(m_eFieldType)!=0)
+        {
+            // An error happened... and was already reported
+            return -1;
+        }
+    }
+
+    return m_poCurChildNode->GotoNodePtr(nChildNodePtr);
+}
+
 /**********************************************************************
  *                   TABINDNode::FindNext()
  *
@@ -1413,6 +2316,121 @@ GInt32 TABINDNode::FindNext(GByte *pKeyValue)
 }
 
 
+/**********************************************************************
+ *                   TABINDNode::FindFirstInRange()
+ *
+ * Start a range search in this node and its children: position the 
+ * search on the first leaf entry with a key >= pMinKey (or on the very 
+ * first entry if pMinKey is NULL) and return it if its key is <= pMaxKey.
+ *
+ * Only the first nMaxKeyLength bytes of the keys are compared to 
+ * pMaxKey, which allows prefix searches on char keys.  pMaxKey=NULL means
+ * no upper bound.
+ *
+ * FindNextInRange() then walks the following entries through the chain
+ * of leaf nodes (m_nNextNodePtr).
+ *
+ * Return value:
+ *  - the key's corresponding record number in the .DAT file (greater than 0)
+ *  - 0 if no key is in the range
+ *  - or -1 if an error happened
+ **********************************************************************/
+GInt32 TABINDNode::FindFirstInRange(GByte *pMinKey, 
+                                    GByte *pMaxKey, int nMaxKeyLength)
+{
+    if (m_poDataBlock == NULL)
+    {
+        CPLError(CE_Failure, CPLE_AssertionFailed,
+                 "TABINDNode::Search(): Node has not been initialized yet!");
+        return -1;
+    }
+
+    int nCmpStatus;
+
+    if (m_nSubTreeDepth == 1)
+    {
+        /*-------------------------------------------------------------
+         * Leaf node level... position just before the first key >= 
+         * pMinKey, FindNextInRange() will do the rest.
+         *------------------------------------------------------------*/
+        m_nCurIndexEntry = pMinKey ? FindFirstKeyGE(pMinKey, &nCmpStatus) : 0;
+        m_nCurIndexEntry--;
+
+        return FindNextInRange(pMaxKey, nMaxKeyLength);
+    }
+
+    if (m_numEntriesInNode == 0)
+        return 0;
+
+    /*-----------------------------------------------------------------
+     * Index Node: the first key >= pMinKey is in the child that precedes
+     * the first node key >= pMinKey.  Since keys may not be unique, an
+     * equal key at the start of a child can also be found at the end of
+     * the preceding child, and if the child does not contain the key at
+     * all then the search simply continues in the next leaf nodes.
+     *----------------------------------------------------------------*/
+    m_nCurIndexEntry = pMinKey ? FindFirstKeyGE(pMinKey, &nCmpStatus) : 0;
+    if (m_nCurIndexEntry > 0)
+        m_nCurIndexEntry--;
+
+    int nChildNodePtr = ReadIndexEntry(m_nCurIndexEntry, NULL);
+    if (nChildNodePtr == 0)
+        return 0;   /* Invalid child node??? */
+
+    if (GotoChildNode(nChildNodePtr) != 0)
+        return -1;
+
+    return m_poCurChildNode->FindFirstInRange(pMinKey, pMaxKey, nMaxKeyLength);
+}
+
+/**********************************************************************
+ *                   TABINDNode::FindNextInRange()
+ *
+ * Continue the range search previously started by FindFirstInRange().
+ *
+ * Return value:
+ *  - the key's corresponding record number in the .DAT file (greater than 0)
+ *  - 0 if there are no more keys in the range
+ *  - or -1 if an error happened
+ **********************************************************************/
+GInt32 TABINDNode::FindNextInRange(GByte *pMaxKey, int nMaxKeyLength)
+{
+    if (m_nSubTreeDepth > 1)
+    {
+        /*-------------------------------------------------------------
+         * Index Node: just pass the search to this child node.
+         *------------------------------------------------------------*/
+        if (m_poCurChildNode == NULL)
+            return 0;
+        return m_poCurChildNode->FindNextInRange(pMaxKey, nMaxKeyLength);
+    }
+
+    /*-----------------------------------------------------------------
+     * Leaf node level... move to the next entry, continuing with the
+     * next leaf nodes when we reach the end of this one.
+     *----------------------------------------------------------------*/
+    m_nCurIndexEntry++;
+    while (m_nCurIndexEntry >= m_numEntriesInNode)
+    {
+        if (m_nNextNodePtr <= 0)
+            return 0;
+
+        if (GotoNodePtr(m_nNextNodePtr) != 0)
+            return -1;
+        m_nCurIndexEntry = 0;
+    }
+
+    if (pMaxKey && 
+        IndexKeyCmp(pMaxKey, m_nCurIndexEntry, nMaxKeyLength) < 0)
+    {
+        /* Past the end of the range */
+        return 0;
+    }
+
+    return ReadIndexEntry(m_nCurIndexEntry, NULL);
+}
+
+
 /**********************************************************************
  *                   TABINDNode::CommitToFile()
  *
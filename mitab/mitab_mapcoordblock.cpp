@@ -377,13 +377,18 @@ int     TABMAPCoordBlock::ReadIntCoords(GBool bCompressed, int numCoordPairs,
 {
     int i, numValues = numCoordPairs*2;
 
+    /* Look for errors posted while reading with a single load per pair */
+    /* rather than a TLS lookup through CPLGetLastErrorType().           */
+    const GUInt32 *pnErrorCounter = CPLGetErrorCounterPtr();
+    GUInt32 nErrorCounter = *pnErrorCounter;
+
     if (bCompressed)
     {   
         for(i=0; i<numValues; i+=2)
         {
             panXY[i]   = m_nComprOrgX + ReadInt16();
             panXY[i+1] = m_nComprOrgY + ReadInt16();
-            if (CPLGetLastErrorType() != 0)
+            if (*pnErrorCounter != nErrorCounter)
                 return -1;
         }
     }
@@ -393,7 +398,7 @@ int     TABMAPCoordBlock::ReadIntCoords(GBool bCompressed, int numCoordPairs,
         {
             panXY[i]   = ReadInt32();
             panXY[i+1] = ReadInt32();
-            if (CPLGetLastErrorType() != 0)
+            if (*pnErrorCounter != nErrorCounter)
                 return -1;
         }
     }
@@ -437,6 +442,8 @@ int     TABMAPCoordBlock::ReadCoordSecHdrs(GBool bCompressed,
                                            GInt32    &numVerticesTotal)
 {
     int i, nTotalHdrSizeUncompressed;
+    const GUInt32 *pnErrorCounter = CPLGetErrorCounterPtr();
+    GUInt32 nErrorCounter = *pnErrorCounter;
 
     CPLErrorReset();
 
@@ -478,7 +485,7 @@ int     TABMAPCoordBlock::ReadCoordSecHdrs(GBool bCompressed,
         ReadIntCoord(bCompressed, pasHdrs[i].nXMax, pasHdrs[i].nYMax);
         pasHdrs[i].nDataOffset = ReadInt32();
 
-        if (CPLGetLastErrorType() != 0)
+        if (*pnErrorCounter != nErrorCounter)
             return -1;
 
         numVerticesTotal += pasHdrs[i].numVertices;
@@ -206,6 +206,7 @@ TABMAPFile::TABMAPFile()
     m_fp = NULL;
     m_pszFname = NULL;
     m_poHeader = NULL;
+    m_bSharedHeader = FALSE;
     m_poSpIndex = NULL;
     m_poSpIndexLeaf = NULL;
 /* See bug 1732: Optimized spatial index produces broken files because
@@ -221,6 +222,20 @@ TABMAPFile::TABMAPFile()
     m_nCurObjId = -1;
     m_poCurCoordBlock = NULL;
     m_poToolDefTable = NULL;
+
+    m_papszPenStyleCache = NULL;
+    m_papszBrushStyleCache = NULL;
+    m_papszSymbolStyleCache = NULL;
+    m_papszPenBrushStyleCache = NULL;
+    m_numPenStyleCache = m_numBrushStyleCache = m_numSymbolStyleCache = 0;
+
+    m_nPrefetchBlocks = 0;
+    m_nPrefetchLeafPtr = -1;
+    m_iPrefetchEntry = -1;
+
+    m_psAsyncReader = NULL;
+    m_pasAsyncBlocks = NULL;
+    m_numAsyncBlocks = 0;
 }
 
 /**********************************************************************
@@ -410,6 +425,9 @@ int TABMAPFile::Open(const char *pszFname, const char *pszAccess,
     if (m_eAccessMode == TABRead)
     {
         ResetCoordFilter();
+        m_nPrefetchBlocks = 
+            atoi(CPLGetConfigOption("MITAB_PREFETCH_BLOCKS", "8"));
+        InitAsyncReader();
     }
 
     /*-----------------------------------------------------------------
@@ -441,6 +459,95 @@ int TABMAPFile::Open(const char *pszFname, const char *pszAccess,
     return 0;
 }
 
+/**********************************************************************
+ *                   TABMAPFile::OpenReadCursor()
+ *
+ * Open this object as an independent read cursor on the .MAP file of
+ * poSrcFile, which must be opened for read.
+ *
+ * The cursor has its own file handle, .ID file, object/coord blocks
+ * and spatial index traversal state, but shares the header block and
+ * drawing tool definitions of poSrcFile (read-only once the file is
+ * opened), which must remain open for as long as the cursor is in use.
+ *
+ * Returns 0 on success, -1 on error.
+ **********************************************************************/
+int TABMAPFile::OpenReadCursor(TABMAPFile *poSrcFile)
+{
+    if (m_fp || m_poHeader)
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "OpenReadCursor() failed: object already contains an "
+                 "open file");
+        return -1;
+    }
+
+    if (poSrcFile == NULL || poSrcFile->m_eAccessMode != TABRead ||
+        poSrcFile->m_poHeader == NULL)
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "OpenReadCursor() requires a .MAP file opened for read.");
+        return -1;
+    }
+
+    m_eAccessMode = TABRead;
+    m_nMinTABVersion = poSrcFile->m_nMinTABVersion;
+    m_bQuickSpatialIndexMode = poSrcFile->m_bQuickSpatialIndexMode;
+    m_nPrefetchBlocks = poSrcFile->m_nPrefetchBlocks;
+    m_poHeader = poSrcFile->m_poHeader;
+    m_bSharedHeader = TRUE;
+    m_poIdIndex = NULL;
+    m_poSpIndex = NULL;
+    m_poToolDefTable = NULL;
+
+    /*-----------------------------------------------------------------
+     * No .MAP file: act as if all objects were NONE geometries, 
+     * like Open() does.
+     *----------------------------------------------------------------*/
+    if (poSrcFile->m_fp == NULL)
+    {
+        m_nCurObjType = TAB_GEOM_NONE;
+        return 0;
+    }
+
+    /*-----------------------------------------------------------------
+     * Drawing tools are normally loaded on demand: do it now so that
+     * the shared table is never modified once cursors use it.
+     *----------------------------------------------------------------*/
+    if (poSrcFile->InitDrawingTools() != 0)
+    {
+        Close();
+        return -1;
+    }
+    m_poToolDefTable = poSrcFile->m_poToolDefTable;
+
+    m_pszFname = CPLStrdup(poSrcFile->m_pszFname);
+    m_fp = VSIFOpen(m_pszFname, "rb");
+    if (m_fp == NULL)
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "OpenReadCursor() failed for %s", m_pszFname);
+        Close();
+        return -1;
+    }
+
+    m_poCurObjBlock = new TABMAPObjectBlock(m_eAccessMode);
+    m_poCurObjBlock->InitNewBlock(m_fp, 512);
+
+    m_poIdIndex = new TABIDFile;
+    if (m_poIdIndex->Open(m_pszFname, "rb") != 0)
+    {
+        // Failed... an error has already been reported
+        Close();
+        return -1;
+    }
+
+    ResetCoordFilter();
+    InitAsyncReader();
+
+    return 0;
+}
+
 /**********************************************************************
  *                   TABMAPFile::Close()
  *
@@ -495,7 +602,7 @@ int TABMAPFile::Close()
     
     // Check for overflow of internal coordinates and produce a warning
     // if that happened...
-    if (m_poHeader && m_poHeader->m_bIntBoundsOverflow)
+    if (m_poHeader && !m_bSharedHeader && m_poHeader->m_bIntBoundsOverflow)
     {
         double dBoundsMinX, dBoundsMinY, dBoundsMaxX, dBoundsMaxY;
         Int2Coordsys(-1000000000, -1000000000, dBoundsMinX, dBoundsMinY);
@@ -511,7 +618,7 @@ int TABMAPFile::Close()
     }
 
     // Delete all structures 
-    if (m_poHeader)
+    if (m_poHeader && !m_bSharedHeader)
         delete m_poHeader;
     m_poHeader = NULL;
 
@@ -544,11 +651,22 @@ int TABMAPFile::Close()
         m_poSpIndexLeaf = NULL;
     }
 
-    if (m_poToolDefTable)
-    {
+    ResetStyleStringCache();
+
+    if (m_poToolDefTable && !m_bSharedHeader)
         delete m_poToolDefTable;
-        m_poToolDefTable = NULL;
+    m_poToolDefTable = NULL;
+    m_bSharedHeader = FALSE;
+
+    // Must be done before closing the file: reads may still be in flight
+    if (m_psAsyncReader)
+    {
+        CPLAsyncReaderDestroy(m_psAsyncReader);
+        m_psAsyncReader = NULL;
     }
+    CPLFree(m_pasAsyncBlocks);
+    m_pasAsyncBlocks = NULL;
+    m_numAsyncBlocks = 0;
 
     // Close file
     if (m_fp)
@@ -720,7 +838,10 @@ int TABMAPFile::LoadNextMatchingObjectBlock( int bFirstObject )
         if( poBlock == NULL )
             return FALSE;
         else if( poBlock->GetBlockType() == TABMAP_OBJECT_BLOCK )
+        {
+            PrefetchAhead();
             return TRUE;
+        }
         else
             /* continue processing new index block */;
     }
@@ -728,6 +849,255 @@ int TABMAPFile::LoadNextMatchingObjectBlock( int bFirstObject )
     return m_poSpIndexLeaf != NULL;
 }
 
+/************************************************************************/
+/*                           PrefetchAhead()                            */
+/*                                                                      */
+/*      Called when LoadNextMatchingObjectBlock() has loaded a new      */
+/*      object block.  Tell the OS which blocks we are about to read:   */
+/*      the next object blocks of the current index node that match     */
+/*      the filter, and the coord blocks of this object block when all  */
+/*      its objects are inside the filter (otherwise most of them may   */
+/*      be skipped), so that they are fetched while the caller          */
+/*      decodes features.                                               */
+/*      This only matters for cold data on slow (e.g. network)          */
+/*      storage.  Set MITAB_PREFETCH_BLOCKS to 0 to disable.            */
+/************************************************************************/
+
+void TABMAPFile::PrefetchAhead()
+
+{
+    // All object and coord blocks are 512 bytes
+    const int nBlockSize = 512;
+
+    if( m_nPrefetchBlocks <= 0 || m_fp == NULL || m_poCurObjBlock == NULL )
+        return;
+
+/* -------------------------------------------------------------------- */
+/*      Coord blocks of the current object block.  They are usually     */
+/*      contiguous, in which case one range covers them.                */
+/* -------------------------------------------------------------------- */
+    GInt32 nFirstCoord = m_poCurObjBlock->GetFirstCoordBlockAddress();
+    GInt32 nLastCoord = m_poCurObjBlock->GetLastCoordBlockAddress();
+    TABMAPIndexEntry *psCurEntry = NULL;
+
+    if( m_poSpIndexLeaf != NULL )
+        psCurEntry = m_poSpIndexLeaf->GetEntry( 
+                                    m_poSpIndexLeaf->GetCurChildIndex() );
+
+    if( nFirstCoord > 0 
+        && (psCurEntry == NULL
+            || (psCurEntry->XMin >= m_XMinFilter
+                && psCurEntry->YMin >= m_YMinFilter
+                && psCurEntry->XMax <= m_XMaxFilter
+                && psCurEntry->YMax <= m_YMaxFilter)) )
+    {
+        if( nLastCoord >= nFirstCoord 
+            && (nLastCoord - nFirstCoord) / nBlockSize < m_nPrefetchBlocks )
+        {
+            VSIFAdviseRead( m_fp, nFirstCoord, 
+                            nLastCoord - nFirstCoord + nBlockSize );
+        }
+        else
+        {
+            VSIFAdviseRead( m_fp, nFirstCoord, nBlockSize );
+            if( nLastCoord > 0 )
+                VSIFAdviseRead( m_fp, nLastCoord, nBlockSize );
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Following entries of the current index node.  A new batch is    */
+/*      requested when we are half way through the previous one.        */
+/* -------------------------------------------------------------------- */
+    if( m_poSpIndexLeaf == NULL )
+        return;
+
+    int iEntry = m_poSpIndexLeaf->GetCurChildIndex();
+    int nEntries = m_poSpIndexLeaf->GetNumEntries();
+
+    if( m_poSpIndexLeaf->GetStartAddress() != m_nPrefetchLeafPtr )
+    {
+        m_nPrefetchLeafPtr = m_poSpIndexLeaf->GetStartAddress();
+        m_iPrefetchEntry = iEntry;
+    }
+    else if( m_iPrefetchEntry - iEntry > m_nPrefetchBlocks / 2 )
+        return;
+
+    int i, nMatching = 0;
+    GInt32 nRangeStart = -1, nRangeEnd = -1;
+
+    for( i = MAX(iEntry, m_iPrefetchEntry) + 1; 
+         i < nEntries && nMatching < m_nPrefetchBlocks; i++ )
+    {
+        TABMAPIndexEntry *psEntry = m_poSpIndexLeaf->GetEntry( i );
+
+        m_iPrefetchEntry = i;
+
+        if( psEntry->XMax < m_XMinFilter
+            || psEntry->YMax < m_YMinFilter
+            || psEntry->XMin > m_XMaxFilter
+            || psEntry->YMin > m_YMaxFilter )
+            continue;
+
+        nMatching++;
+
+        if( m_psAsyncReader != NULL )
+        {
+            // No free buffer: retry this entry in the next batch
+            if( !SubmitAsyncBlock( psEntry->nBlockPtr ) )
+            {
+                m_iPrefetchEntry = i - 1;
+                break;
+            }
+            continue;
+        }
+
+        // Merge consecutive blocks in a single request
+        if( psEntry->nBlockPtr == nRangeEnd )
+        {
+            nRangeEnd += nBlockSize;
+            continue;
+        }
+
+        if( nRangeStart >= 0 )
+            VSIFAdviseRead( m_fp, nRangeStart, nRangeEnd - nRangeStart );
+        nRangeStart = psEntry->nBlockPtr;
+        nRangeEnd = nRangeStart + nBlockSize;
+    }
+
+    if( nRangeStart >= 0 )
+        VSIFAdviseRead( m_fp, nRangeStart, nRangeEnd - nRangeStart );
+
+    if( m_psAsyncReader != NULL )
+        CPLAsyncReaderFlush( m_psAsyncReader );
+}
+
+/************************************************************************/
+/*                          InitAsyncReader()                           */
+/*                                                                      */
+/*      With MITAB_ASYNC_READ=AUTO (the default) the blocks found by    */
+/*      PrefetchAhead() are read with io_uring when it is available,    */
+/*      instead of only being hinted to the OS.  YES forces it even     */
+/*      with the synchronous fallback, NO disables it.                  */
+/************************************************************************/
+
+void TABMAPFile::InitAsyncReader()
+
+{
+    const char *pszAsync = CPLGetConfigOption("MITAB_ASYNC_READ", "AUTO");
+
+    if( m_fp == NULL || m_nPrefetchBlocks <= 0 
+        || (!EQUAL(pszAsync, "AUTO") && !CSLTestBoolean(pszAsync)) )
+        return;
+
+    m_psAsyncReader = CPLAsyncReaderCreate( m_fp, m_nPrefetchBlocks );
+    if( m_psAsyncReader == NULL )
+        return;
+
+    if( EQUAL(pszAsync, "AUTO") 
+        && !EQUAL(CPLAsyncReaderGetBackend(m_psAsyncReader), "io_uring") )
+    {
+        CPLAsyncReaderDestroy( m_psAsyncReader );
+        m_psAsyncReader = NULL;
+        return;
+    }
+
+    m_numAsyncBlocks = m_nPrefetchBlocks;
+    m_pasAsyncBlocks = (TABMAPAsyncBlock *) 
+        CPLMalloc( m_numAsyncBlocks * sizeof(TABMAPAsyncBlock) );
+    for( int i = 0; i < m_numAsyncBlocks; i++ )
+        m_pasAsyncBlocks[i].nOffset = -1;
+}
+
+/************************************************************************/
+/*                          SubmitAsyncBlock()                          */
+/*                                                                      */
+/*      Start reading the block at nOffset in a free buffer.  Returns   */
+/*      FALSE if all buffers are in use.                                */
+/************************************************************************/
+
+GBool TABMAPFile::SubmitAsyncBlock( GInt32 nOffset )
+
+{
+    TABMAPAsyncBlock *psFree = NULL;
+
+    for( int i = 0; i < m_numAsyncBlocks; i++ )
+    {
+        if( m_pasAsyncBlocks[i].nOffset == nOffset )
+            return TRUE;
+        if( psFree == NULL && m_pasAsyncBlocks[i].nOffset == -1 )
+            psFree = m_pasAsyncBlocks + i;
+    }
+
+    if( psFree == NULL 
+        || !CPLAsyncReaderSubmit( m_psAsyncReader, nOffset, 512, 
+                                  psFree->abyData, psFree ) )
+        return FALSE;
+
+    psFree->nOffset = nOffset;
+    psFree->bDone = FALSE;
+    psFree->nBytesRead = 0;
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                           WaitAsyncBlock()                           */
+/*                                                                      */
+/*      Return the buffer holding the block at nOffset once its read    */
+/*      has completed, or NULL if that block was not submitted.  The    */
+/*      caller releases the buffer by setting its nOffset to -1.        */
+/************************************************************************/
+
+TABMAPAsyncBlock *TABMAPFile::WaitAsyncBlock( GInt32 nOffset )
+
+{
+    TABMAPAsyncBlock *psBlock = NULL;
+
+    for( int i = 0; psBlock == NULL && i < m_numAsyncBlocks; i++ )
+    {
+        if( m_pasAsyncBlocks[i].nOffset == nOffset )
+            psBlock = m_pasAsyncBlocks + i;
+    }
+
+    while( psBlock != NULL && !psBlock->bDone )
+    {
+        TABMAPAsyncBlock *psDone;
+        int               nBytesRead;
+
+        if( !CPLAsyncReaderWait( m_psAsyncReader, TRUE, 
+                                 (void **) &psDone, &nBytesRead ) )
+            return NULL;
+
+        psDone->bDone = TRUE;
+        psDone->nBytesRead = nBytesRead;
+    }
+
+    return psBlock;
+}
+
+/************************************************************************/
+/*                          DrainAsyncReader()                          */
+/*                                                                      */
+/*      Wait for all reads in flight and release all buffers.           */
+/************************************************************************/
+
+void TABMAPFile::DrainAsyncReader()
+
+{
+    void *pUserData;
+    int   nBytesRead;
+
+    if( m_psAsyncReader == NULL )
+        return;
+
+    while( CPLAsyncReaderWait( m_psAsyncReader, TRUE, 
+                               &pUserData, &nBytesRead ) ) {}
+
+    for( int i = 0; i < m_numAsyncBlocks; i++ )
+        m_pasAsyncBlocks[i].nOffset = -1;
+}
+
 /************************************************************************/
 /*                            ResetReading()                            */
 /*                                                                      */
@@ -745,6 +1115,9 @@ void TABMAPFile::ResetReading()
         m_poSpIndex = NULL;
         m_poSpIndexLeaf = NULL;
     }
+
+    m_nPrefetchLeafPtr = -1;
+    DrainAsyncReader();
 }
 
 /************************************************************************/
@@ -2203,9 +2576,25 @@ TABRawBinBlock *TABMAPFile::GetIndexObjectBlock( int nFileOffset )
      * Read from the file
      *---------------------------------------------------------------*/
     GByte abyData[512];
+    GByte *pabyData = abyData;
+    TABMAPAsyncBlock *psAsyncBlock = NULL;
+
+    if (m_psAsyncReader)
+    {
+        psAsyncBlock = WaitAsyncBlock(nFileOffset);
+        if (psAsyncBlock && psAsyncBlock->nBytesRead == 512)
+            pabyData = psAsyncBlock->abyData;
+        else if (psAsyncBlock)
+        {
+            // Short read: retry below to report the error
+            psAsyncBlock->nOffset = -1;
+            psAsyncBlock = NULL;
+        }
+    }
 
-    if (VSIFSeek(m_fp, nFileOffset, SEEK_SET) != 0 
-        || VSIFRead(abyData, sizeof(GByte), 512, m_fp) != 512 )
+    if (psAsyncBlock == NULL &&
+        (VSIFSeek(m_fp, nFileOffset, SEEK_SET) != 0 
+         || VSIFRead(abyData, sizeof(GByte), 512, m_fp) != 512) )
     {
         CPLError(CE_Failure, CPLE_FileIO,
                  "GetIndexBlock() failed reading %d bytes at offset %d.",
@@ -2216,7 +2605,7 @@ TABRawBinBlock *TABMAPFile::GetIndexObjectBlock( int nFileOffset )
 /* -------------------------------------------------------------------- */
 /*      Create and initialize depending on the block type.              */
 /* -------------------------------------------------------------------- */
-    int nBlockType = abyData[0];
+    int nBlockType = pabyData[0];
     TABRawBinBlock *poBlock;
 
     if( nBlockType == TABMAP_INDEX_BLOCK )
@@ -2224,13 +2613,17 @@ TABRawBinBlock *TABMAPFile::GetIndexObjectBlock( int nFileOffset )
     else
         poBlock = new TABMAPObjectBlock();
     
-    if( poBlock->InitBlockFromData(abyData, 512, 512,
+    if( poBlock->InitBlockFromData(pabyData, 512, 512,
                                    TRUE, m_fp, nFileOffset) == -1 )
     {
         delete poBlock;
         poBlock = NULL;
     }
 
+    // The data was copied, the buffer can be reused
+    if( psAsyncBlock != NULL )
+        psAsyncBlock->nOffset = -1;
+
     return poBlock;
 }
 
@@ -2580,6 +2973,186 @@ int   TABMAPFile::WriteSymbolDef(TABSymbolDef *psDef)
     return m_poToolDefTable->AddSymbolDefRef(psDef);
 }
 
+/**********************************************************************
+ *                   TABMAPFile::InitStyleStringCache()
+ *
+ * Allocate the (empty) style string caches, sized after the number of
+ * drawing tools in the file.  The pen+brush combinations cache is not
+ * allocated if there are too many combinations to make it worthwhile.
+ *
+ * Style strings are cached only in read mode since the tool defs table
+ * is not final until the file is closed in write mode.
+ *
+ * Returns 0 on success, -1 on error.
+ **********************************************************************/
+int TABMAPFile::InitStyleStringCache()
+{
+    if (m_papszPenStyleCache != NULL)
+        return 0;
+
+    if (m_eAccessMode != TABRead ||
+        (m_poToolDefTable == NULL && InitDrawingTools() != 0) ||
+        m_poToolDefTable == NULL)
+        return -1;
+
+    // Index 0 is valid and refers to the MapInfo default tool
+    m_numPenStyleCache = m_poToolDefTable->GetNumPen() + 1;
+    m_numBrushStyleCache = m_poToolDefTable->GetNumBrushes() + 1;
+    m_numSymbolStyleCache = m_poToolDefTable->GetNumSymbols() + 1;
+
+    m_papszPenStyleCache = (char**)CPLCalloc(m_numPenStyleCache,
+                                             sizeof(char*));
+    m_papszBrushStyleCache = (char**)CPLCalloc(m_numBrushStyleCache,
+                                               sizeof(char*));
+    m_papszSymbolStyleCache = (char**)CPLCalloc(m_numSymbolStyleCache,
+                                                sizeof(char*));
+
+    if (m_numPenStyleCache * m_numBrushStyleCache <= 65536)
+        m_papszPenBrushStyleCache = 
+            (char**)CPLCalloc(m_numPenStyleCache * m_numBrushStyleCache,
+                              sizeof(char*));
+
+    return 0;
+}
+
+/**********************************************************************
+ *                   TABMAPFile::ResetStyleStringCache()
+ *
+ * Free all cached style strings.
+ **********************************************************************/
+void TABMAPFile::ResetStyleStringCache()
+{
+    int i;
+
+    if (m_papszPenStyleCache == NULL)
+        return;
+
+    for(i=0; i<m_numPenStyleCache; i++)
+        CPLFree(m_papszPenStyleCache[i]);
+    for(i=0; i<m_numBrushStyleCache; i++)
+        CPLFree(m_papszBrushStyleCache[i]);
+    for(i=0; i<m_numSymbolStyleCache; i++)
+        CPLFree(m_papszSymbolStyleCache[i]);
+    if (m_papszPenBrushStyleCache)
+    {
+        for(i=0; i<m_numPenStyleCache*m_numBrushStyleCache; i++)
+            CPLFree(m_papszPenBrushStyleCache[i]);
+    }
+
+    CPLFree(m_papszPenStyleCache);
+    CPLFree(m_papszBrushStyleCache);
+    CPLFree(m_papszSymbolStyleCache);
+    CPLFree(m_papszPenBrushStyleCache);
+    m_papszPenStyleCache = NULL;
+    m_papszBrushStyleCache = NULL;
+    m_papszSymbolStyleCache = NULL;
+    m_papszPenBrushStyleCache = NULL;
+    m_numPenStyleCache = m_numBrushStyleCache = m_numSymbolStyleCache = 0;
+}
+
+/**********************************************************************
+ *                   TABMAPFile::GetPenStyleStringRef()
+ *
+ * Return a reference to the OGR PEN() style string for the specified
+ * pen index.  The string is formatted the first time it is requested
+ * and then shared by all features using the same pen.
+ *
+ * The returned string is owned by the TABMAPFile and remains valid
+ * until the file is closed.
+ *
+ * Returns NULL if the index is invalid or if the cache is not available
+ * (i.e. in write mode), in which case the caller should build the style
+ * string itself.
+ **********************************************************************/
+const char *TABMAPFile::GetPenStyleStringRef(int nPenIndex)
+{
+    if (InitStyleStringCache() != 0 ||
+        nPenIndex < 0 || nPenIndex >= m_numPenStyleCache)
+        return NULL;
+
+    if (m_papszPenStyleCache[nPenIndex] == NULL)
+    {
+        ITABFeaturePen oPen;
+        ReadPenDef(nPenIndex, oPen.GetPenDefRef());
+        m_papszPenStyleCache[nPenIndex] = CPLStrdup(oPen.GetPenStyleString());
+    }
+
+    return m_papszPenStyleCache[nPenIndex];
+}
+
+/**********************************************************************
+ *                   TABMAPFile::GetBrushStyleStringRef()
+ *
+ * Return a reference to the cached OGR BRUSH() style string for the
+ * specified brush index.  See GetPenStyleStringRef().
+ **********************************************************************/
+const char *TABMAPFile::GetBrushStyleStringRef(int nBrushIndex)
+{
+    if (InitStyleStringCache() != 0 ||
+        nBrushIndex < 0 || nBrushIndex >= m_numBrushStyleCache)
+        return NULL;
+
+    if (m_papszBrushStyleCache[nBrushIndex] == NULL)
+    {
+        ITABFeatureBrush oBrush;
+        ReadBrushDef(nBrushIndex, oBrush.GetBrushDefRef());
+        m_papszBrushStyleCache[nBrushIndex] = 
+                                    CPLStrdup(oBrush.GetBrushStyleString());
+    }
+
+    return m_papszBrushStyleCache[nBrushIndex];
+}
+
+/**********************************************************************
+ *                   TABMAPFile::GetSymbolStyleStringRef()
+ *
+ * Return a reference to the cached OGR SYMBOL() style string for the
+ * specified symbol index (with no rotation angle).
+ * See GetPenStyleStringRef().
+ **********************************************************************/
+const char *TABMAPFile::GetSymbolStyleStringRef(int nSymbolIndex)
+{
+    if (InitStyleStringCache() != 0 ||
+        nSymbolIndex < 0 || nSymbolIndex >= m_numSymbolStyleCache)
+        return NULL;
+
+    if (m_papszSymbolStyleCache[nSymbolIndex] == NULL)
+    {
+        ITABFeatureSymbol oSymbol;
+        ReadSymbolDef(nSymbolIndex, oSymbol.GetSymbolDefRef());
+        m_papszSymbolStyleCache[nSymbolIndex] = 
+                                    CPLStrdup(oSymbol.GetSymbolStyleString());
+    }
+
+    return m_papszSymbolStyleCache[nSymbolIndex];
+}
+
+/**********************************************************************
+ *                   TABMAPFile::GetPenBrushStyleStringRef()
+ *
+ * Return a reference to the cached "BRUSH(...);PEN(...)" style string
+ * used by closed objects (regions, rectangles, ellipses) for the 
+ * specified pen and brush indexes.  See GetPenStyleStringRef().
+ **********************************************************************/
+const char *TABMAPFile::GetPenBrushStyleStringRef(int nPenIndex, 
+                                                  int nBrushIndex)
+{
+    const char *pszPen, *pszBrush;
+    char      **ppszStyle;
+
+    if ((pszPen = GetPenStyleStringRef(nPenIndex)) == NULL ||
+        (pszBrush = GetBrushStyleStringRef(nBrushIndex)) == NULL ||
+        m_papszPenBrushStyleCache == NULL)
+        return NULL;
+
+    ppszStyle = m_papszPenBrushStyleCache + 
+                                  nPenIndex * m_numBrushStyleCache + nBrushIndex;
+    if (*ppszStyle == NULL)
+        *ppszStyle = CPLStrdup(CPLSPrintf("%s;%s", pszBrush, pszPen));
+
+    return *ppszStyle;
+}
+
 #define ORDER_MIN_MAX(type,min,max)                                    \
     {   if( (max) < (min) )                                            \
           { type temp = (max); (max) = (min); (min) = temp; } }
@@ -81,6 +81,7 @@
  **********************************************************************/
 
 #include "mitab.h"
+#include "mitab_utils.h"
 
 /*=====================================================================
  *                      class MIDDATAFile
@@ -90,8 +91,16 @@
 MIDDATAFile::MIDDATAFile()
 {
     m_fp = NULL;
-    m_szLastRead[0] = '\0';
     m_szSavedLine[0] = '\0';
+
+    m_pabyReadBuf = NULL;
+    m_nReadBufSize = 0;
+    m_nReadBufLen = 0;
+    m_nReadBufPos = 0;
+    m_bReadBufAtEOF = FALSE;
+    m_pszLastRead = "";
+    m_papszFields = NULL;
+    m_nFieldsAlloc = 0;
     m_pszDelimiter = "\t"; // Encom 2003 (was NULL)
     
     m_dfXMultiplier = 1.0;
@@ -99,11 +108,19 @@ MIDDATAFile::MIDDATAFile()
     m_dfXDisplacement = 0.0;
     m_dfYDisplacement = 0.0;
 
+    m_panRecodeTable = NULL;
+    m_pszRecodeBuf = NULL;
+    m_nRecodeBufSize = 0;
+    m_pabyFieldSelection = NULL;
 }
 
 MIDDATAFile::~MIDDATAFile()
 {
     Close();
+
+    CPLFree(m_pszRecodeBuf);
+    CPLFree(m_pabyReadBuf);
+    CPLFree(m_papszFields);
 }
 
 void MIDDATAFile::SaveLine(const char *pszLine)
@@ -123,6 +140,41 @@ const char *MIDDATAFile::GetSavedLine()
     return m_szSavedLine;
 }
 
+/**********************************************************************
+ *                   MIDDATAFile::RecodeString()
+ *
+ * Recode a string value read from the file to UTF-8 if a recode table
+ * has been set with SetRecodeTable().  Pure ASCII strings, and all
+ * strings when there is no recode table, are returned as is.
+ *
+ * Returns either pszString or a reference to an internal buffer that
+ * is valid until the next call.
+ **********************************************************************/
+const char *MIDDATAFile::RecodeString(const char *pszString)
+{
+    const char *psz;
+    int         nLen;
+
+    if (m_panRecodeTable == NULL)
+        return pszString;
+
+    for(psz = pszString; *psz != '\0' && !(*psz & 0x80); psz++) {}
+    if (*psz == '\0')
+        return pszString;
+
+    nLen = strlen(pszString);
+    if (m_nRecodeBufSize < 3*nLen+1)
+    {
+        m_nRecodeBufSize = 3*nLen+1;
+        m_pszRecodeBuf = (char*)CPLRealloc(m_pszRecodeBuf, m_nRecodeBufSize);
+    }
+
+    CPLRecodeSingleByteToUTF8(pszString, nLen, m_panRecodeTable,
+                              m_pszRecodeBuf, m_nRecodeBufSize);
+
+    return m_pszRecodeBuf;
+}
+
 int MIDDATAFile::Open(const char *pszFname, const char *pszAccess)
 {
    if (m_fp)
@@ -174,6 +226,10 @@ int MIDDATAFile::Rewind()
     {
         VSIRewind(m_fp);
         SetEof(VSIFEof(m_fp));
+
+        m_nReadBufLen = m_nReadBufPos = 0;
+        m_bReadBufAtEOF = FALSE;
+        m_pszLastRead = "";
     }
     return 0;
 }
@@ -187,8 +243,10 @@ int MIDDATAFile::Close()
     VSIFClose(m_fp);
     m_fp = NULL;
 
-    // clear readline buffer.
-    CPLReadLine( NULL );
+    // Keep the read buffer for the next Open(), but forget its contents
+    m_nReadBufLen = m_nReadBufPos = 0;
+    m_bReadBufAtEOF = FALSE;
+    m_pszLastRead = "";
 
     CPLFree(m_pszFname);
     m_pszFname = NULL;
@@ -197,37 +255,125 @@ int MIDDATAFile::Close()
 
 }
 
+/**********************************************************************
+ *                   MIDDATAFile::FillReadBuffer()
+ *
+ * Move the unread data to the start of the read buffer (growing it if
+ * it is already full) and read as much as fits after it.
+ *
+ * Returns FALSE if no more data could be read.
+ **********************************************************************/
+GBool MIDDATAFile::FillReadBuffer()
+{
+    int nRead;
+
+    if (m_bReadBufAtEOF)
+        return FALSE;
+
+    if (m_nReadBufPos > 0)
+    {
+        m_nReadBufLen -= m_nReadBufPos;
+        memmove(m_pabyReadBuf, m_pabyReadBuf + m_nReadBufPos, m_nReadBufLen);
+        m_nReadBufPos = 0;
+    }
+
+    // Keep one extra byte to terminate the last line of the file
+    if (m_nReadBufLen >= m_nReadBufSize - 1)
+    {
+        m_nReadBufSize = (m_nReadBufSize == 0) ? 65536 : m_nReadBufSize * 2;
+        m_pabyReadBuf = (char *) CPLRealloc(m_pabyReadBuf, m_nReadBufSize);
+    }
+
+    nRead = VSIFRead(m_pabyReadBuf + m_nReadBufLen, 1, 
+                     m_nReadBufSize - 1 - m_nReadBufLen, m_fp);
+    if (nRead < m_nReadBufSize - 1 - m_nReadBufLen)
+        m_bReadBufAtEOF = TRUE;
+    m_nReadBufLen += nRead;
+
+    return nRead > 0;
+}
+
+/**********************************************************************
+ *                   MIDDATAFile::GetLine()
+ *
+ * Read the next line, stripped of its end of line (LF, CR+LF or CR)
+ * and of its leading spaces and tabs.
+ *
+ * The file is read in large chunks into a buffer, in which lines are
+ * located with memchr() and terminated in place, so the returned 
+ * string is only valid until the next call to GetLine() or Rewind().
+ *
+ * Returns NULL at end of file.  As when reading the file line by line
+ * with fgets(), GetEof() also becomes TRUE after reading a last line
+ * that has no end of line.
+ **********************************************************************/
 const char *MIDDATAFile::GetLine()
 {
-    const char *pszLine;
-    
-    if (m_eAccessMode == TABRead)
+    char       *pszLine, *pszEOL, *pszCR;
+    int         nAvail;
+
+    if (m_eAccessMode != TABRead)
     {
-        
-        pszLine = CPLReadLine(m_fp);
+        CPLAssert(FALSE);
+        return NULL;
+    }
 
-        SetEof(VSIFEof(m_fp));
+    while(TRUE)
+    {
+        pszLine = m_pabyReadBuf + m_nReadBufPos;
+        nAvail = m_nReadBufLen - m_nReadBufPos;
 
-        if (pszLine == NULL)
+        pszEOL = pszCR = NULL;
+        if (nAvail > 0)
         {
-            m_szLastRead[0] = '\0';
+            pszEOL = (char *) memchr(pszLine, '\n', nAvail);
+
+            // A CR alone (old MacOS convention) also ends a line.  If it
+            // is the last char read, wait for more data to check for LF.
+            pszCR = (char *) memchr(pszLine, '\r', 
+                                   pszEOL ? pszEOL - pszLine : nAvail);
+            if (pszCR != NULL && pszCR + 1 < pszLine + nAvail)
+                pszEOL = pszCR;
         }
-        else
+
+        if (pszEOL != NULL)
         {
-            // skip leading spaces
-            while(pszLine && (*pszLine == ' ' || *pszLine == '\t') )
-                pszLine++;
+            m_nReadBufPos = (int)(pszEOL - m_pabyReadBuf) + 1;
+            if (*pszEOL == '\r' && pszEOL[1] == '\n')
+                m_nReadBufPos++;
+            *pszEOL = '\0';
+            SetEof(FALSE);
+            break;
+        }
 
-            strncpy(m_szLastRead,pszLine,MIDMAXCHAR);
+        if (!FillReadBuffer())
+        {
+            // Last line, without end of line
+            pszLine = m_pabyReadBuf + m_nReadBufPos;
+            nAvail = m_nReadBufLen - m_nReadBufPos;
+
+            SetEof(TRUE);
+            if (nAvail == 0)
+            {
+                m_pszLastRead = "";
+                return NULL;
+            }
+
+            if (pszLine[nAvail-1] == '\r')
+                nAvail--;
+            pszLine[nAvail] = '\0';
+            m_nReadBufPos = m_nReadBufLen;
+            break;
         }
-        //if (pszLine)
-        //  printf("%s\n",pszLine);
-        return pszLine;
     }
-    else
-      CPLAssert(FALSE);
-    
-    return NULL;
+
+    // skip leading spaces
+    while(*pszLine == ' ' || *pszLine == '\t')
+        pszLine++;
+
+    m_pszLastRead = pszLine;
+
+    return pszLine;
 }
 
 const char *MIDDATAFile::GetLastLine()
@@ -239,8 +385,7 @@ const char *MIDDATAFile::GetLastLine()
     }
     else if (m_eAccessMode == TABRead)
     {
-        // printf("%s\n",m_szLastRead);
-        return m_szLastRead;
+        return m_pszLastRead;
     }
 
     // We should never get here (Read/Write mode not implemented)
@@ -248,6 +393,90 @@ const char *MIDDATAFile::GetLastLine()
     return NULL;
 }
 
+/**********************************************************************
+ *                   MIDDATAFile::SplitLastLine()
+ *
+ * Split the last line read into fields separated by the current
+ * delimiter (which may be more than one character, MITAB bug 1266).
+ * Delimiters inside double quotes are not field separators, the quotes
+ * are removed and "" inside quotes is unescaped to a single quote.
+ *
+ * The line is split in place in the read buffer, and the returned array
+ * of fields is owned by this object: both are valid until the next call
+ * to GetLine() or Rewind().  A blank line is returned as one empty field.
+ *
+ * Returns NULL at EOF.
+ **********************************************************************/
+char **MIDDATAFile::SplitLastLine(int *pnFields)
+{
+    char        *pszSrc, *pszDst;
+    const char  *pszDelim = m_pszDelimiter;
+    int         nDelimLen = strlen(pszDelim);
+    int         nFields = 0;
+    GBool       bInQuotes = FALSE;
+
+    *pnFields = 0;
+
+    if (GetLastLine() == NULL)
+        return NULL;
+
+    if (m_nFieldsAlloc == 0)
+    {
+        m_nFieldsAlloc = 32;
+        m_papszFields = (char**)CPLMalloc(m_nFieldsAlloc*sizeof(char*));
+    }
+
+    // A non-empty last line always points into our own read buffer.
+    // Fields can only shrink, so they are written back over the line.
+    pszSrc = pszDst = (char*)m_pszLastRead;
+    m_papszFields[nFields++] = pszDst;
+
+    if (*pszSrc == '\0')
+    {
+        *pnFields = nFields;
+        return m_papszFields;
+    }
+
+    while(*pszSrc != '\0')
+    {
+        if (*pszSrc == '"')
+        {
+            if (bInQuotes && pszSrc[1] == '"')
+            {
+                *pszDst++ = '"';
+                pszSrc += 2;
+            }
+            else
+            {
+                bInQuotes = !bInQuotes;
+                pszSrc++;
+            }
+        }
+        else if (!bInQuotes && *pszSrc == *pszDelim &&
+                 strncmp(pszSrc, pszDelim, nDelimLen) == 0)
+        {
+            *pszDst++ = '\0';
+            pszSrc += nDelimLen;
+
+            if (nFields == m_nFieldsAlloc)
+            {
+                m_nFieldsAlloc *= 2;
+                m_papszFields = (char**)CPLRealloc(m_papszFields,
+                                                m_nFieldsAlloc*sizeof(char*));
+            }
+            m_papszFields[nFields++] = pszDst;
+        }
+        else
+        {
+            *pszDst++ = *pszSrc++;
+        }
+    }
+    *pszDst = '\0';
+
+    *pnFields = nFields;
+    return m_papszFields;
+}
+
 void MIDDATAFile::WriteLine(const char *pszFormat,...)
 {
     va_list args;
@@ -288,30 +517,22 @@ double MIDDATAFile::GetYTrans(double dfY)
 
 GBool MIDDATAFile::IsValidFeature(const char *pszString)
 {
-    char **papszToken ;
-
-    papszToken = CSLTokenizeString(pszString);
-    
-    //   printf("%s\n",pszString);
+    TABToken    sToken;
 
-    if (CSLCount(papszToken) == 0)
-    {
-        CSLDestroy(papszToken);
+    // Only the first token matters
+    if (TABTokenizeLine(pszString, " ", &sToken, 1) == 0)
         return FALSE;
-    }
 
-    if (EQUAL(papszToken[0],"NONE")      || EQUAL(papszToken[0],"POINT") ||
-        EQUAL(papszToken[0],"LINE")      || EQUAL(papszToken[0],"PLINE") ||
-        EQUAL(papszToken[0],"REGION")    || EQUAL(papszToken[0],"ARC") ||
-        EQUAL(papszToken[0],"TEXT")      || EQUAL(papszToken[0],"RECT") ||
-        EQUAL(papszToken[0],"ROUNDRECT") || EQUAL(papszToken[0],"ELLIPSE") ||
-        EQUAL(papszToken[0],"MULTIPOINT")|| EQUAL(papszToken[0],"COLLECTION") )
+    if (TABTokenEQUAL(&sToken,"NONE")      || TABTokenEQUAL(&sToken,"POINT") ||
+        TABTokenEQUAL(&sToken,"LINE")      || TABTokenEQUAL(&sToken,"PLINE") ||
+        TABTokenEQUAL(&sToken,"REGION")    || TABTokenEQUAL(&sToken,"ARC") ||
+        TABTokenEQUAL(&sToken,"TEXT")      || TABTokenEQUAL(&sToken,"RECT") ||
+        TABTokenEQUAL(&sToken,"ROUNDRECT") || TABTokenEQUAL(&sToken,"ELLIPSE") ||
+        TABTokenEQUAL(&sToken,"MULTIPOINT")||TABTokenEQUAL(&sToken,"COLLECTION"))
     {
-        CSLDestroy(papszToken);
         return TRUE;
     }
 
-    CSLDestroy(papszToken);
     return FALSE;
 
 }
@@ -229,6 +229,7 @@ MIFFile::MIFFile()
 
     m_poMIDFile = NULL;
     m_poMIFFile = NULL;
+    m_pabySelectedFields = NULL;
     m_nPreloadedId = 0;
 
     m_poDefn = NULL;
@@ -436,6 +437,9 @@ int MIFFile::Open(const char *pszFname, const char *pszAccess,
     m_poMIFFile->SetDelimiter(m_pszDelimiter);
     m_poMIDFile->SetDelimiter(m_pszDelimiter);
 
+    if (m_eAccessMode == TABRead)
+        m_poMIDFile->SetRecodeTable(GetReadRecodeTable());
+
     /*-------------------------------------------------------------
      * Set geometry type if the geometry objects are uniform.
      *------------------------------------------------------------*/
@@ -859,7 +863,8 @@ void MIFFile::ResetReading()
 
 void MIFFile::PreParseFile()
 {
-    char **papszToken = NULL;
+    TABToken    asToken[TAB_MAX_MIF_TOKENS];
+    int         nTokens;
     const char *pszLine;
     
     GBool bPLine = FALSE;
@@ -885,16 +890,16 @@ void MIFFile::PreParseFile()
             m_nFeatureCount++;
         }
 
-        CSLDestroy(papszToken);
-        papszToken = CSLTokenizeString2(pszLine, " \t", CSLT_HONOURSTRINGS);
+        nTokens = TABTokenizeLine(pszLine, " \t", 
+                                  asToken, TAB_MAX_MIF_TOKENS);
 
         if (EQUALN(pszLine,"POINT",5))
         {
             m_nPoints++;
-            if (CSLCount(papszToken) == 3)
+            if (nTokens == 3)
             {
-                UpdateExtents(m_poMIFFile->GetXTrans(atof(papszToken[1])),
-                             m_poMIFFile->GetYTrans(atof(papszToken[2])));
+                UpdateExtents(m_poMIFFile->GetXTrans(TABAtof(asToken[1].pszStart)),
+                             m_poMIFFile->GetYTrans(TABAtof(asToken[2].pszStart)));
             }
               
         }
@@ -904,13 +909,13 @@ void MIFFile::PreParseFile()
                  EQUALN(pszLine,"ARC",3) ||
                  EQUALN(pszLine,"ELLIPSE",7))
         {
-            if (CSLCount(papszToken) == 5)
+            if (nTokens == 5)
             {
                 m_nLines++;
-                UpdateExtents(m_poMIFFile->GetXTrans(atof(papszToken[1])), 
-                             m_poMIFFile->GetYTrans(atof(papszToken[2])));
-                UpdateExtents(m_poMIFFile->GetXTrans(atof(papszToken[3])), 
-                             m_poMIFFile->GetYTrans(atof(papszToken[4])));
+                UpdateExtents(m_poMIFFile->GetXTrans(TABAtof(asToken[1].pszStart)), 
+                             m_poMIFFile->GetYTrans(TABAtof(asToken[2].pszStart)));
+                UpdateExtents(m_poMIFFile->GetXTrans(TABAtof(asToken[3].pszStart)), 
+                             m_poMIFFile->GetYTrans(TABAtof(asToken[4].pszStart)));
             }
         }
         else if (EQUALN(pszLine,"REGION",6) )
@@ -930,29 +935,27 @@ void MIFFile::PreParseFile()
         }
         else if (bPLine == TRUE)
         {
-            if (CSLCount(papszToken) == 2 &&
-                strchr("-.0123456789", papszToken[0][0]) != NULL)
+            if (nTokens == 2 &&
+                strchr("-.0123456789", asToken[0].pszStart[0]) != NULL)
             {
-                UpdateExtents( m_poMIFFile->GetXTrans(atof(papszToken[0])),
-                              m_poMIFFile->GetYTrans(atof(papszToken[1])));
+                UpdateExtents( m_poMIFFile->GetXTrans(TABAtof(asToken[0].pszStart)),
+                              m_poMIFFile->GetYTrans(TABAtof(asToken[1].pszStart)));
             }
         }
         else if (bText == TRUE)
         {
-           if (CSLCount(papszToken) == 4 &&
-                strchr("-.0123456789", papszToken[0][0]) != NULL)
+           if (nTokens == 4 &&
+                strchr("-.0123456789", asToken[0].pszStart[0]) != NULL)
             {
-                UpdateExtents(m_poMIFFile->GetXTrans(atof(papszToken[0])),
-                             m_poMIFFile->GetYTrans(atof(papszToken[1])));
-                UpdateExtents(m_poMIFFile->GetXTrans(atof(papszToken[2])),
-                             m_poMIFFile->GetYTrans(atof(papszToken[3])));
+                UpdateExtents(m_poMIFFile->GetXTrans(TABAtof(asToken[0].pszStart)),
+                             m_poMIFFile->GetYTrans(TABAtof(asToken[1].pszStart)));
+                UpdateExtents(m_poMIFFile->GetXTrans(TABAtof(asToken[2].pszStart)),
+                             m_poMIFFile->GetYTrans(TABAtof(asToken[3].pszStart)));
             } 
         }
         
       }
 
-    CSLDestroy(papszToken);
-    
     m_poMIFFile->Rewind();
 
     while ((pszLine = m_poMIFFile->GetLine()) != NULL)
@@ -1189,6 +1192,9 @@ int MIFFile::Close()
     CPLFree(m_paeFieldType);
     m_paeFieldType = NULL;
 
+    CPLFree(m_pabySelectedFields);
+    m_pabySelectedFields = NULL;
+
     m_nCurFeatureId = 0;
     m_nPreloadedId = 0;
     m_nFeatureCount =0;
@@ -1339,12 +1345,13 @@ TABFeature *MIFFile::GetFeatureRef(int nFeatureId)
         else if (EQUALN(pszLine,"POINT",5))
         {
             // Special case, we need to know two lines to decide the type
-            char **papszToken;
-            papszToken = CSLTokenizeString2(pszLine, " \t", CSLT_HONOURSTRINGS);
+            TABToken    asToken[TAB_MAX_MIF_TOKENS];
+            int         nTokens;
+            nTokens = TABTokenizeLine(pszLine, " \t", 
+                                      asToken, TAB_MAX_MIF_TOKENS);
             
-            if (CSLCount(papszToken) !=3)
+            if (nTokens !=3)
             {
-                CSLDestroy(papszToken);
                 CPLError(CE_Failure, CPLE_NotSupported,
                          "GetFeatureRef() failed: invalid point line: '%s'",
                          pszLine);
@@ -1355,12 +1362,11 @@ TABFeature *MIFFile::GetFeatureRef(int nFeatureId)
 
             if ((pszLine = m_poMIFFile->GetLine()) != NULL)
             {
-                CSLDestroy(papszToken);
-                papszToken = CSLTokenizeStringComplex(pszLine," ,()\t",
-                                                      TRUE,FALSE);
-                if (CSLCount(papszToken)> 0 &&EQUALN(papszToken[0],"SYMBOL",6))
+                nTokens = TABTokenizeLine(pszLine, " ,()\t", 
+                                          asToken, TAB_MAX_MIF_TOKENS);
+                if (nTokens> 0 &&EQUALN(asToken[0].pszStart,"SYMBOL",6))
                 {
-                    switch (CSLCount(papszToken))
+                    switch (nTokens)
                     {
                       case 4:
                         m_poCurFeature = new TABPoint(m_poDefn);
@@ -1372,7 +1378,6 @@ TABFeature *MIFFile::GetFeatureRef(int nFeatureId)
                         m_poCurFeature = new TABCustomPoint(m_poDefn);
                         break;
                       default:
-                        CSLDestroy(papszToken);
                         CPLError(CE_Failure, CPLE_NotSupported,
                                  "GetFeatureRef() failed: invalid symbol "
                                  "line: '%s'", pszLine);
@@ -1382,7 +1387,6 @@ TABFeature *MIFFile::GetFeatureRef(int nFeatureId)
 
                 }
             }
-            CSLDestroy(papszToken);
 
             if (m_poCurFeature == NULL)
             {
@@ -1931,6 +1935,60 @@ TABFieldType MIFFile::GetNativeFieldType(int nFieldId)
     return m_paeFieldType[nFieldId];
 }
 
+/**********************************************************************
+ *                   MIFFile::SetSelectedFields()
+ *
+ * Restrict the attributes read from the .MID file to the named fields,
+ * or read all fields again if papszFieldNames is NULL.  The values of
+ * the other fields are not converted and are left unset in the
+ * features returned by GetFeatureRef().
+ *
+ * Valid only in read mode, after the file has been opened.
+ *
+ * Returns 0 on success, -1 on error.
+ **********************************************************************/
+int MIFFile::SetSelectedFields(char **papszFieldNames)
+{
+    int i, nField;
+
+    if (m_eAccessMode != TABRead || m_poDefn == NULL || m_poMIDFile == NULL)
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "SetSelectedFields() can be used only with Read access "
+                 "on an opened file.");
+        return -1;
+    }
+
+    CPLFree(m_pabySelectedFields);
+    m_pabySelectedFields = NULL;
+
+    if (papszFieldNames != NULL)
+    {
+        m_pabySelectedFields = (GByte*)CPLCalloc(
+                                   MAX(m_poDefn->GetFieldCount(), 1), 1);
+
+        for(i=0; papszFieldNames[i] != NULL; i++)
+        {
+            nField = m_poDefn->GetFieldIndex(papszFieldNames[i]);
+            if (nField < 0)
+            {
+                CPLError(CE_Failure, CPLE_IllegalArg,
+                         "SetSelectedFields(): Field '%s' not found in %s.",
+                         papszFieldNames[i], m_pszFname);
+                CPLFree(m_pabySelectedFields);
+                m_pabySelectedFields = NULL;
+                m_poMIDFile->SetFieldSelection(NULL);
+                return -1;
+            }
+            m_pabySelectedFields[nField] = TRUE;
+        }
+    }
+
+    m_poMIDFile->SetFieldSelection(m_pabySelectedFields);
+
+    return 0;
+}
+
 /************************************************************************
  *                       MIFFile::SetFieldIndexed()
  ************************************************************************/
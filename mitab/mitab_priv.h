@@ -181,6 +181,7 @@
 
 #include "cpl_conv.h"
 #include "cpl_string.h"
+#include "cpl_async_reader.h"
 #include "ogr_feature.h"
 
 class TABFile;
@@ -316,6 +317,62 @@ typedef struct TABDATFieldDef_t
     TABFieldType eTABType;
 } TABDATFieldDef;
 
+/*---------------------------------------------------------------------
+ * TABDATScanCond
+ *
+ * A simple "field <op> constant" predicate that TABDATFile::ScanRecords()
+ * evaluates directly against the raw .DAT records.  Numeric fields
+ * compare against dValue (or padfValues[] for TABScanIN), Char and Date
+ * fields compare against pszValue (a NUL-separated list terminated by an
+ * empty string for TABScanIN).  Date values are compared in the same
+ * "YYYYMMDD" string form returned by TABDATFile::ReadDateField().
+ *--------------------------------------------------------------------*/
+typedef enum
+{
+    TABScanEQ = 0,
+    TABScanNE,
+    TABScanLT,
+    TABScanLE,
+    TABScanGT,
+    TABScanGE,
+    TABScanIN
+} TABScanOp;
+
+typedef struct TABDATScanCond_t
+{
+    int         nFieldId;
+    TABScanOp   eOp;
+    double      dValue;
+    int         numValues;
+    double      *padfValues;
+    const char  *pszValue;
+} TABDATScanCond;
+
+/*---------------------------------------------------------------------
+ * FID bitmaps: one bit per feature id (bit 0 unused), packed in GUInt32
+ * words so that runs of non-matching ids can be skipped a word at a time.
+ *--------------------------------------------------------------------*/
+#define TAB_FIDBITMAP_WORDS(nMaxId) (((nMaxId) >> 5) + 1)
+#define TAB_FIDBITMAP_TEST(panBitmap, nId) \
+    (((panBitmap)[(nId) >> 5] >> ((nId) & 31)) & 1)
+#define TAB_FIDBITMAP_SET(panBitmap, nId) \
+    ((panBitmap)[(nId) >> 5] |= ((GUInt32)1 << ((nId) & 31)))
+#define TAB_FIDBITMAP_CLEAR(panBitmap, nId) \
+    ((panBitmap)[(nId) >> 5] &= ~((GUInt32)1 << ((nId) & 31)))
+
+/*---------------------------------------------------------------------
+ * TABMAPAsyncBlock
+ * Buffer for an index or object block read ahead asynchronously during
+ * a spatial index traversal (see TABMAPFile::PrefetchAhead()).
+ *--------------------------------------------------------------------*/
+typedef struct TABMAPAsyncBlock_t
+{
+    GInt32      nOffset;        /* -1 if the buffer is free */
+    GBool       bDone;
+    int         nBytesRead;
+    GByte       abyData[512];
+} TABMAPAsyncBlock;
+
 /*---------------------------------------------------------------------
  * TABMAPCoordSecHdr
  * struct used in the TABMAPCoordBlock to store info about the coordinates
@@ -421,6 +478,19 @@ typedef struct TABSymbolDef_t
 /* MI Default = SYMBOL(35,0,12) */
 #define MITAB_SYMBOL_DEFAULT {0, 35, 12, 0, 0x000000}
 
+/*---------------------------------------------------------------------
+ * TABToolDefIndex - Hash index on the tool defs of a TABToolDefTable
+ *
+ * Open addressing table of 1-based tool def indexes (0 = empty slot)
+ * used to find existing tool defs in constant time when writing.
+ *--------------------------------------------------------------------*/
+typedef struct TABToolDefIndex_t
+{
+    int         nSize;          /* Number of slots, a power of 2       */
+    int         numIndexed;     /* Number of tool defs in the index    */
+    int         *panSlots;
+} TABToolDefIndex;
+
 /*---------------------------------------------------------------------
  *                      class TABToolDefTable
  *
@@ -446,6 +516,11 @@ class TABToolDefTable
     int         m_numSymbols;
     int         m_numAllocatedSymbols;
 
+    TABToolDefIndex m_sPenIndex;
+    TABToolDefIndex m_sBrushIndex;
+    TABToolDefIndex m_sFontIndex;
+    TABToolDefIndex m_sSymbolIndex;
+
   public:
     TABToolDefTable();
     ~TABToolDefTable();
@@ -1323,6 +1398,10 @@ class TABMAPFile
 
     TABMAPHeaderBlock   *m_poHeader;
 
+    // TRUE if m_poHeader and m_poToolDefTable belong to another
+    // TABMAPFile (see OpenReadCursor())
+    GBool       m_bSharedHeader;
+
     // Members used to access objects using the spatial index
     TABMAPIndexBlock  *m_poSpIndex;
 
@@ -1342,6 +1421,16 @@ class TABMAPFile
     // Drawing Tool Def. table (takes care of all drawing tools in memory)
     TABToolDefTable *m_poToolDefTable;
 
+    // OGR style strings formatted for each tool def index (and for each
+    // pen+brush combination), built on demand and shared by all features
+    char        **m_papszPenStyleCache;
+    char        **m_papszBrushStyleCache;
+    char        **m_papszSymbolStyleCache;
+    char        **m_papszPenBrushStyleCache;
+    int         m_numPenStyleCache;
+    int         m_numBrushStyleCache;
+    int         m_numSymbolStyleCache;
+
     // Coordinates filter... default is MBR of the whole file
     TABVertex   m_sMinFilter;
     TABVertex   m_sMaxFilter;
@@ -1364,6 +1453,8 @@ class TABMAPFile
 
     int         InitDrawingTools();
     int         CommitDrawingTools();
+    int         InitStyleStringCache();
+    void        ResetStyleStringCache();
 
     int         CommitSpatialIndex();
 
@@ -1372,6 +1463,23 @@ class TABMAPFile
 
     int         LoadNextMatchingObjectBlock(int bFirstObject);
     TABRawBinBlock *PushBlock( int nFileOffset );
+
+    // Read-ahead hints given during the spatial traversal
+    int         m_nPrefetchBlocks;
+    GInt32      m_nPrefetchLeafPtr;
+    int         m_iPrefetchEntry;
+
+    void        PrefetchAhead();
+
+    // Asynchronous reads of the next blocks, when io_uring is available
+    CPLAsyncReader   *m_psAsyncReader;
+    TABMAPAsyncBlock *m_pasAsyncBlocks;
+    int         m_numAsyncBlocks;
+
+    void        InitAsyncReader();
+    GBool       SubmitAsyncBlock(GInt32 nOffset);
+    TABMAPAsyncBlock *WaitAsyncBlock(GInt32 nOffset);
+    void        DrainAsyncReader();
     
   public:
     TABMAPFile();
@@ -1379,8 +1487,11 @@ class TABMAPFile
 
     int         Open(const char *pszFname, const char *pszAccess,
                      GBool bNoErrorMsg = FALSE );
+    int         OpenReadCursor(TABMAPFile *poSrcFile);
     int         Close();
 
+    const char  *GetFname() { return m_pszFname; }
+
     int         SetQuickSpatialIndexMode(GBool bQuickSpatialIndexMode = TRUE);
 
     int         Int2Coordsys(GInt32 nX, GInt32 nY, double &dX, double &dY);
@@ -1423,6 +1534,11 @@ class TABMAPFile
     int         WriteFontDef(TABFontDef *psDef);
     int         WriteSymbolDef(TABSymbolDef *psDef);
 
+    const char *GetPenStyleStringRef(int nPenIndex);
+    const char *GetBrushStyleStringRef(int nBrushIndex);
+    const char *GetSymbolStyleStringRef(int nSymbolIndex);
+    const char *GetPenBrushStyleStringRef(int nPenIndex, int nBrushIndex);
+
     int         GetMinTABFileVersion();
 
 #ifdef DEBUG
@@ -1439,6 +1555,45 @@ class TABMAPFile
 
 
 
+/*---------------------------------------------------------------------
+ * TABINDPinnedNode
+ * In read access, the upper (non-leaf) levels of an index tree are kept
+ * in memory once they have been read, so that a point lookup only has to
+ * read the leaf block from the file.  The pinned nodes are owned by the
+ * root node of each index.
+ *--------------------------------------------------------------------*/
+#define TAB_IND_MAX_PINNED_NODES 4096
+
+typedef struct TABINDPinnedNode_t
+{
+    GInt32      nBlockPtr;
+    int         numEntries;
+    GInt32      nPrevNodePtr;
+    GInt32      nNextNodePtr;
+    GByte       abyEntries[512-12];
+} TABINDPinnedNode;
+
+/*---------------------------------------------------------------------
+ * TABINDBulkBuild
+ * (key, record no) pairs collected for an index created in this session.
+ * The tree is built bottom-up from the sorted pairs when the file is
+ * closed.  Sorted runs that do not fit in TAB_IND_BULK_BUFFER_SIZE bytes
+ * are spilled to a temporary file and merged at build time.
+ *--------------------------------------------------------------------*/
+#define TAB_IND_BULK_BUFFER_SIZE (4*1024*1024)
+
+typedef struct TABINDBulkBuild_t
+{
+    int         nEntrySize;     // key length + 4 bytes for the record no
+    GByte      *pabyEntries;
+    int         numEntries;
+    int         nMaxEntries;
+    char       *pszTmpFname;
+    FILE       *fpTmp;
+    int         numRuns;
+    int        *panRunEntries;
+} TABINDBulkBuild;
+
 /*---------------------------------------------------------------------
  *                      class TABINDNode
  *
@@ -1470,9 +1625,19 @@ class TABINDNode
     GInt32      m_nPrevNodePtr;
     GInt32      m_nNextNodePtr;
 
+    // Pinned upper levels (read access only, owned by the root node)
+    TABINDPinnedNode **m_papsPinnedNodes;
+    int         m_numPinnedNodes;
+    const GByte *m_pabyPinnedEntries;
+
     int         GotoNodePtr(GInt32 nNewNodePtr);
     GInt32      ReadIndexEntry(int nEntryNo, GByte *pKeyValue);
-    int         IndexKeyCmp(GByte *pKeyValue, int nEntryNo);
+    int         IndexKeyCmp(GByte *pKeyValue, int nEntryNo, 
+                            int nCmpLength=0);
+    int         GotoChildNode(GInt32 nChildNodePtr);
+    int         FindFirstKeyGE(GByte *pKeyValue, int *pnCmpStatus);
+    TABINDPinnedNode *GetPinnedNode(GInt32 nBlockPtr);
+    TABINDPinnedNode *PinCurrentNode();
 
     int         InsertEntry(GByte *pKeyValue, GInt32 nRecordNo,
                             GBool bInsertAfterCurChild=FALSE,
@@ -1505,6 +1670,9 @@ class TABINDNode
 
     GInt32      FindFirst(GByte *pKeyValue);
     GInt32      FindNext(GByte *pKeyValue);
+    GInt32      FindFirstInRange(GByte *pMinKey, 
+                                 GByte *pMaxKey, int nMaxKeyLength);
+    GInt32      FindNextInRange(GByte *pMaxKey, int nMaxKeyLength);
 
     int         CommitToFile();
 
@@ -1551,11 +1719,20 @@ class TABINDFile
     int         m_numIndexes;
     TABINDNode  **m_papoIndexRootNodes;
     GByte       **m_papbyKeyBuffers;
+    GByte       **m_papbyRangeMaxKeys;
+    int         *m_panRangeMaxKeyLength;
+    TABINDBulkBuild **m_papsBulkBuilds;
 
     int         ValidateIndexNo(int nIndexNumber);
     int         ReadHeader();
     int         WriteHeader();
 
+    int         BulkAddEntry(int nIndexNumber, GByte *pKeyValue, 
+                             GInt32 nRecordNo);
+    int         BulkSpillRun(TABINDBulkBuild *psBuild);
+    int         BuildBulkIndex(int nIndexNumber);
+    void        FreeBulkBuild(int nIndexNumber);
+
    public:
     TABINDFile();
     ~TABINDFile();
@@ -1565,6 +1742,7 @@ class TABINDFile
     int         Close();
 
     int         GetNumIndexes() {return m_numIndexes;};
+    int         GetKeyLength(int nIndexNumber);
     int         SetIndexFieldType(int nIndexNumber, TABFieldType eType);
     int         SetIndexUnique(int nIndexNumber, GBool bUnique=TRUE);
     GByte      *BuildKey(int nIndexNumber, GInt32 nValue);
@@ -1572,6 +1750,9 @@ class TABINDFile
     GByte      *BuildKey(int nIndexNumber, double dValue);
     GInt32      FindFirst(int nIndexNumber, GByte *pKeyValue);
     GInt32      FindNext(int nIndexNumber, GByte *pKeyValue);
+    GInt32      FindFirstInRange(int nIndexNumber, GByte *pMinKey,
+                                 GByte *pMaxKey, int nMaxKeyLength=0);
+    GInt32      FindNextInRange(int nIndexNumber);
 
     int         CreateIndex(TABFieldType eType, int nFieldSize);
     int         AddEntry(int nIndexNumber, GByte *pKeyValue, GInt32 nRecordNo);
@@ -1614,10 +1795,15 @@ class TABDATFile
 
     int         InitWriteHeader();
     int         WriteHeader();
+    int         ReadRecordChunk(int nFirstRecordId, int numRecords,
+                                GByte *pabyBuf);
 
 	// We know that character strings are limited to 254 chars in MapInfo
+	// (up to 3 times more once recoded to UTF-8)
 	// Using a buffer pr. class instance to avoid threading issues with the library
-	char		m_szBuffer[256];
+	char		m_szBuffer[3*256];
+
+    const unsigned short *m_panRecodeTable; // Recode char fields to UTF-8
 
    public:
     TABDATFile();
@@ -1625,6 +1811,7 @@ class TABDATFile
 
     int         Open(const char *pszFname, const char *pszAccess,
                      TABTableType eTableType =TABTableNative);
+    int         OpenReadCursor(TABDATFile *poSrcFile);
     int         Close();
 
     int         GetNumFields();
@@ -1643,6 +1830,14 @@ class TABDATFile
     GBool       IsCurrentRecordDeleted() { return m_bCurRecordDeletedFlag;};
     int         CommitRecordToFile();
 
+    GUInt32     *ScanRecords(int numConds, const TABDATScanCond *pasConds);
+    GUInt32     *BuildActiveRecordBitmap();
+
+    const char  *GetFname() { return m_pszFname; }
+
+    void        SetRecodeTable(const unsigned short *panTable)
+                                          { m_panRecodeTable = panTable; }
+
     const char  *ReadCharField(int nWidth);
     GInt32      ReadIntegerField(int nWidth);
     GInt16      ReadSmallIntField(int nWidth);
@@ -1774,6 +1969,11 @@ class TABRelation
  *
  * Class to handle a file pointer with a copy of the latest readed line
  *
+ * In read mode the file is read in large chunks, and the lines returned
+ * by GetLine()/GetLastLine() point directly into the read buffer: they
+ * are only valid until the next call to GetLine() or Rewind().
+ * SplitLastLine() splits the last line in place, after which the line
+ * itself should not be used anymore.
  *--------------------------------------------------------------------*/
 
 class MIDDATAFile
@@ -1792,6 +1992,7 @@ class MIDDATAFile
      const char *GetSavedLine();
      void WriteLine(const char*, ...);
      GBool IsValidFeature(const char *pszString);
+     char **SplitLastLine(int *pnFields);
 
 //  Translation information
      void SetTranslation(double, double, double, double);
@@ -1804,13 +2005,36 @@ class MIDDATAFile
      void SetEof(GBool bEof);
      GBool GetEof();
 
+     void SetRecodeTable(const unsigned short *panTable)
+                                          { m_panRecodeTable = panTable; }
+     const char *RecodeString(const char *pszString);
+
+     void SetFieldSelection(const GByte *pabySelected)
+                                          { m_pabyFieldSelection = pabySelected; }
+     GBool IsFieldSelected(int nField)
+                { return m_pabyFieldSelection == NULL ||
+                         m_pabyFieldSelection[nField]; }
+
      private:
        FILE *m_fp;
        const char *m_pszDelimiter;
 
-       // Set limit for the length of a line
+       GBool       FillReadBuffer();
+
+       // Read buffer, see GetLine()
+       char        *m_pabyReadBuf;
+       int         m_nReadBufSize;
+       int         m_nReadBufLen;          // Bytes of data in buffer
+       int         m_nReadBufPos;          // Start of next line
+       GBool       m_bReadBufAtEOF;        // No more data in file
+       const char  *m_pszLastRead;
+
+       // Field pointers into the last line, see SplitLastLine()
+       char        **m_papszFields;
+       int         m_nFieldsAlloc;
+
+       // Set limit for the length of a saved line
 #define MIDMAXCHAR 10000
-       char m_szLastRead[MIDMAXCHAR];
        char m_szSavedLine[MIDMAXCHAR];
 
        char        *m_pszFname;
@@ -1820,6 +2044,12 @@ class MIDDATAFile
        double      m_dfXDisplacement;
        double      m_dfYDisplacement;
        GBool       m_bEof;
+
+       const unsigned short *m_panRecodeTable; // Recode strings to UTF-8
+       char        *m_pszRecodeBuf;
+       int         m_nRecodeBufSize;
+
+       const GByte *m_pabyFieldSelection;  // NULL to read all fields
 };
 
 
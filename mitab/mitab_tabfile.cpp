@@ -102,6 +102,8 @@
 #include "mitab.h"
 #include "mitab_utils.h"
 #include "cpl_minixml.h"
+#include "cpl_multiproc.h"
+#include "swq.h"
 
 #include <ctype.h>      /* isspace() */
 
@@ -137,6 +139,14 @@ TABFile::TABFile()
 
     m_panMatchingFIDs = NULL; 
     m_iMatchingFID = 0; 
+    m_bMatchingFIDsTried = FALSE;
+
+    m_panMatchingFIDBitmap = NULL;
+    m_bMatchingFIDBitmapTried = FALSE;
+
+    m_panLiveFIDBitmap = NULL;
+    m_nLiveFeatureCount = 0;
+    m_bLiveFIDBitmapTried = FALSE;
 }
 
 /**********************************************************************
@@ -156,12 +166,147 @@ TABFile::~TABFile()
 int TABFile::GetFeatureCount (int bForce)
 {
     
-    if( m_poFilterGeom != NULL || m_poAttrQuery != NULL || bForce)
+    if( m_poFilterGeom != NULL )
+        return OGRLayer::GetFeatureCount( bForce );
+
+    if( m_poAttrQuery != NULL )
+    {
+        int nCount = GetIndexedFeatureCount( bForce );
+
+        if( nCount >= 0 )
+            return nCount;
+
+        return OGRLayer::GetFeatureCount( bForce );
+    }
+
+    /* -------------------------------------------------------------------- */
+    /*      Without filters, the exact count is the number of live          */
+    /*      features.  Build the live FID bitmap only when forced to,       */
+    /*      otherwise the last feature id is a good enough estimate.        */
+    /* -------------------------------------------------------------------- */
+    if( m_panLiveFIDBitmap == NULL && bForce && !m_bLiveFIDBitmapTried )
+        BuildLiveFIDBitmap();
+
+    if( m_panLiveFIDBitmap != NULL )
+        return m_nLiveFeatureCount;
+    else if( bForce )
         return OGRLayer::GetFeatureCount( bForce );
     else
         return m_nLastFeatureId;
 }
 
+/**********************************************************************
+ *                   TABFile::GetIndexedFeatureCount()
+ *
+ * (private method)
+ * Count the features matching the attribute query using the .IND file.
+ *
+ * When the index resolves the query exactly, the count is the number of
+ * live features in the index matches: neither the .DAT records nor the
+ * geometries are read.  Otherwise, if bForce is TRUE, only the .DAT
+ * record of each candidate is read to evaluate the query.
+ *
+ * Returns -1 if the count cannot be computed this way.
+ **********************************************************************/
+int TABFile::GetIndexedFeatureCount(int bForce)
+{
+    long        *panFIDs;
+    int         i, bExact = FALSE, nCount = 0;
+
+    if (m_eAccessMode != TABRead || m_poAttrQuery == NULL)
+        return -1;
+
+    panFIDs = m_poAttrQuery->EvaluateAgainstIndices(this, NULL, &bExact);
+    if (panFIDs == NULL)
+        return -1;
+
+    /*-----------------------------------------------------------------
+     * Candidates have to be checked against the query: the feature 
+     * built from the .DAT record has no geometry, so this works only
+     * if the query uses no special field other than FID.
+     *----------------------------------------------------------------*/
+    if (!bExact)
+    {
+        char **papszFields = bForce ? m_poAttrQuery->GetUsedFields() : NULL;
+        GBool bAttributesOnly = (papszFields != NULL);
+
+        for(i=0; papszFields && papszFields[i]; i++)
+        {
+            if (m_poDefn->GetFieldIndex(papszFields[i]) < 0 &&
+                !EQUAL(papszFields[i], "FID"))
+                bAttributesOnly = FALSE;
+        }
+        CSLDestroy(papszFields);
+
+        if (!bAttributesOnly)
+        {
+            CPLFree(panFIDs);
+            return -1;
+        }
+    }
+
+    if (m_panLiveFIDBitmap == NULL && !m_bLiveFIDBitmapTried)
+        BuildLiveFIDBitmap();
+
+    TABFeature oFeature(m_poDefn);
+
+    for(i=0; panFIDs[i] != OGRNullFID; i++)
+    {
+        int nFeatureId = panFIDs[i] + 1;
+
+        if (nFeatureId <= 0 || nFeatureId > m_nLastFeatureId)
+            continue;
+
+        if (m_panLiveFIDBitmap != NULL)
+        {
+            if (!TAB_FIDBITMAP_TEST(m_panLiveFIDBitmap, nFeatureId))
+                continue;
+            if (bExact)
+            {
+                nCount++;
+                continue;
+            }
+        }
+
+        /*-------------------------------------------------------------
+         * Without the live FID bitmap, deleted records are found in
+         * the .DAT file.
+         *------------------------------------------------------------*/
+        if (m_poDATFile->GetRecordBlock(nFeatureId) == NULL)
+            continue;
+
+        if (m_panLiveFIDBitmap == NULL && 
+            m_poDATFile->IsCurrentRecordDeleted())
+        {
+            // Same test as BuildLiveFIDBitmap(): a deleted record with a
+            // geometry is still a feature.
+            if (m_poMAPFile->MoveToObjId(nFeatureId) != 0 ||
+                m_poMAPFile->GetCurObjType() == TAB_GEOM_NONE)
+                continue;
+        }
+
+        if (bExact)
+        {
+            nCount++;
+            continue;
+        }
+
+        if (oFeature.ReadRecordFromDATFile(m_poDATFile) != 0)
+        {
+            CPLFree(panFIDs);
+            return -1;
+        }
+        oFeature.SetFID(nFeatureId);
+
+        if (m_poAttrQuery->Evaluate(&oFeature))
+            nCount++;
+    }
+
+    CPLFree(panFIDs);
+
+    return nCount;
+}
+
 /************************************************************************/
 /*                            ResetReading()                            */
 /************************************************************************/
@@ -170,6 +315,11 @@ void TABFile::ResetReading()
     CPLFree(m_panMatchingFIDs);
     m_panMatchingFIDs = NULL;
     m_iMatchingFID = 0;
+    m_bMatchingFIDsTried = FALSE;
+
+    CPLFree(m_panMatchingFIDBitmap);
+    m_panMatchingFIDBitmap = NULL;
+    m_bMatchingFIDBitmapTried = FALSE;
     
     m_nCurFeatureId = 0;
     if( m_poMAPFile != NULL )
@@ -417,6 +567,9 @@ int TABFile::Open(const char *pszFname, const char *pszAccess,
 
     m_nLastFeatureId = m_poDATFile->GetNumRecords();
 
+    if (m_eAccessMode == TABRead)
+        m_poDATFile->SetRecodeTable(GetReadRecodeTable());
+
 
     /*-----------------------------------------------------------------
      * Parse .TAB file field defs and build FeatureDefn (only in read access)
@@ -521,6 +674,12 @@ int TABFile::Open(const char *pszFname, const char *pszAccess,
 
     if (bHasIndex)
     {
+        // Char values are recoded to UTF-8 on read, but the .IND keys
+        // stay in the file charset: tell the index how to build them.
+        if (GetReadRecodeTable() != NULL)
+            CPLCreateXMLElementAndValue( psRoot, "KeyEncoding", 
+                                         TABCharsetToEncoding(m_pszCharset) );
+
         char *pszRawXML = CPLSerializeXMLTree( psRoot );
         InitializeIndexSupport( pszRawXML );
         CPLFree( pszRawXML );
@@ -1063,6 +1222,24 @@ int TABFile::WriteTABFile()
     return 0;
 }
 
+/**********************************************************************
+ *                   TABGetLiveFIDSidecarFname()
+ *
+ * Return the name of the live FID bitmap sidecar file for a .TAB file,
+ * i.e. the .TAB filename with a .fbm (or .FBM) extension.
+ *
+ * Returns a reference to a static buffer (see CPLResetExtension()).
+ **********************************************************************/
+static const char *TABGetLiveFIDSidecarFname(const char *pszTABFname)
+{
+    int nLen = strlen(pszTABFname);
+
+    if (nLen > 4 && strcmp(pszTABFname+nLen-4, ".TAB") == 0)
+        return CPLResetExtension(pszTABFname, "FBM");
+
+    return CPLResetExtension(pszTABFname, "fbm");
+}
+
 /**********************************************************************
  *                   TABFile::Close()
  *
@@ -1082,6 +1259,10 @@ int TABFile::Close()
         m_nVersion = MAX(m_nVersion, nMapObjVersion);
 
         WriteTABFile();
+
+        // Any live FID bitmap sidecar left by a previous dataset with
+        // the same name is now stale.
+        VSIUnlink(TABGetLiveFIDSidecarFname(m_pszFname));
     }
 
     if (m_poMAPFile)
@@ -1144,6 +1325,16 @@ int TABFile::Close()
 
     CPLFree(m_panMatchingFIDs);
     m_panMatchingFIDs = NULL;
+    m_bMatchingFIDsTried = FALSE;
+
+    CPLFree(m_panMatchingFIDBitmap);
+    m_panMatchingFIDBitmap = NULL;
+    m_bMatchingFIDBitmapTried = FALSE;
+
+    CPLFree(m_panLiveFIDBitmap);
+    m_panLiveFIDBitmap = NULL;
+    m_nLiveFeatureCount = 0;
+    m_bLiveFIDBitmapTried = FALSE;
 
     return 0;
 }
@@ -1181,672 +1372,1159 @@ int TABFile::SetQuickSpatialIndexMode(GBool bQuickSpatialIndexMode/*=TRUE*/)
 
 
 /**********************************************************************
- *                   TABFile::GetNextFeatureId()
+ *                   TABCollectScanConds()
  *
- * Returns feature id that follows nPrevId, or -1 if it is the
- * last feature id.  Pass nPrevId=-1 to fetch the first valid feature id.
+ * Walk the top-level AND terms of a compiled attribute query and add
+ * to *ppasConds the ones that TABDATFile::ScanRecords() can evaluate.
+ * Terms that cannot be handled (OR, NOT, LIKE, special fields, etc.)
+ * are simply ignored, so the resulting conditions select a superset of
+ * the features matched by the full query.
  **********************************************************************/
-int TABFile::GetNextFeatureId(int nPrevId)
+static void TABCollectScanConds(swq_expr *psExpr, TABDATFile *poDATFile,
+                                int *pnConds, TABDATScanCond **ppasConds)
 {
-    if (m_eAccessMode != TABRead)
+    TABDATScanCond sCond;
+    TABFieldType   eType;
+    GBool          bNumeric;
+
+    if (psExpr == NULL)
+        return;
+
+    if (psExpr->operation == SWQ_AND)
     {
-        CPLError(CE_Failure, CPLE_NotSupported,
-                 "GetNextFeatureId() can be used only with Read access.");
-        return -1;
+        TABCollectScanConds((swq_expr*)psExpr->first_sub_expr, poDATFile,
+                            pnConds, ppasConds);
+        TABCollectScanConds((swq_expr*)psExpr->second_sub_expr, poDATFile,
+                            pnConds, ppasConds);
+        return;
     }
 
-    /*-----------------------------------------------------------------
-     * Are we using spatial rather than .ID based traversal?
-     *----------------------------------------------------------------*/
-    if( bUseSpatialTraversal )
-        return m_poMAPFile->GetNextFeatureId( nPrevId );
+    if (psExpr->field_index < 0 ||
+        psExpr->field_index >= poDATFile->GetNumFields())
+        return;         // Special field (FID, OGR_GEOMETRY, ...)
 
-    /*-----------------------------------------------------------------
-     * Should we use an attribute index traversal?
-     *----------------------------------------------------------------*/
-    if( m_poAttrQuery != NULL)
-    {
-        if( m_panMatchingFIDs == NULL )
-        {
-            m_iMatchingFID = 0;
-            m_panMatchingFIDs = m_poAttrQuery->EvaluateAgainstIndices( this,
-                                                                 NULL );
-        }
-        if( m_panMatchingFIDs != NULL )
-        {
-            if( m_panMatchingFIDs[m_iMatchingFID] == OGRNullFID )
-                return OGRNullFID;
+    memset(&sCond, 0, sizeof(sCond));
+    sCond.nFieldId = psExpr->field_index;
 
-            return m_panMatchingFIDs[m_iMatchingFID++] + 1;
-        }
+    switch(psExpr->operation)
+    {
+      case SWQ_EQ: sCond.eOp = TABScanEQ; break;
+      case SWQ_NE: sCond.eOp = TABScanNE; break;
+      case SWQ_LT: sCond.eOp = TABScanLT; break;
+      case SWQ_LE: sCond.eOp = TABScanLE; break;
+      case SWQ_GT: sCond.eOp = TABScanGT; break;
+      case SWQ_GE: sCond.eOp = TABScanGE; break;
+      case SWQ_IN: sCond.eOp = TABScanIN; break;
+      default:
+        return;
     }
 
     /*-----------------------------------------------------------------
-     * Establish what the next logical feature ID should be
+     * The field type must match the way OGR sees the field, otherwise
+     * the comparison would not have the same semantics.
      *----------------------------------------------------------------*/
-    int nFeatureId = -1;
-
-    if (nPrevId <= 0 && m_nLastFeatureId > 0)
-        nFeatureId = 1;       // Feature Ids start at 1
-    else if (nPrevId > 0 && nPrevId < m_nLastFeatureId)
-        nFeatureId = nPrevId + 1;
-    else
+    eType = poDATFile->GetFieldType(psExpr->field_index);
+    if ((eType == TABFInteger || eType == TABFSmallInt) &&
+        psExpr->field_type == SWQ_INTEGER)
     {
-        // This was the last feature
-        return OGRNullFID;
+        bNumeric = TRUE;
+        sCond.dValue = psExpr->int_value;
+    }
+    else if ((eType == TABFFloat || eType == TABFDecimal) &&
+             psExpr->field_type == SWQ_FLOAT)
+    {
+        bNumeric = TRUE;
+        sCond.dValue = psExpr->float_value;
+    }
+    else if ((eType == TABFChar || eType == TABFDate) &&
+             psExpr->field_type == SWQ_STRING &&
+             psExpr->string_value != NULL)
+    {
+        bNumeric = FALSE;
+        sCond.pszValue = psExpr->string_value;
     }
+    else
+        return;
 
-    /*-----------------------------------------------------------------
-     * Skip any feature with NONE geometry and a deleted attribute record
-     *----------------------------------------------------------------*/
-    while(nFeatureId <= m_nLastFeatureId)
+    if (sCond.eOp == TABScanIN && bNumeric)
     {
-        if ( m_poMAPFile->MoveToObjId(nFeatureId) != 0 ||
-             m_poDATFile->GetRecordBlock(nFeatureId) == NULL )
-        {
-            CPLError(CE_Failure, CPLE_IllegalArg,
-                     "GetNextFeatureId() failed: unable to set read pointer "
-                     "to feature id %d",  nFeatureId);
-            return -1;
-        }
+        const char *pszSrc;
 
-// __TODO__ Add a test here to check if object is deleted, 
-// i.e. 0x40 set on object_id in object block
-        if (m_poMAPFile->GetCurObjType() != TAB_GEOM_NONE ||
-            m_poDATFile->IsCurrentRecordDeleted() == FALSE)
+        for(pszSrc = psExpr->string_value; *pszSrc != '\0';
+            pszSrc += strlen(pszSrc) + 1)
         {
-            // This feature contains at least a geometry or some attributes...
-            // return its id.
-            return nFeatureId;
+            sCond.padfValues = (double*)CPLRealloc(sCond.padfValues,
+                                     (sCond.numValues+1)*sizeof(double));
+            if (psExpr->field_type == SWQ_INTEGER)
+                sCond.padfValues[sCond.numValues++] = atoi(pszSrc);
+            else
+                sCond.padfValues[sCond.numValues++] = atof(pszSrc);
         }
-
-        nFeatureId++;
     }
 
-    // If we reached this point, then we kept skipping deleted features
-    // and stopped when EOF was reached.
-    return -1;
+    *ppasConds = (TABDATScanCond*)CPLRealloc(*ppasConds,
+                                   (*pnConds+1)*sizeof(TABDATScanCond));
+    (*ppasConds)[(*pnConds)++] = sCond;
 }
 
 /**********************************************************************
- *                   TABFile::GetNextFeatureId_Spatial()
+ *                   TABBuildMatchingFIDBitmap()
  *
- * Returns feature id that follows nPrevId, or -1 if it is the
- * last feature id, but by traversing the spatial tree instead of the
- * direct object index.  Generally speaking the feature id's will be
- * returned in an unordered fashion.  
+ * Use TABDATFile::ScanRecords() to pre-filter the records of a native
+ * .DAT file against the simple terms of an attribute query.
+ *
+ * Returns a FID bitmap of candidate features (to be freed with 
+ * CPLFree()), or NULL if the attribute query cannot be used that way.
  **********************************************************************/
-int TABFile::GetNextFeatureId_Spatial(int nPrevId)
+static GUInt32 *TABBuildMatchingFIDBitmap(OGRFeatureQuery *poAttrQuery,
+                                          TABDATFile *poDATFile,
+                                          TABTableType eTableType)
 {
-    if (m_eAccessMode != TABRead)
-    {
-        CPLError(CE_Failure, CPLE_NotSupported,
-            "GetNextFeatureId_Spatial() can be used only with Read access.");
-        return -1;
-    }
+    TABDATScanCond *pasConds = NULL;
+    int         i, numConds = 0;
+    GUInt32     *panBitmap = NULL;
 
-    if( m_poMAPFile == NULL )
-    {
-        CPLError(CE_Failure, CPLE_NotSupported,
-            "GetNextFeatureId_Spatial() requires availability of .MAP file." );
-        return -1;
-    }
+    if (poAttrQuery == NULL || poDATFile == NULL ||
+        eTableType != TABTableNative)
+        return NULL;
 
-    return m_poMAPFile->GetNextFeatureId( nPrevId );
+    TABCollectScanConds((swq_expr*)poAttrQuery->GetSWGExpr(), poDATFile,
+                        &numConds, &pasConds);
+
+    if (numConds > 0)
+        panBitmap = poDATFile->ScanRecords(numConds, pasConds);
+
+    for(i=0; i<numConds; i++)
+        CPLFree(pasConds[i].padfValues);
+    CPLFree(pasConds);
+
+    return panBitmap;
 }
 
 /**********************************************************************
- *                   TABFile::GetFeatureRef()
- *
- * Fill and return a TABFeature object for the specified feature id.
- *
- * The retruned pointer is a reference to an object owned and maintained
- * by this TABFile object.  It should not be altered or freed by the 
- * caller and its contents is guaranteed to be valid only until the next
- * call to GetFeatureRef() or Close().
+ *                   TABFile::BuildMatchingFIDBitmap()
  *
- * Returns NULL if the specified feature id does not exist of if an
- * error happened.  In any case, CPLError() will have been called to
- * report the reason of the failure.
+ * Pre-filter the records of the .DAT file against the simple terms of
+ * the current attribute query.  See TABBuildMatchingFIDBitmap().
+ **********************************************************************/
+GUInt32 *TABFile::BuildMatchingFIDBitmap()
+{
+    return TABBuildMatchingFIDBitmap(m_poAttrQuery, m_poDATFile, 
+                                     m_eTableType);
+}
+
+/**********************************************************************
+ *                   TABGetLiveFIDSidecarStamp()
  *
- * If an unsupported object type is encountered (likely from a newer version
- * of MapInfo) then a valid feature will be returned with a NONE geometry,
- * and a warning will be produced with code TAB_WarningFeatureTypeNotSupported
- * CPLGetLastErrorNo() should be used to detect that case.
+ * Fill panStamp[0..3] with the size and modification time of the .DAT
+ * and .MAP files.  These are stored in the sidecar file to detect that
+ * the dataset has been modified since the sidecar was written.
  **********************************************************************/
-TABFeature *TABFile::GetFeatureRef(int nFeatureId)
+static void TABGetLiveFIDSidecarStamp(TABDATFile *poDATFile,
+                                      TABMAPFile *poMAPFile,
+                                      GInt32 *panStamp)
 {
-    CPLErrorReset();
+    VSIStatBuf  sStat;
 
-    if (m_eAccessMode != TABRead)
+    panStamp[0] = panStamp[1] = panStamp[2] = panStamp[3] = 0;
+
+    if (poDATFile && poDATFile->GetFname() &&
+        VSIStat(poDATFile->GetFname(), &sStat) == 0)
     {
-        CPLError(CE_Failure, CPLE_NotSupported,
-                 "GetFeatureRef() can be used only with Read access.");
-        return NULL;
+        panStamp[0] = (GInt32)sStat.st_size;
+        panStamp[1] = (GInt32)sStat.st_mtime;
     }
 
-    /*-----------------------------------------------------------------
-     * Make sure file is opened and Validate feature id by positioning
-     * the read pointers for the .MAP and .DAT files to this feature id.
-     *----------------------------------------------------------------*/
-    if (m_poMAPFile == NULL)
+    if (poMAPFile && poMAPFile->GetFname() &&
+        VSIStat(poMAPFile->GetFname(), &sStat) == 0)
     {
-        CPLError(CE_Failure, CPLE_IllegalArg,
-                 "GetFeatureRef() failed: file is not opened!");
-        return NULL;
+        panStamp[2] = (GInt32)sStat.st_size;
+        panStamp[3] = (GInt32)sStat.st_mtime;
     }
+}
 
+/**********************************************************************
+ *                   TABFile::ReadLiveFIDBitmapSidecar()
+ *
+ * Try to load the live FID bitmap from the .fbm sidecar file written by
+ * WriteLiveFIDBitmapSidecar().  The sidecar is a small binary file made
+ * of an 8 bytes "MITABFBM" signature followed by the following LSB
+ * int32 values: version (1), number of records, .DAT size and mtime,
+ * .MAP size and mtime, number of live features, and then the bitmap
+ * words themselves.
+ *
+ * Returns 0 on success, or -1 if there is no sidecar or if it does not
+ * match the current dataset.  No error is reported in that case.
+ **********************************************************************/
+int TABFile::ReadLiveFIDBitmapSidecar()
+{
+    FILE        *fp;
+    GByte       abySignature[8];
+    GInt32      anHeader[7], anStamp[4];
+    int         i, numWords;
 
-    if (nFeatureId <= 0 || nFeatureId > m_nLastFeatureId ||
-        m_poMAPFile->MoveToObjId(nFeatureId) != 0 ||
-        m_poDATFile->GetRecordBlock(nFeatureId) == NULL )
-    {
-        //     CPLError(CE_Failure, CPLE_IllegalArg,
-        //    "GetFeatureRef() failed: invalid feature id %d", 
-        //    nFeatureId);
-        return NULL;
-    }
-    
-    /*-----------------------------------------------------------------
-     * Flush current feature object
-     * __TODO__ try to reuse if it is already of the right type
-     *----------------------------------------------------------------*/
-    if (m_poCurFeature)
-    {
-        delete m_poCurFeature;
-        m_poCurFeature = NULL;
-    }
+    if ((fp = VSIFOpen(TABGetLiveFIDSidecarFname(m_pszFname), "rb")) == NULL)
+        return -1;
 
-    /*-----------------------------------------------------------------
-     * Create new feature object of the right type
-     * Unsupported object types are returned as raw TABFeature (i.e. NONE
-     * geometry)
-     *----------------------------------------------------------------*/
-    m_poCurFeature = TABFeature::CreateFromMapInfoType(m_poMAPFile->GetCurObjType(), 
-                                                       m_poDefn);
+    TABGetLiveFIDSidecarStamp(m_poDATFile, m_poMAPFile, anStamp);
 
-    /*-----------------------------------------------------------------
-     * Read fields from the .DAT file
-     * GetRecordBlock() has already been called above...
-     *----------------------------------------------------------------*/
-    if (m_poCurFeature->ReadRecordFromDATFile(m_poDATFile) != 0)
+    if (VSIFRead(abySignature, 1, 8, fp) != 8 ||
+        memcmp(abySignature, "MITABFBM", 8) != 0 ||
+        VSIFRead(anHeader, sizeof(GInt32), 7, fp) != 7)
     {
-        delete m_poCurFeature;
-        m_poCurFeature = NULL;
-        return NULL;
+        VSIFClose(fp);
+        return -1;
     }
 
-    /*-----------------------------------------------------------------
-     * Read geometry from the .MAP file
-     * MoveToObjId() has already been called above...
-     *----------------------------------------------------------------*/
-    TABMAPObjHdr *poObjHdr = 
-        TABMAPObjHdr::NewObj((GByte)m_poMAPFile->GetCurObjType(), 
-                             m_poMAPFile->GetCurObjId());
-    // Note that poObjHdr==NULL is a valid case if geometry type is NONE
+    for(i=0; i<7; i++)
+        CPL_LSBPTR32(anHeader+i);
 
-    if ((poObjHdr && poObjHdr->ReadObj(m_poMAPFile->GetCurObjBlock()) != 0) ||
-        m_poCurFeature->ReadGeometryFromMAPFile(m_poMAPFile, poObjHdr) != 0)
+    if (anHeader[0] != 1 || anHeader[1] != m_nLastFeatureId ||
+        anHeader[2] != anStamp[0] || anHeader[3] != anStamp[1] ||
+        anHeader[4] != anStamp[2] || anHeader[5] != anStamp[3])
     {
-        delete m_poCurFeature;
-        m_poCurFeature = NULL;
-        if (poObjHdr) 
-            delete poObjHdr;
-        return NULL;
+        VSIFClose(fp);
+        return -1;
     }
-    if (poObjHdr)       // May be NULL if feature geometry type is NONE
-        delete poObjHdr; 
 
-    m_nCurFeatureId = nFeatureId;
-    m_poCurFeature->SetFID(m_nCurFeatureId);
+    numWords = TAB_FIDBITMAP_WORDS(m_nLastFeatureId);
+    m_panLiveFIDBitmap = (GUInt32*)CPLMalloc(numWords*sizeof(GUInt32));
+    if ((int)VSIFRead(m_panLiveFIDBitmap, sizeof(GUInt32), numWords, fp) !=
+                                                                   numWords)
+    {
+        CPLFree(m_panLiveFIDBitmap);
+        m_panLiveFIDBitmap = NULL;
+        VSIFClose(fp);
+        return -1;
+    }
+    VSIFClose(fp);
 
-    m_poCurFeature->SetRecordDeleted(m_poDATFile->IsCurrentRecordDeleted());
+    for(i=0; i<numWords; i++)
+        CPL_LSBPTR32(m_panLiveFIDBitmap+i);
 
-    return m_poCurFeature;
+    m_nLiveFeatureCount = anHeader[6];
+
+    return 0;
 }
 
 /**********************************************************************
- *                   TABFile::WriteFeature()
+ *                   TABFile::WriteLiveFIDBitmapSidecar()
  *
- * Write a feature to this dataset.  
- *
- * For now only sequential writes are supported (i.e. with nFeatureId=-1)
- * but eventually we should be able to do random access by specifying
- * a value through nFeatureId.
+ * Save the current live FID bitmap to the .fbm sidecar file.  See
+ * ReadLiveFIDBitmapSidecar() for the file format.
  *
- * Returns the new featureId (> 0) on success, or -1 if an
- * error happened in which case, CPLError() will have been called to
- * report the reason of the failure.
+ * Returns 0 on success, -1 on error.  Failing to write the sidecar
+ * (e.g. read-only directory) is not an error for the caller.
  **********************************************************************/
-int TABFile::WriteFeature(TABFeature *poFeature, int nFeatureId /*=-1*/)
+int TABFile::WriteLiveFIDBitmapSidecar()
 {
-    if (m_eAccessMode != TABWrite)
-    {
-        CPLError(CE_Failure, CPLE_NotSupported,
-                 "WriteFeature() can be used only with Write access.");
-        return -1;
-    }
+    FILE        *fp;
+    GInt32      anHeader[7], anStamp[4];
+    GUInt32     nWord;
+    int         i, numWords, nStatus = 0;
 
-    if (nFeatureId != -1)
-    {
-        CPLError(CE_Failure, CPLE_NotSupported,
-                 "WriteFeature(): random access not implemented yet.");
+    if (m_panLiveFIDBitmap == NULL)
         return -1;
-    }
 
-    /*-----------------------------------------------------------------
-     * Make sure file is opened and establish new feature id.
-     *----------------------------------------------------------------*/
-    if (m_poMAPFile == NULL)
+    if ((fp = VSIFOpen(TABGetLiveFIDSidecarFname(m_pszFname), "wb")) == NULL)
     {
-        CPLError(CE_Failure, CPLE_IllegalArg,
-                 "WriteFeature() failed: file is not opened!");
+        CPLDebug("MITAB", "Cannot create %s",
+                 TABGetLiveFIDSidecarFname(m_pszFname));
         return -1;
     }
 
-    if (m_nLastFeatureId < 1)
-    {
-        /*-------------------------------------------------------------
-         * OK, this is the first feature in the dataset... make sure the
-         * .DAT schema has been initialized.
-         *------------------------------------------------------------*/
-        if (m_poDefn == NULL)
-            SetFeatureDefn(poFeature->GetDefnRef(), NULL);
+    TABGetLiveFIDSidecarStamp(m_poDATFile, m_poMAPFile, anStamp);
 
-        /*-------------------------------------------------------------
-         * Special hack to write out at least one field if none are in 
-         * OGRFeatureDefn.
-         *------------------------------------------------------------*/
-        if( m_poDATFile->GetNumFields() == 0 )
-        {
-            CPLError(CE_Warning, CPLE_IllegalArg,
-                     "MapInfo tables must contain at least 1 column, adding dummy FID column.");
-            m_poDATFile->AddField("FID", TABFInteger, 10, 0 );
-        }
+    anHeader[0] = 1;
+    anHeader[1] = m_nLastFeatureId;
+    anHeader[2] = anStamp[0];
+    anHeader[3] = anStamp[1];
+    anHeader[4] = anStamp[2];
+    anHeader[5] = anStamp[3];
+    anHeader[6] = m_nLiveFeatureCount;
 
-        nFeatureId = m_nLastFeatureId = 1;
-    }
-    else
+    for(i=0; i<7; i++)
+        CPL_LSBPTR32(anHeader+i);
+
+    if (VSIFWrite((void*)"MITABFBM", 1, 8, fp) != 8 ||
+        VSIFWrite(anHeader, sizeof(GInt32), 7, fp) != 7)
+        nStatus = -1;
+
+    numWords = TAB_FIDBITMAP_WORDS(m_nLastFeatureId);
+    for(i=0; nStatus == 0 && i<numWords; i++)
     {
-        nFeatureId = ++ m_nLastFeatureId;
+        nWord = m_panLiveFIDBitmap[i];
+        CPL_LSBPTR32(&nWord);
+        if (VSIFWrite(&nWord, sizeof(GUInt32), 1, fp) != 1)
+            nStatus = -1;
     }
 
+    VSIFClose(fp);
 
-    /*-----------------------------------------------------------------
-     * Write fields to the .DAT file and update .IND if necessary
-     *----------------------------------------------------------------*/
-    if (m_poDATFile == NULL ||
-        m_poDATFile->GetRecordBlock(nFeatureId) == NULL ||
-        poFeature->WriteRecordToDATFile(m_poDATFile, m_poINDFile,
-                                        m_panIndexNo) != 0 )
-    {
-        CPLError(CE_Failure, CPLE_FileIO,
-                 "Failed writing attributes for feature id %d in %s",
-                 nFeatureId, m_pszFname);
+    if (nStatus != 0)
+        VSIUnlink(TABGetLiveFIDSidecarFname(m_pszFname));
+
+    return nStatus;
+}
+
+/**********************************************************************
+ *                   TABFile::BuildLiveFIDBitmap()
+ *
+ * Build m_panLiveFIDBitmap, a FID bitmap of the "live" features, i.e.
+ * the feature ids that GetNextFeatureId() would not skip because they
+ * have either a geometry or an active attribute record.
+ *
+ * The deleted flags are read from the .DAT file in a single pass, and
+ * the .MAP file is looked at only for the ids with a deleted record.
+ *
+ * If the MITAB_FID_BITMAP_SIDECAR config option is set to YES, the 
+ * bitmap is loaded from (or saved to) a .fbm sidecar file next to the
+ * .TAB file so that it doesn't have to be rebuilt each time the dataset
+ * is opened.
+ *
+ * Returns 0 on success, -1 if the bitmap could not be built.
+ **********************************************************************/
+int TABFile::BuildLiveFIDBitmap()
+{
+    int         nFeatureId, iWord, numWords;
+    GBool       bSidecar;
+
+    m_bLiveFIDBitmapTried = TRUE;
+
+    if (m_eAccessMode != TABRead || m_poDATFile == NULL || 
+        m_poMAPFile == NULL)
         return -1;
-    }
 
-    /*-----------------------------------------------------------------
-     * Write geometry to the .MAP file
-     * The call to PrepareNewObj() takes care of the .ID file.
-     *----------------------------------------------------------------*/
-    TABMAPObjHdr *poObjHdr = 
-        TABMAPObjHdr::NewObj((GByte)poFeature->ValidateMapInfoType(m_poMAPFile),
-                             nFeatureId);
-    
-    /*-----------------------------------------------------------------
-     * ValidateMapInfoType() may have returned TAB_GEOM_NONE if feature
-     * contained an invalid geometry for its class. Need to catch that
-     * case and return the error.
-     *----------------------------------------------------------------*/
-    if (poObjHdr->m_nType == TAB_GEOM_NONE &&
-        poFeature->GetFeatureClass() != TABFCNoGeomFeature )
-    {
-        CPLError(CE_Failure, CPLE_FileIO,
-                 "Invalid geometry for feature id %d in %s",
-                 nFeatureId, m_pszFname);
+    bSidecar = CSLTestBoolean(CPLGetConfigOption("MITAB_FID_BITMAP_SIDECAR",
+                                                 "NO"));
+    if (bSidecar && ReadLiveFIDBitmapSidecar() == 0)
+        return 0;
+
+    m_panLiveFIDBitmap = m_poDATFile->BuildActiveRecordBitmap();
+    if (m_panLiveFIDBitmap == NULL)
         return -1;
-    }
 
     /*-----------------------------------------------------------------
-     * The ValidateMapInfoType() call above has forced calculation of the
-     * feature's IntMBR. Store that value in the ObjHdr for use by
-     * PrepareNewObj() to search the best node to insert the feature.
+     * Ids with a deleted attribute record are still live if they have
+     * a geometry.  If we can't tell then we consider them live and let
+     * GetNextFeatureId()/GetFeatureRef() deal with the error later.
      *----------------------------------------------------------------*/
-    if ( poObjHdr && poObjHdr->m_nType != TAB_GEOM_NONE)
-    {
-        poFeature->GetIntMBR(poObjHdr->m_nMinX, poObjHdr->m_nMinY,
-                             poObjHdr->m_nMaxX, poObjHdr->m_nMaxY);
-    }
+    numWords = TAB_FIDBITMAP_WORDS(m_nLastFeatureId);
+    m_nLiveFeatureCount = 0;
 
-    if ( poObjHdr == NULL || m_poMAPFile == NULL ||
-         m_poMAPFile->PrepareNewObj(poObjHdr) != 0 ||
-         poFeature->WriteGeometryToMAPFile(m_poMAPFile, poObjHdr) != 0 ||
-         m_poMAPFile->CommitNewObj(poObjHdr) != 0 )
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    for(iWord=0; iWord<numWords; iWord++)
     {
-        CPLError(CE_Failure, CPLE_FileIO,
-                 "Failed writing geometry for feature id %d in %s",
-                 nFeatureId, m_pszFname);
-        if (poObjHdr)
-            delete poObjHdr;
-        return -1;
+        GUInt32 nWord;
+
+        if (m_panLiveFIDBitmap[iWord] != 0xffffffff)
+        {
+            for(nFeatureId = MAX(1, iWord*32); 
+                nFeatureId < (iWord+1)*32 && nFeatureId <= m_nLastFeatureId;
+                nFeatureId++)
+            {
+                if (!TAB_FIDBITMAP_TEST(m_panLiveFIDBitmap, nFeatureId) &&
+                    (m_poMAPFile->MoveToObjId(nFeatureId) != 0 ||
+                     m_poMAPFile->GetCurObjType() != TAB_GEOM_NONE))
+                    TAB_FIDBITMAP_SET(m_panLiveFIDBitmap, nFeatureId);
+            }
+        }
+
+        // Count bits set in this word
+        for(nWord = m_panLiveFIDBitmap[iWord]; nWord != 0; 
+            nWord &= nWord - 1)
+            m_nLiveFeatureCount++;
     }
+    CPLPopErrorHandler();
+    CPLErrorReset();
 
-    delete poObjHdr;
+    if (bSidecar)
+        WriteLiveFIDBitmapSidecar();
 
-    return nFeatureId;
+    return 0;
 }
 
-
 /**********************************************************************
- *                   TABFile::CreateFeature()
+ *                   TABGetNextLiveFeatureId()
  *
- * Write a new feature to this dataset. The passed in feature is updated 
- * with the new feature id.
+ * Returns the first feature id >= nFeatureId that has a geometry or an
+ * active attribute record (and is set in panMatchingFIDBitmap if not 
+ * NULL), or -1 if there is none.
  *
- * Returns OGRERR_NONE on success, or an appropriate OGRERR_ code if an
- * error happened in which case, CPLError() will have been called to
- * report the reason of the failure.
+ * panLiveFIDBitmap is used to skip whole words of ids at once when it 
+ * is available, otherwise the .MAP and .DAT files are looked at for 
+ * each id.
  **********************************************************************/
-OGRErr TABFile::CreateFeature(TABFeature *poFeature)
+static int TABGetNextLiveFeatureId(TABMAPFile *poMAPFile, 
+                                   TABDATFile *poDATFile,
+                                   int nLastFeatureId,
+                                   GUInt32 *panLiveFIDBitmap,
+                                   GUInt32 *panMatchingFIDBitmap,
+                                   int nFeatureId)
 {
-    int nFeatureId = -1;
+    if( panLiveFIDBitmap != NULL )
+    {
+        while(nFeatureId <= nLastFeatureId)
+        {
+            GUInt32 nWord = panLiveFIDBitmap[nFeatureId >> 5];
 
-    nFeatureId = WriteFeature(poFeature, -1);
+            if( panMatchingFIDBitmap != NULL )
+                nWord &= panMatchingFIDBitmap[nFeatureId >> 5];
 
-    if (nFeatureId == -1)
-        return OGRERR_FAILURE;
+            nWord >>= (nFeatureId & 31);
+            if( nWord == 0 )
+            {
+                nFeatureId = (nFeatureId | 31) + 1;
+                continue;
+            }
 
-    poFeature->SetFID(nFeatureId);
+            while( (nWord & 1) == 0 )
+            {
+                nWord >>= 1;
+                nFeatureId++;
+            }
 
-    return OGRERR_NONE;
-}
+            return (nFeatureId <= nLastFeatureId) ? nFeatureId : -1;
+        }
 
-/**********************************************************************
- *                   TABFile::SetFeature()
- *
- * Implementation of OGRLayer's SetFeature(), enabled only for
- * random write access   
- **********************************************************************/
-OGRErr TABFile::SetFeature( OGRFeature *poFeature )
+        return -1;
+    }
 
-{
-//TODO: See CreateFeature()
-// Need to convert OGRFeature to TABFeature, extract FID and then forward
-// forward call to SetFeature(TABFeature, fid)
-    return OGRERR_UNSUPPORTED_OPERATION;
-}
+    /*-----------------------------------------------------------------
+     * Skip any feature with NONE geometry and a deleted attribute record
+     *----------------------------------------------------------------*/
+    while(nFeatureId <= nLastFeatureId)
+    {
+        if ( panMatchingFIDBitmap != NULL &&
+             nFeatureId <= poDATFile->GetNumRecords() &&
+             !TAB_FIDBITMAP_TEST(panMatchingFIDBitmap, nFeatureId) )
+        {
+            // Can't match the attribute query... skip whole words of
+            // non-matching ids at once when possible.
+            if ( panMatchingFIDBitmap[nFeatureId >> 5] == 0 )
+                nFeatureId = (nFeatureId | 31) + 1;
+            else
+                nFeatureId++;
+            continue;
+        }
 
+        if ( poMAPFile->MoveToObjId(nFeatureId) != 0 ||
+             poDATFile->GetRecordBlock(nFeatureId) == NULL )
+        {
+            CPLError(CE_Failure, CPLE_IllegalArg,
+                     "GetNextFeatureId() failed: unable to set read pointer "
+                     "to feature id %d",  nFeatureId);
+            return -1;
+        }
 
-/**********************************************************************
- *                   TABFile::GetLayerDefn()
- *
- * Returns a reference to the OGRFeatureDefn that will be used to create
- * features in this dataset.
- *
- * Returns a reference to an object that is maintained by this TABFile
- * object (and thus should not be modified or freed by the caller) or
- * NULL if the OGRFeatureDefn has not been initialized yet (i.e. no file
- * opened yet)
- **********************************************************************/
-OGRFeatureDefn *TABFile::GetLayerDefn()
-{
-    return m_poDefn;
+// __TODO__ Add a test here to check if object is deleted, 
+// i.e. 0x40 set on object_id in object block
+        if (poMAPFile->GetCurObjType() != TAB_GEOM_NONE ||
+            poDATFile->IsCurrentRecordDeleted() == FALSE)
+        {
+            // This feature contains at least a geometry or some attributes...
+            // return its id.
+            return nFeatureId;
+        }
+
+        nFeatureId++;
+    }
+
+    // If we reached this point, then we kept skipping deleted features
+    // and stopped when EOF was reached.
+    return -1;
 }
 
 /**********************************************************************
- *                   TABFile::SetFeatureDefn()
- *
- * Pass a reference to the OGRFeatureDefn that will be used to create
- * features in this dataset.  This function should be called after
- * creating a new dataset, but before writing the first feature.
- * All features that will be written to this dataset must share this same
- * OGRFeatureDefn.
- *
- * A reference to the OGRFeatureDefn will be kept and will be used to
- * build the .DAT file, etc.
+ *                   TABFile::GetNextFeatureId()
  *
- * Returns 0 on success, -1 on error.
+ * Returns feature id that follows nPrevId, or -1 if it is the
+ * last feature id.  Pass nPrevId=-1 to fetch the first valid feature id.
  **********************************************************************/
-int TABFile::SetFeatureDefn(OGRFeatureDefn *poFeatureDefn,
-                         TABFieldType *paeMapInfoNativeFieldTypes /* =NULL */)
+int TABFile::GetNextFeatureId(int nPrevId)
 {
-    int           iField, numFields;
-    OGRFieldDefn *poFieldDefn;
-    TABFieldType eMapInfoType = TABFUnknown;
-    int nStatus = 0;
-
-    if (m_eAccessMode != TABWrite)
+    if (m_eAccessMode != TABRead)
     {
         CPLError(CE_Failure, CPLE_NotSupported,
-                 "SetFeatureDefn() can be used only with Write access.");
+                 "GetNextFeatureId() can be used only with Read access.");
         return -1;
     }
 
     /*-----------------------------------------------------------------
-     * Keep a reference to the OGRFeatureDefn... we'll have to take the
-     * reference count into account when we are done with it.
+     * Are we using spatial rather than .ID based traversal?
      *----------------------------------------------------------------*/
-    if (m_poDefn && m_poDefn->Dereference() == 0)
-        delete m_poDefn;
-
-    m_poDefn = poFeatureDefn;
-    m_poDefn->Reference();
+    if( bUseSpatialTraversal )
+        return m_poMAPFile->GetNextFeatureId( nPrevId );
 
     /*-----------------------------------------------------------------
-     * Pass field information to the .DAT file, after making sure that
-     * it has been created and that it does not contain any field
-     * definition yet.
+     * Should we use an attribute index traversal?
      *----------------------------------------------------------------*/
-    if (m_poDATFile== NULL || m_poDATFile->GetNumFields() > 0 )
+    if( m_poAttrQuery != NULL)
     {
-        CPLError(CE_Failure, CPLE_AssertionFailed,
-                 "SetFeatureDefn() can be called only once in a newly "
-                 "created dataset.");
-        return -1;
-    }
-
-    numFields = poFeatureDefn->GetFieldCount();
-    for(iField=0; nStatus==0 && iField < numFields; iField++)
-    {
-        poFieldDefn = m_poDefn->GetFieldDefn(iField);
-
-        /*-------------------------------------------------------------
-         * Make sure field name is valid... check for special chars, etc.
-         *------------------------------------------------------------*/
-        char *pszCleanName = TABCleanFieldName(poFieldDefn->GetNameRef());
-        if (!EQUAL(pszCleanName, poFieldDefn->GetNameRef()))
-            poFieldDefn->SetName(pszCleanName);
-        CPLFree(pszCleanName);
-        pszCleanName = NULL;
-
-        if (paeMapInfoNativeFieldTypes)
+        if( m_panMatchingFIDs == NULL && !m_bMatchingFIDsTried )
         {
-            eMapInfoType = paeMapInfoNativeFieldTypes[iField];
+            m_bMatchingFIDsTried = TRUE;
+            m_iMatchingFID = 0;
+            m_panMatchingFIDs = m_poAttrQuery->EvaluateAgainstIndices( this,
+                                                                 NULL );
         }
-        else
+        if( m_panMatchingFIDs != NULL )
         {
             /*---------------------------------------------------------
-             * Map OGRFieldTypes to MapInfo native types
+             * The index can return stale or deleted record ids (which
+             * GetFeatureRef() would fail on), skip them.
              *--------------------------------------------------------*/
-            switch(poFieldDefn->GetType())
+            if( m_panLiveFIDBitmap == NULL && !m_bLiveFIDBitmapTried )
+                BuildLiveFIDBitmap();
+
+            while( m_panMatchingFIDs[m_iMatchingFID] != OGRNullFID )
             {
-              case OFTInteger:
-                eMapInfoType = TABFInteger;
-                break;
-              case OFTReal:
-                eMapInfoType = TABFFloat;
-                break;
-              case OFTDateTime:
-                eMapInfoType = TABFDateTime;
-                break;
-              case OFTDate:
-                eMapInfoType = TABFDate;
-                break;
-              case OFTTime:
-                eMapInfoType = TABFTime;
-                break;
-              case OFTString:
-              default:
-                eMapInfoType = TABFChar;
+                int nFeatureId = m_panMatchingFIDs[m_iMatchingFID++] + 1;
+
+                if( nFeatureId > 0 && nFeatureId <= m_nLastFeatureId &&
+                    (m_panLiveFIDBitmap == NULL ||
+                     TAB_FIDBITMAP_TEST(m_panLiveFIDBitmap, nFeatureId)) )
+                    return nFeatureId;
             }
+
+            return OGRNullFID;
         }
+    }
 
-        nStatus = m_poDATFile->AddField(poFieldDefn->GetNameRef(),
-                                            eMapInfoType,
-                                            poFieldDefn->GetWidth(),
-                                            poFieldDefn->GetPrecision());
+    /*-----------------------------------------------------------------
+     * Establish what the next logical feature ID should be
+     *----------------------------------------------------------------*/
+    int nFeatureId = -1;
+
+    if (nPrevId <= 0 && m_nLastFeatureId > 0)
+        nFeatureId = 1;       // Feature Ids start at 1
+    else if (nPrevId > 0 && nPrevId < m_nLastFeatureId)
+        nFeatureId = nPrevId + 1;
+    else
+    {
+        // This was the last feature
+        return OGRNullFID;
     }
 
     /*-----------------------------------------------------------------
-     * Alloc the array to keep track of indexed fields (default=NOT indexed)
+     * No usable index: try to pre-filter the .DAT records against the
+     * attribute query in a single pass.
      *----------------------------------------------------------------*/
-    m_panIndexNo = (int *)CPLCalloc(numFields, sizeof(int));
+    if( m_poAttrQuery != NULL && !m_bMatchingFIDBitmapTried )
+    {
+        m_bMatchingFIDBitmapTried = TRUE;
+        m_panMatchingFIDBitmap = BuildMatchingFIDBitmap();
+    }
 
-    return nStatus;
+    /*-----------------------------------------------------------------
+     * Use the live FID bitmap to skip features with NONE geometry and
+     * a deleted attribute record, a whole word of ids at a time when
+     * possible.
+     *----------------------------------------------------------------*/
+    if( m_panLiveFIDBitmap == NULL && !m_bLiveFIDBitmapTried )
+        BuildLiveFIDBitmap();
+
+    return TABGetNextLiveFeatureId(m_poMAPFile, m_poDATFile, m_nLastFeatureId,
+                                   m_panLiveFIDBitmap, m_panMatchingFIDBitmap,
+                                   nFeatureId);
 }
 
 /**********************************************************************
- *                   TABFile::AddFieldNative()
- *
- * Create a new field using a native mapinfo data type... this is an 
- * alternative to defining fields through the OGR interface.
- * This function should be called after creating a new dataset, but before 
- * writing the first feature.
- *
- * This function will build/update the OGRFeatureDefn that will have to be
- * used when writing features to this dataset.
- *
- * A reference to the OGRFeatureDefn can be obtained using GetLayerDefn().
- *
- * Note: The bUnique flag has no effect on TABFiles.  See the TABView class.
+ *                   TABFile::GetNextFeatureId_Spatial()
  *
- * Returns 0 on success, -1 on error.
+ * Returns feature id that follows nPrevId, or -1 if it is the
+ * last feature id, but by traversing the spatial tree instead of the
+ * direct object index.  Generally speaking the feature id's will be
+ * returned in an unordered fashion.  
  **********************************************************************/
-int TABFile::AddFieldNative(const char *pszName, TABFieldType eMapInfoType,
-                            int nWidth /*=0*/, int nPrecision /*=0*/,
-                            GBool bIndexed /*=FALSE*/, GBool /*bUnique=FALSE*/, int bApproxOK)
+int TABFile::GetNextFeatureId_Spatial(int nPrevId)
 {
-    OGRFieldDefn *poFieldDefn;
-    int nStatus = 0;
-    char *pszCleanName = NULL;
-    char szNewFieldName[31+1]; /* 31 is the max characters for a field name*/
-    int nRenameNum = 1;
-
-    if (m_eAccessMode != TABWrite)
+    if (m_eAccessMode != TABRead)
     {
         CPLError(CE_Failure, CPLE_NotSupported,
-                 "AddFieldNative() can be used only with Write access.");
+            "GetNextFeatureId_Spatial() can be used only with Read access.");
         return -1;
     }
 
-    /*-----------------------------------------------------------------
-     * Check that call happens at the right time in dataset's life.
-     *----------------------------------------------------------------*/
-    if (m_eAccessMode != TABWrite || 
-        m_nLastFeatureId > 0 || m_poDATFile == NULL)
+    if( m_poMAPFile == NULL )
     {
-        CPLError(CE_Failure, CPLE_AssertionFailed,
-                 "AddFieldNative() must be called after opening a new "
-                 "dataset, but before writing the first feature to it.");
+        CPLError(CE_Failure, CPLE_NotSupported,
+            "GetNextFeatureId_Spatial() requires availability of .MAP file." );
         return -1;
     }
 
+    return m_poMAPFile->GetNextFeatureId( nPrevId );
+}
+
+/**********************************************************************
+ *                   TABReadFeature()
+ *
+ * Create and read the feature at which the read pointers of poMAPFile and 
+ * poDATFile have been positioned by MoveToObjId() and GetRecordBlock().
+ *
+ * Returns a new feature, to be deleted by the caller, or NULL on error.
+ **********************************************************************/
+static TABFeature *TABReadFeature(TABMAPFile *poMAPFile, 
+                                  TABDATFile *poDATFile,
+                                  OGRFeatureDefn *poDefn)
+{
+    TABFeature *poFeature;
+
     /*-----------------------------------------------------------------
-     * Create new OGRFeatureDefn if not done yet...
+     * Create new feature object of the right type
+     * Unsupported object types are returned as raw TABFeature (i.e. NONE
+     * geometry)
      *----------------------------------------------------------------*/
-    if (m_poDefn== NULL)
-    {
-        char *pszFeatureClassName = TABGetBasename(m_pszFname);
-        m_poDefn = new OGRFeatureDefn(pszFeatureClassName);
-        CPLFree(pszFeatureClassName);
-        // Ref count defaults to 0... set it to 1
-        m_poDefn->Reference();
-    }
+    poFeature = TABFeature::CreateFromMapInfoType(poMAPFile->GetCurObjType(), 
+                                                  poDefn);
 
     /*-----------------------------------------------------------------
-     * Validate field width... must be <= 254
+     * Read fields from the .DAT file
      *----------------------------------------------------------------*/
-    if (nWidth > 254)
+    if (poFeature->ReadRecordFromDATFile(poDATFile) != 0)
     {
-        CPLError(CE_Warning, CPLE_IllegalArg,
-                 "Invalid size (%d) for field '%s'.  "
-                 "Size must be 254 or less.", nWidth, pszName);
-        nWidth=254;
+        delete poFeature;
+        return NULL;
     }
 
     /*-----------------------------------------------------------------
-     * Map fields with width=0 (variable length in OGR) to a valid default
-     *----------------------------------------------------------------*/
-    if (eMapInfoType == TABFDecimal && nWidth == 0)
-        nWidth=20;
-    else if (nWidth == 0)
-        nWidth=254; /* char fields */
-
-    /*-----------------------------------------------------------------
-     * Make sure field name is valid... check for special chars, etc.
-     * (pszCleanName will have to be freed.)
+     * Read geometry from the .MAP file
      *----------------------------------------------------------------*/
-    pszCleanName = TABCleanFieldName(pszName);
+    TABMAPObjHdr *poObjHdr = 
+        TABMAPObjHdr::NewObj((GByte)poMAPFile->GetCurObjType(), 
+                             poMAPFile->GetCurObjId());
+    // Note that poObjHdr==NULL is a valid case if geometry type is NONE
 
-    if( !bApproxOK &&
-        ( m_poDefn->GetFieldIndex(pszCleanName) >= 0 ||
-          !EQUAL(pszName, pszCleanName) ) )
+    if ((poObjHdr && poObjHdr->ReadObj(poMAPFile->GetCurObjBlock()) != 0) ||
+        poFeature->ReadGeometryFromMAPFile(poMAPFile, poObjHdr) != 0)
     {
-        CPLError( CE_Failure, CPLE_NotSupported,
-                  "Failed to add field named '%s'",
-                  pszName );
+        delete poFeature;
+        if (poObjHdr) 
+            delete poObjHdr;
+        return NULL;
     }
+    if (poObjHdr)       // May be NULL if feature geometry type is NONE
+        delete poObjHdr; 
 
-    strncpy(szNewFieldName, pszCleanName, 31);
-    szNewFieldName[31] = '\0';
+    poFeature->SetRecordDeleted(poDATFile->IsCurrentRecordDeleted());
 
-    while (m_poDefn->GetFieldIndex(szNewFieldName) >= 0 && nRenameNum < 10) 
-      sprintf( szNewFieldName, "%.29s_%.1d", pszCleanName, nRenameNum++ );
+    return poFeature;
+}
 
-    while (m_poDefn->GetFieldIndex(szNewFieldName) >= 0 && nRenameNum < 100) 
-      sprintf( szNewFieldName, "%.29s%.2d", pszCleanName, nRenameNum++ );
+/**********************************************************************
+ *                   TABFile::GetFeatureRef()
+ *
+ * Fill and return a TABFeature object for the specified feature id.
+ *
+ * The retruned pointer is a reference to an object owned and maintained
+ * by this TABFile object.  It should not be altered or freed by the 
+ * caller and its contents is guaranteed to be valid only until the next
+ * call to GetFeatureRef() or Close().
+ *
+ * Returns NULL if the specified feature id does not exist of if an
+ * error happened.  In any case, CPLError() will have been called to
+ * report the reason of the failure.
+ *
+ * If an unsupported object type is encountered (likely from a newer version
+ * of MapInfo) then a valid feature will be returned with a NONE geometry,
+ * and a warning will be produced with code TAB_WarningFeatureTypeNotSupported
+ * CPLGetLastErrorNo() should be used to detect that case.
+ **********************************************************************/
+TABFeature *TABFile::GetFeatureRef(int nFeatureId)
+{
+    CPLErrorReset();
 
-    if (m_poDefn->GetFieldIndex(szNewFieldName) >= 0)
+    if (m_eAccessMode != TABRead)
     {
-      CPLError( CE_Failure, CPLE_NotSupported, 
-                "Too many field names like '%s' when truncated to 31 letters " 
-                "for MapInfo format.", pszCleanName );
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "GetFeatureRef() can be used only with Read access.");
+        return NULL;
     }
 
-    if( !EQUAL(pszCleanName,szNewFieldName) ) 
+    /*-----------------------------------------------------------------
+     * Make sure file is opened and Validate feature id by positioning
+     * the read pointers for the .MAP and .DAT files to this feature id.
+     *----------------------------------------------------------------*/
+    if (m_poMAPFile == NULL)
     {
-      CPLError( CE_Warning, CPLE_NotSupported,
-                "Normalized/laundered field name: '%s' to '%s'",
-                pszCleanName,
-                szNewFieldName );
+        CPLError(CE_Failure, CPLE_IllegalArg,
+                 "GetFeatureRef() failed: file is not opened!");
+        return NULL;
     }
 
+
+    if (nFeatureId <= 0 || nFeatureId > m_nLastFeatureId ||
+        m_poMAPFile->MoveToObjId(nFeatureId) != 0 ||
+        m_poDATFile->GetRecordBlock(nFeatureId) == NULL )
+    {
+        //     CPLError(CE_Failure, CPLE_IllegalArg,
+        //    "GetFeatureRef() failed: invalid feature id %d", 
+        //    nFeatureId);
+        return NULL;
+    }
+    
     /*-----------------------------------------------------------------
-     * Map MapInfo native types to OGR types
+     * Flush current feature object
+     * __TODO__ try to reuse if it is already of the right type
      *----------------------------------------------------------------*/
-    poFieldDefn = NULL;
-
-    switch(eMapInfoType)
+    if (m_poCurFeature)
     {
-      case TABFChar:
-        /*-------------------------------------------------
-         * CHAR type
-         *------------------------------------------------*/
-        poFieldDefn = new OGRFieldDefn(szNewFieldName, OFTString);
-        poFieldDefn->SetWidth(nWidth);
-        break;
-      case TABFInteger:
-        /*-------------------------------------------------
-         * INTEGER type
-         *------------------------------------------------*/
-        poFieldDefn = new OGRFieldDefn(szNewFieldName, OFTInteger);
-        break;
-      case TABFSmallInt:
-        /*-------------------------------------------------
-         * SMALLINT type
-         *------------------------------------------------*/
-        poFieldDefn = new OGRFieldDefn(szNewFieldName, OFTInteger);
+        delete m_poCurFeature;
+        m_poCurFeature = NULL;
+    }
+
+    m_poCurFeature = TABReadFeature(m_poMAPFile, m_poDATFile, m_poDefn);
+    if (m_poCurFeature == NULL)
+        return NULL;
+
+    m_nCurFeatureId = nFeatureId;
+    m_poCurFeature->SetFID(m_nCurFeatureId);
+
+    return m_poCurFeature;
+}
+
+/**********************************************************************
+ *                   TABFile::WriteFeature()
+ *
+ * Write a feature to this dataset.  
+ *
+ * For now only sequential writes are supported (i.e. with nFeatureId=-1)
+ * but eventually we should be able to do random access by specifying
+ * a value through nFeatureId.
+ *
+ * Returns the new featureId (> 0) on success, or -1 if an
+ * error happened in which case, CPLError() will have been called to
+ * report the reason of the failure.
+ **********************************************************************/
+int TABFile::WriteFeature(TABFeature *poFeature, int nFeatureId /*=-1*/)
+{
+    if (m_eAccessMode != TABWrite)
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "WriteFeature() can be used only with Write access.");
+        return -1;
+    }
+
+    if (nFeatureId != -1)
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "WriteFeature(): random access not implemented yet.");
+        return -1;
+    }
+
+    /*-----------------------------------------------------------------
+     * Make sure file is opened and establish new feature id.
+     *----------------------------------------------------------------*/
+    if (m_poMAPFile == NULL)
+    {
+        CPLError(CE_Failure, CPLE_IllegalArg,
+                 "WriteFeature() failed: file is not opened!");
+        return -1;
+    }
+
+    if (m_nLastFeatureId < 1)
+    {
+        /*-------------------------------------------------------------
+         * OK, this is the first feature in the dataset... make sure the
+         * .DAT schema has been initialized.
+         *------------------------------------------------------------*/
+        if (m_poDefn == NULL)
+            SetFeatureDefn(poFeature->GetDefnRef(), NULL);
+
+        /*-------------------------------------------------------------
+         * Special hack to write out at least one field if none are in 
+         * OGRFeatureDefn.
+         *------------------------------------------------------------*/
+        if( m_poDATFile->GetNumFields() == 0 )
+        {
+            CPLError(CE_Warning, CPLE_IllegalArg,
+                     "MapInfo tables must contain at least 1 column, adding dummy FID column.");
+            m_poDATFile->AddField("FID", TABFInteger, 10, 0 );
+        }
+
+        nFeatureId = m_nLastFeatureId = 1;
+    }
+    else
+    {
+        nFeatureId = ++ m_nLastFeatureId;
+    }
+
+
+    /*-----------------------------------------------------------------
+     * Write fields to the .DAT file and update .IND if necessary
+     *----------------------------------------------------------------*/
+    if (m_poDATFile == NULL ||
+        m_poDATFile->GetRecordBlock(nFeatureId) == NULL ||
+        poFeature->WriteRecordToDATFile(m_poDATFile, m_poINDFile,
+                                        m_panIndexNo) != 0 )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Failed writing attributes for feature id %d in %s",
+                 nFeatureId, m_pszFname);
+        return -1;
+    }
+
+    /*-----------------------------------------------------------------
+     * Write geometry to the .MAP file
+     * The call to PrepareNewObj() takes care of the .ID file.
+     *----------------------------------------------------------------*/
+    TABMAPObjHdr *poObjHdr = 
+        TABMAPObjHdr::NewObj((GByte)poFeature->ValidateMapInfoType(m_poMAPFile),
+                             nFeatureId);
+    
+    /*-----------------------------------------------------------------
+     * ValidateMapInfoType() may have returned TAB_GEOM_NONE if feature
+     * contained an invalid geometry for its class. Need to catch that
+     * case and return the error.
+     *----------------------------------------------------------------*/
+    if (poObjHdr->m_nType == TAB_GEOM_NONE &&
+        poFeature->GetFeatureClass() != TABFCNoGeomFeature )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Invalid geometry for feature id %d in %s",
+                 nFeatureId, m_pszFname);
+        return -1;
+    }
+
+    /*-----------------------------------------------------------------
+     * The ValidateMapInfoType() call above has forced calculation of the
+     * feature's IntMBR. Store that value in the ObjHdr for use by
+     * PrepareNewObj() to search the best node to insert the feature.
+     *----------------------------------------------------------------*/
+    if ( poObjHdr && poObjHdr->m_nType != TAB_GEOM_NONE)
+    {
+        poFeature->GetIntMBR(poObjHdr->m_nMinX, poObjHdr->m_nMinY,
+                             poObjHdr->m_nMaxX, poObjHdr->m_nMaxY);
+    }
+
+    if ( poObjHdr == NULL || m_poMAPFile == NULL ||
+         m_poMAPFile->PrepareNewObj(poObjHdr) != 0 ||
+         poFeature->WriteGeometryToMAPFile(m_poMAPFile, poObjHdr) != 0 ||
+         m_poMAPFile->CommitNewObj(poObjHdr) != 0 )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Failed writing geometry for feature id %d in %s",
+                 nFeatureId, m_pszFname);
+        if (poObjHdr)
+            delete poObjHdr;
+        return -1;
+    }
+
+    delete poObjHdr;
+
+    return nFeatureId;
+}
+
+
+/**********************************************************************
+ *                   TABFile::CreateFeature()
+ *
+ * Write a new feature to this dataset. The passed in feature is updated 
+ * with the new feature id.
+ *
+ * Returns OGRERR_NONE on success, or an appropriate OGRERR_ code if an
+ * error happened in which case, CPLError() will have been called to
+ * report the reason of the failure.
+ **********************************************************************/
+OGRErr TABFile::CreateFeature(TABFeature *poFeature)
+{
+    int nFeatureId = -1;
+
+    nFeatureId = WriteFeature(poFeature, -1);
+
+    if (nFeatureId == -1)
+        return OGRERR_FAILURE;
+
+    poFeature->SetFID(nFeatureId);
+
+    return OGRERR_NONE;
+}
+
+/**********************************************************************
+ *                   TABFile::SetFeature()
+ *
+ * Implementation of OGRLayer's SetFeature(), enabled only for
+ * random write access   
+ **********************************************************************/
+OGRErr TABFile::SetFeature( OGRFeature *poFeature )
+
+{
+//TODO: See CreateFeature()
+// Need to convert OGRFeature to TABFeature, extract FID and then forward
+// forward call to SetFeature(TABFeature, fid)
+    return OGRERR_UNSUPPORTED_OPERATION;
+}
+
+
+/**********************************************************************
+ *                   TABFile::GetLayerDefn()
+ *
+ * Returns a reference to the OGRFeatureDefn that will be used to create
+ * features in this dataset.
+ *
+ * Returns a reference to an object that is maintained by this TABFile
+ * object (and thus should not be modified or freed by the caller) or
+ * NULL if the OGRFeatureDefn has not been initialized yet (i.e. no file
+ * opened yet)
+ **********************************************************************/
+OGRFeatureDefn *TABFile::GetLayerDefn()
+{
+    return m_poDefn;
+}
+
+/**********************************************************************
+ *                   TABFile::SetFeatureDefn()
+ *
+ * Pass a reference to the OGRFeatureDefn that will be used to create
+ * features in this dataset.  This function should be called after
+ * creating a new dataset, but before writing the first feature.
+ * All features that will be written to this dataset must share this same
+ * OGRFeatureDefn.
+ *
+ * A reference to the OGRFeatureDefn will be kept and will be used to
+ * build the .DAT file, etc.
+ *
+ * Returns 0 on success, -1 on error.
+ **********************************************************************/
+int TABFile::SetFeatureDefn(OGRFeatureDefn *poFeatureDefn,
+                         TABFieldType *paeMapInfoNativeFieldTypes /* =NULL */)
+{
+    int           iField, numFields;
+    OGRFieldDefn *poFieldDefn;
+    TABFieldType eMapInfoType = TABFUnknown;
+    int nStatus = 0;
+
+    if (m_eAccessMode != TABWrite)
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "SetFeatureDefn() can be used only with Write access.");
+        return -1;
+    }
+
+    /*-----------------------------------------------------------------
+     * Keep a reference to the OGRFeatureDefn... we'll have to take the
+     * reference count into account when we are done with it.
+     *----------------------------------------------------------------*/
+    if (m_poDefn && m_poDefn->Dereference() == 0)
+        delete m_poDefn;
+
+    m_poDefn = poFeatureDefn;
+    m_poDefn->Reference();
+
+    /*-----------------------------------------------------------------
+     * Pass field information to the .DAT file, after making sure that
+     * it has been created and that it does not contain any field
+     * definition yet.
+     *----------------------------------------------------------------*/
+    if (m_poDATFile== NULL || m_poDATFile->GetNumFields() > 0 )
+    {
+        CPLError(CE_Failure, CPLE_AssertionFailed,
+                 "SetFeatureDefn() can be called only once in a newly "
+                 "created dataset.");
+        return -1;
+    }
+
+    numFields = poFeatureDefn->GetFieldCount();
+    for(iField=0; nStatus==0 && iField < numFields; iField++)
+    {
+        poFieldDefn = m_poDefn->GetFieldDefn(iField);
+
+        /*-------------------------------------------------------------
+         * Make sure field name is valid... check for special chars, etc.
+         *------------------------------------------------------------*/
+        char *pszCleanName = TABCleanFieldName(poFieldDefn->GetNameRef());
+        if (!EQUAL(pszCleanName, poFieldDefn->GetNameRef()))
+            poFieldDefn->SetName(pszCleanName);
+        CPLFree(pszCleanName);
+        pszCleanName = NULL;
+
+        if (paeMapInfoNativeFieldTypes)
+        {
+            eMapInfoType = paeMapInfoNativeFieldTypes[iField];
+        }
+        else
+        {
+            /*---------------------------------------------------------
+             * Map OGRFieldTypes to MapInfo native types
+             *--------------------------------------------------------*/
+            switch(poFieldDefn->GetType())
+            {
+              case OFTInteger:
+                eMapInfoType = TABFInteger;
+                break;
+              case OFTReal:
+                eMapInfoType = TABFFloat;
+                break;
+              case OFTDateTime:
+                eMapInfoType = TABFDateTime;
+                break;
+              case OFTDate:
+                eMapInfoType = TABFDate;
+                break;
+              case OFTTime:
+                eMapInfoType = TABFTime;
+                break;
+              case OFTString:
+              default:
+                eMapInfoType = TABFChar;
+            }
+        }
+
+        nStatus = m_poDATFile->AddField(poFieldDefn->GetNameRef(),
+                                            eMapInfoType,
+                                            poFieldDefn->GetWidth(),
+                                            poFieldDefn->GetPrecision());
+    }
+
+    /*-----------------------------------------------------------------
+     * Alloc the array to keep track of indexed fields (default=NOT indexed)
+     *----------------------------------------------------------------*/
+    m_panIndexNo = (int *)CPLCalloc(numFields, sizeof(int));
+
+    return nStatus;
+}
+
+/**********************************************************************
+ *                   TABFile::AddFieldNative()
+ *
+ * Create a new field using a native mapinfo data type... this is an 
+ * alternative to defining fields through the OGR interface.
+ * This function should be called after creating a new dataset, but before 
+ * writing the first feature.
+ *
+ * This function will build/update the OGRFeatureDefn that will have to be
+ * used when writing features to this dataset.
+ *
+ * A reference to the OGRFeatureDefn can be obtained using GetLayerDefn().
+ *
+ * Note: The bUnique flag has no effect on TABFiles.  See the TABView class.
+ *
+ * Returns 0 on success, -1 on error.
+ **********************************************************************/
+int TABFile::AddFieldNative(const char *pszName, TABFieldType eMapInfoType,
+                            int nWidth /*=0*/, int nPrecision /*=0*/,
+                            GBool bIndexed /*=FALSE*/, GBool /*bUnique=FALSE*/, int bApproxOK)
+{
+    OGRFieldDefn *poFieldDefn;
+    int nStatus = 0;
+    char *pszCleanName = NULL;
+    char szNewFieldName[31+1]; /* 31 is the max characters for a field name*/
+    int nRenameNum = 1;
+
+    if (m_eAccessMode != TABWrite)
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "AddFieldNative() can be used only with Write access.");
+        return -1;
+    }
+
+    /*-----------------------------------------------------------------
+     * Check that call happens at the right time in dataset's life.
+     *----------------------------------------------------------------*/
+    if (m_eAccessMode != TABWrite || 
+        m_nLastFeatureId > 0 || m_poDATFile == NULL)
+    {
+        CPLError(CE_Failure, CPLE_AssertionFailed,
+                 "AddFieldNative() must be called after opening a new "
+                 "dataset, but before writing the first feature to it.");
+        return -1;
+    }
+
+    /*-----------------------------------------------------------------
+     * Create new OGRFeatureDefn if not done yet...
+     *----------------------------------------------------------------*/
+    if (m_poDefn== NULL)
+    {
+        char *pszFeatureClassName = TABGetBasename(m_pszFname);
+        m_poDefn = new OGRFeatureDefn(pszFeatureClassName);
+        CPLFree(pszFeatureClassName);
+        // Ref count defaults to 0... set it to 1
+        m_poDefn->Reference();
+    }
+
+    /*-----------------------------------------------------------------
+     * Validate field width... must be <= 254
+     *----------------------------------------------------------------*/
+    if (nWidth > 254)
+    {
+        CPLError(CE_Warning, CPLE_IllegalArg,
+                 "Invalid size (%d) for field '%s'.  "
+                 "Size must be 254 or less.", nWidth, pszName);
+        nWidth=254;
+    }
+
+    /*-----------------------------------------------------------------
+     * Map fields with width=0 (variable length in OGR) to a valid default
+     *----------------------------------------------------------------*/
+    if (eMapInfoType == TABFDecimal && nWidth == 0)
+        nWidth=20;
+    else if (nWidth == 0)
+        nWidth=254; /* char fields */
+
+    /*-----------------------------------------------------------------
+     * Make sure field name is valid... check for special chars, etc.
+     * (pszCleanName will have to be freed.)
+     *----------------------------------------------------------------*/
+    pszCleanName = TABCleanFieldName(pszName);
+
+    if( !bApproxOK &&
+        ( m_poDefn->GetFieldIndex(pszCleanName) >= 0 ||
+          !EQUAL(pszName, pszCleanName) ) )
+    {
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "Failed to add field named '%s'",
+                  pszName );
+    }
+
+    strncpy(szNewFieldName, pszCleanName, 31);
+    szNewFieldName[31] = '\0';
+
+    while (m_poDefn->GetFieldIndex(szNewFieldName) >= 0 && nRenameNum < 10) 
+      sprintf( szNewFieldName, "%.29s_%.1d", pszCleanName, nRenameNum++ );
+
+    while (m_poDefn->GetFieldIndex(szNewFieldName) >= 0 && nRenameNum < 100) 
+      sprintf( szNewFieldName, "%.29s%.2d", pszCleanName, nRenameNum++ );
+
+    if (m_poDefn->GetFieldIndex(szNewFieldName) >= 0)
+    {
+      CPLError( CE_Failure, CPLE_NotSupported, 
+                "Too many field names like '%s' when truncated to 31 letters " 
+                "for MapInfo format.", pszCleanName );
+    }
+
+    if( !EQUAL(pszCleanName,szNewFieldName) ) 
+    {
+      CPLError( CE_Warning, CPLE_NotSupported,
+                "Normalized/laundered field name: '%s' to '%s'",
+                pszCleanName,
+                szNewFieldName );
+    }
+
+    /*-----------------------------------------------------------------
+     * Map MapInfo native types to OGR types
+     *----------------------------------------------------------------*/
+    poFieldDefn = NULL;
+
+    switch(eMapInfoType)
+    {
+      case TABFChar:
+        /*-------------------------------------------------
+         * CHAR type
+         *------------------------------------------------*/
+        poFieldDefn = new OGRFieldDefn(szNewFieldName, OFTString);
+        poFieldDefn->SetWidth(nWidth);
+        break;
+      case TABFInteger:
+        /*-------------------------------------------------
+         * INTEGER type
+         *------------------------------------------------*/
+        poFieldDefn = new OGRFieldDefn(szNewFieldName, OFTInteger);
+        break;
+      case TABFSmallInt:
+        /*-------------------------------------------------
+         * SMALLINT type
+         *------------------------------------------------*/
+        poFieldDefn = new OGRFieldDefn(szNewFieldName, OFTInteger);
         break;
       case TABFDecimal:
         /*-------------------------------------------------
@@ -1910,540 +2588,1498 @@ int TABFile::AddFieldNative(const char *pszName, TABFieldType eMapInfoType,
         break;
       default:
         CPLError(CE_Failure, CPLE_NotSupported,
-                 "Unsupported type for field %s", szNewFieldName);
-        CPLFree(pszCleanName);
+                 "Unsupported type for field %s", szNewFieldName);
+        CPLFree(pszCleanName);
+        return -1;
+    }
+
+    /*-----------------------------------------------------
+     * Add the FieldDefn to the FeatureDefn 
+     *----------------------------------------------------*/
+    m_poDefn->AddFieldDefn(poFieldDefn);
+    delete poFieldDefn;
+
+    /*-----------------------------------------------------
+     * ... and pass field info to the .DAT file.
+     *----------------------------------------------------*/
+    nStatus = m_poDATFile->AddField(szNewFieldName, eMapInfoType, 
+                                    nWidth, nPrecision);
+
+    /*-----------------------------------------------------------------
+     * Extend the array to keep track of indexed fields (default=NOT indexed)
+     *----------------------------------------------------------------*/
+    m_panIndexNo = (int *)CPLRealloc(m_panIndexNo,
+                                     m_poDefn->GetFieldCount()*sizeof(int));
+    m_panIndexNo[m_poDefn->GetFieldCount()-1] = 0;
+
+     /*-----------------------------------------------------------------
+     * Index the field if requested
+     *----------------------------------------------------------------*/
+    if (nStatus == 0 && bIndexed)
+        nStatus = SetFieldIndexed(m_poDefn->GetFieldCount()-1);
+
+    CPLFree(pszCleanName);
+    return nStatus;
+}
+
+
+/**********************************************************************
+ *                   TABFile::GetNativeFieldType()
+ *
+ * Returns the native MapInfo field type for the specified field.
+ *
+ * Returns TABFUnknown if file is not opened, or if specified field index is
+ * invalid.
+ *
+ * Note that field ids are positive and start at 0.
+ **********************************************************************/
+TABFieldType TABFile::GetNativeFieldType(int nFieldId)
+{
+    if (m_poDATFile)
+    {
+        return m_poDATFile->GetFieldType(nFieldId);
+    }
+    return TABFUnknown;
+}
+
+
+
+/**********************************************************************
+ *                   TABFile::GetFieldIndexNumber()
+ *
+ * Returns the field's index number that was specified in the .TAB header
+ * or 0 if the specified field is not indexed.
+ *
+ * Note that field ids are positive and start at 0
+ * and valid index ids are positive and start at 1.
+ **********************************************************************/
+int  TABFile::GetFieldIndexNumber(int nFieldId)
+{
+    if (m_panIndexNo == NULL || nFieldId < 0 || 
+        m_poDATFile== NULL || nFieldId >= m_poDATFile->GetNumFields())
+        return 0;  // no index
+
+    return m_panIndexNo[nFieldId];
+}
+
+/************************************************************************
+ *                       TABFile::SetFieldIndexed()
+ *
+ * Request that a field be indexed.  This will create the .IND file if
+ * necessary, etc.
+ *
+ * Note that field ids are positive and start at 0.
+ *
+ * Returns 0 on success, -1 on error.
+ ************************************************************************/
+int TABFile::SetFieldIndexed( int nFieldId )
+{
+    /*-----------------------------------------------------------------
+     * Make sure things are OK
+     *----------------------------------------------------------------*/
+    if (m_pszFname == NULL || m_eAccessMode != TABWrite || m_poDefn == NULL)
+    {
+        CPLError(CE_Failure, CPLE_AssertionFailed,
+                 "SetFieldIndexed() must be called after opening a new "
+                 "dataset, but before writing the first feature to it.");
+        return -1;
+    }
+
+    if (m_panIndexNo == NULL || nFieldId < 0 || 
+        m_poDATFile== NULL || nFieldId >= m_poDATFile->GetNumFields())
+    {
+        CPLError(CE_Failure, CPLE_AssertionFailed,
+                 "Invalid field number in SetFieldIndexed().");
+        return -1;
+    }
+
+    /*-----------------------------------------------------------------
+     * If field is already indexed then just return
+     *----------------------------------------------------------------*/
+    if (m_panIndexNo[nFieldId] != 0)
+        return 0;  // Nothing to do
+
+
+    /*-----------------------------------------------------------------
+     * Create .IND file if it's not done yet.
+     *
+     * Note: We can pass the .TAB's filename directly and the
+     * TABINDFile class will automagically adjust the extension.
+     *----------------------------------------------------------------*/
+    if (m_poINDFile == NULL)
+    {
+        m_poINDFile = new TABINDFile;
+   
+        if ( m_poINDFile->Open(m_pszFname, "w", TRUE) != 0)
+        {
+            // File could not be opened... 
+            delete m_poINDFile;
+            m_poINDFile = NULL;
+            return -1;
+        }
+    }
+
+    /*-----------------------------------------------------------------
+     * Init new index.
+     *----------------------------------------------------------------*/
+    int nNewIndexNo;
+    OGRFieldDefn *poFieldDefn = m_poDefn->GetFieldDefn(nFieldId);
+
+    if (poFieldDefn == NULL ||
+        (nNewIndexNo = m_poINDFile->CreateIndex(GetNativeFieldType(nFieldId),
+                                                poFieldDefn->GetWidth()) ) < 1)
+    {
+        // Failed... an error has already been reported.
+        return -1;
+    }
+
+    m_panIndexNo[nFieldId] = nNewIndexNo;
+
+    return 0;
+}
+
+/************************************************************************
+ *                       TABFile::IsFieldIndexed()
+ *
+ * Returns TRUE if field is indexed, or FALSE otherwise.
+ ************************************************************************/
+GBool TABFile::IsFieldIndexed( int nFieldId )
+{
+    return (GetFieldIndexNumber(nFieldId) > 0 ? TRUE:FALSE);
+}
+
+
+
+/**********************************************************************
+ *                   TABFile::GetINDFileRef()
+ *
+ * Opens the .IND file for this dataset and returns a reference to
+ * the handle.  
+ * If the .IND file has already been opened then the same handle is 
+ * returned directly.
+ * If the .IND file does not exist then the function silently returns NULL.
+ *
+ * Note that the returned TABINDFile handle is only a reference to an
+ * object that is owned by this class.  Callers can use it but cannot
+ * destroy the object.  The object will remain valid for as long as 
+ * the TABFile will remain open.
+ **********************************************************************/
+TABINDFile  *TABFile::GetINDFileRef()
+{
+    if (m_pszFname == NULL)
+        return NULL;
+
+    if (m_eAccessMode == TABRead && m_poINDFile == NULL)
+    {
+        /*-------------------------------------------------------------
+         * File is not opened yet... do it now.
+         *
+         * Note: We can pass the .TAB's filename directly and the
+         * TABINDFile class will automagically adjust the extension.
+         *------------------------------------------------------------*/
+        m_poINDFile = new TABINDFile;
+   
+        if ( m_poINDFile->Open(m_pszFname, "r", TRUE) != 0)
+        {
+            // File could not be opened... probably does not exist
+            delete m_poINDFile;
+            m_poINDFile = NULL;
+        }
+        else if (m_panIndexNo && m_poDATFile)
+        {
+            /*---------------------------------------------------------
+             * Pass type information for each indexed field.
+             *--------------------------------------------------------*/
+            for(int i=0; i<m_poDATFile->GetNumFields(); i++)
+            {
+                if (m_panIndexNo[i] > 0)
+                {
+                    m_poINDFile->SetIndexFieldType(m_panIndexNo[i],
+                                                   GetNativeFieldType(i));
+                }
+            }
+        }
+    }
+
+    return m_poINDFile;
+}
+
+
+/**********************************************************************
+ *                   TABFile::SetBounds()
+ *
+ * Set projection coordinates bounds of the newly created dataset.
+ *
+ * This function must be called after creating a new dataset and before any
+ * feature can be written to it.
+ *
+ * Returns 0 on success, -1 on error.
+ **********************************************************************/
+int TABFile::SetBounds(double dXMin, double dYMin, 
+                       double dXMax, double dYMax)
+{
+    if (m_eAccessMode != TABWrite)
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "SetBounds() can be used only with Write access.");
+        return -1;
+    }
+
+    /*-----------------------------------------------------------------
+     * Check that dataset has been created but no feature set yet.
+     *----------------------------------------------------------------*/
+    if (m_poMAPFile && m_nLastFeatureId < 1)
+    {
+        m_poMAPFile->SetCoordsysBounds(dXMin, dYMin, dXMax, dYMax);
+
+        m_bBoundsSet = TRUE;
+    }
+    else
+    {
+        CPLError(CE_Failure, CPLE_AssertionFailed,
+                 "SetBounds() can be called only after dataset has been "
+                 "created and before any feature is set.");
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/**********************************************************************
+ *                   TABFile::GetBounds()
+ *
+ * Fetch projection coordinates bounds of a dataset.
+ *
+ * The bForce flag has no effect on TAB files since the bounds are
+ * always in the header.
+ *
+ * Returns 0 on success, -1 on error.
+ **********************************************************************/
+int TABFile::GetBounds(double &dXMin, double &dYMin, 
+                       double &dXMax, double &dYMax,
+                       GBool /*bForce = TRUE*/)
+{
+    TABMAPHeaderBlock *poHeader;
+
+    if (m_poMAPFile && (poHeader=m_poMAPFile->GetHeaderBlock()) != NULL)
+    {
+        /*-------------------------------------------------------------
+         * Projection bounds correspond to the +/- 1e9 integer coord. limits
+         *------------------------------------------------------------*/
+        double dX0, dX1, dY0, dY1;
+        m_poMAPFile->Int2Coordsys(-1000000000, -1000000000,  
+                                  dX0, dY0);
+        m_poMAPFile->Int2Coordsys(1000000000, 1000000000, 
+                                  dX1, dY1);
+        /*-------------------------------------------------------------
+         * ... and make sure that Min < Max
+         *------------------------------------------------------------*/
+        dXMin = MIN(dX0, dX1);
+        dXMax = MAX(dX0, dX1);
+        dYMin = MIN(dY0, dY1);
+        dYMax = MAX(dY0, dY1);
+    }
+    else
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+             "GetBounds() can be called only after dataset has been opened.");
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/**********************************************************************
+ *                   TABFile::GetExtent()
+ *
+ * Fetch extent of the data currently stored in the dataset.
+ *
+ * The bForce flag has no effect on TAB files since that value is
+ * always in the header.
+ *
+ * Returns OGRERR_NONE/OGRRERR_FAILURE.
+ **********************************************************************/
+OGRErr TABFile::GetExtent (OGREnvelope *psExtent, int bForce)
+{
+    TABMAPHeaderBlock *poHeader;
+
+    if (m_poMAPFile && (poHeader=m_poMAPFile->GetHeaderBlock()) != NULL)
+    {
+        double dX0, dX1, dY0, dY1;
+        /*-------------------------------------------------------------
+         * Fetch extent of the data from the .map header block
+         * this value is different from the projection bounds.
+         *------------------------------------------------------------*/
+        m_poMAPFile->Int2Coordsys(poHeader->m_nXMin, poHeader->m_nYMin,  
+                                  dX0, dY0);
+        m_poMAPFile->Int2Coordsys(poHeader->m_nXMax, poHeader->m_nYMax, 
+                                  dX1, dY1);
+
+       /*-------------------------------------------------------------
+         * ... and make sure that Min < Max
+         *------------------------------------------------------------*/
+        psExtent->MinX = MIN(dX0, dX1);
+        psExtent->MaxX = MAX(dX0, dX1);
+        psExtent->MinY = MIN(dY0, dY1);
+        psExtent->MaxY = MAX(dY0, dY1);
+
+        return OGRERR_NONE;
+    }
+
+    return OGRERR_FAILURE;
+}
+
+/**********************************************************************
+ *                   TABFile::GetFeatureCountByType()
+ *
+ * Return number of features of each type.
+ *
+ * Note that the sum of the 4 returned values may be different from
+ * the total number of features since features with NONE geometry
+ * are not taken into account here.
+ *
+ * Note: the bForce flag has nmo effect on .TAB files since the info
+ * is always in the header.
+ *
+ * Returns 0 on success, or silently returns -1 (with no error) if this
+ * information is not available.
+ **********************************************************************/
+int TABFile::GetFeatureCountByType(int &numPoints, int &numLines,
+                                   int &numRegions, int &numTexts,
+                                   GBool /* bForce = TRUE*/ )
+{
+    TABMAPHeaderBlock *poHeader;
+
+    if (m_poMAPFile && (poHeader=m_poMAPFile->GetHeaderBlock()) != NULL)
+    {
+        numPoints  = poHeader->m_numPointObjects;
+        numLines   = poHeader->m_numLineObjects;
+        numRegions = poHeader->m_numRegionObjects;
+        numTexts   = poHeader->m_numTextObjects;
+    }
+    else
+    {
+        numPoints = numLines = numRegions = numTexts = 0;
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/**********************************************************************
+ *                   TABFile::SetMIFCoordSys()
+ *
+ * Set projection for a new file using a MIF coordsys string.
+ *
+ * This function must be called after creating a new dataset and before any
+ * feature can be written to it.
+ *
+ * Returns 0 on success, -1 on error.
+ **********************************************************************/
+int TABFile::SetMIFCoordSys(const char *pszMIFCoordSys)
+{
+    if (m_eAccessMode != TABWrite)
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "SetMIFCoordSys() can be used only with Write access.");
+        return -1;
+    }
+
+    /*-----------------------------------------------------------------
+     * Check that dataset has been created but no feature set yet.
+     *----------------------------------------------------------------*/
+    if (m_poMAPFile && m_nLastFeatureId < 1)
+    {
+        OGRSpatialReference *poSpatialRef;
+
+        poSpatialRef = MITABCoordSys2SpatialRef( pszMIFCoordSys );
+
+        if (poSpatialRef)
+        {
+            double dXMin, dYMin, dXMax, dYMax;
+            if (SetSpatialRef(poSpatialRef) == 0)
+            {
+                if (MITABExtractCoordSysBounds(pszMIFCoordSys,
+                                               dXMin, dYMin, 
+                                               dXMax, dYMax) == TRUE)
+                {
+                    // If the coordsys string contains bounds, then use them
+                    if (SetBounds(dXMin, dYMin, dXMax, dYMax) != 0)
+                    {
+                        // Failed Setting Bounds... an error should have
+                        // been already reported.
+                        return -1;
+                    }
+                }
+            }
+            else
+            {
+                // Failed setting poSpatialRef... and error should have 
+                // been reported.
+                return -1;
+            }
+
+            // Release our handle on poSpatialRef
+            if( poSpatialRef->Dereference() == 0 )
+                delete poSpatialRef;
+        }
+    }
+    else
+    {
+        CPLError(CE_Failure, CPLE_AssertionFailed,
+                 "SetMIFCoordSys() can be called only after dataset has been "
+                 "created and before any feature is set.");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**********************************************************************
+ *                   TABFile::SetProjInfo()
+ *
+ * Set projection for a new file using a TABProjInfo structure.
+ *
+ * This function must be called after creating a new dataset and before any
+ * feature can be written to it.
+ *
+ * This call will also trigger a lookup of default bounds for the specified
+ * projection (except nonearth), and reset the m_bBoundsValid flag.
+ *
+ * Returns 0 on success, -1 on error.
+ **********************************************************************/
+int TABFile::SetProjInfo(TABProjInfo *poPI)
+{
+    if (m_eAccessMode != TABWrite)
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "SetProjInfo() can be used only with Write access.");
         return -1;
     }
 
-    /*-----------------------------------------------------
-     * Add the FieldDefn to the FeatureDefn 
-     *----------------------------------------------------*/
-    m_poDefn->AddFieldDefn(poFieldDefn);
-    delete poFieldDefn;
+    /*-----------------------------------------------------------------
+     * Check that dataset has been created but no feature set yet.
+     *----------------------------------------------------------------*/
+    if (m_poMAPFile && m_nLastFeatureId < 1)
+    {
+        if (m_poMAPFile->GetHeaderBlock()->SetProjInfo( poPI ) != 0)
+            return -1;
+    }
+    else
+    {
+        CPLError(CE_Failure, CPLE_AssertionFailed,
+                 "SetProjInfo() can be called only after dataset has been "
+                 "created and before any feature is set.");
+        return -1;
+    }
 
-    /*-----------------------------------------------------
-     * ... and pass field info to the .DAT file.
-     *----------------------------------------------------*/
-    nStatus = m_poDATFile->AddField(szNewFieldName, eMapInfoType, 
-                                    nWidth, nPrecision);
+    /*-----------------------------------------------------------------
+     * Lookup default bounds and reset m_bBoundsSet flag
+     *----------------------------------------------------------------*/
+    double dXMin, dYMin, dXMax, dYMax;
+
+    m_bBoundsSet = FALSE;
+    if (MITABLookupCoordSysBounds(poPI, dXMin, dYMin, dXMax, dYMax) == TRUE)
+    {
+        SetBounds(dXMin, dYMin, dXMax, dYMax);
+    }
+
+    return 0;
+}
+
+
+/************************************************************************/
+/*                           TestCapability()                           */
+/************************************************************************/
+
+int TABFile::TestCapability( const char * pszCap )
+
+{
+    if( EQUAL(pszCap,OLCRandomRead) )
+        return TRUE;
+
+    else if( EQUAL(pszCap,OLCSequentialWrite) )
+        return m_eAccessMode == TABWrite;
+
+    else if( EQUAL(pszCap,OLCRandomWrite) )
+        return FALSE;
+
+    else if( EQUAL(pszCap,OLCFastFeatureCount) )
+        return m_poFilterGeom == NULL
+            && m_poAttrQuery == NULL;
+
+    else if( EQUAL(pszCap,OLCFastSpatialFilter) )
+        return TRUE;
+
+    else if( EQUAL(pszCap,OLCFastGetExtent) )
+        return TRUE;
+
+    else if( EQUAL(pszCap,OLCCreateField) )
+        return TRUE;
+
+    else 
+        return FALSE;
+}
+
+/**********************************************************************
+ *                   TABFile::CreateCursor()
+ *
+ * Create an independent read cursor on this dataset (see TABFileCursor).
+ *
+ * This must be called from the thread that owns the TABFile since the
+ * state shared with the cursors (drawing tools, live FID bitmap, 
+ * spatial ref) is finalized here.  The returned cursor can then be used
+ * from any thread, and must be deleted before this TABFile is closed.
+ *
+ * Returns NULL if the cursor could not be created, in which case
+ * CPLError() will have been called.
+ **********************************************************************/
+TABFileCursor *TABFile::CreateCursor()
+{
+    TABFileCursor *poCursor;
+
+    if (m_eAccessMode != TABRead || m_poMAPFile == NULL || 
+        m_poDATFile == NULL)
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "CreateCursor() can be used only with Read access.");
+        return NULL;
+    }
+
+    if (m_panLiveFIDBitmap == NULL && !m_bLiveFIDBitmapTried)
+        BuildLiveFIDBitmap();
+
+    GetSpatialRef();
+
+    poCursor = new TABFileCursor;
+    if (poCursor->Open(this) != 0)
+    {
+        delete poCursor;
+        return NULL;
+    }
+
+    return poCursor;
+}
+
+/**********************************************************************
+ *                   TABFileCursor::TABFileCursor()
+ *
+ * Constructor.
+ **********************************************************************/
+TABFileCursor::TABFileCursor()
+{
+    m_poParent = NULL;
+    m_poMAPFile = NULL;
+    m_poDATFile = NULL;
+    m_poDefn = NULL;
+    m_poSpatialRef = NULL;
+
+    m_nCurFeatureId = 0;
+    m_poCurFeature = NULL;
+    m_bUseSpatialTraversal = FALSE;
+
+    m_panMatchingFIDBitmap = NULL;
+    m_bMatchingFIDBitmapTried = FALSE;
+
+    m_nFirstRangeId = 0;
+    m_nLastRangeId = 0;
+    m_panFeatureIdList = NULL;
+    m_nFeatureIdListSize = 0;
+    m_iFeatureIdList = 0;
+}
+
+/**********************************************************************
+ *                   TABFileCursor::~TABFileCursor()
+ *
+ * Destructor.
+ **********************************************************************/
+TABFileCursor::~TABFileCursor()
+{
+    Close();
+}
+
+/**********************************************************************
+ *                   TABFileCursor::Open()
+ *
+ * Open the cursor's own .MAP and .DAT file handles on the files of 
+ * poParent, which must be opened for read.  Use TABFile::CreateCursor()
+ * rather than calling this directly.
+ *
+ * Returns 0 on success, -1 on error.
+ **********************************************************************/
+int TABFileCursor::Open(TABFile *poParent)
+{
+    if (m_poParent != NULL)
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Open() failed: cursor is already opened");
+        return -1;
+    }
+
+    m_poMAPFile = new TABMAPFile;
+    m_poDATFile = new TABDATFile;
+
+    if (m_poMAPFile->OpenReadCursor(poParent->m_poMAPFile) != 0 ||
+        m_poDATFile->OpenReadCursor(poParent->m_poDATFile) != 0)
+    {
+        Close();
+        return -1;
+    }
+
+    m_poParent = poParent;
+
+    m_poDefn = poParent->m_poDefn;
+    if (m_poDefn)
+        m_poDefn->Reference();
+
+    m_poSpatialRef = poParent->m_poSpatialRef;
+    if (m_poSpatialRef)
+        m_poSpatialRef->Reference();
+
+    ResetReading();
+
+    return 0;
+}
+
+/**********************************************************************
+ *                   TABFileCursor::Close()
+ *
+ * Close the cursor's file handles and release the references it holds
+ * on the parent's feature defn and spatial ref.
+ *
+ * Returns 0 on success, -1 on error.
+ **********************************************************************/
+int TABFileCursor::Close()
+{
+    if (m_poCurFeature)
+    {
+        delete m_poCurFeature;
+        m_poCurFeature = NULL;
+    }
+
+    if (m_poMAPFile)
+    {
+        m_poMAPFile->Close();
+        delete m_poMAPFile;
+        m_poMAPFile = NULL;
+    }
+
+    if (m_poDATFile)
+    {
+        m_poDATFile->Close();
+        delete m_poDATFile;
+        m_poDATFile = NULL;
+    }
+
+    if (m_poDefn && m_poDefn->Dereference() == 0)
+        delete m_poDefn;
+    m_poDefn = NULL;
+
+    if (m_poSpatialRef && m_poSpatialRef->Dereference() == 0)
+        delete m_poSpatialRef;
+    m_poSpatialRef = NULL;
+
+    CPLFree(m_panMatchingFIDBitmap);
+    m_panMatchingFIDBitmap = NULL;
+    m_bMatchingFIDBitmapTried = FALSE;
+
+    m_poParent = NULL;
+
+    return 0;
+}
+
+/**********************************************************************
+ *                   TABFileCursor::ResetReading()
+ *
+ * Restart reading from the first feature, and apply the current
+ * spatial filter to the cursor's .MAP file.
+ **********************************************************************/
+void TABFileCursor::ResetReading()
+{
+    CPLFree(m_panMatchingFIDBitmap);
+    m_panMatchingFIDBitmap = NULL;
+    m_bMatchingFIDBitmapTried = FALSE;
+
+    m_nCurFeatureId = 0;
+    m_iFeatureIdList = 0;
+    m_bUseSpatialTraversal = FALSE;
+
+    if (m_poMAPFile == NULL)
+        return;
+
+    m_poMAPFile->ResetReading();
+    m_poMAPFile->ResetCoordFilter();
 
     /*-----------------------------------------------------------------
-     * Extend the array to keep track of indexed fields (default=NOT indexed)
+     * Use the spatial index if the filter is smaller than the file
+     * bounds, as TABFile::ResetReading() does.
      *----------------------------------------------------------------*/
-    m_panIndexNo = (int *)CPLRealloc(m_panIndexNo,
-                                     m_poDefn->GetFieldCount()*sizeof(int));
-    m_panIndexNo[m_poDefn->GetFieldCount()-1] = 0;
+    if (m_poFilterGeom != NULL)
+    {
+        OGREnvelope  sEnvelope;
+        TABVertex sMin, sMax;
 
-     /*-----------------------------------------------------------------
-     * Index the field if requested
+        m_poFilterGeom->getEnvelope( &sEnvelope );
+        m_poMAPFile->GetCoordFilter( sMin, sMax );
+
+        if( sEnvelope.MinX > sMin.x 
+            || sEnvelope.MinY > sMin.y
+            || sEnvelope.MaxX < sMax.x
+            || sEnvelope.MaxY < sMax.y )
+        {
+            m_bUseSpatialTraversal = TRUE;
+            sMin.x = sEnvelope.MinX;
+            sMin.y = sEnvelope.MinY;
+            sMax.x = sEnvelope.MaxX;
+            sMax.y = sEnvelope.MaxY;
+            m_poMAPFile->SetCoordFilter( sMin, sMax );
+        }
+    }
+}
+
+/**********************************************************************
+ *                   TABFileCursor::SetSpatialFilter()
+ **********************************************************************/
+void TABFileCursor::SetSpatialFilter( OGRGeometry * poGeomIn )
+{
+    OGRLayer::SetSpatialFilter( poGeomIn );
+    ResetReading();
+}
+
+/**********************************************************************
+ *                   TABFileCursor::GetNextFeatureId()
+ *
+ * Returns feature id that follows nPrevId, or -1 if it is the
+ * last feature id.  Pass nPrevId=-1 to fetch the first valid feature id.
+ *
+ * Unlike TABFile::GetNextFeatureId(), the attribute indexes are not used
+ * since the .IND file is not shared with the cursors: the attribute 
+ * query is only used to pre-filter the cursor's .DAT records.
+ **********************************************************************/
+int TABFileCursor::GetNextFeatureId(int nPrevId)
+{
+    int nFeatureId;
+
+    int nLastFeatureId;
+
+    if (m_poParent == NULL)
+        return -1;
+
+    /*-----------------------------------------------------------------
+     * An explicit list of ids is returned as is, in list order.
      *----------------------------------------------------------------*/
-    if (nStatus == 0 && bIndexed)
-        nStatus = SetFieldIndexed(m_poDefn->GetFieldCount()-1);
+    if (m_panFeatureIdList != NULL)
+    {
+        if (m_iFeatureIdList >= m_nFeatureIdListSize)
+            return -1;
+        return m_panFeatureIdList[m_iFeatureIdList++];
+    }
+
+    nLastFeatureId = m_poParent->m_nLastFeatureId;
+
+    if (m_nFirstRangeId > 0)
+    {
+        nLastFeatureId = MIN(nLastFeatureId, m_nLastRangeId);
+        nPrevId = MAX(nPrevId, m_nFirstRangeId - 1);
+    }
+    else if (m_bUseSpatialTraversal)
+        return m_poMAPFile->GetNextFeatureId( nPrevId );
+
+    if (nPrevId <= 0 && nLastFeatureId > 0)
+        nFeatureId = 1;       // Feature Ids start at 1
+    else if (nPrevId > 0 && nPrevId < nLastFeatureId)
+        nFeatureId = nPrevId + 1;
+    else
+        return OGRNullFID;
 
-    CPLFree(pszCleanName);
-    return nStatus;
-}
+    if (m_poAttrQuery != NULL && !m_bMatchingFIDBitmapTried)
+    {
+        m_bMatchingFIDBitmapTried = TRUE;
+        m_panMatchingFIDBitmap = 
+            TABBuildMatchingFIDBitmap(m_poAttrQuery, m_poDATFile,
+                                      m_poParent->m_eTableType);
+    }
 
+    return TABGetNextLiveFeatureId(m_poMAPFile, m_poDATFile, 
+                                   nLastFeatureId,
+                                   m_poParent->m_panLiveFIDBitmap,
+                                   m_panMatchingFIDBitmap, nFeatureId);
+}
 
 /**********************************************************************
- *                   TABFile::GetNativeFieldType()
+ *                   TABFileCursor::SetFeatureIdRange()
  *
- * Returns the native MapInfo field type for the specified field.
- *
- * Returns TABFUnknown if file is not opened, or if specified field index is
- * invalid.
+ * Restrict the traversal to the live feature ids between nFirstId and 
+ * nLastId inclusively, and restart reading.  The spatial filter is then
+ * applied to each feature instead of using the spatial index.
  *
- * Note that field ids are positive and start at 0.
+ * Pass nFirstId <= 0 to remove the restriction.
  **********************************************************************/
-TABFieldType TABFile::GetNativeFieldType(int nFieldId)
+void TABFileCursor::SetFeatureIdRange(int nFirstId, int nLastId)
 {
-    if (m_poDATFile)
-    {
-        return m_poDATFile->GetFieldType(nFieldId);
-    }
-    return TABFUnknown;
-}
+    m_panFeatureIdList = NULL;
+    m_nFeatureIdListSize = 0;
 
+    m_nFirstRangeId = MAX(nFirstId, 0);
+    m_nLastRangeId = nLastId;
 
+    m_nCurFeatureId = 0;
+    m_iFeatureIdList = 0;
+}
 
 /**********************************************************************
- *                   TABFile::GetFieldIndexNumber()
+ *                   TABFileCursor::SetFeatureIdList()
  *
- * Returns the field's index number that was specified in the .TAB header
- * or 0 if the specified field is not indexed.
+ * Restrict the traversal to the nCount feature ids of panFeatureIds, 
+ * in that order, and restart reading.  The ids must be valid feature 
+ * ids, e.g. as returned by GetNextFeatureId().  The list is not copied
+ * and must remain valid until the restriction is removed.
  *
- * Note that field ids are positive and start at 0
- * and valid index ids are positive and start at 1.
+ * Pass panFeatureIds = NULL to remove the restriction.
  **********************************************************************/
-int  TABFile::GetFieldIndexNumber(int nFieldId)
+void TABFileCursor::SetFeatureIdList(const int *panFeatureIds, int nCount)
 {
-    if (m_panIndexNo == NULL || nFieldId < 0 || 
-        m_poDATFile== NULL || nFieldId >= m_poDATFile->GetNumFields())
-        return 0;  // no index
+    m_nFirstRangeId = 0;
+    m_nLastRangeId = 0;
 
-    return m_panIndexNo[nFieldId];
+    m_panFeatureIdList = panFeatureIds;
+    m_nFeatureIdListSize = (panFeatureIds != NULL) ? nCount : 0;
+
+    m_nCurFeatureId = 0;
+    m_iFeatureIdList = 0;
 }
 
-/************************************************************************
- *                       TABFile::SetFieldIndexed()
+/**********************************************************************
+ *                   TABFileCursor::GetFeatureRef()
  *
- * Request that a field be indexed.  This will create the .IND file if
- * necessary, etc.
+ * Fill and return a TABFeature object for the specified feature id.
  *
- * Note that field ids are positive and start at 0.
+ * The returned pointer is a reference to an object owned by this cursor
+ * and is valid only until the next call to GetFeatureRef() or Close().
  *
- * Returns 0 on success, -1 on error.
- ************************************************************************/
-int TABFile::SetFieldIndexed( int nFieldId )
+ * Returns NULL if the specified feature id does not exist of if an
+ * error happened.
+ **********************************************************************/
+TABFeature *TABFileCursor::GetFeatureRef(int nFeatureId)
 {
-    /*-----------------------------------------------------------------
-     * Make sure things are OK
-     *----------------------------------------------------------------*/
-    if (m_pszFname == NULL || m_eAccessMode != TABWrite || m_poDefn == NULL)
+    CPLErrorReset();
+
+    if (m_poParent == NULL)
     {
-        CPLError(CE_Failure, CPLE_AssertionFailed,
-                 "SetFieldIndexed() must be called after opening a new "
-                 "dataset, but before writing the first feature to it.");
-        return -1;
+        CPLError(CE_Failure, CPLE_IllegalArg,
+                 "GetFeatureRef() failed: cursor is not opened!");
+        return NULL;
     }
 
-    if (m_panIndexNo == NULL || nFieldId < 0 || 
-        m_poDATFile== NULL || nFieldId >= m_poDATFile->GetNumFields())
+    if (nFeatureId <= 0 || nFeatureId > m_poParent->m_nLastFeatureId ||
+        m_poMAPFile->MoveToObjId(nFeatureId) != 0 ||
+        m_poDATFile->GetRecordBlock(nFeatureId) == NULL )
+        return NULL;
+
+    if (m_poCurFeature)
     {
-        CPLError(CE_Failure, CPLE_AssertionFailed,
-                 "Invalid field number in SetFieldIndexed().");
-        return -1;
+        delete m_poCurFeature;
+        m_poCurFeature = NULL;
     }
 
-    /*-----------------------------------------------------------------
-     * If field is already indexed then just return
-     *----------------------------------------------------------------*/
-    if (m_panIndexNo[nFieldId] != 0)
-        return 0;  // Nothing to do
+    m_poCurFeature = TABReadFeature(m_poMAPFile, m_poDATFile, m_poDefn);
+    if (m_poCurFeature == NULL)
+        return NULL;
 
+    m_nCurFeatureId = nFeatureId;
+    m_poCurFeature->SetFID(m_nCurFeatureId);
 
-    /*-----------------------------------------------------------------
-     * Create .IND file if it's not done yet.
-     *
-     * Note: We can pass the .TAB's filename directly and the
-     * TABINDFile class will automagically adjust the extension.
-     *----------------------------------------------------------------*/
-    if (m_poINDFile == NULL)
+    return m_poCurFeature;
+}
+
+/**********************************************************************
+ *                   TABFileCursor::GetNextFeature()
+ *
+ * Standard OGR GetNextFeature implementation, same as 
+ * IMapInfoFile::GetNextFeature().
+ **********************************************************************/
+OGRFeature *TABFileCursor::GetNextFeature()
+{
+    OGRFeature *poFeatureRef;
+    OGRGeometry *poGeom;
+    int nFeatureId;
+
+    while( (nFeatureId = GetNextFeatureId(m_nCurFeatureId)) != -1 )
     {
-        m_poINDFile = new TABINDFile;
-   
-        if ( m_poINDFile->Open(m_pszFname, "w", TRUE) != 0)
+        poFeatureRef = GetFeatureRef(nFeatureId);
+        if (poFeatureRef == NULL)
+            return NULL;
+        else if( (m_poFilterGeom == NULL ||
+                  ((poGeom = poFeatureRef->GetGeometryRef()) != NULL &&
+                   FilterGeometry( poGeom )))
+                 && (m_poAttrQuery == NULL
+                     || m_poAttrQuery->Evaluate( poFeatureRef )) )
         {
-            // File could not be opened... 
-            delete m_poINDFile;
-            m_poINDFile = NULL;
-            return -1;
+            // Avoid cloning feature... return the copy owned by the class
+            ((TABFeature*)poFeatureRef)->DetachStyleStringRef();
+            m_poCurFeature = NULL;
+            m_nFeaturesRead++;
+            return poFeatureRef;
         }
     }
+    return NULL;
+}
 
-    /*-----------------------------------------------------------------
-     * Init new index.
-     *----------------------------------------------------------------*/
-    int nNewIndexNo;
-    OGRFieldDefn *poFieldDefn = m_poDefn->GetFieldDefn(nFieldId);
+/**********************************************************************
+ *                   TABFileCursor::GetFeature()
+ *
+ * Standard OGR GetFeature implementation.  The returned feature is 
+ * owned by the caller.
+ **********************************************************************/
+OGRFeature *TABFileCursor::GetFeature(long nFeatureId)
+{
+    OGRFeature *poFeatureRef;
 
-    if (poFieldDefn == NULL ||
-        (nNewIndexNo = m_poINDFile->CreateIndex(GetNativeFieldType(nFieldId),
-                                                poFieldDefn->GetWidth()) ) < 1)
+    poFeatureRef = GetFeatureRef(nFeatureId);
+    if (poFeatureRef)
     {
-        // Failed... an error has already been reported.
-        return -1;
+        ((TABFeature*)poFeatureRef)->DetachStyleStringRef();
+        m_poCurFeature = NULL;
     }
 
-    m_panIndexNo[nFieldId] = nNewIndexNo;
-
-    return 0;
+    return poFeatureRef;
 }
 
-/************************************************************************
- *                       TABFile::IsFieldIndexed()
- *
- * Returns TRUE if field is indexed, or FALSE otherwise.
- ************************************************************************/
-GBool TABFile::IsFieldIndexed( int nFieldId )
+/**********************************************************************
+ *                   TABFileCursor::TestCapability()
+ **********************************************************************/
+int TABFileCursor::TestCapability( const char * pszCap )
 {
-    return (GetFieldIndexNumber(nFieldId) > 0 ? TRUE:FALSE);
+    if( EQUAL(pszCap,OLCRandomRead) )
+        return TRUE;
+
+    else if( EQUAL(pszCap,OLCFastSpatialFilter) )
+        return TRUE;
+
+    else 
+        return FALSE;
 }
 
+/*=====================================================================
+ *                      class TABParallelScan
+ *====================================================================*/
 
+/* Number of consecutive feature ids read by a worker at a time */
+#define TAB_SCAN_CHUNK_SIZE     1024
 
 /**********************************************************************
- *                   TABFile::GetINDFileRef()
+ *                   TABCompareFeatureIds()
  *
- * Opens the .IND file for this dataset and returns a reference to
- * the handle.  
- * If the .IND file has already been opened then the same handle is 
- * returned directly.
- * If the .IND file does not exist then the function silently returns NULL.
+ * qsort() callback to sort a list of feature ids.
+ **********************************************************************/
+static int TABCompareFeatureIds(const void *pA, const void *pB)
+{
+    int nA = *((const int *) pA);
+    int nB = *((const int *) pB);
+
+    return (nA < nB) ? -1 : (nA > nB) ? 1 : 0;
+}
+
+/**********************************************************************
+ *                   TABFile::CreateParallelScan()
  *
- * Note that the returned TABINDFile handle is only a reference to an
- * object that is owned by this class.  Callers can use it but cannot
- * destroy the object.  The object will remain valid for as long as 
- * the TABFile will remain open.
+ * Create a multithreaded scan of the features of this dataset (see 
+ * TABParallelScan) using nWorkers threads.  Pass nWorkers <= 0 to use 
+ * the value of the MITAB_NUM_THREADS config option, or by default one 
+ * thread per CPU.  If bOrdered is TRUE then the features are returned
+ * in feature id order.
+ *
+ * As for CreateCursor(), this must be called from the thread that owns
+ * the TABFile, and the returned scan must be deleted before this 
+ * TABFile is closed.
+ *
+ * Returns NULL if the scan could not be created, in which case
+ * CPLError() will have been called.
  **********************************************************************/
-TABINDFile  *TABFile::GetINDFileRef()
+TABParallelScan *TABFile::CreateParallelScan(int nWorkers, GBool bOrdered)
 {
-    if (m_pszFname == NULL)
-        return NULL;
+    TABParallelScan *poScan;
 
-    if (m_eAccessMode == TABRead && m_poINDFile == NULL)
+    poScan = new TABParallelScan;
+    if (poScan->Open(this, nWorkers, bOrdered) != 0)
     {
-        /*-------------------------------------------------------------
-         * File is not opened yet... do it now.
-         *
-         * Note: We can pass the .TAB's filename directly and the
-         * TABINDFile class will automagically adjust the extension.
-         *------------------------------------------------------------*/
-        m_poINDFile = new TABINDFile;
-   
-        if ( m_poINDFile->Open(m_pszFname, "r", TRUE) != 0)
-        {
-            // File could not be opened... probably does not exist
-            delete m_poINDFile;
-            m_poINDFile = NULL;
-        }
-        else if (m_panIndexNo && m_poDATFile)
-        {
-            /*---------------------------------------------------------
-             * Pass type information for each indexed field.
-             *--------------------------------------------------------*/
-            for(int i=0; i<m_poDATFile->GetNumFields(); i++)
-            {
-                if (m_panIndexNo[i] > 0)
-                {
-                    m_poINDFile->SetIndexFieldType(m_panIndexNo[i],
-                                                   GetNativeFieldType(i));
-                }
-            }
-        }
+        delete poScan;
+        return NULL;
     }
 
-    return m_poINDFile;
+    return poScan;
 }
 
+/**********************************************************************
+ *                   TABParallelScan::TABParallelScan()
+ *
+ * Constructor.
+ **********************************************************************/
+TABParallelScan::TABParallelScan()
+{
+    m_poParent = NULL;
+    m_poAttrQuery = NULL;
+    m_bOrdered = FALSE;
+
+    m_panFeatureIds = NULL;
+    m_nFeatureIds = 0;
+    m_nChunks = 0;
+    m_nNextChunk = 0;
+    m_nChunksDone = 0;
+
+    m_nCursors = 0;
+    m_papoCursors = NULL;
+    m_nThreads = 0;
+    m_pahThreads = NULL;
+
+    m_hMutex = NULL;
+    m_hCond = NULL;
+    m_bStop = FALSE;
+    m_bError = FALSE;
+
+    m_nBatches = 0;
+    m_pasBatches = NULL;
+    m_psCurBatch = NULL;
+    m_iCurFeature = 0;
+}
 
 /**********************************************************************
- *                   TABFile::SetBounds()
+ *                   TABParallelScan::~TABParallelScan()
  *
- * Set projection coordinates bounds of the newly created dataset.
+ * Destructor.
+ **********************************************************************/
+TABParallelScan::~TABParallelScan()
+{
+    Close();
+}
+
+/**********************************************************************
+ *                   TABParallelScan::Open()
  *
- * This function must be called after creating a new dataset and before any
- * feature can be written to it.
+ * Prepare the cursors and chunks and start the worker threads.  Use 
+ * TABFile::CreateParallelScan() rather than calling this directly.
  *
  * Returns 0 on success, -1 on error.
  **********************************************************************/
-int TABFile::SetBounds(double dXMin, double dYMin, 
-                       double dXMax, double dYMax)
+int TABParallelScan::Open(TABFile *poParent, int nWorkers, GBool bOrdered)
 {
-    if (m_eAccessMode != TABWrite)
+    OGRGeometry *poFilterGeom;
+    int         i;
+
+    if (m_poParent != NULL)
     {
-        CPLError(CE_Failure, CPLE_NotSupported,
-                 "SetBounds() can be used only with Write access.");
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Open() failed: scan is already opened");
         return -1;
     }
 
+    if (nWorkers <= 0)
+    {
+        const char *pszThreads = CPLGetConfigOption("MITAB_NUM_THREADS", 
+                                                    NULL);
+        if (pszThreads != NULL && !EQUAL(pszThreads, "ALL_CPUS"))
+            nWorkers = atoi(pszThreads);
+        else
+            nWorkers = CPLGetNumCPUs();
+    }
+    nWorkers = MAX(nWorkers, 1);
+
     /*-----------------------------------------------------------------
-     * Check that dataset has been created but no feature set yet.
+     * The first cursor is used to walk the spatial index if needed, 
+     * and to read the chunks in this thread if no worker can be started.
      *----------------------------------------------------------------*/
-    if (m_poMAPFile && m_nLastFeatureId < 1)
+    m_papoCursors = (TABFileCursor **) CPLCalloc(nWorkers, 
+                                                 sizeof(TABFileCursor*));
+    m_papoCursors[0] = poParent->CreateCursor();
+    if (m_papoCursors[0] == NULL)
     {
-        m_poMAPFile->SetCoordsysBounds(dXMin, dYMin, dXMax, dYMax);
+        Close();
+        return -1;
+    }
+    m_nCursors = 1;
 
-        m_bBoundsSet = TRUE;
+    m_poParent = poParent;
+    m_poAttrQuery = poParent->m_poAttrQuery;
+    m_bOrdered = bOrdered;
+
+    poFilterGeom = poParent->GetSpatialFilter();
+    if (poFilterGeom != NULL)
+        m_papoCursors[0]->SetSpatialFilter(poFilterGeom);
+
+    if (m_papoCursors[0]->m_bUseSpatialTraversal)
+    {
+        /*-------------------------------------------------------------
+         * Collect the ids of the objects in the matching index leaves.
+         * This only reads object headers, the geometries and attributes
+         * are decoded by the workers.
+         *------------------------------------------------------------*/
+        int nMaxFeatureIds = 0, nFeatureId = -1;
+
+        CPLErrorReset();
+        while((nFeatureId = 
+               m_papoCursors[0]->GetNextFeatureId(nFeatureId)) != -1)
+        {
+            if (m_nFeatureIds >= nMaxFeatureIds)
+            {
+                nMaxFeatureIds = nMaxFeatureIds * 2 + 1024;
+                m_panFeatureIds = (int *) CPLRealloc(m_panFeatureIds, 
+                                                nMaxFeatureIds*sizeof(int));
+            }
+            m_panFeatureIds[m_nFeatureIds++] = nFeatureId;
+        }
+
+        if (CPLGetLastErrorType() == CE_Failure)
+        {
+            Close();
+            return -1;
+        }
+
+        if (m_bOrdered && m_nFeatureIds > 1)
+            qsort(m_panFeatureIds, m_nFeatureIds, sizeof(int), 
+                  TABCompareFeatureIds);
     }
     else
     {
-        CPLError(CE_Failure, CPLE_AssertionFailed,
-                 "SetBounds() can be called only after dataset has been "
-                 "created and before any feature is set.");
-        return -1;
+        m_nFeatureIds = poParent->m_nLastFeatureId;
+    }
+
+    m_nChunks = (m_nFeatureIds + TAB_SCAN_CHUNK_SIZE - 1) / 
+                                                        TAB_SCAN_CHUNK_SIZE;
+    nWorkers = MAX(MIN(nWorkers, m_nChunks), 1);
+
+    for( ; m_nCursors < nWorkers; m_nCursors++)
+    {
+        m_papoCursors[m_nCursors] = poParent->CreateCursor();
+        if (m_papoCursors[m_nCursors] == NULL)
+        {
+            Close();
+            return -1;
+        }
+        if (poFilterGeom != NULL)
+            m_papoCursors[m_nCursors]->SetSpatialFilter(poFilterGeom);
+    }
+
+    /*-----------------------------------------------------------------
+     * Two batches per worker let each worker read its next chunk while
+     * the caller consumes the previous one.
+     *----------------------------------------------------------------*/
+    m_nBatches = 2 * nWorkers;
+    m_pasBatches = (TABScanBatch *) CPLCalloc(m_nBatches, 
+                                              sizeof(TABScanBatch));
+    for(i = 0; i < m_nBatches; i++)
+        m_pasBatches[i].nChunk = -1;
+
+    m_hMutex = CPLCreateMutex();
+    CPLReleaseMutex(m_hMutex);
+    m_hCond = CPLCreateCond();
+
+    /*-----------------------------------------------------------------
+     * Start the workers.  Without thread support (or a condition 
+     * variable to wait on), GetNextFeature() reads the chunks itself.
+     *----------------------------------------------------------------*/
+    m_pahThreads = (void **) CPLCalloc(nWorkers, sizeof(void*));
+    for(i = 0; m_hCond != NULL && i < nWorkers; i++)
+    {
+        m_pahThreads[i] = CPLCreateJoinableThread(WorkerThread, this);
+        if (m_pahThreads[i] == NULL)
+            break;
+        m_nThreads++;
     }
 
+    if (m_nThreads == 0)
+        CPLDebug("MITAB", "Parallel scan of %s running in calling thread.",
+                 poParent->GetTableName());
+
     return 0;
 }
 
-
 /**********************************************************************
- *                   TABFile::GetBounds()
- *
- * Fetch projection coordinates bounds of a dataset.
+ *                   TABParallelScan::Close()
  *
- * The bForce flag has no effect on TAB files since the bounds are
- * always in the header.
+ * Stop and wait for the workers, and release all resources.
  *
  * Returns 0 on success, -1 on error.
  **********************************************************************/
-int TABFile::GetBounds(double &dXMin, double &dYMin, 
-                       double &dXMax, double &dYMax,
-                       GBool /*bForce = TRUE*/)
+int TABParallelScan::Close()
 {
-    TABMAPHeaderBlock *poHeader;
+    int i, j;
 
-    if (m_poMAPFile && (poHeader=m_poMAPFile->GetHeaderBlock()) != NULL)
+    if (m_nThreads > 0)
     {
-        /*-------------------------------------------------------------
-         * Projection bounds correspond to the +/- 1e9 integer coord. limits
-         *------------------------------------------------------------*/
-        double dX0, dX1, dY0, dY1;
-        m_poMAPFile->Int2Coordsys(-1000000000, -1000000000,  
-                                  dX0, dY0);
-        m_poMAPFile->Int2Coordsys(1000000000, 1000000000, 
-                                  dX1, dY1);
-        /*-------------------------------------------------------------
-         * ... and make sure that Min < Max
-         *------------------------------------------------------------*/
-        dXMin = MIN(dX0, dX1);
-        dXMax = MAX(dX0, dX1);
-        dYMin = MIN(dY0, dY1);
-        dYMax = MAX(dY0, dY1);
+        CPLAcquireMutex(m_hMutex, 1000.0);
+        m_bStop = TRUE;
+        CPLCondBroadcast(m_hCond);
+        CPLReleaseMutex(m_hMutex);
+
+        for(i = 0; i < m_nThreads; i++)
+            CPLJoinThread(m_pahThreads[i]);
+        m_nThreads = 0;
     }
-    else
+    CPLFree(m_pahThreads);
+    m_pahThreads = NULL;
+
+    for(i = 0; i < m_nCursors; i++)
+        delete m_papoCursors[i];
+    CPLFree(m_papoCursors);
+    m_papoCursors = NULL;
+    m_nCursors = 0;
+
+    for(i = 0; i < m_nBatches; i++)
     {
-        CPLError(CE_Failure, CPLE_AppDefined,
-             "GetBounds() can be called only after dataset has been opened.");
-        return -1;
+        for(j = 0; j < m_pasBatches[i].nFeatures; j++)
+            delete m_pasBatches[i].papoFeatures[j];
+        CPLFree(m_pasBatches[i].papoFeatures);
     }
+    CPLFree(m_pasBatches);
+    m_pasBatches = NULL;
+    m_nBatches = 0;
+    m_psCurBatch = NULL;
+
+    if (m_hCond)
+        CPLDestroyCond(m_hCond);
+    m_hCond = NULL;
+    if (m_hMutex)
+        CPLDestroyMutex(m_hMutex);
+    m_hMutex = NULL;
+
+    CPLFree(m_panFeatureIds);
+    m_panFeatureIds = NULL;
+    m_nFeatureIds = 0;
+    m_nChunks = 0;
+    m_nNextChunk = 0;
+    m_nChunksDone = 0;
+    m_bStop = FALSE;
+    m_bError = FALSE;
+
+    m_poParent = NULL;
+    m_poAttrQuery = NULL;
 
     return 0;
 }
 
-
 /**********************************************************************
- *                   TABFile::GetExtent()
- *
- * Fetch extent of the data currently stored in the dataset.
+ *                   TABParallelScan::ClaimChunk()
  *
- * The bForce flag has no effect on TAB files since that value is
- * always in the header.
+ * Assign the next chunk to a free batch.  Must be called with m_hMutex 
+ * held.
  *
- * Returns OGRERR_NONE/OGRRERR_FAILURE.
+ * Returns the batch, or NULL if all chunks are assigned or no batch is
+ * free.
  **********************************************************************/
-OGRErr TABFile::GetExtent (OGREnvelope *psExtent, int bForce)
+TABScanBatch *TABParallelScan::ClaimChunk()
 {
-    TABMAPHeaderBlock *poHeader;
-
-    if (m_poMAPFile && (poHeader=m_poMAPFile->GetHeaderBlock()) != NULL)
-    {
-        double dX0, dX1, dY0, dY1;
-        /*-------------------------------------------------------------
-         * Fetch extent of the data from the .map header block
-         * this value is different from the projection bounds.
-         *------------------------------------------------------------*/
-        m_poMAPFile->Int2Coordsys(poHeader->m_nXMin, poHeader->m_nYMin,  
-                                  dX0, dY0);
-        m_poMAPFile->Int2Coordsys(poHeader->m_nXMax, poHeader->m_nYMax, 
-                                  dX1, dY1);
+    int i;
 
-       /*-------------------------------------------------------------
-         * ... and make sure that Min < Max
-         *------------------------------------------------------------*/
-        psExtent->MinX = MIN(dX0, dX1);
-        psExtent->MaxX = MAX(dX0, dX1);
-        psExtent->MinY = MIN(dY0, dY1);
-        psExtent->MaxY = MAX(dY0, dY1);
+    if (m_nNextChunk >= m_nChunks)
+        return NULL;
 
-        return OGRERR_NONE;
+    for(i = 0; i < m_nBatches; i++)
+    {
+        if (m_pasBatches[i].nChunk == -1)
+        {
+            m_pasBatches[i].nChunk = m_nNextChunk++;
+            m_pasBatches[i].bReady = FALSE;
+            m_pasBatches[i].nFeatures = 0;
+            return m_pasBatches + i;
+        }
     }
 
-    return OGRERR_FAILURE;
+    return NULL;
 }
 
 /**********************************************************************
- *                   TABFile::GetFeatureCountByType()
- *
- * Return number of features of each type.
- *
- * Note that the sum of the 4 returned values may be different from
- * the total number of features since features with NONE geometry
- * are not taken into account here.
+ *                   TABParallelScan::ReadChunk()
  *
- * Note: the bForce flag has nmo effect on .TAB files since the info
- * is always in the header.
+ * Read the features of the chunk of psBatch that pass the filters using 
+ * poCursor.  Called without m_hMutex held: the batch and the cursor 
+ * belong to the caller until the batch is flagged ready.
  *
- * Returns 0 on success, or silently returns -1 (with no error) if this
- * information is not available.
+ * Returns 0 on success, -1 on error.
  **********************************************************************/
-int TABFile::GetFeatureCountByType(int &numPoints, int &numLines,
-                                   int &numRegions, int &numTexts,
-                                   GBool /* bForce = TRUE*/ )
+int TABParallelScan::ReadChunk(TABFileCursor *poCursor, 
+                               TABScanBatch *psBatch)
 {
-    TABMAPHeaderBlock *poHeader;
+    OGRFeature *poFeature;
+    int nFirst = psBatch->nChunk * TAB_SCAN_CHUNK_SIZE;
+    int nCount = MIN(TAB_SCAN_CHUNK_SIZE, m_nFeatureIds - nFirst);
 
-    if (m_poMAPFile && (poHeader=m_poMAPFile->GetHeaderBlock()) != NULL)
-    {
-        numPoints  = poHeader->m_numPointObjects;
-        numLines   = poHeader->m_numLineObjects;
-        numRegions = poHeader->m_numRegionObjects;
-        numTexts   = poHeader->m_numTextObjects;
-    }
+    if (m_panFeatureIds != NULL)
+        poCursor->SetFeatureIdList(m_panFeatureIds + nFirst, nCount);
     else
+        poCursor->SetFeatureIdRange(nFirst + 1, nFirst + nCount);
+
+    CPLErrorReset();
+    while((poFeature = poCursor->GetNextFeature()) != NULL)
     {
-        numPoints = numLines = numRegions = numTexts = 0;
-        return -1;
+        if (m_poAttrQuery != NULL && !m_poAttrQuery->Evaluate(poFeature))
+        {
+            delete poFeature;
+            continue;
+        }
+
+        if (psBatch->nFeatures >= psBatch->nMaxFeatures)
+        {
+            psBatch->nMaxFeatures = psBatch->nMaxFeatures * 2 + 64;
+            psBatch->papoFeatures = (OGRFeature **) 
+                CPLRealloc(psBatch->papoFeatures, 
+                           psBatch->nMaxFeatures * sizeof(OGRFeature*));
+        }
+        psBatch->papoFeatures[psBatch->nFeatures++] = poFeature;
     }
 
-    return 0;
+    return (CPLGetLastErrorType() == CE_Failure) ? -1 : 0;
 }
 
-
 /**********************************************************************
- *                   TABFile::SetMIFCoordSys()
- *
- * Set projection for a new file using a MIF coordsys string.
- *
- * This function must be called after creating a new dataset and before any
- * feature can be written to it.
+ *                   TABParallelScan::WorkerThread()
  *
- * Returns 0 on success, -1 on error.
+ * Main function of the worker threads: read chunks until all are read
+ * or the scan is closed.
  **********************************************************************/
-int TABFile::SetMIFCoordSys(const char *pszMIFCoordSys)
+void TABParallelScan::WorkerThread(void *pData)
 {
-    if (m_eAccessMode != TABWrite)
-    {
-        CPLError(CE_Failure, CPLE_NotSupported,
-                 "SetMIFCoordSys() can be used only with Write access.");
-        return -1;
-    }
+    TABParallelScan *poScan = (TABParallelScan *) pData;
+    TABFileCursor   *poCursor;
+    TABScanBatch    *psBatch;
+    int              i, nStatus;
 
-    /*-----------------------------------------------------------------
-     * Check that dataset has been created but no feature set yet.
-     *----------------------------------------------------------------*/
-    if (m_poMAPFile && m_nLastFeatureId < 1)
-    {
-        OGRSpatialReference *poSpatialRef;
+    CPLAcquireMutex(poScan->m_hMutex, 1000.0);
 
-        poSpatialRef = MITABCoordSys2SpatialRef( pszMIFCoordSys );
+    /* Each worker takes the first cursor that is not in use */
+    for(i = 0; i < poScan->m_nCursors && poScan->m_papoCursors[i] == NULL; 
+        i++) {}
+    poCursor = poScan->m_papoCursors[i];
+    poScan->m_papoCursors[i] = NULL;
 
-        if (poSpatialRef)
+    while(!poScan->m_bStop && !poScan->m_bError)
+    {
+        psBatch = poScan->ClaimChunk();
+        if (psBatch == NULL)
         {
-            double dXMin, dYMin, dXMax, dYMax;
-            if (SetSpatialRef(poSpatialRef) == 0)
-            {
-                if (MITABExtractCoordSysBounds(pszMIFCoordSys,
-                                               dXMin, dYMin, 
-                                               dXMax, dYMax) == TRUE)
-                {
-                    // If the coordsys string contains bounds, then use them
-                    if (SetBounds(dXMin, dYMin, dXMax, dYMax) != 0)
-                    {
-                        // Failed Setting Bounds... an error should have
-                        // been already reported.
-                        return -1;
-                    }
-                }
-            }
-            else
-            {
-                // Failed setting poSpatialRef... and error should have 
-                // been reported.
-                return -1;
-            }
-
-            // Release our handle on poSpatialRef
-            if( poSpatialRef->Dereference() == 0 )
-                delete poSpatialRef;
+            if (poScan->m_nNextChunk >= poScan->m_nChunks)
+                break;
+            CPLCondWait(poScan->m_hCond, poScan->m_hMutex);
+            continue;
         }
-    }
-    else
-    {
-        CPLError(CE_Failure, CPLE_AssertionFailed,
-                 "SetMIFCoordSys() can be called only after dataset has been "
-                 "created and before any feature is set.");
-        return -1;
+
+        CPLReleaseMutex(poScan->m_hMutex);
+        nStatus = poScan->ReadChunk(poCursor, psBatch);
+        CPLAcquireMutex(poScan->m_hMutex, 1000.0);
+
+        psBatch->bReady = TRUE;
+        if (nStatus != 0)
+            poScan->m_bError = TRUE;
+        CPLCondBroadcast(poScan->m_hCond);
     }
 
-    return 0;
+    /* Give the cursor back so that Close() can delete it */
+    poScan->m_papoCursors[i] = poCursor;
+
+    CPLReleaseMutex(poScan->m_hMutex);
 }
 
 /**********************************************************************
- *                   TABFile::SetProjInfo()
- *
- * Set projection for a new file using a TABProjInfo structure.
- *
- * This function must be called after creating a new dataset and before any
- * feature can be written to it.
- *
- * This call will also trigger a lookup of default bounds for the specified
- * projection (except nonearth), and reset the m_bBoundsValid flag.
+ *                   TABParallelScan::GetNextFeature()
  *
- * Returns 0 on success, -1 on error.
+ * Return the next feature of the scan, or NULL when all features have 
+ * been returned or on error.  The returned feature is owned by the 
+ * caller.
  **********************************************************************/
-int TABFile::SetProjInfo(TABProjInfo *poPI)
+OGRFeature *TABParallelScan::GetNextFeature()
 {
-    if (m_eAccessMode != TABWrite)
-    {
-        CPLError(CE_Failure, CPLE_NotSupported,
-                 "SetProjInfo() can be used only with Write access.");
-        return -1;
-    }
+    TABScanBatch *psBatch;
+    OGRFeature   *poFeature;
+    int           i, nStatus;
 
-    /*-----------------------------------------------------------------
-     * Check that dataset has been created but no feature set yet.
-     *----------------------------------------------------------------*/
-    if (m_poMAPFile && m_nLastFeatureId < 1)
-    {
-        if (m_poMAPFile->GetHeaderBlock()->SetProjInfo( poPI ) != 0)
-            return -1;
-    }
-    else
-    {
-        CPLError(CE_Failure, CPLE_AssertionFailed,
-                 "SetProjInfo() can be called only after dataset has been "
-                 "created and before any feature is set.");
-        return -1;
-    }
+    if (m_poParent == NULL)
+        return NULL;
 
     /*-----------------------------------------------------------------
-     * Lookup default bounds and reset m_bBoundsSet flag
+     * Loop since batches can be empty if no feature of their chunk
+     * passed the filters.
      *----------------------------------------------------------------*/
-    double dXMin, dYMin, dXMax, dYMax;
-
-    m_bBoundsSet = FALSE;
-    if (MITABLookupCoordSysBounds(poPI, dXMin, dYMin, dXMax, dYMax) == TRUE)
+    for( ; ; )
     {
-        SetBounds(dXMin, dYMin, dXMax, dYMax);
-    }
+        if (m_psCurBatch != NULL && m_iCurFeature < m_psCurBatch->nFeatures)
+        {
+            poFeature = m_psCurBatch->papoFeatures[m_iCurFeature];
+            m_psCurBatch->papoFeatures[m_iCurFeature++] = NULL;
+            return poFeature;
+        }
 
-    return 0;
-}
+        CPLAcquireMutex(m_hMutex, 1000.0);
 
+        /*-------------------------------------------------------------
+         * Release the batch that was just consumed to the workers.
+         *------------------------------------------------------------*/
+        if (m_psCurBatch != NULL)
+        {
+            m_psCurBatch->nChunk = -1;
+            m_psCurBatch->bReady = FALSE;
+            m_psCurBatch->nFeatures = 0;
+            m_psCurBatch = NULL;
+            m_nChunksDone++;
+            CPLCondBroadcast(m_hCond);
+        }
 
-/************************************************************************/
-/*                           TestCapability()                           */
-/************************************************************************/
+        psBatch = NULL;
+        while(!m_bError && m_nChunksDone < m_nChunks)
+        {
+            for(i = 0; i < m_nBatches; i++)
+            {
+                if (m_pasBatches[i].bReady && 
+                    (!m_bOrdered || m_pasBatches[i].nChunk == m_nChunksDone))
+                {
+                    psBatch = m_pasBatches + i;
+                    break;
+                }
+            }
 
-int TABFile::TestCapability( const char * pszCap )
+            if (psBatch != NULL)
+                break;
 
-{
-    if( EQUAL(pszCap,OLCRandomRead) )
-        return TRUE;
+            if (m_nThreads > 0)
+            {
+                CPLCondWait(m_hCond, m_hMutex);
+                continue;
+            }
 
-    else if( EQUAL(pszCap,OLCSequentialWrite) )
-        return m_eAccessMode == TABWrite;
+            /*---------------------------------------------------------
+             * No worker threads: read the next chunk ourselves.
+             *--------------------------------------------------------*/
+            psBatch = ClaimChunk();
+            if (psBatch == NULL)
+                break;
 
-    else if( EQUAL(pszCap,OLCRandomWrite) )
-        return FALSE;
+            CPLReleaseMutex(m_hMutex);
+            nStatus = ReadChunk(m_papoCursors[0], psBatch);
+            CPLAcquireMutex(m_hMutex, 1000.0);
 
-    else if( EQUAL(pszCap,OLCFastFeatureCount) )
-        return m_poFilterGeom == NULL
-            && m_poAttrQuery == NULL;
+            psBatch->bReady = TRUE;
+            if (nStatus != 0)
+                m_bError = TRUE;
+        }
 
-    else if( EQUAL(pszCap,OLCFastSpatialFilter) )
-        return TRUE;
+        if (m_bError)
+        {
+            CPLReleaseMutex(m_hMutex);
+            CPLError(CE_Failure, CPLE_FileIO,
+                     "GetNextFeature() failed: error reading features of %s",
+                     m_poParent->GetTableName());
+            return NULL;
+        }
 
-    else if( EQUAL(pszCap,OLCFastGetExtent) )
-        return TRUE;
+        m_psCurBatch = psBatch;
+        m_iCurFeature = 0;
 
-    else if( EQUAL(pszCap,OLCCreateField) )
-        return TRUE;
+        CPLReleaseMutex(m_hMutex);
 
-    else 
-        return FALSE;
+        if (m_psCurBatch == NULL)
+            return NULL;
+    }
 }
 
 /**********************************************************************
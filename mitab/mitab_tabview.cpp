@@ -1639,14 +1639,30 @@ TABFeature *TABRelation::GetFeature(int nFeatureId)
      *          one new feature for each of them.
      *----------------------------------------------------------------*/
     TABFeature *poRelFeature=NULL;
-    GByte *pKey = BuildFieldKey(poMainFeature, m_nMainFieldNo,
+    int i, bUseRelFields = FALSE;
+
+    /*-----------------------------------------------------------------
+     * Don't bother probing the index and reading the related record if
+     * none of the related table fields is part of the view.
+     *----------------------------------------------------------------*/
+    for(i=0; !bUseRelFields &&
+             i<m_poRelTable->GetLayerDefn()->GetFieldCount(); i++)
+    {
+        if (m_panRelTableFieldMap[i] != -1)
+            bUseRelFields = TRUE;
+    }
+
+    if (bUseRelFields)
+    {
+        GByte *pKey = BuildFieldKey(poMainFeature, m_nMainFieldNo,
                             m_poMainTable->GetNativeFieldType(m_nMainFieldNo),
-                                m_nRelFieldIndexNo);
-    int i;
-    int nRelFeatureId = m_poRelINDFileRef->FindFirst(m_nRelFieldIndexNo, pKey);
+                                    m_nRelFieldIndexNo);
+        int nRelFeatureId = m_poRelINDFileRef->FindFirst(m_nRelFieldIndexNo, 
+                                                         pKey);
     
-    if (nRelFeatureId > 0)
-        poRelFeature = m_poRelTable->GetFeatureRef(nRelFeatureId);
+        if (nRelFeatureId > 0)
+            poRelFeature = m_poRelTable->GetFeatureRef(nRelFeatureId);
+    }
 
     /*-----------------------------------------------------------------
      * Copy fields from poMainFeature
@@ -61,6 +61,170 @@
  *                      class TABToolDefTable
  *====================================================================*/
 
+/*=====================================================================
+ * Hash index used to look up existing tool defs in Add???DefRef().
+ *
+ * The lookup functions receive the array of tool defs from the table
+ * as a void** and return the 1-based index of the first tool def equal
+ * to the one passed in (i.e. the same index that a linear scan of the
+ * table would find), so that the file contents are not affected.
+ *====================================================================*/
+
+typedef GUInt32 (*TABToolDefHashFunc)(const void *);
+typedef GBool   (*TABToolDefEqualFunc)(const void *, const void *);
+
+#define TAB_HASH_COMBINE(h, v)  (((h) ^ (GUInt32)(v)) * 16777619U)
+
+static GUInt32 TABPenDefHash(const void *p)
+{
+    const TABPenDef *psDef = (const TABPenDef *)p;
+    GUInt32 nHash = 2166136261U;
+    nHash = TAB_HASH_COMBINE(nHash, psDef->nPixelWidth);
+    nHash = TAB_HASH_COMBINE(nHash, psDef->nLinePattern);
+    nHash = TAB_HASH_COMBINE(nHash, psDef->nPointWidth);
+    nHash = TAB_HASH_COMBINE(nHash, psDef->rgbColor);
+    return nHash;
+}
+
+static GBool TABPenDefEqual(const void *p1, const void *p2)
+{
+    const TABPenDef *psDef1 = (const TABPenDef *)p1;
+    const TABPenDef *psDef2 = (const TABPenDef *)p2;
+    return (psDef1->nPixelWidth == psDef2->nPixelWidth &&
+            psDef1->nLinePattern == psDef2->nLinePattern &&
+            psDef1->nPointWidth == psDef2->nPointWidth &&
+            psDef1->rgbColor == psDef2->rgbColor);
+}
+
+static GUInt32 TABBrushDefHash(const void *p)
+{
+    const TABBrushDef *psDef = (const TABBrushDef *)p;
+    GUInt32 nHash = 2166136261U;
+    nHash = TAB_HASH_COMBINE(nHash, psDef->nFillPattern);
+    nHash = TAB_HASH_COMBINE(nHash, psDef->bTransparentFill);
+    nHash = TAB_HASH_COMBINE(nHash, psDef->rgbFGColor);
+    nHash = TAB_HASH_COMBINE(nHash, psDef->rgbBGColor);
+    return nHash;
+}
+
+static GBool TABBrushDefEqual(const void *p1, const void *p2)
+{
+    const TABBrushDef *psDef1 = (const TABBrushDef *)p1;
+    const TABBrushDef *psDef2 = (const TABBrushDef *)p2;
+    return (psDef1->nFillPattern == psDef2->nFillPattern &&
+            psDef1->bTransparentFill == psDef2->bTransparentFill &&
+            psDef1->rgbFGColor == psDef2->rgbFGColor &&
+            psDef1->rgbBGColor == psDef2->rgbBGColor);
+}
+
+/* Font names are compared with EQUAL() so the hash is case insensitive */
+static GUInt32 TABFontDefHash(const void *p)
+{
+    const TABFontDef *psDef = (const TABFontDef *)p;
+    GUInt32 nHash = 2166136261U;
+    for(const char *pszName = psDef->szFontName; *pszName != '\0'; pszName++)
+        nHash = TAB_HASH_COMBINE(nHash, toupper((unsigned char)*pszName));
+    return nHash;
+}
+
+static GBool TABFontDefEqual(const void *p1, const void *p2)
+{
+    return EQUAL(((const TABFontDef *)p1)->szFontName,
+                 ((const TABFontDef *)p2)->szFontName);
+}
+
+static GUInt32 TABSymbolDefHash(const void *p)
+{
+    const TABSymbolDef *psDef = (const TABSymbolDef *)p;
+    GUInt32 nHash = 2166136261U;
+    nHash = TAB_HASH_COMBINE(nHash, psDef->nSymbolNo);
+    nHash = TAB_HASH_COMBINE(nHash, psDef->nPointSize);
+    nHash = TAB_HASH_COMBINE(nHash, psDef->_nUnknownValue_);
+    nHash = TAB_HASH_COMBINE(nHash, psDef->rgbColor);
+    return nHash;
+}
+
+static GBool TABSymbolDefEqual(const void *p1, const void *p2)
+{
+    const TABSymbolDef *psDef1 = (const TABSymbolDef *)p1;
+    const TABSymbolDef *psDef2 = (const TABSymbolDef *)p2;
+    return (psDef1->nSymbolNo == psDef2->nSymbolNo &&
+            psDef1->nPointSize == psDef2->nPointSize &&
+            psDef1->_nUnknownValue_ == psDef2->_nUnknownValue_ &&
+            psDef1->rgbColor == psDef2->rgbColor);
+}
+
+/**********************************************************************
+ *                   TABToolDefIndexFind()
+ *
+ * Return the 1-based index of the tool def equal to psDef, or 0 if
+ * there is none in the index.
+ **********************************************************************/
+static int TABToolDefIndexFind(TABToolDefIndex *psIndex, void **papDefs,
+                               const void *psDef, 
+                               TABToolDefHashFunc pfnHash,
+                               TABToolDefEqualFunc pfnEqual)
+{
+    int i, nToolIndex;
+
+    if (psIndex->nSize == 0)
+        return 0;
+
+    for(i = pfnHash(psDef) & (psIndex->nSize-1);
+        (nToolIndex = psIndex->panSlots[i]) != 0;
+        i = (i+1) & (psIndex->nSize-1))
+    {
+        if (pfnEqual(papDefs[nToolIndex-1], psDef))
+            return nToolIndex;
+    }
+
+    return 0;
+}
+
+/**********************************************************************
+ *                   TABToolDefIndexAdd()
+ *
+ * Make sure that the first numDefs tool defs of papDefs are in the index.
+ * The index is (re)built as needed, e.g. for tool defs that were read 
+ * from an existing file or when it has to grow.
+ *
+ * Tool defs equal to one already in the index are skipped, so that
+ * lookups always return the lowest matching index.
+ **********************************************************************/
+static void TABToolDefIndexAdd(TABToolDefIndex *psIndex, void **papDefs,
+                               int numDefs, TABToolDefHashFunc pfnHash,
+                               TABToolDefEqualFunc pfnEqual)
+{
+    int i, iDef;
+
+    if (numDefs*2 > psIndex->nSize)
+    {
+        // Keep load factor under 50%
+        psIndex->nSize = MAX(psIndex->nSize, 64);
+        while(numDefs*2 > psIndex->nSize)
+            psIndex->nSize *= 2;
+        CPLFree(psIndex->panSlots);
+        psIndex->panSlots = (int*)CPLCalloc(psIndex->nSize, sizeof(int));
+        psIndex->numIndexed = 0;
+    }
+
+    for(iDef = psIndex->numIndexed; iDef < numDefs; iDef++)
+    {
+        for(i = pfnHash(papDefs[iDef]) & (psIndex->nSize-1);
+            psIndex->panSlots[i] != 0;
+            i = (i+1) & (psIndex->nSize-1))
+        {
+            if (pfnEqual(papDefs[psIndex->panSlots[i]-1], papDefs[iDef]))
+                break;
+        }
+
+        if (psIndex->panSlots[i] == 0)
+            psIndex->panSlots[i] = iDef+1;
+    }
+    psIndex->numIndexed = numDefs;
+}
+
+
 /**********************************************************************
  *                   TABToolDefTable::TABToolDefTable()
  *
@@ -81,6 +245,10 @@ TABToolDefTable::TABToolDefTable()
     m_numAllocatedFonts = 0;
     m_numAllocatedSymbols = 0;
 
+    memset(&m_sPenIndex, 0, sizeof(TABToolDefIndex));
+    memset(&m_sBrushIndex, 0, sizeof(TABToolDefIndex));
+    memset(&m_sFontIndex, 0, sizeof(TABToolDefIndex));
+    memset(&m_sSymbolIndex, 0, sizeof(TABToolDefIndex));
 }
 
 /**********************************************************************
@@ -108,6 +276,11 @@ TABToolDefTable::~TABToolDefTable()
         CPLFree(m_papsSymbol[i]);
     CPLFree(m_papsSymbol);
 
+    CPLFree(m_sPenIndex.panSlots);
+    CPLFree(m_sBrushIndex.panSlots);
+    CPLFree(m_sFontIndex.panSlots);
+    CPLFree(m_sSymbolIndex.panSlots);
+
 }
 
 
@@ -412,8 +585,7 @@ TABPenDef *TABToolDefTable::GetPenDefRef(int nIndex)
  **********************************************************************/
 int TABToolDefTable::AddPenDefRef(TABPenDef *poNewPenDef)
 {
-    int i, nNewPenIndex = 0;
-    TABPenDef *poDef;
+    int nNewPenIndex = 0;
 
     if (poNewPenDef == NULL)
         return -1;
@@ -425,20 +597,15 @@ int TABToolDefTable::AddPenDefRef(TABPenDef *poNewPenDef)
         return 0;
 
     /*-----------------------------------------------------------------
-     * Start by searching the list of existing pens
+     * Start by searching the list of existing pens (hashed lookup)
      *----------------------------------------------------------------*/
-    for (i=0; nNewPenIndex == 0 && i<m_numPen; i++)
-    {
-        poDef = m_papsPen[i];
-        if (poDef->nPixelWidth == poNewPenDef->nPixelWidth &&
-            poDef->nLinePattern == poNewPenDef->nLinePattern &&
-            poDef->nPointWidth == poNewPenDef->nPointWidth &&
-            poDef->rgbColor == poNewPenDef->rgbColor)
-        {
-            nNewPenIndex = i+1; // Fount it!
-            poDef->nRefCount++;
-        }               
-    }
+    TABToolDefIndexAdd(&m_sPenIndex, (void**)m_papsPen, m_numPen,
+                       TABPenDefHash, TABPenDefEqual);
+    nNewPenIndex = TABToolDefIndexFind(&m_sPenIndex, (void**)m_papsPen,
+                                       poNewPenDef,
+                                       TABPenDefHash, TABPenDefEqual);
+    if (nNewPenIndex > 0)
+        m_papsPen[nNewPenIndex-1]->nRefCount++;
 
     /*-----------------------------------------------------------------
      * OK, we did not find a match, then create a new entry
@@ -502,8 +669,7 @@ TABBrushDef *TABToolDefTable::GetBrushDefRef(int nIndex)
  **********************************************************************/
 int TABToolDefTable::AddBrushDefRef(TABBrushDef *poNewBrushDef)
 {
-    int i, nNewBrushIndex = 0;
-    TABBrushDef *poDef;
+    int nNewBrushIndex = 0;
 
     if (poNewBrushDef == NULL)
         return -1;
@@ -515,20 +681,15 @@ int TABToolDefTable::AddBrushDefRef(TABBrushDef *poNewBrushDef)
         return 0;
 
     /*-----------------------------------------------------------------
-     * Start by searching the list of existing Brushs
+     * Start by searching the list of existing Brushs (hashed lookup)
      *----------------------------------------------------------------*/
-    for (i=0; nNewBrushIndex == 0 && i<m_numBrushes; i++)
-    {
-        poDef = m_papsBrush[i];
-        if (poDef->nFillPattern == poNewBrushDef->nFillPattern &&
-            poDef->bTransparentFill == poNewBrushDef->bTransparentFill &&
-            poDef->rgbFGColor == poNewBrushDef->rgbFGColor &&
-            poDef->rgbBGColor == poNewBrushDef->rgbBGColor)
-        {
-            nNewBrushIndex = i+1; // Fount it!
-            poDef->nRefCount++;
-        }               
-    }
+    TABToolDefIndexAdd(&m_sBrushIndex, (void**)m_papsBrush, m_numBrushes,
+                       TABBrushDefHash, TABBrushDefEqual);
+    nNewBrushIndex = TABToolDefIndexFind(&m_sBrushIndex, (void**)m_papsBrush,
+                                         poNewBrushDef,
+                                         TABBrushDefHash, TABBrushDefEqual);
+    if (nNewBrushIndex > 0)
+        m_papsBrush[nNewBrushIndex-1]->nRefCount++;
 
     /*-----------------------------------------------------------------
      * OK, we did not find a match, then create a new entry
@@ -593,24 +754,21 @@ TABFontDef *TABToolDefTable::GetFontDefRef(int nIndex)
  **********************************************************************/
 int TABToolDefTable::AddFontDefRef(TABFontDef *poNewFontDef)
 {
-    int i, nNewFontIndex = 0;
-    TABFontDef *poDef;
+    int nNewFontIndex = 0;
 
     if (poNewFontDef == NULL)
         return -1;
 
     /*-----------------------------------------------------------------
-     * Start by searching the list of existing Fonts
+     * Start by searching the list of existing Fonts (hashed lookup)
      *----------------------------------------------------------------*/
-    for (i=0; nNewFontIndex == 0 && i<m_numFonts; i++)
-    {
-        poDef = m_papsFont[i];
-        if (EQUAL(poDef->szFontName, poNewFontDef->szFontName))
-        {
-            nNewFontIndex = i+1; // Fount it!
-            poDef->nRefCount++;
-        }               
-    }
+    TABToolDefIndexAdd(&m_sFontIndex, (void**)m_papsFont, m_numFonts,
+                       TABFontDefHash, TABFontDefEqual);
+    nNewFontIndex = TABToolDefIndexFind(&m_sFontIndex, (void**)m_papsFont,
+                                        poNewFontDef,
+                                        TABFontDefHash, TABFontDefEqual);
+    if (nNewFontIndex > 0)
+        m_papsFont[nNewFontIndex-1]->nRefCount++;
 
     /*-----------------------------------------------------------------
      * OK, we did not find a match, then create a new entry
@@ -676,27 +834,21 @@ TABSymbolDef *TABToolDefTable::GetSymbolDefRef(int nIndex)
  **********************************************************************/
 int TABToolDefTable::AddSymbolDefRef(TABSymbolDef *poNewSymbolDef)
 {
-    int i, nNewSymbolIndex = 0;
-    TABSymbolDef *poDef;
+    int nNewSymbolIndex = 0;
 
     if (poNewSymbolDef == NULL)
         return -1;
 
     /*-----------------------------------------------------------------
-     * Start by searching the list of existing Symbols
+     * Start by searching the list of existing Symbols (hashed lookup)
      *----------------------------------------------------------------*/
-    for (i=0; nNewSymbolIndex == 0 && i<m_numSymbols; i++)
-    {
-        poDef = m_papsSymbol[i];
-        if (poDef->nSymbolNo == poNewSymbolDef->nSymbolNo &&
-            poDef->nPointSize == poNewSymbolDef->nPointSize &&
-            poDef->_nUnknownValue_ == poNewSymbolDef->_nUnknownValue_ &&
-            poDef->rgbColor == poNewSymbolDef->rgbColor )
-        {
-            nNewSymbolIndex = i+1; // Fount it!
-            poDef->nRefCount++;
-        }               
-    }
+    TABToolDefIndexAdd(&m_sSymbolIndex, (void**)m_papsSymbol, m_numSymbols,
+                       TABSymbolDefHash, TABSymbolDefEqual);
+    nNewSymbolIndex = TABToolDefIndexFind(&m_sSymbolIndex, (void**)m_papsSymbol,
+                                          poNewSymbolDef,
+                                          TABSymbolDefHash, TABSymbolDefEqual);
+    if (nNewSymbolIndex > 0)
+        m_papsSymbol[nNewSymbolIndex-1]->nRefCount++;
 
     /*-----------------------------------------------------------------
      * OK, we did not find a match, then create a new entry
@@ -755,3 +755,517 @@ int TABUnitIdFromString(const char *pszName)
     return -1;
 }
 
+
+/**********************************************************************
+ *                       TABParseDecimal()
+ *
+ * Convert the text of a decimal field (e.g. "   -1234.567") to a double,
+ * reading at most nLen chars (or up to the terminating '\0' if nLen < 0).
+ *
+ * Values made of at most 15 significant digits and 22 decimals (which
+ * covers everything MapInfo can store in a decimal field) are converted
+ * directly: the digits are accumulated in an integer which is then
+ * divided by an exact power of 10, which gives the same correctly rounded
+ * result as strtod().  Anything else goes through CPLAtof().  In both
+ * cases the conversion does not depend on the current locale.
+ **********************************************************************/
+static const double gadfTABPow10[] = 
+{ 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+double TABParseDecimal(const char *pszValue, int nLen)
+{
+    const char *psz = pszValue, *pszEnd;
+    GUIntBig    nMantissa = 0;
+    int         numDigits = 0, numDecimals = 0;
+    GBool       bNegative = FALSE, bHaveDigits = FALSE, bHaveDot = FALSE;
+    double      dValue;
+
+    pszEnd = (nLen < 0) ? pszValue + strlen(pszValue) : pszValue + nLen;
+
+    while(psz < pszEnd && *psz == ' ')
+        psz++;
+
+    if (psz == pszEnd || *psz == '\0')
+        return 0.0;     // Empty value
+
+    if (*psz == '-' || *psz == '+')
+        bNegative = (*(psz++) == '-');
+
+    for( ; psz < pszEnd; psz++)
+    {
+        if (*psz >= '0' && *psz <= '9')
+        {
+            bHaveDigits = TRUE;
+            if (bHaveDot)
+                numDecimals++;
+            if (nMantissa != 0 || *psz != '0')
+            {
+                nMantissa = nMantissa * 10 + (*psz - '0');
+                if (++numDigits > 15)
+                    break;
+            }
+        }
+        else if (*psz == '.' && !bHaveDot)
+            bHaveDot = TRUE;
+        else
+            break;
+    }
+
+    // Only trailing spaces or '\0' padding may follow the number
+    while(psz < pszEnd && *psz == ' ')
+        psz++;
+
+    if (!bHaveDigits || numDigits > 15 || numDecimals > 22 ||
+        (psz < pszEnd && *psz != '\0'))
+    {
+        char szBuf[256];
+        int  nCopyLen = MIN((int)(pszEnd - pszValue), 255);
+
+        strncpy(szBuf, pszValue, nCopyLen);
+        szBuf[nCopyLen] = '\0';
+        return CPLAtof(szBuf);
+    }
+
+    dValue = ((double)(GIntBig)nMantissa) / gadfTABPow10[numDecimals];
+
+    return bNegative ? -dValue : dValue;
+}
+
+/**********************************************************************
+ *                       TABFormatDecimal()
+ *
+ * Format a decimal field value into pszBuf, producing exactly the same
+ * nWidth chars as sprintf("%*.*f", nWidth, nPrec, dValue) (keeping only
+ * the last nWidth chars if the value does not fit, as MITAB has always
+ * done), followed by a '\0'.  pszBuf must be at least nWidth+1 bytes.
+ *
+ * The value is scaled by 10^nPrec and rounded to an integer directly
+ * whenever the rounding decision is certain, i.e. when the scaled value
+ * is not within rounding error of a .5 tie.  Other values (including
+ * very large ones, NaN and Inf) are formatted with CPLSPrintf().
+ **********************************************************************/
+int TABFormatDecimal(char *pszBuf, double dValue, int nWidth, int nPrec)
+{
+    char        szTmp[64];
+    char        *psz = NULL;
+    int         nLen;
+
+    if (nWidth < 0)
+        nWidth = 0;
+
+    if (nPrec >= 0 && nPrec <= 15)
+    {
+        union { double d; GUIntBig n; } uValue;
+        GBool   bNegative;
+        double  dScaled, dFloor, dFrac;
+
+        uValue.d = dValue;
+        bNegative = (uValue.n >> 63) != 0;   // Catches -0.0 too
+        dScaled = (bNegative ? -dValue : dValue) * gadfTABPow10[nPrec];
+
+        // 4503599627370496 = 2^52
+        if (dScaled < 4503599627370496.0 &&
+            fabs((dFrac = dScaled - (dFloor = floor(dScaled))) - 0.5) > 
+                                       dScaled * 2.3e-16)
+        {
+            GUIntBig nValue = (GUIntBig)dFloor + (dFrac > 0.5 ? 1 : 0);
+            int      i;
+
+            psz = szTmp + sizeof(szTmp) - 1;
+            *psz = '\0';
+
+            for(i=0; i<nPrec; i++)
+            {
+                *(--psz) = (char)('0' + (int)(nValue % 10));
+                nValue /= 10;
+            }
+            if (nPrec > 0)
+                *(--psz) = '.';
+            do
+            {
+                *(--psz) = (char)('0' + (int)(nValue % 10));
+                nValue /= 10;
+            } while(nValue != 0);
+
+            if (bNegative)
+                *(--psz) = '-';
+        }
+    }
+
+    if (psz == NULL)
+        psz = (char*)CPLSPrintf("%.*f", nPrec, dValue);
+
+    /*-----------------------------------------------------------------
+     * Right-align in nWidth chars, truncating on the left if too long.
+     *----------------------------------------------------------------*/
+    nLen = strlen(psz);
+    if (nLen >= nWidth)
+    {
+        memcpy(pszBuf, psz + nLen - nWidth, nWidth);
+    }
+    else
+    {
+        memset(pszBuf, ' ', nWidth - nLen);
+        memcpy(pszBuf + nWidth - nLen, psz, nLen);
+    }
+    pszBuf[nWidth] = '\0';
+
+    return 0;
+}
+
+/**********************************************************************
+ *                       TABFormatDate()
+ *                       TABFormatTime()
+ *
+ * Format date and time values in the "YYYYMMDD" and "HHMMSSmmm" forms
+ * used by TABDATFile, i.e. the same as sprintf("%4.4d%2.2d%2.2d") and
+ * sprintf("%2.2d%2.2d%2.2d%3.3d").  pszBuf must be at least 10 bytes.
+ *
+ * Returns a pointer to the terminating '\0' so that a date and a time
+ * can be formatted one after the other.
+ **********************************************************************/
+static char *TABFormatDigits(char *pszBuf, int nValue, int numDigits)
+{
+    int i;
+
+    for(i=numDigits-1; i>=0; i--)
+    {
+        pszBuf[i] = (char)('0' + nValue % 10);
+        nValue /= 10;
+    }
+
+    return pszBuf + numDigits;
+}
+
+char *TABFormatDate(char *pszBuf, int nYear, int nMonth, int nDay)
+{
+    if (nYear < 0 || nYear > 9999 || nMonth < 0 || nMonth > 99 ||
+        nDay < 0 || nDay > 99)
+    {
+        sprintf(pszBuf, "%4.4d%2.2d%2.2d", nYear, nMonth, nDay);
+        return pszBuf + strlen(pszBuf);
+    }
+
+    pszBuf = TABFormatDigits(pszBuf, nYear, 4);
+    pszBuf = TABFormatDigits(pszBuf, nMonth, 2);
+    pszBuf = TABFormatDigits(pszBuf, nDay, 2);
+    *pszBuf = '\0';
+
+    return pszBuf;
+}
+
+char *TABFormatTime(char *pszBuf, int nHour, int nMinute, int nSecond,
+                    int nMS)
+{
+    if (nHour < 0 || nHour > 99 || nMinute < 0 || nMinute > 99 ||
+        nSecond < 0 || nSecond > 99 || nMS < 0 || nMS > 999)
+    {
+        sprintf(pszBuf, "%2.2d%2.2d%2.2d%3.3d", nHour, nMinute, nSecond, nMS);
+        return pszBuf + strlen(pszBuf);
+    }
+
+    pszBuf = TABFormatDigits(pszBuf, nHour, 2);
+    pszBuf = TABFormatDigits(pszBuf, nMinute, 2);
+    pszBuf = TABFormatDigits(pszBuf, nSecond, 2);
+    pszBuf = TABFormatDigits(pszBuf, nMS, 3);
+    *pszBuf = '\0';
+
+    return pszBuf;
+}
+
+/**********************************************************************
+ *                       TABParseDigits()
+ *
+ * Parse a run of exactly numDigits decimal digits starting at pszValue.
+ *
+ * Returns TRUE and sets *pnValue on success, or FALSE if one of the
+ * chars is not a digit.
+ **********************************************************************/
+GBool TABParseDigits(const char *pszValue, int numDigits, int *pnValue)
+{
+    int i, nValue = 0;
+
+    for(i=0; i<numDigits; i++)
+    {
+        if (pszValue[i] < '0' || pszValue[i] > '9')
+            return FALSE;
+        nValue = nValue * 10 + (pszValue[i] - '0');
+    }
+
+    *pnValue = nValue;
+    return TRUE;
+}
+
+/**********************************************************************
+ *                       TABAtof()
+ *
+ * Locale independent replacement for atof(), used for the coordinates
+ * and other numeric values read from MIF files.  Like atof(), it stops
+ * at the first char that cannot be part of the number, so it can be
+ * used directly on a TABToken.
+ *
+ * Values with at most 15 significant digits and a power of 10 within
+ * [-22, 22] (which covers everything written with "%.15g", as MITAB
+ * does) are converted with a single exact multiplication or division,
+ * which gives the same correctly rounded result as strtod().  Anything
+ * else goes through CPLAtof().
+ **********************************************************************/
+double TABAtof(const char *pszValue)
+{
+    const char *psz = pszValue;
+    GUIntBig    nMantissa = 0;
+    int         numDigits = 0, nExp10 = 0;
+    GBool       bNegative = FALSE, bHaveDigits = FALSE;
+    double      dValue;
+
+    while(*psz == ' ' || *psz == '\t')
+        psz++;
+
+    if (*psz == '-' || *psz == '+')
+        bNegative = (*(psz++) == '-');
+
+    for( ; *psz >= '0' && *psz <= '9'; psz++)
+    {
+        bHaveDigits = TRUE;
+        if (nMantissa != 0 || *psz != '0')
+        {
+            if (++numDigits > 15)
+                return CPLAtof(pszValue);
+            nMantissa = nMantissa * 10 + (*psz - '0');
+        }
+    }
+
+    if (*psz == '.')
+    {
+        for(psz++; *psz >= '0' && *psz <= '9'; psz++)
+        {
+            bHaveDigits = TRUE;
+            nExp10--;
+            if (nMantissa != 0 || *psz != '0')
+            {
+                if (++numDigits > 15)
+                    return CPLAtof(pszValue);
+                nMantissa = nMantissa * 10 + (*psz - '0');
+            }
+        }
+    }
+
+    // Also takes care of "inf", "nan" and invalid values
+    if (!bHaveDigits)
+        return CPLAtof(pszValue);
+
+    // An 'e' that is not followed by digits is not part of the number
+    if ((*psz == 'e' || *psz == 'E') &&
+        ((psz[1] >= '0' && psz[1] <= '9') ||
+         ((psz[1] == '-' || psz[1] == '+') && 
+          psz[2] >= '0' && psz[2] <= '9')))
+    {
+        GBool bNegExp = FALSE;
+        int   nExp = 0;
+
+        psz++;
+        if (*psz == '-' || *psz == '+')
+            bNegExp = (*(psz++) == '-');
+
+        for( ; *psz >= '0' && *psz <= '9'; psz++)
+        {
+            nExp = nExp * 10 + (*psz - '0');
+            if (nExp > 1000)
+                return CPLAtof(pszValue);
+        }
+
+        nExp10 += bNegExp ? -nExp : nExp;
+    }
+
+    if (nMantissa == 0)
+        dValue = 0.0;
+    else if (nExp10 >= 0 && nExp10 <= 22)
+        dValue = ((double)(GIntBig)nMantissa) * gadfTABPow10[nExp10];
+    else if (nExp10 < 0 && nExp10 >= -22)
+        dValue = ((double)(GIntBig)nMantissa) / gadfTABPow10[-nExp10];
+    else
+        return CPLAtof(pszValue);
+
+    return bNegative ? -dValue : dValue;
+}
+
+/**********************************************************************
+ *                       TABTokenizeLine()
+ *
+ * Split pszLine into tokens separated by any of the chars in 
+ * pszDelimiters, the same way as CSLTokenizeString2() with 
+ * CSLT_HONOURSTRINGS does (runs of delimiters are collapsed and 
+ * delimiters inside quoted strings are ignored), but without copying
+ * anything: the first nMaxTokens tokens are returned as spans of
+ * pszLine in pasTokens.
+ *
+ * Returns the total number of tokens on the line, which may be greater
+ * than nMaxTokens.
+ **********************************************************************/
+int TABTokenizeLine(const char *pszLine, const char *pszDelimiters,
+                    TABToken *pasTokens, int nMaxTokens)
+{
+    const unsigned char *psz = (const unsigned char *)pszLine;
+    char        abIsDelim[256];
+    int         nTokens = 0;
+
+    if (pszLine == NULL)
+        return 0;
+
+    memset(abIsDelim, 0, sizeof(abIsDelim));
+    for( ; *pszDelimiters != '\0'; pszDelimiters++)
+        abIsDelim[(unsigned char)*pszDelimiters] = 1;
+
+    while(*psz != '\0')
+    {
+        const unsigned char *pszStart;
+        GBool       bQuoted = FALSE, bInString;
+        int         numValueChars = 0;
+
+        if (abIsDelim[*psz])
+        {
+            psz++;
+            continue;
+        }
+
+        // Skip the opening quote so that numbers can be parsed directly
+        if (*psz == '"')
+        {
+            bQuoted = TRUE;
+            psz++;
+        }
+
+        pszStart = psz;
+        bInString = bQuoted;
+        while(*psz != '\0' && (bInString || !abIsDelim[*psz]))
+        {
+            if (*psz == '"')
+                bInString = !bInString;
+            else
+            {
+                if (bInString && *psz == '\\' && 
+                    (psz[1] == '"' || psz[1] == '\\'))
+                    psz++;
+                numValueChars++;
+            }
+            psz++;
+        }
+
+        // Empty strings ("") are dropped, as CSLTokenizeString2() does
+        if (numValueChars == 0)
+            continue;
+
+        if (nTokens < nMaxTokens)
+        {
+            pasTokens[nTokens].pszStart = (const char *)pszStart;
+            pasTokens[nTokens].nLen = (int)(psz - pszStart);
+            pasTokens[nTokens].bQuoted = bQuoted;
+        }
+        nTokens++;
+    }
+
+    return nTokens;
+}
+
+/**********************************************************************
+ *                       TABTokenEQUAL()
+ *
+ * Case-insensitive comparison of a whole token, as it appears in the
+ * line, with pszValue.  Only meant for unquoted keywords.
+ **********************************************************************/
+GBool TABTokenEQUAL(const TABToken *psToken, const char *pszValue)
+{
+    return (int)strlen(pszValue) == psToken->nLen &&
+           EQUALN(psToken->pszStart, pszValue, psToken->nLen);
+}
+
+/**********************************************************************
+ *                       TABTokenCopy()
+ *
+ * Copy the value of a token to pszBuf as a '\0'-terminated string, i.e.
+ * without the quotes and with \" and \\ unescaped inside quoted 
+ * strings, exactly as CSLTokenizeString2() would have returned it.
+ * The value is truncated to nBufSize-1 chars if needed.
+ *
+ * Returns pszBuf.
+ **********************************************************************/
+char *TABTokenCopy(const TABToken *psToken, char *pszBuf, int nBufSize)
+{
+    const char *psz = psToken->pszStart;
+    const char *pszEnd = psToken->pszStart + psToken->nLen;
+    GBool       bInString = psToken->bQuoted;
+    int         j = 0;
+
+    for( ; psz < pszEnd && j < nBufSize-1; psz++)
+    {
+        if (*psz == '"')
+        {
+            bInString = !bInString;
+            continue;
+        }
+        if (bInString && *psz == '\\' && psz+1 < pszEnd &&
+            (psz[1] == '"' || psz[1] == '\\'))
+            psz++;
+        pszBuf[j++] = *psz;
+    }
+    pszBuf[j] = '\0';
+
+    return pszBuf;
+}
+
+/**********************************************************************
+ *                       TABCharsetToEncoding()
+ *
+ * Return the CPL encoding name (as used by CPLRecode() and 
+ * CPLGetSingleByteToUCSTable()) that matches a MapInfo charset name,
+ * or "" for "Neutral" and unknown charsets.
+ **********************************************************************/
+typedef struct
+{
+    const char *pszCharset;
+    const char *pszEncoding;
+} TABCharsetInfo;
+
+static const TABCharsetInfo gasCharsetList[] = 
+{
+    {"WindowsLatin1",       "CP1252"},
+    {"WindowsLatin2",       "CP1250"},
+    {"WindowsArabic",       "CP1256"},
+    {"WindowsCyrillic",     "CP1251"},
+    {"WindowsGreek",        "CP1253"},
+    {"WindowsHebrew",       "CP1255"},
+    {"WindowsTurkish",      "CP1254"},
+    {"WindowsBalticRim",    "CP1257"},
+    {"WindowsVietnamese",   "CP1258"},
+    {"ISO8859_1",           "ISO-8859-1"},
+    {"ISO8859_2",           "ISO-8859-2"},
+    {"ISO8859_3",           "ISO-8859-3"},
+    {"ISO8859_4",           "ISO-8859-4"},
+    {"ISO8859_5",           "ISO-8859-5"},
+    {"ISO8859_6",           "ISO-8859-6"},
+    {"ISO8859_7",           "ISO-8859-7"},
+    {"ISO8859_8",           "ISO-8859-8"},
+    {"ISO8859_9",           "ISO-8859-9"},
+    {"CodePage437",         "CP437"},
+    {"CodePage850",         "CP850"},
+    {"CodePage852",         "CP852"},
+    {"CodePage866",         "CP866"},
+    {NULL,                  NULL}
+};
+
+const char *TABCharsetToEncoding(const char *pszCharset)
+{
+    const TABCharsetInfo *psList;
+
+    if (pszCharset == NULL)
+        return "";
+
+    for(psList = gasCharsetList; psList->pszCharset != NULL; psList++)
+    {
+        if (EQUAL(psList->pszCharset, pszCharset))
+            return psList->pszEncoding;
+    }
+
+    return "";
+}
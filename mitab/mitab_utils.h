@@ -71,6 +71,23 @@
 #define COLOR_G(color) ((color&0xff00)/0x100)
 #define COLOR_B(color) (color&0xff)
 
+/*---------------------------------------------------------------------
+ * Token returned by TABTokenizeLine().  pszStart points inside the
+ * tokenized line, so the token is NOT '\0'-terminated.  For a token
+ * that starts with a quote, pszStart is after the opening quote, and
+ * the span still includes the closing quote and any escapes: use 
+ * TABTokenCopy() to get the actual string value.
+ *--------------------------------------------------------------------*/
+typedef struct TABToken_t
+{
+    const char  *pszStart;
+    int         nLen;
+    GBool       bQuoted;
+} TABToken;
+
+/* Max. number of tokens used on any line of a MIF file */
+#define TAB_MAX_MIF_TOKENS      16
+
 /*=====================================================================
                         Function prototypes
  =====================================================================*/
@@ -94,6 +111,21 @@ char *TABCleanFieldName(const char *pszSrcName);
 const char *TABUnitIdToString(int nId);
 int   TABUnitIdFromString(const char *pszName);
 
+double TABParseDecimal(const char *pszValue, int nLen);
+int   TABFormatDecimal(char *pszBuf, double dValue, int nWidth, int nPrec);
+char *TABFormatDate(char *pszBuf, int nYear, int nMonth, int nDay);
+char *TABFormatTime(char *pszBuf, int nHour, int nMinute, int nSecond,
+                    int nMS);
+GBool TABParseDigits(const char *pszValue, int numDigits, int *pnValue);
+double TABAtof(const char *pszValue);
+
+int   TABTokenizeLine(const char *pszLine, const char *pszDelimiters,
+                      TABToken *pasTokens, int nMaxTokens);
+GBool TABTokenEQUAL(const TABToken *psToken, const char *pszValue);
+char *TABTokenCopy(const TABToken *psToken, char *pszBuf, int nBufSize);
+
+const char *TABCharsetToEncoding(const char *pszCharset);
+
 #endif /* _MITAB_UTILS_H_INCLUDED_ */
 
 
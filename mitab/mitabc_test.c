@@ -105,7 +105,7 @@
 /*                              ReportFile                              */
 /************************************************************************/
 
-static void ReportFile( const char * pszFilename )
+static void ReportFile( const char * pszFilename, const char * pszSelect )
 
 {
     mitab_handle	dataset;
@@ -121,6 +121,14 @@ static void ReportFile( const char * pszFilename )
         exit( 1 );
     }
 
+    if( pszSelect != NULL 
+        && mitab_c_set_selected_fields( dataset, pszSelect ) != 0 )
+    {
+        printf( "mitab_c_set_selected_fields(%s) failed, "
+                "reading all fields.\n%s\n",
+                pszSelect, mitab_c_getlasterrormsg() );
+    }
+
     printf("Dataset class: %d\n", mitab_c_get_table_class( dataset ));
     printf("Dataset version: %d\n", mitab_c_get_file_version( dataset ));
     num_fields = mitab_c_get_field_count(dataset);
@@ -600,12 +608,15 @@ int main( int nArgc, char ** papszArgv )
     if( nArgc < 2 )
     {
         printf( "Usage: mitabc_test src_filename [dst_filename]\n" );
+        printf( "    or mitabc_test -select field_list src_filename\n" );
         printf( "    or mitabc_test -w[mif/tab] dst_filename\n" );
         exit( 1 );
     }
 
     if( nArgc == 2 )
-        ReportFile( papszArgv[1] );
+        ReportFile( papszArgv[1], NULL );
+    else if( strcmp(papszArgv[1],"-select") == 0 && nArgc == 4 )
+        ReportFile( papszArgv[3], papszArgv[2] );
     else if( strcmp(papszArgv[1],"-wtab") == 0 )
         WriteFile( papszArgv[2], "tab" );
     else if( strcmp(papszArgv[1],"-wmif") == 0 )
@@ -121,6 +121,7 @@
  */
 
 #include "ogrsf_frmts.h"
+#include "ogr_pipeline.h"
 #include "cpl_conv.h"
 #include "cpl_string.h"
 
@@ -143,6 +144,7 @@ static int bSkipFailures = FALSE;
 static int nGroupTransactions = 200;
 static int bPreserveFID = FALSE;
 static int nFIDToFetch = OGRNullFID;
+static int nThreads = 0;
 
 /************************************************************************/
 /*                                main()                                */
@@ -269,6 +271,10 @@ int main( int nArgc, char ** papszArgv )
         {
             nGroupTransactions = atoi(papszArgv[++iArg]);
         }
+        else if( EQUAL(papszArgv[iArg],"-threads") && iArg < nArgc-1 )
+        {
+            nThreads = atoi(papszArgv[++iArg]);
+        }
         else if( EQUAL(papszArgv[iArg],"-s_srs") && iArg < nArgc-1 )
         {
             pszSourceSRSDef = papszArgv[++iArg];
@@ -546,6 +552,7 @@ static void Usage()
             "               [-select field_list] [-where restricted_where] \n"
             "               [-sql <sql statement>] \n" 
             "               [-spat xmin ymin xmax ymax] [-preserve_fid] [-fid FID]\n"
+            "               [-threads n]\n"
             "               [-a_srs srs_def] [-t_srs srs_def] [-s_srs srs_def]\n"
             "               [[-dsco NAME=VALUE] ...] dst_datasource_name\n"
             "               src_datasource_name\n"
@@ -569,6 +576,8 @@ static void Usage()
             " -sql statement: Execute given SQL statement and save result.\n"
             " -skipfailures: skip features or layers that fail to convert\n"
             " -spat xmin ymin xmax ymax: spatial query extents\n"
+            " -threads n: read, translate and write in parallel, with n\n"
+            "             threads translating/reprojecting features\n"
             " -dsco NAME=VALUE: Dataset creation option (format specific)\n"
             " -lco  NAME=VALUE: Layer creation option (format specific)\n"
             " -nln name: Assign an alternate name to the new layer\n"
@@ -588,6 +597,154 @@ static void Usage()
     exit( 1 );
 }
 
+/************************************************************************/
+/*                          TranslateContext                            */
+/*                                                                      */
+/*      State shared by the read, translate and write stages of         */
+/*      TranslateLayer().  The translate stage may run concurrently     */
+/*      on several threads, so it only uses its own entry of papoCT.    */
+/************************************************************************/
+
+#define TRANSLATE_OK                    0
+#define TRANSLATE_SETFROM_FAILED        1
+#define TRANSLATE_TRANSFORM_FAILED      2
+
+typedef struct
+{
+    OGRLayer    *poSrcLayer;
+    OGRLayer    *poDstLayer;
+    OGRCoordinateTransformation **papoCT;       /* one per worker */
+    int         bForceToPolygon;
+    int         bForceToMultiPolygon;
+    int         nFeaturesRead;
+    int         nFeaturesInTransaction;
+} TranslateContext;
+
+/************************************************************************/
+/*                          ReadSrcFeature()                            */
+/************************************************************************/
+
+static OGRFeature *ReadSrcFeature( void *pData )
+
+{
+    TranslateContext *psCtx = (TranslateContext *) pData;
+
+    if( nFIDToFetch != OGRNullFID )
+    {
+        // Only fetch feature on first pass.
+        if( psCtx->nFeaturesRead++ == 0 )
+            return psCtx->poSrcLayer->GetFeature(nFIDToFetch);
+        return NULL;
+    }
+
+    psCtx->nFeaturesRead++;
+    return psCtx->poSrcLayer->GetNextFeature();
+}
+
+/************************************************************************/
+/*                         TranslateFeature()                           */
+/************************************************************************/
+
+static int TranslateFeature( OGRFeature *poFeature, 
+                             OGRFeature **ppoDstFeature,
+                             int iWorker, void *pData )
+
+{
+    TranslateContext *psCtx = (TranslateContext *) pData;
+    OGRCoordinateTransformation *poCT = psCtx->papoCT[iWorker];
+    OGRFeature  *poDstFeature;
+    int         nStatus = TRANSLATE_OK;
+
+    CPLErrorReset();
+    poDstFeature = 
+        OGRFeature::CreateFeature( psCtx->poDstLayer->GetLayerDefn() );
+    *ppoDstFeature = poDstFeature;
+
+    if( poDstFeature->SetFrom( poFeature, TRUE ) != OGRERR_NONE )
+        return TRANSLATE_SETFROM_FAILED;
+
+    if( bPreserveFID )
+        poDstFeature->SetFID( poFeature->GetFID() );
+    
+    if( poCT && poDstFeature->GetGeometryRef() != NULL )
+    {
+        if( poDstFeature->GetGeometryRef()->transform( poCT ) 
+            != OGRERR_NONE )
+            nStatus = TRANSLATE_TRANSFORM_FAILED;
+    }
+
+    if( poDstFeature->GetGeometryRef() != NULL && psCtx->bForceToPolygon )
+    {
+        poDstFeature->SetGeometryDirectly( 
+            OGRGeometryFactory::forceToPolygon(
+                poDstFeature->StealGeometry() ) );
+    }
+                    
+    if( poDstFeature->GetGeometryRef() != NULL 
+        && psCtx->bForceToMultiPolygon )
+    {
+        poDstFeature->SetGeometryDirectly( 
+            OGRGeometryFactory::forceToMultiPolygon(
+                poDstFeature->StealGeometry() ) );
+    }
+
+    return nStatus;
+}
+
+/************************************************************************/
+/*                          WriteDstFeature()                           */
+/************************************************************************/
+
+static int WriteDstFeature( OGRFeature *poFeature, OGRFeature *poDstFeature,
+                            int nStatus, void *pData )
+
+{
+    TranslateContext *psCtx = (TranslateContext *) pData;
+    OGRLayer    *poDstLayer = psCtx->poDstLayer;
+
+    if( ++psCtx->nFeaturesInTransaction == nGroupTransactions )
+    {
+        poDstLayer->CommitTransaction();
+        poDstLayer->StartTransaction();
+        psCtx->nFeaturesInTransaction = 0;
+    }
+
+    if( nStatus == TRANSLATE_SETFROM_FAILED )
+    {
+        if( nGroupTransactions )
+            poDstLayer->CommitTransaction();
+            
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Unable to translate feature %d from layer %s.\n",
+                  poFeature->GetFID(), 
+                  psCtx->poSrcLayer->GetLayerDefn()->GetName() );
+        return FALSE;
+    }
+
+    if( nStatus == TRANSLATE_TRANSFORM_FAILED )
+    {
+        if( nGroupTransactions )
+            poDstLayer->CommitTransaction();
+
+        printf( "Failed to transform feature %d.\n", 
+                (int) poFeature->GetFID() );
+        if( !bSkipFailures )
+            return FALSE;
+    }
+
+    CPLErrorReset();
+    if( poDstLayer->CreateFeature( poDstFeature ) != OGRERR_NONE 
+        && !bSkipFailures )
+    {
+        if( nGroupTransactions )
+            poDstLayer->RollbackTransaction();
+
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
 /************************************************************************/
 /*                           TranslateLayer()                           */
 /************************************************************************/
@@ -606,7 +763,6 @@ static int TranslateLayer( OGRDataSource *poSrcDS,
 {
     OGRLayer    *poDstLayer;
     OGRFeatureDefn *poFDefn;
-    OGRErr      eErr;
     int         bForceToPolygon = FALSE;
     int         bForceToMultiPolygon = FALSE;
 
@@ -619,9 +775,16 @@ static int TranslateLayer( OGRDataSource *poSrcDS,
         bForceToMultiPolygon = TRUE;
 
 /* -------------------------------------------------------------------- */
-/*      Setup coordinate transformation if we need it.                  */
+/*      Setup coordinate transformation if we need it.  Each            */
+/*      translation thread gets its own.                                */
 /* -------------------------------------------------------------------- */
     OGRCoordinateTransformation *poCT = NULL;
+    OGRCoordinateTransformation **papoCT;
+    int         nWorkers = nThreads;
+    int         nCT = MAX(nWorkers,1), iCT;
+
+    papoCT = (OGRCoordinateTransformation **) 
+        CPLCalloc( sizeof(OGRCoordinateTransformation *), nCT );
 
     if( bTransform )
     {
@@ -652,6 +815,23 @@ static int TranslateLayer( OGRDataSource *poSrcDS,
             printf( "Target:\n%s\n", pszWKT );
             exit( 1 );
         }
+
+        papoCT[0] = poCT;
+        for( iCT = 1; iCT < nCT; iCT++ )
+        {
+            papoCT[iCT] = 
+                OGRCreateCoordinateTransformation( poSourceSRS, poOutputSRS );
+
+            // Workers without their own transformation would write
+            // unprojected geometries: translate on this thread instead.
+            if( papoCT[iCT] == NULL )
+            {
+                printf( "Failed to create a coordinate transformation for "
+                        "each thread, -threads ignored.\n" );
+                nWorkers = 0;
+                break;
+            }
+        }
     }
     
 /* -------------------------------------------------------------------- */
@@ -741,111 +921,34 @@ static int TranslateLayer( OGRDataSource *poSrcDS,
 /* -------------------------------------------------------------------- */
 /*      Transfer features.                                              */
 /* -------------------------------------------------------------------- */
-    OGRFeature  *poFeature;
-    int         nFeaturesInTransaction = 0;
-    
+    TranslateContext sCtx;
+    int         bSuccess;
+
+    sCtx.poSrcLayer = poSrcLayer;
+    sCtx.poDstLayer = poDstLayer;
+    sCtx.papoCT = papoCT;
+    sCtx.bForceToPolygon = bForceToPolygon;
+    sCtx.bForceToMultiPolygon = bForceToMultiPolygon;
+    sCtx.nFeaturesRead = 0;
+    sCtx.nFeaturesInTransaction = 0;
+
     poSrcLayer->ResetReading();
 
     if( nGroupTransactions )
         poDstLayer->StartTransaction();
 
-    while( TRUE )
-    {
-        OGRFeature      *poDstFeature = NULL;
-
-        if( nFIDToFetch != OGRNullFID )
-        {
-            // Only fetch feature on first pass.
-            if( nFeaturesInTransaction == 0 )
-                poFeature = poSrcLayer->GetFeature(nFIDToFetch);
-            else
-                poFeature = NULL;
-        }
-        else
-            poFeature = poSrcLayer->GetNextFeature();
-        
-        if( poFeature == NULL )
-            break;
-
-        if( ++nFeaturesInTransaction == nGroupTransactions )
-        {
-            poDstLayer->CommitTransaction();
-            poDstLayer->StartTransaction();
-            nFeaturesInTransaction = 0;
-        }
-
-        CPLErrorReset();
-        poDstFeature = OGRFeature::CreateFeature( poDstLayer->GetLayerDefn() );
-
-        if( poDstFeature->SetFrom( poFeature, TRUE ) != OGRERR_NONE )
-        {
-            if( nGroupTransactions )
-                poDstLayer->CommitTransaction();
-            
-            CPLError( CE_Failure, CPLE_AppDefined,
-                      "Unable to translate feature %d from layer %s.\n",
-                      poFeature->GetFID(), poFDefn->GetName() );
-            
-            OGRFeature::DestroyFeature( poFeature );
-            OGRFeature::DestroyFeature( poDstFeature );
-            return FALSE;
-        }
-
-        if( bPreserveFID )
-            poDstFeature->SetFID( poFeature->GetFID() );
-        
-        if( poCT && poDstFeature->GetGeometryRef() != NULL )
-        {
-            eErr = poDstFeature->GetGeometryRef()->transform( poCT );
-            if( eErr != OGRERR_NONE )
-            {
-                if( nGroupTransactions )
-                    poDstLayer->CommitTransaction();
+    OGRFeaturePipeline oPipeline( ReadSrcFeature, TranslateFeature, 
+                                  WriteDstFeature, &sCtx );
 
-                printf( "Failed to transform feature %d.\n", 
-                        (int) poFeature->GetFID() );
-                if( !bSkipFailures )
-                {
-                    OGRFeature::DestroyFeature( poFeature );
-                    OGRFeature::DestroyFeature( poDstFeature );
-                    return FALSE;
-                }
-            }
-        }
+    bSuccess = oPipeline.Run( nFIDToFetch == OGRNullFID ? nWorkers : 0 );
 
-        if( poDstFeature->GetGeometryRef() != NULL && bForceToPolygon )
-        {
-            poDstFeature->SetGeometryDirectly( 
-                OGRGeometryFactory::forceToPolygon(
-                    poDstFeature->StealGeometry() ) );
-        }
-                    
-        if( poDstFeature->GetGeometryRef() != NULL && bForceToMultiPolygon )
-        {
-            poDstFeature->SetGeometryDirectly( 
-                OGRGeometryFactory::forceToMultiPolygon(
-                    poDstFeature->StealGeometry() ) );
-        }
-                    
-        OGRFeature::DestroyFeature( poFeature );
-
-        CPLErrorReset();
-        if( poDstLayer->CreateFeature( poDstFeature ) != OGRERR_NONE 
-            && !bSkipFailures )
-        {
-            if( nGroupTransactions )
-                poDstLayer->RollbackTransaction();
-
-            OGRFeature::DestroyFeature( poDstFeature );
-            return FALSE;
-        }
-
-        OGRFeature::DestroyFeature( poDstFeature );
-    }
-
-    if( nGroupTransactions )
+    if( bSuccess && nGroupTransactions )
         poDstLayer->CommitTransaction();
 
-    return TRUE;
+    for( iCT = 0; iCT < nCT; iCT++ )
+        delete papoCT[iCT];
+    CPLFree( papoCT );
+
+    return bSuccess;
 }
 
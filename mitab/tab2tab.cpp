@@ -95,11 +95,13 @@
 
 
 #include "mitab.h"
+#include "ogr_pipeline.h"
 #include <ctype.h>
 
 static int Tab2Tab(const char *pszSrcFname, const char *pszDstFname,
                    int nMaxFeatures, 
-                   GBool bQuickSpatialIndexMode, GBool bOptSpatialIndexMode);
+                   GBool bQuickSpatialIndexMode, GBool bOptSpatialIndexMode,
+                   int nThreads);
 
 
 /**********************************************************************
@@ -112,6 +114,7 @@ int main(int argc, char *argv[])
     int nMaxFeatures = -1;
     GBool bQuickSpatialIndexMode = FALSE;
     GBool bOptSpatialIndexMode = FALSE;
+    int nThreads = 0;
 
 /*---------------------------------------------------------------------
  *      Read program arguments.
@@ -120,8 +123,11 @@ int main(int argc, char *argv[])
     {
         printf("\nTAB2TAB Conversion Program - MITAB Version %s\n\n", MITAB_VERSION);
         printf("Usage: tab2tab <src_filename> <dst_filename> [-q|-o] [-n num_features]\n");
+        printf("               [-threads n]\n");
         printf("    Converts TAB or MIF file <src_filename> to TAB or MIF format.\n");
-        printf("    The extension of <dst_filename> (.tab or .mif) defines the output format.\n\n");
+        printf("    The extension of <dst_filename> (.tab or .mif) defines the output format.\n");
+        printf("    -threads n reads and writes in parallel, with n threads decoding\n");
+        printf("    the features of a .TAB source.\n\n");
         printf("For the latest version of this program and of the library, see: \n");
         printf("    http://mitab.maptools.org/\n\n");
         return 1;
@@ -140,10 +146,61 @@ int main(int argc, char *argv[])
             bOptSpatialIndexMode = TRUE;
         else if (EQUAL(argv[iArg], "-n") && iArg+1 < argc)
             nMaxFeatures = atoi(argv[++iArg]);
+        else if (EQUAL(argv[iArg], "-threads") && iArg+1 < argc)
+            nThreads = atoi(argv[++iArg]);
     }
 
     return Tab2Tab(pszSrcFname, pszDstFname, 
-                   nMaxFeatures, bQuickSpatialIndexMode, bOptSpatialIndexMode);
+                   nMaxFeatures, bQuickSpatialIndexMode, bOptSpatialIndexMode,
+                   nThreads);
+}
+
+
+/**********************************************************************
+ * Reader and writer stages of the pipelined copy (-threads)
+ **********************************************************************/
+typedef struct
+{
+    IMapInfoFile    *poSrcFile;
+    TABParallelScan *poScan;        // Used instead of poSrcFile if not NULL
+    IMapInfoFile    *poDstFile;
+    int             nMaxFeatures;
+    int             numFeatures;
+    GBool           bReadError;
+} Tab2TabContext;
+
+static OGRFeature *Tab2TabRead(void *pData)
+{
+    Tab2TabContext *psCtx = (Tab2TabContext *) pData;
+    OGRFeature *poFeature;
+
+    if (psCtx->nMaxFeatures >= 1 && 
+        psCtx->numFeatures >= psCtx->nMaxFeatures)
+        return NULL;
+
+    CPLErrorReset();
+    if (psCtx->poScan)
+        poFeature = psCtx->poScan->GetNextFeature();
+    else
+        poFeature = psCtx->poSrcFile->GetNextFeature();
+
+    if (poFeature == NULL && CPLGetLastErrorType() == CE_Failure)
+        psCtx->bReadError = TRUE;
+    else if (poFeature != NULL)
+        psCtx->numFeatures++;
+
+    return poFeature;
+}
+
+static int Tab2TabWrite(OGRFeature *poFeature, OGRFeature * /*poDstFeature*/,
+                        int /*nStatus*/, void *pData)
+{
+    Tab2TabContext *psCtx = (Tab2TabContext *) pData;
+
+    // Features read from MapInfo files are always TABFeatures
+    psCtx->poDstFile->CreateFeature((TABFeature *) poFeature);
+
+    return TRUE;
 }
 
 
@@ -154,7 +211,8 @@ int main(int argc, char *argv[])
  **********************************************************************/
 static int Tab2Tab(const char *pszSrcFname, const char *pszDstFname,
                    int nMaxFeatures, 
-                   GBool bQuickSpatialIndexMode, GBool bOptSpatialIndexMode)
+                   GBool bQuickSpatialIndexMode, GBool bOptSpatialIndexMode,
+                   int nThreads)
 {
     IMapInfoFile *poSrcFile = NULL, *poDstFile = NULL;
     int      nFeatureId, iField, numFeatures=0;
@@ -264,11 +322,43 @@ static int Tab2Tab(const char *pszSrcFname, const char *pszDstFname,
                                   poSrcFile->IsFieldUnique(iField));
     }
 
+    /*---------------------------------------------------------------------
+     * Pipelined copy: read on a separate thread (and decode .TAB features
+     * on several threads) while this thread writes.
+     *--------------------------------------------------------------------*/
+    if (nThreads > 0)
+    {
+        Tab2TabContext sCtx;
+
+        sCtx.poSrcFile = poSrcFile;
+        sCtx.poScan = NULL;
+        sCtx.poDstFile = poDstFile;
+        sCtx.nMaxFeatures = nMaxFeatures;
+        sCtx.numFeatures = 0;
+        sCtx.bReadError = FALSE;
+
+        if (poSrcFile->GetFileClass() == TABFC_TABFile)
+            sCtx.poScan = ((TABFile *) poSrcFile)->CreateParallelScan(
+                                                            nThreads, TRUE);
+
+        OGRFeaturePipeline oPipeline(Tab2TabRead, NULL, Tab2TabWrite, &sCtx);
+        oPipeline.Run(nThreads);
+
+        delete sCtx.poScan;
+
+        if (sCtx.bReadError)
+        {
+            printf( "Failed to read features from %s.\n", pszSrcFname );
+            return -1;
+        }
+    }
+
     /*---------------------------------------------------------------------
      * Copy objects until EOF is reached
      *--------------------------------------------------------------------*/
     nFeatureId = -1;
-    while ( (nFeatureId = poSrcFile->GetNextFeatureId(nFeatureId)) != -1 &&
+    while ( nThreads <= 0 &&
+            (nFeatureId = poSrcFile->GetNextFeatureId(nFeatureId)) != -1 &&
             (nMaxFeatures < 1 || numFeatures++ < nMaxFeatures ))
     {
         poFeature = poSrcFile->GetFeatureRef(nFeatureId);
@@ -82,3 +82,61 @@ OGRAttrIndex::OGRAttrIndex()
 OGRAttrIndex::~OGRAttrIndex()
 {
 }
+
+/************************************************************************/
+/*                          GetRangeMatches()                           */
+/*                                                                      */
+/*      Return an "OGRNullFID" terminated list of the FIDs whose key    */
+/*      may be in the inclusive range [psMin,psMax] (NULL for no        */
+/*      bound), or NULL if the index cannot answer range queries.       */
+/*      The list may contain extra FIDs: the caller is still expected   */
+/*      to evaluate the query against the returned features.            */
+/************************************************************************/
+
+long *OGRAttrIndex::GetRangeMatches( OGRField * /*psMin*/, 
+                                     OGRField * /*psMax*/ )
+
+{
+    return NULL;
+}
+
+/************************************************************************/
+/*                          GetPrefixMatches()                          */
+/*                                                                      */
+/*      Same as GetRangeMatches() for the string keys starting with     */
+/*      pszPrefix (compared case insensitively like LIKE does).         */
+/************************************************************************/
+
+long *OGRAttrIndex::GetPrefixMatches( const char * /*pszPrefix*/ )
+
+{
+    return NULL;
+}
+
+/************************************************************************/
+/*                            IsExactRange()                            */
+/*                                                                      */
+/*      Returns TRUE if GetRangeMatches(psMin,psMax) returns exactly    */
+/*      the features whose value is in the range (GetAllMatches() if    */
+/*      psMin == psMax), so that the query does not need to be          */
+/*      evaluated against them.                                         */
+/************************************************************************/
+
+int OGRAttrIndex::IsExactRange( OGRField * /*psMin*/, 
+                                OGRField * /*psMax*/ )
+
+{
+    return FALSE;
+}
+
+/************************************************************************/
+/*                           IsExactPrefix()                            */
+/*                                                                      */
+/*      Same as IsExactRange() for GetPrefixMatches().                  */
+/************************************************************************/
+
+int OGRAttrIndex::IsExactPrefix( const char * /*pszPrefix*/ )
+
+{
+    return FALSE;
+}
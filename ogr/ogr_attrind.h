@@ -48,6 +48,10 @@ public:
 
     virtual long   GetFirstMatch( OGRField *psKey ) = 0;
     virtual long  *GetAllMatches( OGRField *psKey ) = 0;
+    virtual long  *GetRangeMatches( OGRField *psMin, OGRField *psMax );
+    virtual long  *GetPrefixMatches( const char *pszPrefix );
+    virtual int    IsExactRange( OGRField *psMin, OGRField *psMax );
+    virtual int    IsExactPrefix( const char *pszPrefix );
     
     virtual OGRErr AddEntry( OGRField *psKey, long nFID ) = 0;
     virtual OGRErr RemoveEntry( OGRField *psKey, long nFID ) = 0;
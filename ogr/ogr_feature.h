@@ -300,6 +300,7 @@ class CPL_DLL OGRFeatureQuery
   private:
     OGRFeatureDefn *poTargetDefn;
     void           *pSWQExpr;
+    void           *pProgram;
 
     char          **FieldCollector( void *, char ** );
     
@@ -310,7 +311,8 @@ class CPL_DLL OGRFeatureQuery
     OGRErr      Compile( OGRFeatureDefn *, const char * );
     int         Evaluate( OGRFeature * );
 
-    long       *EvaluateAgainstIndices( OGRLayer *, OGRErr * );
+    long       *EvaluateAgainstIndices( OGRLayer *, OGRErr *, 
+                                        int *pbExact = NULL );
 
     char      **GetUsedFields();
 
@@ -29,10 +29,19 @@
 
 #include "ogr_p.h"
 #include "ogr_gensql.h"
+#include "ogr_attrind.h"
 #include "cpl_string.h"
 
 CPL_CVSID("$Id: ogr_gensql.cpp 17648 2009-09-17 15:11:18Z warmerdam $");
 
+typedef struct _OGRGenSQLJoinHash OGRGenSQLJoinHash;
+
+static void OGRGenSQLJoinHashFree( OGRGenSQLJoinHash *psHash );
+
+typedef struct _OGRGenSQLGroupTable OGRGenSQLGroupTable;
+
+static void OGRGenSQLGroupTableFree( OGRGenSQLGroupTable *psTable );
+
 /************************************************************************/
 /*                       OGRGenSQLResultsLayer()                        */
 /************************************************************************/
@@ -50,9 +59,16 @@ OGRGenSQLResultsLayer::OGRGenSQLResultsLayer( OGRDataSource *poSrcDS,
     poSummaryFeature = NULL;
     panFIDIndex = NULL;
     nIndexSize = 0;
+    pszFIDIndexFilename = NULL;
+    fpFIDIndex = NULL;
+    panFIDIndexCache = NULL;
+    nFIDIndexCacheStart = -1;
+    nFeaturesReturned = 0;
     nNextIndexFID = 0;
     nExtraDSCount = 0;
     papoExtraDS = NULL;
+    papJoinHashes = NULL;
+    pGroupTable = NULL;
 
 /* -------------------------------------------------------------------- */
 /*      Identify all the layers involved in the SELECT.                 */
@@ -100,6 +116,10 @@ OGRGenSQLResultsLayer::OGRGenSQLResultsLayer( OGRDataSource *poSrcDS,
     
     poSrcLayer = papoTableLayers[0];
 
+    if( psSelectInfo->join_count > 0 )
+        papJoinHashes = (void **) 
+            CPLCalloc( sizeof(void *), psSelectInfo->join_count );
+
 /* -------------------------------------------------------------------- */
 /*      Now that we have poSrcLayer, we can install a spatial filter    */
 /*      if there is one.                                                */
@@ -233,15 +253,35 @@ OGRGenSQLResultsLayer::~OGRGenSQLResultsLayer()
 /* -------------------------------------------------------------------- */
 /*      Free various datastructures.                                    */
 /* -------------------------------------------------------------------- */
+    if( papJoinHashes != NULL )
+    {
+        swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+
+        for( int iJoin = 0; iJoin < psSelectInfo->join_count; iJoin++ )
+            OGRGenSQLJoinHashFree( (OGRGenSQLJoinHash *) papJoinHashes[iJoin] );
+        CPLFree( papJoinHashes );
+    }
+
     CPLFree( papoTableLayers );
     papoTableLayers = NULL;
              
     if( panFIDIndex != NULL )
         CPLFree( panFIDIndex );
 
+    if( fpFIDIndex != NULL )
+    {
+        VSIFCloseL( fpFIDIndex );
+        VSIUnlink( pszFIDIndexFilename );
+    }
+    CPLFree( pszFIDIndexFilename );
+    CPLFree( panFIDIndexCache );
+
     if( poSummaryFeature )
         delete poSummaryFeature;
 
+    if( pGroupTable != NULL )
+        OGRGenSQLGroupTableFree( (OGRGenSQLGroupTable *) pGroupTable );
+
     if( pSelectInfo != NULL )
         swq_select_free( (swq_select *) pSelectInfo );
 
@@ -319,6 +359,7 @@ void OGRGenSQLResultsLayer::ResetReading()
     }
 
     nNextIndexFID = 0;
+    nFeaturesReturned = 0;
 }
 
 /************************************************************************/
@@ -335,7 +376,8 @@ OGRErr OGRGenSQLResultsLayer::SetNextByIndex( long nIndex )
 
     if( psSelectInfo->query_mode == SWQM_SUMMARY_RECORD 
         || psSelectInfo->query_mode == SWQM_DISTINCT_LIST 
-        || panFIDIndex != NULL )
+        || psSelectInfo->query_mode == SWQM_GROUPED_SUMMARY 
+        || HasOrderByIndex() )
     {
         nNextIndexFID = nIndex;
         return OGRERR_NONE;
@@ -398,12 +440,31 @@ int OGRGenSQLResultsLayer::GetFeatureCount( int bForce )
 
         return psSummary->count;
     }
+    else if( psSelectInfo->query_mode == SWQM_GROUPED_SUMMARY )
+    {
+        int nGroups = GetGroupCount();
+
+        if( psSelectInfo->limit >= 0 && nGroups > psSelectInfo->limit )
+            nGroups = psSelectInfo->limit;
+
+        return nGroups;
+    }
     else if( psSelectInfo->query_mode != SWQM_RECORDSET )
         return 1;
+
+    int nCount;
+
+    if( HasOrderByIndex() && m_poAttrQuery == NULL )
+        nCount = nIndexSize;
     else if( m_poAttrQuery == NULL )
-        return poSrcLayer->GetFeatureCount( bForce );
+        nCount = poSrcLayer->GetFeatureCount( bForce );
     else
-        return OGRLayer::GetFeatureCount( bForce );
+        nCount = OGRLayer::GetFeatureCount( bForce );
+
+    if( psSelectInfo->limit >= 0 && nCount > psSelectInfo->limit )
+        nCount = psSelectInfo->limit;
+
+    return nCount;
 }
 
 /************************************************************************/
@@ -419,7 +480,8 @@ int OGRGenSQLResultsLayer::TestCapability( const char *pszCap )
     {
         if( psSelectInfo->query_mode == SWQM_SUMMARY_RECORD 
             || psSelectInfo->query_mode == SWQM_DISTINCT_LIST 
-            || panFIDIndex != NULL )
+            || psSelectInfo->query_mode == SWQM_GROUPED_SUMMARY 
+            || HasOrderByIndex() )
             return TRUE;
         else 
             return poSrcLayer->TestCapability( pszCap );
@@ -449,6 +511,9 @@ int OGRGenSQLResultsLayer::PrepareSummary()
 {
     swq_select *psSelectInfo = (swq_select *) pSelectInfo;
 
+    if( psSelectInfo->query_mode == SWQM_GROUPED_SUMMARY )
+        return PrepareGroupedSummary();
+
     if( poSummaryFeature != NULL )
         return TRUE;
 
@@ -556,472 +621,2102 @@ int OGRGenSQLResultsLayer::PrepareSummary()
 }
 
 /************************************************************************/
-/*                          TranslateFeature()                          */
+/*                         OGRGenSQLGroupTable                          */
+/*                                                                      */
+/*      Hash aggregation state for GROUP BY.  Groups are numbered in    */
+/*      the order they are first seen, through a swq_hash_set keyed    */
+/*      on the grouping field values, and each keeps one accumulator   */
+/*      per result column.                                              */
 /************************************************************************/
 
-OGRFeature *OGRGenSQLResultsLayer::TranslateFeature( OGRFeature *poSrcFeat )
-
+typedef struct
 {
-    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
-    OGRFeature *poDstFeat;
+    int         nCount;         /* rows for COUNT(), values for others */
+    double      dfSum;
+    double      dfMin;
+    double      dfMax;
+} OGRGenSQLGroupAccum;
 
-    if( poSrcFeat == NULL )
-        return NULL;
+struct _OGRGenSQLGroupTable
+{
+    int         nColumns;
+    int         nGroupFields;
 
-    m_nFeaturesRead++;
+    swq_hash_set *psKeys;       /* one entry per group */
+    int         nMaxGroups;
 
-/* -------------------------------------------------------------------- */
-/*      Create destination feature.                                     */
-/* -------------------------------------------------------------------- */
-    poDstFeat = new OGRFeature( poDefn );
+    OGRGenSQLGroupAccum *pasAccum;      /* nMaxGroups * nColumns */
+    char      **papszGroupValues;       /* nMaxGroups * nGroupFields */
 
-    poDstFeat->SetFID( poSrcFeat->GetFID() );
+    swq_hash_set **papsDistinct;        /* per column, COUNT(DISTINCT) */
 
-    poDstFeat->SetGeometry( poSrcFeat->GetGeometryRef() );
+    int        *panOrder;       /* group number in ORDER BY order */
+};
 
-    poDstFeat->SetStyleString( poSrcFeat->GetStyleString() );
-    
-/* -------------------------------------------------------------------- */
-/*      Copy fields from primary record to the destination feature.     */
-/* -------------------------------------------------------------------- */
-    for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
-    {
-        swq_col_def *psColDef = psSelectInfo->column_defs + iField;
+/************************************************************************/
+/*                      OGRGenSQLGroupTableFree()                       */
+/************************************************************************/
 
-        if( psColDef->table_index != 0 )
-            continue;
+static void OGRGenSQLGroupTableFree( OGRGenSQLGroupTable *psTable )
 
-        if ( psColDef->field_index >= iFIDFieldIndex &&
-            psColDef->field_index < iFIDFieldIndex + SPECIAL_FIELD_COUNT )
-        {
-            switch (SpecialFieldTypes[psColDef->field_index - iFIDFieldIndex])
-            {
-              case SWQ_INTEGER:
-                poDstFeat->SetField( iField, poSrcFeat->GetFieldAsInteger(psColDef->field_index) );
-                break;
-              case SWQ_FLOAT:
-                poDstFeat->SetField( iField, poSrcFeat->GetFieldAsDouble(psColDef->field_index) );
-                break;
-              default:
-                poDstFeat->SetField( iField, poSrcFeat->GetFieldAsString(psColDef->field_index) );
-            }
-        }
-        else
-        {
-            switch (psColDef->target_type)
-            {
-              case SWQ_INTEGER:
-                poDstFeat->SetField( iField, poSrcFeat->GetFieldAsInteger(psColDef->field_index) );
-                break;
+{
+    int  i;
 
-              case SWQ_FLOAT:
-                poDstFeat->SetField( iField, poSrcFeat->GetFieldAsDouble(psColDef->field_index) );
-                break;
-              
-              case SWQ_STRING:
-              case SWQ_TIMESTAMP:
-              case SWQ_DATE:
-              case SWQ_TIME:
-                poDstFeat->SetField( iField, poSrcFeat->GetFieldAsString(psColDef->field_index) );
-                break;
+    if( psTable == NULL )
+        return;
 
-              default:
-                poDstFeat->SetField( iField,
-                         poSrcFeat->GetRawFieldRef( psColDef->field_index ) );
-            }
-        }
+    if( psTable->papszGroupValues != NULL )
+    {
+        for( i = 0; i < psTable->psKeys->count * psTable->nGroupFields; i++ )
+            CPLFree( psTable->papszGroupValues[i] );
+        CPLFree( psTable->papszGroupValues );
     }
 
-/* -------------------------------------------------------------------- */
-/*      Copy values from any joined tables.                             */
-/* -------------------------------------------------------------------- */
-    int iJoin;
-
-    for( iJoin = 0; iJoin < psSelectInfo->join_count; iJoin++ )
+    if( psTable->papsDistinct != NULL )
     {
-        char szFilter[512];
+        for( i = 0; i < psTable->nColumns; i++ )
+            swq_hash_set_free( psTable->papsDistinct[i], TRUE );
+        CPLFree( psTable->papsDistinct );
+    }
 
-        swq_join_def *psJoinInfo = psSelectInfo->join_defs + iJoin;
-        OGRLayer *poJoinLayer = papoTableLayers[psJoinInfo->secondary_table];
-        
-        // if source key is null, we can't do join.
-        if( !poSrcFeat->IsFieldSet( psJoinInfo->primary_field ) )
-            continue;
+    swq_hash_set_free( psTable->psKeys, TRUE );
+    CPLFree( psTable->pasAccum );
+    CPLFree( psTable->panOrder );
+    CPLFree( psTable );
+}
+
+/************************************************************************/
+/*                    OGRGenSQLGroupTableCompare()                      */
+/*                                                                      */
+/*      Compare two groups on the ORDER BY fields, which are all        */
+/*      grouping fields.  Unset values sort first, and ties keep the    */
+/*      order the groups were first seen in.                            */
+/************************************************************************/
 
-        // Prepare attribute query to express fetching on the joined variable
-        sprintf( szFilter, "%s = ", 
-                 poJoinLayer->GetLayerDefn()->GetFieldDefn( 
-                     psJoinInfo->secondary_field )->GetNameRef() );
+static int OGRGenSQLGroupTableCompare( OGRGenSQLGroupTable *psTable,
+                                       swq_select *psSelectInfo,
+                                       int *panOrderSlot,
+                                       int iFirst, int iSecond )
 
-        OGRField *psSrcField = 
-            poSrcFeat->GetRawFieldRef(psJoinInfo->primary_field);
+{
+    for( int iKey = 0; iKey < psSelectInfo->order_specs; iKey++ )
+    {
+        int  iSlot = panOrderSlot[iKey];
+        const char *pszFirst = 
+            psTable->papszGroupValues[iFirst*psTable->nGroupFields + iSlot];
+        const char *pszSecond = 
+            psTable->papszGroupValues[iSecond*psTable->nGroupFields + iSlot];
+        swq_field_type eType = psSelectInfo->group_defs[iSlot].field_type;
+        int  nResult;
 
-        switch( poSrcLayer->GetLayerDefn()->GetFieldDefn( 
-                    psJoinInfo->primary_field )->GetType() )
+        if( pszFirst == NULL || pszSecond == NULL )
+            nResult = (pszFirst != NULL) - (pszSecond != NULL);
+        else if( eType == SWQ_INTEGER || eType == SWQ_FLOAT )
         {
-          case OFTInteger:
-            sprintf( szFilter+strlen(szFilter), "%d", psSrcField->Integer );
-            break;
+            double dfFirst = atof(pszFirst), dfSecond = atof(pszSecond);
 
-          case OFTReal:
-            sprintf( szFilter+strlen(szFilter), "%.16g", psSrcField->Real );
-            break;
+            nResult = (dfFirst > dfSecond) - (dfFirst < dfSecond);
+        }
+        else
+            nResult = strcmp( pszFirst, pszSecond );
 
-          case OFTString:
-          {
-              char *pszEscaped = CPLEscapeString( psSrcField->String, 
-                                                  strlen(psSrcField->String),
-                                                  CPLES_SQL );
-              if( strlen(pszEscaped) + strlen(szFilter) < sizeof(szFilter)-3 )
-                  sprintf( szFilter+strlen(szFilter), "\'%s\'", 
-                           pszEscaped );
-              else
-              {
-                  strcat( szFilter, "' '" );
-                  CPLDebug( "GenSQL", "Skip long join field value." );
-              }
-              CPLFree( pszEscaped );
-          }
-          break;
+        if( !psSelectInfo->order_defs[iKey].ascending_flag )
+            nResult = -nResult;
 
-          default:
-            CPLAssert( FALSE );
-            continue;
-        }
+        if( nResult != 0 )
+            return nResult;
+    }
 
-        poJoinLayer->ResetReading();
-        if( poJoinLayer->SetAttributeFilter( szFilter ) != OGRERR_NONE )
-            continue;
+    return (iFirst > iSecond) - (iFirst < iSecond);
+}
 
-        // Fetch first joined feature.
-        OGRFeature *poJoinFeature;
+/************************************************************************/
+/*                      OGRGenSQLGroupTableSort()                       */
+/*                                                                      */
+/*      Merge sort of a section of panOrder[].                          */
+/************************************************************************/
 
-        poJoinFeature = poJoinLayer->GetNextFeature();
+static void OGRGenSQLGroupTableSort( OGRGenSQLGroupTable *psTable,
+                                     swq_select *psSelectInfo,
+                                     int *panOrderSlot, int *panTemp,
+                                     int nStart, int nEntries )
 
-        if( poJoinFeature == NULL )
-            continue;
+{
+    int *panOrder = psTable->panOrder;
 
-        // Copy over selected field values. 
-        for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
-        {
-            swq_col_def *psColDef = psSelectInfo->column_defs + iField;
-            
-            if( psColDef->table_index == psJoinInfo->secondary_table )
-                poDstFeat->SetField( iField,
-                                     poJoinFeature->GetRawFieldRef( 
-                                         psColDef->field_index ) );
-        }
+    if( nEntries < 2 )
+        return;
 
-        delete poJoinFeature;
+    int nFirstGroup = nEntries / 2;
+    int nSecondGroup = nEntries - nFirstGroup;
+    int iFirst = nStart, iSecond = nStart + nFirstGroup, iOut = 0;
+
+    OGRGenSQLGroupTableSort( psTable, psSelectInfo, panOrderSlot, panTemp,
+                             nStart, nFirstGroup );
+    OGRGenSQLGroupTableSort( psTable, psSelectInfo, panOrderSlot, panTemp,
+                             nStart + nFirstGroup, nSecondGroup );
+
+    while( iFirst < nStart + nFirstGroup || iSecond < nStart + nEntries )
+    {
+        if( iSecond == nStart + nEntries
+            || (iFirst < nStart + nFirstGroup
+                && OGRGenSQLGroupTableCompare( psTable, psSelectInfo, 
+                                               panOrderSlot,
+                                               panOrder[iFirst],
+                                               panOrder[iSecond] ) <= 0) )
+            panTemp[iOut++] = panOrder[iFirst++];
+        else
+            panTemp[iOut++] = panOrder[iSecond++];
     }
 
-    return poDstFeat;
+    memcpy( panOrder + nStart, panTemp, sizeof(int) * nEntries );
 }
 
 /************************************************************************/
-/*                           GetNextFeature()                           */
+/*                       PrepareGroupedSummary()                        */
+/*                                                                      */
+/*      Read all the source features once, accumulating each result    */
+/*      column into the group selected by the GROUP BY field values.    */
 /************************************************************************/
 
-OGRFeature *OGRGenSQLResultsLayer::GetNextFeature()
+int OGRGenSQLResultsLayer::PrepareGroupedSummary()
 
 {
     swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    OGRFeatureDefn *poSrcDefn = poSrcLayer->GetLayerDefn();
+
+    if( pGroupTable != NULL )
+        return TRUE;
+
+    OGRGenSQLGroupTable *psTable = (OGRGenSQLGroupTable *)
+        CPLCalloc( sizeof(OGRGenSQLGroupTable), 1 );
+
+    psTable->nColumns = psSelectInfo->result_columns;
+    psTable->nGroupFields = psSelectInfo->group_specs;
+    psTable->psKeys = swq_hash_set_create();
+    psTable->papsDistinct = (swq_hash_set **)
+        CPLCalloc( sizeof(swq_hash_set *), psTable->nColumns );
 
 /* -------------------------------------------------------------------- */
-/*      Handle summary sets.                                            */
+/*      Ensure our query parameters are in place on the source          */
+/*      layer.  And initialize reading.                                 */
 /* -------------------------------------------------------------------- */
-    if( psSelectInfo->query_mode == SWQM_SUMMARY_RECORD 
-        || psSelectInfo->query_mode == SWQM_DISTINCT_LIST )
-        return GetFeature( nNextIndexFID++ );
+    poSrcLayer->SetAttributeFilter( psSelectInfo->whole_where_clause );
+    
+    poSrcLayer->SetSpatialFilter( m_poFilterGeom );
+        
+    poSrcLayer->ResetReading();
 
 /* -------------------------------------------------------------------- */
-/*      Handle ordered sets.                                            */
+/*      Accumulate the source features.  The group key is the field     */
+/*      values joined with a unit separator, with a record separator    */
+/*      standing in for unset values.                                   */
 /* -------------------------------------------------------------------- */
-    while( TRUE )
+    OGRFeature *poSrcFeature;
+    CPLString   osKey;
+
+    while( (poSrcFeature = poSrcLayer->GetNextFeature()) != NULL )
     {
-        OGRFeature *poFeature;
+        int  iGroup, bNewGroup, iField;
 
-        if( panFIDIndex != NULL )
-            poFeature =  GetFeature( nNextIndexFID++ );
-        else
+        osKey = "";
+        for( iField = 0; iField < psTable->nGroupFields; iField++ )
         {
-            OGRFeature *poSrcFeat = poSrcLayer->GetNextFeature();
-
-            if( poSrcFeat == NULL )
-                return NULL;
-            
-            poFeature = TranslateFeature( poSrcFeat );
-            delete poSrcFeat;
+            int iSrcField = psSelectInfo->group_defs[iField].field_index;
+
+            if( iField > 0 )
+                osKey += '\x1f';
+            if( iSrcField < iFIDFieldIndex 
+                && !poSrcFeature->IsFieldSet( iSrcField ) )
+                osKey += '\x1e';
+            else
+                osKey += poSrcFeature->GetFieldAsString( iSrcField );
         }
 
-        if( poFeature == NULL )
-            return NULL;
-
-        if( m_poAttrQuery == NULL
-            || m_poAttrQuery->Evaluate( poFeature ) )
-            return poFeature;
+        iGroup = swq_hash_set_insert( psTable->psKeys, osKey, &bNewGroup );
 
-        delete poFeature;
-    }
+/* -------------------------------------------------------------------- */
+/*      Set up the accumulators of a new group.                         */
+/* -------------------------------------------------------------------- */
+        if( bNewGroup )
+        {
+            if( iGroup == psTable->nMaxGroups )
+            {
+                psTable->nMaxGroups = psTable->nMaxGroups * 2 + 64;
+                psTable->pasAccum = (OGRGenSQLGroupAccum *)
+                    CPLRealloc( psTable->pasAccum, 
+                                sizeof(OGRGenSQLGroupAccum) 
+                                * psTable->nMaxGroups * psTable->nColumns );
+                psTable->papszGroupValues = (char **)
+                    CPLRealloc( psTable->papszGroupValues,
+                                sizeof(char *) 
+                                * psTable->nMaxGroups * psTable->nGroupFields );
+            }
 
-    return NULL;
-}
+            for( iField = 0; iField < psTable->nColumns; iField++ )
+            {
+                OGRGenSQLGroupAccum *psAccum = 
+                    psTable->pasAccum + iGroup * psTable->nColumns + iField;
 
-/************************************************************************/
-/*                             GetFeature()                             */
-/************************************************************************/
+                psAccum->nCount = 0;
+                psAccum->dfSum = 0.0;
+                psAccum->dfMin = 1e20;
+                psAccum->dfMax = -1e20;
+            }
 
-OGRFeature *OGRGenSQLResultsLayer::GetFeature( long nFID )
+            for( iField = 0; iField < psTable->nGroupFields; iField++ )
+            {
+                int iSrcField = psSelectInfo->group_defs[iField].field_index;
+                char **ppszValue = psTable->papszGroupValues 
+                    + iGroup * psTable->nGroupFields + iField;
 
-{
-    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+                if( iSrcField < iFIDFieldIndex 
+                    && !poSrcFeature->IsFieldSet( iSrcField ) )
+                    *ppszValue = NULL;
+                else
+                    *ppszValue = CPLStrdup( 
+                        poSrcFeature->GetFieldAsString( iSrcField ) );
+            }
+        }
 
 /* -------------------------------------------------------------------- */
-/*      Handle request for summary record.                              */
+/*      Update the accumulators of this group.                          */
 /* -------------------------------------------------------------------- */
-    if( psSelectInfo->query_mode == SWQM_SUMMARY_RECORD )
-    {
-        if( !PrepareSummary() || nFID != 0 || poSummaryFeature == NULL )
-            return NULL;
-        else
-            return poSummaryFeature->Clone();
-    }
+        for( iField = 0; iField < psTable->nColumns; iField++ )
+        {
+            swq_col_def *psColDef = psSelectInfo->column_defs + iField;
+            OGRGenSQLGroupAccum *psAccum = 
+                psTable->pasAccum + iGroup * psTable->nColumns + iField;
+            int  iSrcField = psColDef->field_index;
+            double dfValue;
 
-/* -------------------------------------------------------------------- */
-/*      Handle request for distinct list record.                        */
-/* -------------------------------------------------------------------- */
-    if( psSelectInfo->query_mode == SWQM_DISTINCT_LIST )
-    {
-        if( !PrepareSummary() )
-            return NULL;
+            if( psColDef->col_func == SWQCF_NONE )
+                continue;
 
-        swq_summary *psSummary = psSelectInfo->column_summary + 0;
+            if( psColDef->col_func == SWQCF_COUNT )
+            {
+                if( psColDef->distinct_flag )
+                {
+                    int  bNew;
+
+                    if( psTable->papsDistinct[iField] == NULL )
+                        psTable->papsDistinct[iField] = swq_hash_set_create();
+
+                    swq_hash_set_insert( 
+                        psTable->papsDistinct[iField], 
+                        CPLSPrintf( "%d\x1f%s", iGroup, 
+                                    poSrcFeature->GetFieldAsString(iSrcField) ),
+                        &bNew );
+                    if( bNew )
+                        psAccum->nCount++;
+                }
+                else
+                    psAccum->nCount++;
+                continue;
+            }
 
-        if( psSummary == NULL )
-            return NULL;
+            /* MIN/MAX/SUM/AVG skip unset values */
+            if( iSrcField < iFIDFieldIndex )
+            {
+                OGRFieldType eType;
 
-        if( nFID < 0 || nFID >= psSummary->count )
-            return NULL;
+                if( !poSrcFeature->IsFieldSet( iSrcField ) )
+                    continue;
 
-        poSummaryFeature->SetField( 0, psSummary->distinct_list[nFID] );
-        poSummaryFeature->SetFID( nFID );
+                eType = poSrcDefn->GetFieldDefn(iSrcField)->GetType();
+                if( eType == OFTInteger || eType == OFTReal )
+                    dfValue = poSrcFeature->GetFieldAsDouble( iSrcField );
+                else
+                {
+                    const char *pszValue = 
+                        poSrcFeature->GetFieldAsString( iSrcField );
+                    if( pszValue[0] == '\0' )
+                        continue;
+                    dfValue = atof( pszValue );
+                }
+            }
+            else
+                dfValue = poSrcFeature->GetFieldAsDouble( iSrcField );
+
+            psAccum->nCount++;
+            psAccum->dfSum += dfValue;
+            if( dfValue < psAccum->dfMin )
+                psAccum->dfMin = dfValue;
+            if( dfValue > psAccum->dfMax )
+                psAccum->dfMax = dfValue;
+        }
 
-        return poSummaryFeature->Clone();
+        delete poSrcFeature;
     }
 
+    ClearFilters();
+
 /* -------------------------------------------------------------------- */
-/*      Are we running in sorted mode?  If so, run the fid through      */
-/*      the index.                                                      */
+/*      Order the groups if requested.                                  */
 /* -------------------------------------------------------------------- */
-    if( panFIDIndex != NULL )
+    int nGroups = psTable->psKeys->count;
+
+    if( psSelectInfo->order_specs > 0 && nGroups > 1 )
+    {
+        int *panOrderSlot = (int *) 
+            CPLMalloc( sizeof(int) * psSelectInfo->order_specs );
+        int *panTemp = (int *) CPLMalloc( sizeof(int) * nGroups );
+        int  iKey, iGroup;
+
+        for( iKey = 0; iKey < psSelectInfo->order_specs; iKey++ )
+        {
+            swq_order_def *psKeyDef = psSelectInfo->order_defs + iKey;
+
+            panOrderSlot[iKey] = 0;
+            for( int iSlot = 0; iSlot < psTable->nGroupFields; iSlot++ )
+            {
+                if( psSelectInfo->group_defs[iSlot].field_index 
+                    == psKeyDef->field_index )
+                    panOrderSlot[iKey] = iSlot;
+            }
+        }
+
+        psTable->panOrder = (int *) CPLMalloc( sizeof(int) * nGroups );
+        for( iGroup = 0; iGroup < nGroups; iGroup++ )
+            psTable->panOrder[iGroup] = iGroup;
+
+        OGRGenSQLGroupTableSort( psTable, psSelectInfo, panOrderSlot, 
+                                 panTemp, 0, nGroups );
+
+        CPLFree( panTemp );
+        CPLFree( panOrderSlot );
+    }
+
+    CPLDebug( "GenSQL", "GROUP BY produced %d groups.", nGroups );
+
+    pGroupTable = psTable;
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                           GetGroupCount()                            */
+/************************************************************************/
+
+int OGRGenSQLResultsLayer::GetGroupCount()
+
+{
+    if( !PrepareGroupedSummary() )
+        return 0;
+
+    return ((OGRGenSQLGroupTable *) pGroupTable)->psKeys->count;
+}
+
+/************************************************************************/
+/*                         GetGroupedFeature()                          */
+/*                                                                      */
+/*      Build the result feature for the nFID'th group in output        */
+/*      order.                                                          */
+/************************************************************************/
+
+OGRFeature *OGRGenSQLResultsLayer::GetGroupedFeature( long nFID )
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+
+    if( !PrepareGroupedSummary() )
+        return NULL;
+
+    OGRGenSQLGroupTable *psTable = (OGRGenSQLGroupTable *) pGroupTable;
+
+    if( nFID < 0 || nFID >= psTable->psKeys->count )
+        return NULL;
+
+    int iGroup = psTable->panOrder != NULL ? psTable->panOrder[nFID] : nFID;
+    OGRFeature *poFeature = new OGRFeature( poDefn );
+
+    poFeature->SetFID( nFID );
+
+    for( int iField = 0; iField < psTable->nColumns; iField++ )
+    {
+        swq_col_def *psColDef = psSelectInfo->column_defs + iField;
+        OGRGenSQLGroupAccum *psAccum = 
+            psTable->pasAccum + iGroup * psTable->nColumns + iField;
+
+        switch( psColDef->col_func )
+        {
+          case SWQCF_NONE:
+          {
+              for( int iSlot = 0; iSlot < psTable->nGroupFields; iSlot++ )
+              {
+                  const char *pszValue = psTable->papszGroupValues[
+                      iGroup * psTable->nGroupFields + iSlot];
+
+                  if( psSelectInfo->group_defs[iSlot].field_index 
+                      == psColDef->field_index )
+                  {
+                      if( pszValue != NULL )
+                          poFeature->SetField( iField, pszValue );
+                      break;
+                  }
+              }
+              break;
+          }
+
+          case SWQCF_COUNT:
+            poFeature->SetField( iField, psAccum->nCount );
+            break;
+
+          case SWQCF_SUM:
+            if( psAccum->nCount > 0 )
+                poFeature->SetField( iField, psAccum->dfSum );
+            break;
+
+          case SWQCF_AVG:
+            if( psAccum->nCount > 0 )
+                poFeature->SetField( iField, 
+                                     psAccum->dfSum / psAccum->nCount );
+            break;
+
+          case SWQCF_MIN:
+            if( psAccum->nCount > 0 )
+                poFeature->SetField( iField, psAccum->dfMin );
+            break;
+
+          case SWQCF_MAX:
+            if( psAccum->nCount > 0 )
+                poFeature->SetField( iField, psAccum->dfMax );
+            break;
+
+          default:
+            break;
+        }
+    }
+
+    return poFeature;
+}
+
+/************************************************************************/
+/*                          OGRGenSQLJoinHash                           */
+/*                                                                      */
+/*      In memory hash table of the features of a joined layer, keyed   */
+/*      on the join field.  Only the first feature read for a given     */
+/*      key is kept, as it is the one the filter based lookup would     */
+/*      return.  Features are kept without their geometry, or by FID   */
+/*      only (and fetched again with GetFeature()) once the memory      */
+/*      budget is exceeded.                                             */
+/************************************************************************/
+
+#define GENSQL_JOIN_HASH_MEMORY (64*1024*1024)
+
+typedef struct
+{
+    GUInt32     nHash;
+    int         nNext;          /* next entry in the bucket, or -1 */
+    OGRField    sKey;           /* String is owned */
+    long        nFID;
+    OGRFeature *poFeature;      /* NULL in FID only mode */
+} OGRGenSQLJoinEntry;
+
+struct _OGRGenSQLJoinHash
+{
+    int         bUsable;        /* FALSE: use FetchJoinFeatureByFilter() */
+    OGRFieldType eKeyType;
+    int         bFIDOnly;
+
+    int         nBuckets;       /* power of 2 */
+    int        *panBuckets;
+
+    int         nEntries;
+    int         nMaxEntries;
+    OGRGenSQLJoinEntry *pasEntries;
+};
+
+/************************************************************************/
+/*                        OGRGenSQLJoinHashFree()                       */
+/************************************************************************/
+
+static void OGRGenSQLJoinHashFree( OGRGenSQLJoinHash *psHash )
+
+{
+    if( psHash == NULL )
+        return;
+
+    for( int i = 0; i < psHash->nEntries; i++ )
+    {
+        if( psHash->eKeyType == OFTString )
+            CPLFree( psHash->pasEntries[i].sKey.String );
+        delete psHash->pasEntries[i].poFeature;
+    }
+
+    CPLFree( psHash->pasEntries );
+    CPLFree( psHash->panBuckets );
+    CPLFree( psHash );
+}
+
+/************************************************************************/
+/*                       OGRGenSQLJoinHashKey()                         */
+/*                                                                      */
+/*      Compute the hash of a key.  Strings are hashed case             */
+/*      insensitively to match EQUAL().                                 */
+/************************************************************************/
+
+static GUInt32 OGRGenSQLJoinHashKey( OGRFieldType eType, OGRField *psKey )
+
+{
+    GUInt32 nHash = 2166136261U;
+
+    if( eType == OFTInteger )
+        return ((GUInt32) psKey->Integer) * 2654435761U;
+
+    if( eType == OFTReal )
+    {
+        GByte abyValue[sizeof(double)];
+
+        if( psKey->Real == 0.0 )
+            psKey->Real = 0.0;  // -0.0 == 0.0
+        memcpy( abyValue, &(psKey->Real), sizeof(double) );
+        for( int i = 0; i < (int) sizeof(double); i++ )
+            nHash = (nHash ^ abyValue[i]) * 16777619U;
+        return nHash;
+    }
+
+    for( const GByte *pabySrc = (const GByte *) psKey->String; 
+         *pabySrc != '\0'; pabySrc++ )
+        nHash = (nHash ^ (GByte) tolower(*pabySrc)) * 16777619U;
+
+    return nHash;
+}
+
+/************************************************************************/
+/*                     OGRGenSQLJoinHashSetKey()                        */
+/*                                                                      */
+/*      Fill psKey with the value of field iField of poFeature, as      */
+/*      used for hashing.  String keys point into the feature.          */
+/*                                                                      */
+/*      The filter based join compares the raw joined values against    */
+/*      the primary value formatted with 16 significant digits, so      */
+/*      bRoundReal is set for the primary (probe) key only.             */
+/************************************************************************/
+
+static void OGRGenSQLJoinHashSetKey( OGRFieldType eType, 
+                                     OGRFeature *poFeature, int iField,
+                                     int bRoundReal, OGRField *psKey )
+
+{
+    OGRField *psField = poFeature->GetRawFieldRef( iField );
+
+    if( eType == OFTReal && bRoundReal )
+        psKey->Real = CPLAtof( CPLSPrintf( "%.16g", psField->Real ) );
+    else if( eType == OFTReal )
+        psKey->Real = psField->Real;
+    else if( eType == OFTString )
+        // An unset string compares equal to ''.
+        psKey->String = (char *) 
+            (poFeature->IsFieldSet( iField ) ? psField->String : "");
+    else
+        psKey->Integer = psField->Integer;
+}
+
+/************************************************************************/
+/*                      OGRGenSQLJoinHashFind()                         */
+/************************************************************************/
+
+static OGRGenSQLJoinEntry *OGRGenSQLJoinHashFind( OGRGenSQLJoinHash *psHash,
+                                                  OGRField *psKey,
+                                                  GUInt32 nHash )
+
+{
+    int iEntry = psHash->panBuckets[nHash & (psHash->nBuckets - 1)];
+
+    while( iEntry != -1 )
+    {
+        OGRGenSQLJoinEntry *psEntry = psHash->pasEntries + iEntry;
+
+        if( psEntry->nHash == nHash )
+        {
+            if( psHash->eKeyType == OFTInteger )
+            {
+                if( psEntry->sKey.Integer == psKey->Integer )
+                    return psEntry;
+            }
+            else if( psHash->eKeyType == OFTReal )
+            {
+                if( psEntry->sKey.Real == psKey->Real )
+                    return psEntry;
+            }
+            else if( EQUAL(psEntry->sKey.String, psKey->String) )
+                return psEntry;
+        }
+
+        iEntry = psEntry->nNext;
+    }
+
+    return NULL;
+}
+
+/************************************************************************/
+/*                      OGRGenSQLJoinHashGrow()                         */
+/************************************************************************/
+
+static void OGRGenSQLJoinHashGrow( OGRGenSQLJoinHash *psHash )
+
+{
+    int i;
+
+    psHash->nBuckets = psHash->nBuckets * 2;
+    psHash->panBuckets = (int *)
+        CPLRealloc( psHash->panBuckets, sizeof(int) * psHash->nBuckets );
+
+    for( i = 0; i < psHash->nBuckets; i++ )
+        psHash->panBuckets[i] = -1;
+
+    // Rehash backward so that each chain stays in insertion order.
+    for( i = psHash->nEntries - 1; i >= 0; i-- )
+    {
+        OGRGenSQLJoinEntry *psEntry = psHash->pasEntries + i;
+        int iBucket = psEntry->nHash & (psHash->nBuckets - 1);
+
+        psEntry->nNext = psHash->panBuckets[iBucket];
+        psHash->panBuckets[iBucket] = i;
+    }
+}
+
+/************************************************************************/
+/*                           BuildJoinHash()                            */
+/*                                                                      */
+/*      Read the joined layer once and build the hash table used to     */
+/*      resolve the join.  Returns a hash with bUsable FALSE if the     */
+/*      filter based lookup has to be used instead.                     */
+/************************************************************************/
+
+void *OGRGenSQLResultsLayer::BuildJoinHash( int iJoin )
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    swq_join_def *psJoinInfo = psSelectInfo->join_defs + iJoin;
+    OGRLayer *poJoinLayer = papoTableLayers[psJoinInfo->secondary_table];
+    OGRFeatureDefn *poJoinDefn = poJoinLayer->GetLayerDefn();
+    OGRGenSQLJoinHash *psHash;
+
+    psHash = (OGRGenSQLJoinHash *) CPLCalloc( 1, sizeof(OGRGenSQLJoinHash) );
+
+/* -------------------------------------------------------------------- */
+/*      The hash join is used only if both join fields have the same    */
+/*      simple type, and if the joined layer can be read without        */
+/*      disturbing the source layer.  An indexed join field is left     */
+/*      to the filter based lookup, unless OGR_SQL_HASH_JOIN is YES.    */
+/* -------------------------------------------------------------------- */
+    const char *pszHashJoin = CPLGetConfigOption( "OGR_SQL_HASH_JOIN", 
+                                                  "AUTO" );
+    OGRFieldType eType = poSrcLayer->GetLayerDefn()->GetFieldDefn( 
+        psJoinInfo->primary_field )->GetType();
+
+    if( (!EQUAL(pszHashJoin,"AUTO") && !CSLTestBoolean(pszHashJoin))
+        || poJoinLayer == poSrcLayer
+        || (eType != OFTInteger && eType != OFTReal && eType != OFTString)
+        || poJoinDefn->GetFieldDefn( 
+               psJoinInfo->secondary_field )->GetType() != eType )
+        return psHash;
+
+    if( EQUAL(pszHashJoin,"AUTO") && poJoinLayer->GetIndex() != NULL
+        && poJoinLayer->GetIndex()->GetFieldIndex( 
+               psJoinInfo->secondary_field ) != NULL )
+        return psHash;
+
+/* -------------------------------------------------------------------- */
+/*      Read all the features of the joined layer.                      */
+/* -------------------------------------------------------------------- */
+    int   bCanFetchByFID = poJoinLayer->TestCapability( OLCRandomRead );
+    int   nMaxMemory = atoi( CPLGetConfigOption( "OGR_SQL_HASH_JOIN_MEMORY",
+                         CPLSPrintf("%d", GENSQL_JOIN_HASH_MEMORY) ) );
+    int   nMemory = 0;
+    OGRFeature *poJoinFeature;
+
+    psHash->eKeyType = eType;
+    psHash->nBuckets = 1024;
+    psHash->panBuckets = (int *) CPLMalloc( sizeof(int) * psHash->nBuckets );
+    for( int i = 0; i < psHash->nBuckets; i++ )
+        psHash->panBuckets[i] = -1;
+
+    poJoinLayer->SetAttributeFilter( NULL );
+    poJoinLayer->ResetReading();
+
+    while( (poJoinFeature = poJoinLayer->GetNextFeature()) != NULL )
+    {
+        OGRField sKey;
+        GUInt32  nHash;
+
+        OGRGenSQLJoinHashSetKey( eType, poJoinFeature, 
+                                 psJoinInfo->secondary_field, FALSE, &sKey );
+        nHash = OGRGenSQLJoinHashKey( eType, &sKey );
+
+        if( OGRGenSQLJoinHashFind( psHash, &sKey, nHash ) != NULL )
+        {
+            delete poJoinFeature;
+            continue;
+        }
+
+        if( psHash->nEntries == psHash->nMaxEntries )
+        {
+            psHash->nMaxEntries = psHash->nMaxEntries * 2 + 1024;
+            psHash->pasEntries = (OGRGenSQLJoinEntry *)
+                CPLRealloc( psHash->pasEntries, 
+                            sizeof(OGRGenSQLJoinEntry) * psHash->nMaxEntries );
+        }
+        if( psHash->nEntries >= psHash->nBuckets )
+            OGRGenSQLJoinHashGrow( psHash );
+
+        OGRGenSQLJoinEntry *psEntry = psHash->pasEntries + psHash->nEntries;
+        int iBucket = nHash & (psHash->nBuckets - 1);
+
+        psEntry->nHash = nHash;
+        psEntry->sKey = sKey;
+        if( eType == OFTString )
+        {
+            psEntry->sKey.String = CPLStrdup( sKey.String );
+            nMemory += strlen( sKey.String ) + 1;
+        }
+        psEntry->nFID = poJoinFeature->GetFID();
+        psEntry->poFeature = NULL;
+        psEntry->nNext = psHash->panBuckets[iBucket];
+        psHash->panBuckets[iBucket] = psHash->nEntries++;
+        nMemory += sizeof(OGRGenSQLJoinEntry) + sizeof(int);
+
+/* -------------------------------------------------------------------- */
+/*      Keep the feature, without its geometry, while within budget.    */
+/*      Past it switch to FID only mode if possible, or give up.        */
+/* -------------------------------------------------------------------- */
+        if( !psHash->bFIDOnly )
+        {
+            poJoinFeature->SetGeometryDirectly( NULL );
+            nMemory += 64 + poJoinDefn->GetFieldCount() * sizeof(OGRField);
+            for( int iField = 0; iField < poJoinDefn->GetFieldCount(); 
+                 iField++ )
+            {
+                if( poJoinDefn->GetFieldDefn(iField)->GetType() == OFTString
+                    && poJoinFeature->IsFieldSet(iField) )
+                    nMemory += strlen(poJoinFeature->GetFieldAsString(iField));
+            }
+            psEntry->poFeature = poJoinFeature;
+            poJoinFeature = NULL;
+        }
+
+        delete poJoinFeature;
+
+        if( nMemory > nMaxMemory && !psHash->bFIDOnly )
+        {
+            if( !bCanFetchByFID )
+                break;
+
+            CPLDebug( "GenSQL", 
+                      "Join hash over %d bytes, keeping FIDs only.",
+                      nMaxMemory );
+            psHash->bFIDOnly = TRUE;
+            for( int i = 0; i < psHash->nEntries; i++ )
+            {
+                delete psHash->pasEntries[i].poFeature;
+                psHash->pasEntries[i].poFeature = NULL;
+            }
+        }
+    }
+
+    poJoinLayer->ResetReading();
+
+    if( nMemory > nMaxMemory && !bCanFetchByFID )
+    {
+        CPLDebug( "GenSQL", 
+                  "Join hash over %d bytes, using attribute filter lookups.",
+                  nMaxMemory );
+        OGRGenSQLJoinHashFree( psHash );
+        psHash = (OGRGenSQLJoinHash *) 
+            CPLCalloc( 1, sizeof(OGRGenSQLJoinHash) );
+        return psHash;
+    }
+
+    CPLDebug( "GenSQL", "Hash join on '%s': %d keys%s.",
+              poJoinDefn->GetName(), psHash->nEntries,
+              psHash->bFIDOnly ? " (FIDs only)" : "" );
+
+    psHash->bUsable = TRUE;
+
+    return psHash;
+}
+
+/************************************************************************/
+/*                          FetchJoinFeature()                          */
+/*                                                                      */
+/*      Fetch the feature of the joined layer matching poSrcFeat.  If   */
+/*      *pbOwned is set to FALSE on return, the feature belongs to the  */
+/*      join hash and must not be deleted by the caller.                */
+/************************************************************************/
+
+OGRFeature *OGRGenSQLResultsLayer::FetchJoinFeature( int iJoin, 
+                                                     OGRFeature *poSrcFeat,
+                                                     int *pbOwned )
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    swq_join_def *psJoinInfo = psSelectInfo->join_defs + iJoin;
+    OGRGenSQLJoinHash *psHash;
+
+    *pbOwned = TRUE;
+
+    if( papJoinHashes[iJoin] == NULL )
+        papJoinHashes[iJoin] = BuildJoinHash( iJoin );
+
+    psHash = (OGRGenSQLJoinHash *) papJoinHashes[iJoin];
+
+    if( !psHash->bUsable )
+        return FetchJoinFeatureByFilter( iJoin, poSrcFeat );
+
+    OGRField sKey;
+    OGRGenSQLJoinEntry *psEntry;
+
+    OGRGenSQLJoinHashSetKey( psHash->eKeyType, poSrcFeat, 
+                             psJoinInfo->primary_field, TRUE, &sKey );
+    psEntry = OGRGenSQLJoinHashFind( psHash, &sKey, 
+                             OGRGenSQLJoinHashKey( psHash->eKeyType, &sKey ) );
+
+    if( psEntry == NULL )
+        return NULL;
+
+    if( psEntry->poFeature != NULL )
+    {
+        *pbOwned = FALSE;
+        return psEntry->poFeature;
+    }
+
+    return papoTableLayers[psJoinInfo->secondary_table]->GetFeature( 
+        psEntry->nFID );
+}
+
+/************************************************************************/
+/*                      FetchJoinFeatureByFilter()                      */
+/*                                                                      */
+/*      Fetch the feature of the joined layer matching poSrcFeat by     */
+/*      installing an attribute filter on the joined layer.             */
+/************************************************************************/
+
+OGRFeature *
+OGRGenSQLResultsLayer::FetchJoinFeatureByFilter( int iJoin, 
+                                                 OGRFeature *poSrcFeat )
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    char szFilter[512];
+
+    swq_join_def *psJoinInfo = psSelectInfo->join_defs + iJoin;
+    OGRLayer *poJoinLayer = papoTableLayers[psJoinInfo->secondary_table];
+        
+    // Prepare attribute query to express fetching on the joined variable
+    sprintf( szFilter, "%s = ", 
+             poJoinLayer->GetLayerDefn()->GetFieldDefn( 
+                 psJoinInfo->secondary_field )->GetNameRef() );
+
+    OGRField *psSrcField = 
+        poSrcFeat->GetRawFieldRef(psJoinInfo->primary_field);
+
+    switch( poSrcLayer->GetLayerDefn()->GetFieldDefn( 
+                psJoinInfo->primary_field )->GetType() )
+    {
+      case OFTInteger:
+        sprintf( szFilter+strlen(szFilter), "%d", psSrcField->Integer );
+        break;
+
+      case OFTReal:
+        sprintf( szFilter+strlen(szFilter), "%.16g", psSrcField->Real );
+        break;
+
+      case OFTString:
+      {
+          char *pszEscaped = CPLEscapeString( psSrcField->String, 
+                                              strlen(psSrcField->String),
+                                              CPLES_SQL );
+          if( strlen(pszEscaped) + strlen(szFilter) < sizeof(szFilter)-3 )
+              sprintf( szFilter+strlen(szFilter), "\'%s\'", 
+                       pszEscaped );
+          else
+          {
+              strcat( szFilter, "' '" );
+              CPLDebug( "GenSQL", "Skip long join field value." );
+          }
+          CPLFree( pszEscaped );
+      }
+      break;
+
+      default:
+        CPLAssert( FALSE );
+        return NULL;
+    }
+
+    poJoinLayer->ResetReading();
+    if( poJoinLayer->SetAttributeFilter( szFilter ) != OGRERR_NONE )
+        return NULL;
+
+    return poJoinLayer->GetNextFeature();
+}
+
+/************************************************************************/
+/*                          TranslateFeature()                          */
+/************************************************************************/
+
+OGRFeature *OGRGenSQLResultsLayer::TranslateFeature( OGRFeature *poSrcFeat )
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    OGRFeature *poDstFeat;
+
+    if( poSrcFeat == NULL )
+        return NULL;
+
+    m_nFeaturesRead++;
+
+/* -------------------------------------------------------------------- */
+/*      Create destination feature.                                     */
+/* -------------------------------------------------------------------- */
+    poDstFeat = new OGRFeature( poDefn );
+
+    poDstFeat->SetFID( poSrcFeat->GetFID() );
+
+    poDstFeat->SetGeometry( poSrcFeat->GetGeometryRef() );
+
+    poDstFeat->SetStyleString( poSrcFeat->GetStyleString() );
+    
+/* -------------------------------------------------------------------- */
+/*      Copy fields from primary record to the destination feature.     */
+/* -------------------------------------------------------------------- */
+    for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
+    {
+        swq_col_def *psColDef = psSelectInfo->column_defs + iField;
+
+        if( psColDef->table_index != 0 )
+            continue;
+
+        if ( psColDef->field_index >= iFIDFieldIndex &&
+            psColDef->field_index < iFIDFieldIndex + SPECIAL_FIELD_COUNT )
+        {
+            switch (SpecialFieldTypes[psColDef->field_index - iFIDFieldIndex])
+            {
+              case SWQ_INTEGER:
+                poDstFeat->SetField( iField, poSrcFeat->GetFieldAsInteger(psColDef->field_index) );
+                break;
+              case SWQ_FLOAT:
+                poDstFeat->SetField( iField, poSrcFeat->GetFieldAsDouble(psColDef->field_index) );
+                break;
+              default:
+                poDstFeat->SetField( iField, poSrcFeat->GetFieldAsString(psColDef->field_index) );
+            }
+        }
+        else
+        {
+            switch (psColDef->target_type)
+            {
+              case SWQ_INTEGER:
+                poDstFeat->SetField( iField, poSrcFeat->GetFieldAsInteger(psColDef->field_index) );
+                break;
+
+              case SWQ_FLOAT:
+                poDstFeat->SetField( iField, poSrcFeat->GetFieldAsDouble(psColDef->field_index) );
+                break;
+              
+              case SWQ_STRING:
+              case SWQ_TIMESTAMP:
+              case SWQ_DATE:
+              case SWQ_TIME:
+                poDstFeat->SetField( iField, poSrcFeat->GetFieldAsString(psColDef->field_index) );
+                break;
+
+              default:
+                poDstFeat->SetField( iField,
+                         poSrcFeat->GetRawFieldRef( psColDef->field_index ) );
+            }
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Copy values from any joined tables.                             */
+/* -------------------------------------------------------------------- */
+    int iJoin;
+
+    for( iJoin = 0; iJoin < psSelectInfo->join_count; iJoin++ )
+    {
+        swq_join_def *psJoinInfo = psSelectInfo->join_defs + iJoin;
+        OGRFeature *poJoinFeature;
+        int         bOwned = TRUE;
+
+        // if source key is null, we can't do join.
+        if( !poSrcFeat->IsFieldSet( psJoinInfo->primary_field ) )
+            continue;
+
+        // Fetch first joined feature.
+        poJoinFeature = FetchJoinFeature( iJoin, poSrcFeat, &bOwned );
+
+        if( poJoinFeature == NULL )
+            continue;
+
+        // Copy over selected field values. 
+        for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
+        {
+            swq_col_def *psColDef = psSelectInfo->column_defs + iField;
+            
+            if( psColDef->table_index == psJoinInfo->secondary_table )
+                poDstFeat->SetField( iField,
+                                     poJoinFeature->GetRawFieldRef( 
+                                         psColDef->field_index ) );
+        }
+
+        if( bOwned )
+            delete poJoinFeature;
+    }
+
+    return poDstFeat;
+}
+
+/************************************************************************/
+/*                           GetNextFeature()                           */
+/************************************************************************/
+
+OGRFeature *OGRGenSQLResultsLayer::GetNextFeature()
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+
+/* -------------------------------------------------------------------- */
+/*      Handle summary sets.                                            */
+/* -------------------------------------------------------------------- */
+    if( psSelectInfo->query_mode == SWQM_SUMMARY_RECORD 
+        || psSelectInfo->query_mode == SWQM_DISTINCT_LIST 
+        || psSelectInfo->query_mode == SWQM_GROUPED_SUMMARY )
+    {
+        if( psSelectInfo->limit >= 0 && nNextIndexFID >= psSelectInfo->limit )
+            return NULL;
+
+        return GetFeature( nNextIndexFID++ );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Stop once LIMIT features have been returned.                    */
+/* -------------------------------------------------------------------- */
+    if( psSelectInfo->limit >= 0 
+        && nFeaturesReturned >= psSelectInfo->limit )
+        return NULL;
+
+/* -------------------------------------------------------------------- */
+/*      Handle ordered sets.                                            */
+/* -------------------------------------------------------------------- */
+    while( TRUE )
+    {
+        OGRFeature *poFeature;
+
+        if( HasOrderByIndex() )
+            poFeature =  GetFeature( nNextIndexFID++ );
+        else
+        {
+            OGRFeature *poSrcFeat = poSrcLayer->GetNextFeature();
+
+            if( poSrcFeat == NULL )
+                return NULL;
+            
+            poFeature = TranslateFeature( poSrcFeat );
+            delete poSrcFeat;
+        }
+
+        if( poFeature == NULL )
+            return NULL;
+
+        if( m_poAttrQuery == NULL
+            || m_poAttrQuery->Evaluate( poFeature ) )
+        {
+            nFeaturesReturned++;
+            return poFeature;
+        }
+
+        delete poFeature;
+    }
+
+    return NULL;
+}
+
+/************************************************************************/
+/*                             GetFeature()                             */
+/************************************************************************/
+
+OGRFeature *OGRGenSQLResultsLayer::GetFeature( long nFID )
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+
+/* -------------------------------------------------------------------- */
+/*      Handle request for summary record.                              */
+/* -------------------------------------------------------------------- */
+    if( psSelectInfo->query_mode == SWQM_SUMMARY_RECORD )
+    {
+        if( !PrepareSummary() || nFID != 0 || poSummaryFeature == NULL )
+            return NULL;
+        else
+            return poSummaryFeature->Clone();
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Handle request for one group of a GROUP BY result.              */
+/* -------------------------------------------------------------------- */
+    if( psSelectInfo->query_mode == SWQM_GROUPED_SUMMARY )
+        return GetGroupedFeature( nFID );
+
+/* -------------------------------------------------------------------- */
+/*      Handle request for distinct list record.                        */
+/* -------------------------------------------------------------------- */
+    if( psSelectInfo->query_mode == SWQM_DISTINCT_LIST )
+    {
+        if( !PrepareSummary() )
+            return NULL;
+
+        swq_summary *psSummary = psSelectInfo->column_summary + 0;
+
+        if( psSummary == NULL )
+            return NULL;
+
+        if( nFID < 0 || nFID >= psSummary->count )
+            return NULL;
+
+        poSummaryFeature->SetField( 0, psSummary->distinct_list[nFID] );
+        poSummaryFeature->SetFID( nFID );
+
+        return poSummaryFeature->Clone();
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Are we running in sorted mode?  If so, run the fid through      */
+/*      the index.                                                      */
+/* -------------------------------------------------------------------- */
+    if( HasOrderByIndex() )
+    {
+        if( nFID < 0 || nFID >= nIndexSize )
+            return NULL;
+        else
+            nFID = GetOrderByIndexFID( nFID );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Handle request for random record.                               */
+/* -------------------------------------------------------------------- */
+    OGRFeature *poSrcFeature = poSrcLayer->GetFeature( nFID );
+    OGRFeature *poResult;
+
+    if( poSrcFeature == NULL )
+        return NULL;
+
+    poResult = TranslateFeature( poSrcFeature );
+    poResult->SetFID( nFID );
+    
+    delete poSrcFeature;
+
+    return poResult;
+}
+
+/************************************************************************/
+/*                          GetSpatialFilter()                          */
+/************************************************************************/
+
+OGRGeometry *OGRGenSQLResultsLayer::GetSpatialFilter() 
+
+{
+    return NULL;
+}
+
+/************************************************************************/
+/*                            GetLayerDefn()                            */
+/************************************************************************/
+
+OGRFeatureDefn *OGRGenSQLResultsLayer::GetLayerDefn()
+
+{
+    return poDefn;
+}
+
+/************************************************************************/
+/*                         IsOrderByStringKey()                         */
+/*                                                                      */
+/*      Is the iKey'th ORDER BY key a string (allocated in the index)?  */
+/************************************************************************/
+
+int OGRGenSQLResultsLayer::IsOrderByStringKey( int iKey )
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    swq_order_def *psKeyDef = psSelectInfo->order_defs + iKey;
+
+    if( psKeyDef->field_index >= iFIDFieldIndex )
+        return psKeyDef->field_index < iFIDFieldIndex + SPECIAL_FIELD_COUNT
+            && SpecialFieldTypes[psKeyDef->field_index - iFIDFieldIndex] 
+               == SWQ_STRING;
+
+    return poSrcLayer->GetLayerDefn()->GetFieldDefn( 
+        psKeyDef->field_index )->GetType() == OFTString;
+}
+
+/************************************************************************/
+/*                          ReadOrderByKeys()                           */
+/*                                                                      */
+/*      Copy the ORDER BY key values of poSrcFeat into pasKeys.         */
+/************************************************************************/
+
+void OGRGenSQLResultsLayer::ReadOrderByKeys( OGRFeature *poSrcFeat, 
+                                             OGRField *pasKeys )
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    int iKey;
+
+    memset( pasKeys, 0, sizeof(OGRField) * psSelectInfo->order_specs );
+
+    for( iKey = 0; iKey < psSelectInfo->order_specs; iKey++ )
+    {
+        swq_order_def *psKeyDef = psSelectInfo->order_defs + iKey;
+        OGRFieldDefn *poFDefn;
+        OGRField *psSrcField, *psDstField;
+
+        psDstField = pasKeys + iKey;
+
+        if ( psKeyDef->field_index >= iFIDFieldIndex)
+        {
+            if ( psKeyDef->field_index < iFIDFieldIndex + SPECIAL_FIELD_COUNT )
+            {
+                switch (SpecialFieldTypes[psKeyDef->field_index - iFIDFieldIndex])
+                {
+                  case SWQ_INTEGER:
+                    psDstField->Integer = poSrcFeat->GetFieldAsInteger(psKeyDef->field_index);
+                    break;
+
+                  case SWQ_FLOAT:
+                    psDstField->Real = poSrcFeat->GetFieldAsDouble(psKeyDef->field_index);
+                    break;
+
+                  default:
+                    psDstField->String = CPLStrdup( poSrcFeat->GetFieldAsString(psKeyDef->field_index) );
+                    break;
+                }
+            }
+            continue;
+        }
+        
+        poFDefn = poSrcLayer->GetLayerDefn()->GetFieldDefn( 
+            psKeyDef->field_index );
+
+        psSrcField = poSrcFeat->GetRawFieldRef( psKeyDef->field_index );
+
+        if( poFDefn->GetType() == OFTInteger 
+            || poFDefn->GetType() == OFTReal
+            || poFDefn->GetType() == OFTDate
+            || poFDefn->GetType() == OFTTime
+            || poFDefn->GetType() == OFTDateTime)
+            memcpy( psDstField, psSrcField, sizeof(OGRField) );
+        else if( poFDefn->GetType() == OFTString )
+        {
+            if( poSrcFeat->IsFieldSet( psKeyDef->field_index ) )
+                psDstField->String = CPLStrdup( psSrcField->String );
+            else
+                memcpy( psDstField, psSrcField, sizeof(OGRField) );
+        }
+    }
+}
+
+/************************************************************************/
+/*                          FreeOrderByKeys()                           */
+/************************************************************************/
+
+void OGRGenSQLResultsLayer::FreeOrderByKeys( OGRField *pasIndexFields,
+                                             int nEntries )
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    int      i, nOrderItems = psSelectInfo->order_specs;
+
+    for( int iKey = 0; iKey < nOrderItems; iKey++ )
+    {
+        if( !IsOrderByStringKey( iKey ) )
+            continue;
+
+        for( i = 0; i < nEntries; i++ )
+        {
+            OGRField *psField = pasIndexFields + iKey + i * nOrderItems;
+                
+            if( psField->Set.nMarker1 != OGRUnsetMarker 
+                || psField->Set.nMarker2 != OGRUnsetMarker )
+                CPLFree( psField->String );
+        }
+    }
+}
+
+/************************************************************************/
+/*                           IsOrderedAfter()                           */
+/*                                                                      */
+/*      Does the first tuple come after the second one in the result?   */
+/*      Ties are broken on the read sequence, like the stable sort of   */
+/*      SortIndexSection().                                             */
+/************************************************************************/
+
+int OGRGenSQLResultsLayer::IsOrderedAfter( OGRField *pasFirst, 
+                                           long nFirstSeq,
+                                           OGRField *pasSecond, 
+                                           long nSecondSeq )
+
+{
+    int nResult = Compare( pasFirst, pasSecond );
+
+    if( nResult != 0 )
+        return nResult < 0;
+
+    return nFirstSeq > nSecondSeq;
+}
+
+/************************************************************************/
+/*                         CreateOrderByIndex()                         */
+/*                                                                      */
+/*      This method is responsible for creating an index providing      */
+/*      ordered access to the features according to the supplied        */
+/*      ORDER BY clauses.                                               */
+/*                                                                      */
+/*      This is accomplished by making one pass through all the         */
+/*      eligible source features, and capturing the order by fields     */
+/*      of all records in memory.  A quick sort is then applied to      */
+/*      this in memory copy of the order-by fields to create the        */
+/*      required index.                                                 */
+/*                                                                      */
+/*      Past OGR_SQL_SORT_MEMORY bytes of keys, the sorted chunks are   */
+/*      written as runs to a temporary file and merged at the end,      */
+/*      the resulting FIDs being kept on disk as well.  With a LIMIT    */
+/*      clause only the first rows are kept (see                        */
+/*      CreateTopNOrderByIndex()).                                      */
+/*                                                                      */
+/*      Keys are stored in an array of OGRFields.  Keys that are        */
+/*      strings are strdup()ed.                                         */
+/************************************************************************/
+
+#define GENSQL_SORT_MEMORY   (64*1024*1024)
+#define GENSQL_FID_CACHE     4096
+#define GENSQL_MERGE_FANIN   64
+
+void OGRGenSQLResultsLayer::CreateOrderByIndex()
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    OGRField *pasIndexFields = NULL;
+    int      i, nOrderItems = psSelectInfo->order_specs;
+    long     *panFIDList = NULL;
+    int      nEntries = 0, nMaxEntries = 0;
+
+    if( nOrderItems == 0 )
+        return;
+
+    if( psSelectInfo->limit >= 0 )
+    {
+        CreateTopNOrderByIndex( psSelectInfo->limit );
+        return;
+    }
+
+    ResetReading();
+
+/* -------------------------------------------------------------------- */
+/*      Read in all the key values, spilling sorted runs to a temp      */
+/*      file when over the memory budget.                               */
+/* -------------------------------------------------------------------- */
+    int         nMaxMemory = atoi( CPLGetConfigOption( "OGR_SQL_SORT_MEMORY",
+                                  CPLSPrintf("%d", GENSQL_SORT_MEMORY) ) );
+    int         nMemory = 0, nRuns = 0;
+    int         *panRunSizes = NULL;
+    vsi_l_offset *panRunOffsets = NULL;
+    CPLString   osRunFilename;
+    FILE        *fpRuns = NULL;
+    OGRFeature  *poSrcFeat;
+    int         bWriteFailed = FALSE;
+
+    while( (poSrcFeat = poSrcLayer->GetNextFeature()) != NULL )
+    {
+        if( nEntries == nMaxEntries )
+        {
+            nMaxEntries = nMaxEntries * 2 + 1024;
+            pasIndexFields = (OGRField *) 
+                CPLRealloc( pasIndexFields, 
+                            sizeof(OGRField) * nOrderItems * nMaxEntries );
+            panFIDList = (long *) 
+                CPLRealloc( panFIDList, sizeof(long) * nMaxEntries );
+        }
+
+        ReadOrderByKeys( poSrcFeat, pasIndexFields + nEntries * nOrderItems );
+        panFIDList[nEntries++] = poSrcFeat->GetFID();
+        delete poSrcFeat;
+
+        nMemory += sizeof(OGRField) * nOrderItems + 2 * sizeof(long);
+        for( int iKey = 0; iKey < nOrderItems; iKey++ )
+        {
+            OGRField *psField = pasIndexFields 
+                + (nEntries-1) * nOrderItems + iKey;
+
+            if( IsOrderByStringKey( iKey )
+                && (psField->Set.nMarker1 != OGRUnsetMarker 
+                    || psField->Set.nMarker2 != OGRUnsetMarker) )
+                nMemory += strlen(psField->String) + 1;
+        }
+
+        if( nMemory <= nMaxMemory )
+            continue;
+
+        if( fpRuns == NULL )
+        {
+            osRunFilename = CPLGenerateTempFilename( "ogrsort" );
+            fpRuns = VSIFOpenL( osRunFilename, "w+b" );
+            if( fpRuns == NULL )
+            {
+                CPLError( CE_Failure, CPLE_FileIO, 
+                          "Failed to create temporary file %s.",
+                          osRunFilename.c_str() );
+                FreeOrderByKeys( pasIndexFields, nEntries );
+                CPLFree( pasIndexFields );
+                CPLFree( panFIDList );
+                return;
+            }
+        }
+
+        panRunOffsets = (vsi_l_offset *) 
+            CPLRealloc( panRunOffsets, sizeof(vsi_l_offset) * (nRuns+1) );
+        panRunSizes = (int *) CPLRealloc( panRunSizes, sizeof(int)*(nRuns+1) );
+        panRunOffsets[nRuns] = VSIFTellL( fpRuns );
+        panRunSizes[nRuns++] = nEntries;
+
+        if( WriteOrderByRun( fpRuns, pasIndexFields, panFIDList, 
+                             nEntries ) != 0 )
+        {
+            bWriteFailed = TRUE;
+            break;
+        }
+        FreeOrderByKeys( pasIndexFields, nEntries );
+        nEntries = 0;
+        nMemory = 0;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Everything fit in memory: sort the records in place.            */
+/* -------------------------------------------------------------------- */
+    if( fpRuns == NULL )
     {
-        if( nFID < 0 || nFID >= nIndexSize )
-            return NULL;
-        else
-            nFID = panFIDIndex[nFID];
+        nIndexSize = nEntries;
+        panFIDIndex = (long *) CPLCalloc(sizeof(long),nIndexSize+1);
+
+        for( i = 0; i < nIndexSize; i++ )
+            panFIDIndex[i] = i;
+
+        SortIndexSection( pasIndexFields, 0, nIndexSize );
+
+/* -------------------------------------------------------------------- */
+/*      Rework the FID map to map to real FIDs.                         */
+/* -------------------------------------------------------------------- */
+        for( i = 0; i < nIndexSize; i++ )
+            panFIDIndex[i] = panFIDList[panFIDIndex[i]];
+
+        FreeOrderByKeys( pasIndexFields, nEntries );
+        CPLFree( pasIndexFields );
+        CPLFree( panFIDList );
+        return;
     }
 
 /* -------------------------------------------------------------------- */
-/*      Handle request for random record.                               */
+/*      Otherwise write the last run and merge all of them.             */
 /* -------------------------------------------------------------------- */
-    OGRFeature *poSrcFeature = poSrcLayer->GetFeature( nFID );
-    OGRFeature *poResult;
+    if( nEntries > 0 && !bWriteFailed )
+    {
+        panRunOffsets = (vsi_l_offset *) 
+            CPLRealloc( panRunOffsets, sizeof(vsi_l_offset) * (nRuns+1) );
+        panRunSizes = (int *) CPLRealloc( panRunSizes, sizeof(int)*(nRuns+1) );
+        panRunOffsets[nRuns] = VSIFTellL( fpRuns );
+        panRunSizes[nRuns++] = nEntries;
+
+        if( WriteOrderByRun( fpRuns, pasIndexFields, panFIDList, 
+                             nEntries ) != 0 )
+            bWriteFailed = TRUE;
+    }
 
-    if( poSrcFeature == NULL )
-        return NULL;
+    FreeOrderByKeys( pasIndexFields, nEntries );
+    CPLFree( pasIndexFields );
+    CPLFree( panFIDList );
+    VSIFCloseL( fpRuns );
 
-    poResult = TranslateFeature( poSrcFeature );
-    poResult->SetFID( nFID );
-    
-    delete poSrcFeature;
+/* -------------------------------------------------------------------- */
+/*      Don't merge truncated runs: on a write error (e.g. disk full)   */
+/*      give up on the index like when the temp file can't be created.  */
+/* -------------------------------------------------------------------- */
+    if( bWriteFailed )
+    {
+        VSIUnlink( osRunFilename );
+        CPLFree( panRunOffsets );
+        CPLFree( panRunSizes );
+        return;
+    }
 
-    return poResult;
+    CPLDebug( "GenSQL", "ORDER BY spilled %d runs to %s.", 
+              nRuns, osRunFilename.c_str() );
+
+    MergeOrderByRuns( osRunFilename, nRuns, panRunOffsets, panRunSizes );
+
+    VSIUnlink( osRunFilename );
+    CPLFree( panRunOffsets );
+    CPLFree( panRunSizes );
 }
 
 /************************************************************************/
-/*                          GetSpatialFilter()                          */
+/*                          WriteOrderByRun()                           */
+/*                                                                      */
+/*      Sort nEntries records and append them to the run file.  Each    */
+/*      record is the FID followed by the keys, strings being written   */
+/*      as their length (-1 if unset) and characters.                   */
 /************************************************************************/
 
-OGRGeometry *OGRGenSQLResultsLayer::GetSpatialFilter() 
+int OGRGenSQLResultsLayer::WriteOrderByRun( FILE *fp, 
+                                            OGRField *pasIndexFields,
+                                            long *panFIDList, int nEntries )
 
 {
-    return NULL;
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    int      i, nOrderItems = psSelectInfo->order_specs;
+    int      nRet = 0;
+
+    panFIDIndex = (long *) CPLMalloc( sizeof(long) * (nEntries+1) );
+    for( i = 0; i < nEntries; i++ )
+        panFIDIndex[i] = i;
+
+    SortIndexSection( pasIndexFields, 0, nEntries );
+
+    for( i = 0; i < nEntries && nRet == 0; i++ )
+        nRet = WriteOrderByRecord( 
+            fp, pasIndexFields + panFIDIndex[i] * nOrderItems,
+            panFIDList[panFIDIndex[i]] );
+
+    CPLFree( panFIDIndex );
+    panFIDIndex = NULL;
+
+    if( nRet != 0 )
+        CPLError( CE_Failure, CPLE_FileIO, 
+                  "Failed writing ORDER BY run to temporary file." );
+
+    return nRet;
 }
 
 /************************************************************************/
-/*                            GetLayerDefn()                            */
+/*                         WriteOrderByRecord()                         */
+/*                                                                      */
+/*      Write one run record: the FID followed by the keys.             */
 /************************************************************************/
 
-OGRFeatureDefn *OGRGenSQLResultsLayer::GetLayerDefn()
+int OGRGenSQLResultsLayer::WriteOrderByRecord( FILE *fp, OGRField *pasKeys,
+                                               long nFID )
 
 {
-    return poDefn;
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+
+    if( VSIFWriteL( &nFID, sizeof(long), 1, fp ) != 1 )
+        return -1;
+
+    for( int iKey = 0; iKey < psSelectInfo->order_specs; iKey++ )
+    {
+        OGRField *psField = pasKeys + iKey;
+
+        if( IsOrderByStringKey( iKey ) )
+        {
+            int nLen = -1;
+
+            if( psField->Set.nMarker1 != OGRUnsetMarker 
+                || psField->Set.nMarker2 != OGRUnsetMarker )
+                nLen = strlen(psField->String);
+
+            if( VSIFWriteL( &nLen, sizeof(int), 1, fp ) != 1
+                || (nLen > 0 
+                    && VSIFWriteL( psField->String, nLen, 1, fp ) != 1) )
+                return -1;
+        }
+        else if( VSIFWriteL( psField, sizeof(OGRField), 1, fp ) != 1 )
+            return -1;
+    }
+
+    return 0;
 }
 
 /************************************************************************/
-/*                         CreateOrderByIndex()                         */
-/*                                                                      */
-/*      This method is responsible for creating an index providing      */
-/*      ordered access to the features according to the supplied        */
-/*      ORDER BY clauses.                                               */
-/*                                                                      */
-/*      This is accomplished by making one pass through all the         */
-/*      eligible source features, and capturing the order by fields     */
-/*      of all records in memory.  A quick sort is then applied to      */
-/*      this in memory copy of the order-by fields to create the        */
-/*      required index.                                                 */
+/*                         ReadOrderByRecord()                          */
 /*                                                                      */
-/*      Keeping all the key values in memory will *not* scale up to     */
-/*      very large input datasets.                                      */
+/*      Read back a record written by WriteOrderByRun().                */
 /************************************************************************/
 
-void OGRGenSQLResultsLayer::CreateOrderByIndex()
+int OGRGenSQLResultsLayer::ReadOrderByRecord( FILE *fp, OGRField *pasKeys,
+                                              long *pnFID )
 
 {
     swq_select *psSelectInfo = (swq_select *) pSelectInfo;
-    OGRField *pasIndexFields;
-    int      i, nOrderItems = psSelectInfo->order_specs;
-    long     *panFIDList;
 
-    if( nOrderItems == 0 )
-        return;
+    if( VSIFReadL( pnFID, sizeof(long), 1, fp ) != 1 )
+        return -1;
 
-    ResetReading();
+    for( int iKey = 0; iKey < psSelectInfo->order_specs; iKey++ )
+    {
+        OGRField *psField = pasKeys + iKey;
 
-/* -------------------------------------------------------------------- */
-/*      Allocate set of key values, and the output index.               */
-/* -------------------------------------------------------------------- */
-    nIndexSize = poSrcLayer->GetFeatureCount();
+        if( IsOrderByStringKey( iKey ) )
+        {
+            int nLen;
 
-    pasIndexFields = (OGRField *) 
-        CPLCalloc(sizeof(OGRField), nOrderItems * nIndexSize);
-    panFIDIndex = (long *) CPLCalloc(sizeof(long),nIndexSize);
-    panFIDList = (long *) CPLCalloc(sizeof(long),nIndexSize);
+            if( VSIFReadL( &nLen, sizeof(int), 1, fp ) != 1 )
+                return -1;
 
-    for( i = 0; i < nIndexSize; i++ )
-        panFIDIndex[i] = i;
+            if( nLen < 0 )
+            {
+                psField->Set.nMarker1 = OGRUnsetMarker;
+                psField->Set.nMarker2 = OGRUnsetMarker;
+                continue;
+            }
+
+            psField->String = (char *) CPLMalloc( nLen + 1 );
+            psField->String[nLen] = '\0';
+            if( nLen > 0 && VSIFReadL( psField->String, nLen, 1, fp ) != 1 )
+            {
+                psField->String[0] = '\0';
+                return -1;
+            }
+        }
+        else if( VSIFReadL( psField, sizeof(OGRField), 1, fp ) != 1 )
+            return -1;
+    }
+
+    return 0;
+}
+
+/************************************************************************/
+/*                          MergeOrderByRuns()                          */
+/*                                                                      */
+/*      Merge the sorted runs into the on disk FID index.  At most      */
+/*      GENSQL_MERGE_FANIN runs are opened at once: past that, groups   */
+/*      of consecutive runs are first merged into longer runs, in a     */
+/*      new temporary file, as many times as needed.                    */
+/************************************************************************/
+
+int OGRGenSQLResultsLayer::MergeOrderByRuns( const char *pszRunFilename,
+                                             int nRuns,
+                                             vsi_l_offset *panRunOffsets,
+                                             int *panRunSizes )
+
+{
+    CPLString    osRunFilename = pszRunFilename;
+    vsi_l_offset *panOffsets = panRunOffsets;
+    int          *panSizes = panRunSizes;
+    int          iRun, nRet = 0;
+
+    while( nRuns > GENSQL_MERGE_FANIN && nRet == 0 )
+    {
+        CPLString    osPassFilename = CPLGenerateTempFilename( "ogrsort" );
+        FILE         *fpPass = VSIFOpenL( osPassFilename, "w+b" );
+        int          nPassRuns, iPassRun;
+        vsi_l_offset *panPassOffsets;
+        int          *panPassSizes;
+
+        if( fpPass == NULL )
+        {
+            CPLError( CE_Failure, CPLE_FileIO, 
+                      "Failed to create temporary file %s.",
+                      osPassFilename.c_str() );
+            nRet = -1;
+            break;
+        }
+
+        nPassRuns = (nRuns + GENSQL_MERGE_FANIN - 1) / GENSQL_MERGE_FANIN;
+        panPassOffsets = (vsi_l_offset *) 
+            CPLMalloc( sizeof(vsi_l_offset) * nPassRuns );
+        panPassSizes = (int *) CPLCalloc( sizeof(int), nPassRuns );
+
+        for( iPassRun = 0, iRun = 0; iPassRun < nPassRuns && nRet == 0; 
+             iPassRun++ )
+        {
+            int nGroup = MIN(GENSQL_MERGE_FANIN, nRuns - iRun);
+
+            panPassOffsets[iPassRun] = VSIFTellL( fpPass );
+            nRet = MergeOrderByRunGroup( osRunFilename, nGroup, 
+                                         panOffsets + iRun, panSizes + iRun,
+                                         fpPass, TRUE );
+            for( ; nGroup > 0; nGroup-- )
+                panPassSizes[iPassRun] += panSizes[iRun++];
+        }
+
+        VSIFCloseL( fpPass );
+
+        CPLDebug( "GenSQL", "ORDER BY merged %d runs into %d in %s.", 
+                  nRuns, nPassRuns, osPassFilename.c_str() );
+
+        // The runs of the previous pass are no longer needed, but the
+        // caller's ones are its to remove.
+        if( panOffsets != panRunOffsets )
+        {
+            VSIUnlink( osRunFilename );
+            CPLFree( panOffsets );
+            CPLFree( panSizes );
+        }
+
+        osRunFilename = osPassFilename;
+        panOffsets = panPassOffsets;
+        panSizes = panPassSizes;
+        nRuns = nPassRuns;
+    }
 
 /* -------------------------------------------------------------------- */
-/*      Read in all the key values.                                     */
+/*      Final merge, keeping only the FIDs.                             */
 /* -------------------------------------------------------------------- */
-    OGRFeature *poSrcFeat;
-    int         iFeature = 0;
+    nIndexSize = 0;
 
-    while( (poSrcFeat = poSrcLayer->GetNextFeature()) != NULL )
+    if( nRet == 0 )
+    {
+        pszFIDIndexFilename = 
+            CPLStrdup( CPLGenerateTempFilename( "ogrsort" ) );
+        fpFIDIndex = VSIFOpenL( pszFIDIndexFilename, "w+b" );
+        if( fpFIDIndex == NULL )
+        {
+            CPLError( CE_Failure, CPLE_FileIO, 
+                      "Failed to create temporary file %s.", 
+                      pszFIDIndexFilename );
+            nRet = -1;
+        }
+        else
+            nRet = MergeOrderByRunGroup( osRunFilename, nRuns, 
+                                         panOffsets, panSizes,
+                                         fpFIDIndex, FALSE );
+    }
+
+    for( iRun = 0; iRun < nRuns && nRet == 0; iRun++ )
+        nIndexSize += panSizes[iRun];
+
+    if( panOffsets != panRunOffsets )
     {
-        int iKey;
+        VSIUnlink( osRunFilename );
+        CPLFree( panOffsets );
+        CPLFree( panSizes );
+    }
+
+    return nRet;
+}
 
-        for( iKey = 0; iKey < nOrderItems; iKey++ )
+/************************************************************************/
+/*                        MergeOrderByRunGroup()                        */
+/*                                                                      */
+/*      Merge nRuns runs and append the result to fpOut, as a run if    */
+/*      bWriteKeys is TRUE, or as FIDs only otherwise.  The current     */
+/*      record of each run is kept in a heap whose root is the one      */
+/*      that comes first, the earliest run winning ties so that the     */
+/*      sort stays stable.                                              */
+/************************************************************************/
+
+int OGRGenSQLResultsLayer::MergeOrderByRunGroup( const char *pszRunFilename,
+                                                 int nRuns,
+                                                 vsi_l_offset *panRunOffsets,
+                                                 int *panRunSizes,
+                                                 FILE *fpOut, int bWriteKeys )
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    int      iRun, nOrderItems = psSelectInfo->order_specs;
+    FILE     **pafpRuns;
+    OGRField *pasRunKeys;
+    long     *panRunFIDs;
+    int      *panRunLeft;
+    int      *panHeap;
+    int      nHeap = 0, iParent, iChild;
+    int      nRet = 0;
+
+    pafpRuns = (FILE **) CPLCalloc( sizeof(FILE *), nRuns );
+    pasRunKeys = (OGRField *) 
+        CPLCalloc( sizeof(OGRField), nOrderItems * nRuns );
+    panRunFIDs = (long *) CPLCalloc( sizeof(long), nRuns );
+    panRunLeft = (int *) CPLCalloc( sizeof(int), nRuns );
+    panHeap = (int *) CPLCalloc( sizeof(int), nRuns );
+
+#define MERGE_KEYS(iRun)  (pasRunKeys + (iRun) * nOrderItems)
+#define MERGE_AFTER(iRunA, iRunB) \
+    IsOrderedAfter( MERGE_KEYS(iRunA), iRunA, MERGE_KEYS(iRunB), iRunB )
+
+    for( iRun = 0; iRun < nRuns && nRet == 0; iRun++ )
+    {
+        pafpRuns[iRun] = VSIFOpenL( pszRunFilename, "rb" );
+        if( pafpRuns[iRun] == NULL 
+            || VSIFSeekL( pafpRuns[iRun], panRunOffsets[iRun], SEEK_SET ) != 0
+            || ReadOrderByRecord( pafpRuns[iRun], MERGE_KEYS(iRun),
+                                  panRunFIDs + iRun ) != 0 )
         {
-            swq_order_def *psKeyDef = psSelectInfo->order_defs + iKey;
-            OGRFieldDefn *poFDefn;
-            OGRField *psSrcField, *psDstField;
+            nRet = -1;
+            break;
+        }
 
-            psDstField = pasIndexFields + iFeature * nOrderItems + iKey;
+        panRunLeft[iRun] = panRunSizes[iRun];
 
-            if ( psKeyDef->field_index >= iFIDFieldIndex)
-            {
-                if ( psKeyDef->field_index < iFIDFieldIndex + SPECIAL_FIELD_COUNT )
-                {
-                    switch (SpecialFieldTypes[psKeyDef->field_index - iFIDFieldIndex])
-                    {
-                      case SWQ_INTEGER:
-                        psDstField->Integer = poSrcFeat->GetFieldAsInteger(psKeyDef->field_index);
-                        break;
-
-                      case SWQ_FLOAT:
-                        psDstField->Real = poSrcFeat->GetFieldAsDouble(psKeyDef->field_index);
-                        break;
-
-                      default:
-                        psDstField->String = CPLStrdup( poSrcFeat->GetFieldAsString(psKeyDef->field_index) );
-                        break;
-                    }
-                }
-                continue;
-            }
-            
-            poFDefn = poSrcLayer->GetLayerDefn()->GetFieldDefn( 
-                psKeyDef->field_index );
+        // Sift up the new run.
+        iChild = nHeap++;
+        panHeap[iChild] = iRun;
+        while( iChild > 0 )
+        {
+            iParent = (iChild - 1) / 2;
+            if( !MERGE_AFTER(panHeap[iParent], panHeap[iChild]) )
+                break;
+            int nTmp = panHeap[iChild];
+            panHeap[iChild] = panHeap[iParent];
+            panHeap[iParent] = nTmp;
+            iChild = iParent;
+        }
+    }
+
+    while( nRet == 0 && nHeap > 0 )
+    {
+        iRun = panHeap[0];
+
+        if( bWriteKeys )
+            nRet = WriteOrderByRecord( fpOut, MERGE_KEYS(iRun), 
+                                       panRunFIDs[iRun] );
+        else if( VSIFWriteL( panRunFIDs + iRun, sizeof(long), 1, fpOut ) 
+                 != 1 )
+            nRet = -1;
+        if( nRet != 0 )
+            break;
 
-            psSrcField = poSrcFeat->GetRawFieldRef( psKeyDef->field_index );
+        FreeOrderByKeys( MERGE_KEYS(iRun), 1 );
+        memset( MERGE_KEYS(iRun), 0, sizeof(OGRField) * nOrderItems );
 
-            if( poFDefn->GetType() == OFTInteger 
-                || poFDefn->GetType() == OFTReal
-                || poFDefn->GetType() == OFTDate
-                || poFDefn->GetType() == OFTTime
-                || poFDefn->GetType() == OFTDateTime)
-                memcpy( psDstField, psSrcField, sizeof(OGRField) );
-            else if( poFDefn->GetType() == OFTString )
+        // Replace the root by the next record of its run, or by the 
+        // last run of the heap if it is exhausted, and sift it down.
+        if( --panRunLeft[iRun] > 0 )
+        {
+            if( ReadOrderByRecord( pafpRuns[iRun], MERGE_KEYS(iRun),
+                                   panRunFIDs + iRun ) != 0 )
             {
-                if( poSrcFeat->IsFieldSet( psKeyDef->field_index ) )
-                    psDstField->String = CPLStrdup( psSrcField->String );
-                else
-                    memcpy( psDstField, psSrcField, sizeof(OGRField) );
+                nRet = -1;
+                break;
             }
         }
+        else
+            panHeap[0] = panHeap[--nHeap];
 
-        panFIDList[iFeature] = poSrcFeat->GetFID();
-        delete poSrcFeat;
+        iParent = 0;
+        while( (iChild = 2 * iParent + 1) < nHeap )
+        {
+            if( iChild + 1 < nHeap 
+                && MERGE_AFTER(panHeap[iChild], panHeap[iChild+1]) )
+                iChild++;
+            if( !MERGE_AFTER(panHeap[iParent], panHeap[iChild]) )
+                break;
+            int nTmp = panHeap[iChild];
+            panHeap[iChild] = panHeap[iParent];
+            panHeap[iParent] = nTmp;
+            iParent = iChild;
+        }
+    }
 
-        iFeature++;
+    for( iRun = 0; iRun < nRuns; iRun++ )
+    {
+        if( panRunLeft[iRun] > 0 )
+            FreeOrderByKeys( MERGE_KEYS(iRun), 1 );
+        if( pafpRuns[iRun] != NULL )
+            VSIFCloseL( pafpRuns[iRun] );
     }
 
-    CPLAssert( nIndexSize == iFeature );
+#undef MERGE_KEYS
+#undef MERGE_AFTER
 
-/* -------------------------------------------------------------------- */
-/*      Quick sort the records.                                         */
-/* -------------------------------------------------------------------- */
-    SortIndexSection( pasIndexFields, 0, nIndexSize );
+    CPLFree( pafpRuns );
+    CPLFree( pasRunKeys );
+    CPLFree( panRunFIDs );
+    CPLFree( panRunLeft );
+    CPLFree( panHeap );
 
-/* -------------------------------------------------------------------- */
-/*      Rework the FID map to map to real FIDs.                         */
-/* -------------------------------------------------------------------- */
-    for( i = 0; i < nIndexSize; i++ )
-        panFIDIndex[i] = panFIDList[panFIDIndex[i]];
+    if( nRet != 0 )
+        CPLError( CE_Failure, CPLE_FileIO, 
+                  "Failed merging ORDER BY runs from temporary file %s.",
+                  pszRunFilename );
 
-    CPLFree( panFIDList );
+    return nRet;
+}
+
+/************************************************************************/
+/*                         GetOrderByIndexFID()                         */
+/*                                                                      */
+/*      Return the FID of the iIndex'th feature in ORDER BY order.      */
+/************************************************************************/
+
+long OGRGenSQLResultsLayer::GetOrderByIndexFID( long iIndex )
+
+{
+    if( panFIDIndex != NULL )
+        return panFIDIndex[iIndex];
+
+    if( nFIDIndexCacheStart < 0 || iIndex < nFIDIndexCacheStart
+        || iIndex >= nFIDIndexCacheStart + GENSQL_FID_CACHE )
+    {
+        int nToRead = MIN(GENSQL_FID_CACHE, nIndexSize - iIndex);
+
+        if( panFIDIndexCache == NULL )
+            panFIDIndexCache = (long *) 
+                CPLMalloc( sizeof(long) * GENSQL_FID_CACHE );
+
+        nFIDIndexCacheStart = -1;
+        if( VSIFSeekL( fpFIDIndex, (vsi_l_offset) iIndex * sizeof(long),
+                       SEEK_SET ) != 0
+            || (int) VSIFReadL( panFIDIndexCache, sizeof(long), nToRead,
+                                fpFIDIndex ) != nToRead )
+        {
+            CPLError( CE_Failure, CPLE_FileIO, 
+                      "Failed reading ORDER BY index from %s.",
+                      pszFIDIndexFilename );
+            return OGRNullFID;
+        }
+        nFIDIndexCacheStart = iIndex;
+    }
+
+    return panFIDIndexCache[iIndex - nFIDIndexCacheStart];
+}
+
+/************************************************************************/
+/*                       CreateTopNOrderByIndex()                       */
+/*                                                                      */
+/*      ORDER BY with a LIMIT: keep only the nLimit first records in a  */
+/*      heap whose root is the record that comes last in the result,    */
+/*      and replace it whenever a record that comes before it is read.  */
+/************************************************************************/
+
+void OGRGenSQLResultsLayer::CreateTopNOrderByIndex( int nLimit )
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    int      i, nOrderItems = psSelectInfo->order_specs;
+    OGRField *pasSlotKeys;
+    long     *panSlotFIDs, *panSlotSeqs;
+    int      *panHeap;
+    int      nEntries = 0, nMaxEntries = 0;
+    long     nSeq = 0;
+    OGRFeature *poSrcFeat;
+
+    ResetReading();
+
+    // Slot nLimit is used to read the incoming record.
+    pasSlotKeys = (OGRField *) 
+        CPLCalloc( sizeof(OGRField), nOrderItems * (nMaxEntries+1) );
+    panSlotFIDs = (long *) CPLCalloc( sizeof(long), nMaxEntries+1 );
+    panSlotSeqs = (long *) CPLCalloc( sizeof(long), nMaxEntries+1 );
+    panHeap = (int *) CPLCalloc( sizeof(int), nMaxEntries+1 );
+
+#define TOPN_KEYS(iSlot)  (pasSlotKeys + (iSlot) * nOrderItems)
+#define TOPN_AFTER(iSlotA, iSlotB) \
+    IsOrderedAfter( TOPN_KEYS(iSlotA), panSlotSeqs[iSlotA], \
+                    TOPN_KEYS(iSlotB), panSlotSeqs[iSlotB] )
+
+    while( (poSrcFeat = poSrcLayer->GetNextFeature()) != NULL )
+    {
+        int iNew, iParent, iChild;
 
 /* -------------------------------------------------------------------- */
-/*      Free the key field values.                                      */
+/*      The arrays grow with the number of records kept, so a large     */
+/*      LIMIT on a small table does not allocate nLimit entries.        */
 /* -------------------------------------------------------------------- */
-    for( int iKey = 0; iKey < nOrderItems; iKey++ )
-    {
-        swq_order_def *psKeyDef = psSelectInfo->order_defs + iKey;
-        OGRFieldDefn *poFDefn;
+        if( nEntries == nMaxEntries && nMaxEntries < nLimit )
+        {
+            nMaxEntries = MIN(nLimit, nMaxEntries * 2 + 1024);
+            pasSlotKeys = (OGRField *) 
+                CPLRealloc( pasSlotKeys, 
+                            sizeof(OGRField) * nOrderItems * (nMaxEntries+1) );
+            panSlotFIDs = (long *) 
+                CPLRealloc( panSlotFIDs, sizeof(long) * (nMaxEntries+1) );
+            panSlotSeqs = (long *) 
+                CPLRealloc( panSlotSeqs, sizeof(long) * (nMaxEntries+1) );
+            panHeap = (int *) 
+                CPLRealloc( panHeap, sizeof(int) * (nMaxEntries+1) );
+        }
 
-        if ( psKeyDef->field_index >= iFIDFieldIndex &&
-            psKeyDef->field_index < iFIDFieldIndex + SPECIAL_FIELD_COUNT )
+        iNew = (nEntries < nLimit) ? nEntries : nLimit;
+        ReadOrderByKeys( poSrcFeat, TOPN_KEYS(iNew) );
+        panSlotFIDs[iNew] = poSrcFeat->GetFID();
+        panSlotSeqs[iNew] = nSeq++;
+        delete poSrcFeat;
+
+        if( nEntries < nLimit )
         {
-            /* warning: only special fields of type string should be deallocated */
-            if (SpecialFieldTypes[psKeyDef->field_index - iFIDFieldIndex] == SWQ_STRING)
+            // Sift up the new record.
+            iChild = nEntries++;
+            panHeap[iChild] = iNew;
+            while( iChild > 0 )
             {
-                for( i = 0; i < nIndexSize; i++ )
-                {
-                    OGRField *psField = pasIndexFields + iKey + i * nOrderItems;
-                    CPLFree( psField->String );
-                }
+                iParent = (iChild - 1) / 2;
+                if( !TOPN_AFTER(panHeap[iChild], panHeap[iParent]) )
+                    break;
+                int nTmp = panHeap[iChild];
+                panHeap[iChild] = panHeap[iParent];
+                panHeap[iParent] = nTmp;
+                iChild = iParent;
             }
             continue;
         }
 
-        poFDefn = poSrcLayer->GetLayerDefn()->GetFieldDefn( 
-            psKeyDef->field_index );
+        // Drop the new record unless it comes before the root.
+        if( nLimit == 0 || !TOPN_AFTER(panHeap[0], iNew) )
+        {
+            FreeOrderByKeys( TOPN_KEYS(iNew), 1 );
+            continue;
+        }
+
+        // Replace the root by the new record, and sift it down.
+        int iSlot = panHeap[0];
 
-        if( poFDefn->GetType() == OFTString )
+        FreeOrderByKeys( TOPN_KEYS(iSlot), 1 );
+        memcpy( TOPN_KEYS(iSlot), TOPN_KEYS(iNew), 
+                sizeof(OGRField) * nOrderItems );
+        panSlotFIDs[iSlot] = panSlotFIDs[iNew];
+        panSlotSeqs[iSlot] = panSlotSeqs[iNew];
+
+        iParent = 0;
+        while( (iChild = 2 * iParent + 1) < nEntries )
         {
-            for( i = 0; i < nIndexSize; i++ )
-            {
-                OGRField *psField = pasIndexFields + iKey + i * nOrderItems;
-                
-                if( psField->Set.nMarker1 != OGRUnsetMarker 
-                    || psField->Set.nMarker2 != OGRUnsetMarker )
-                    CPLFree( psField->String );
-            }
+            if( iChild + 1 < nEntries 
+                && TOPN_AFTER(panHeap[iChild+1], panHeap[iChild]) )
+                iChild++;
+            if( !TOPN_AFTER(panHeap[iChild], panHeap[iParent]) )
+                break;
+            int nTmp = panHeap[iChild];
+            panHeap[iChild] = panHeap[iParent];
+            panHeap[iParent] = nTmp;
+            iParent = iChild;
         }
     }
 
-    CPLFree( pasIndexFields );
+/* -------------------------------------------------------------------- */
+/*      Pop the heap to get the records from the last to the first.     */
+/* -------------------------------------------------------------------- */
+    nIndexSize = nEntries;
+    panFIDIndex = (long *) CPLCalloc( sizeof(long), nIndexSize+1 );
+
+    for( i = nEntries - 1; i >= 0; i-- )
+    {
+        int iParent, iChild, iSlot = panHeap[0];
+
+        panFIDIndex[i] = panSlotFIDs[iSlot];
+        FreeOrderByKeys( TOPN_KEYS(iSlot), 1 );
+
+        panHeap[0] = panHeap[i];
+        iParent = 0;
+        while( (iChild = 2 * iParent + 1) < i )
+        {
+            if( iChild + 1 < i
+                && TOPN_AFTER(panHeap[iChild+1], panHeap[iChild]) )
+                iChild++;
+            if( !TOPN_AFTER(panHeap[iChild], panHeap[iParent]) )
+                break;
+            int nTmp = panHeap[iChild];
+            panHeap[iChild] = panHeap[iParent];
+            panHeap[iParent] = nTmp;
+            iParent = iChild;
+        }
+    }
+
+#undef TOPN_KEYS
+#undef TOPN_AFTER
+
+    CPLFree( pasSlotKeys );
+    CPLFree( panSlotFIDs );
+    CPLFree( panSlotSeqs );
+    CPLFree( panHeap );
 }
 
 /************************************************************************/
@@ -48,10 +48,22 @@ class CPL_DLL OGRGenSQLResultsLayer : public OGRLayer
     OGRFeatureDefn *poDefn;
 
     int         PrepareSummary();
+    int         PrepareGroupedSummary();
+    OGRFeature *GetGroupedFeature( long nFID );
+    int         GetGroupCount();
+
+    void       *pGroupTable;
 
     int         nIndexSize;
     long       *panFIDIndex;
 
+    char       *pszFIDIndexFilename;  /* sorted FIDs spilled to disk */
+    FILE       *fpFIDIndex;
+    long       *panFIDIndexCache;
+    int         nFIDIndexCacheStart;
+
+    int         nFeaturesReturned;
+
     int         nNextIndexFID;
     OGRFeature  *poSummaryFeature;
 
@@ -64,11 +76,37 @@ class CPL_DLL OGRGenSQLResultsLayer : public OGRLayer
 
     OGRFeature *TranslateFeature( OGRFeature * );
     void        CreateOrderByIndex();
+    void        CreateTopNOrderByIndex( int nLimit );
+    int         HasOrderByIndex() 
+                    { return panFIDIndex != NULL || fpFIDIndex != NULL; }
+    long        GetOrderByIndexFID( long iIndex );
+    int         IsOrderByStringKey( int iKey );
+    void        ReadOrderByKeys( OGRFeature *poSrcFeat, OGRField *pasKeys );
+    void        FreeOrderByKeys( OGRField *pasIndexFields, int nEntries );
+    int         IsOrderedAfter( OGRField *pasFirst, long nFirstSeq,
+                                OGRField *pasSecond, long nSecondSeq );
+    int         WriteOrderByRun( FILE *fp, OGRField *pasIndexFields, 
+                                 long *panFIDList, int nEntries );
+    int         WriteOrderByRecord( FILE *fp, OGRField *pasKeys, long nFID );
+    int         ReadOrderByRecord( FILE *fp, OGRField *pasKeys, long *pnFID );
+    int         MergeOrderByRuns( const char *pszRunFilename, int nRuns,
+                                  vsi_l_offset *panRunOffsets, int *panRunSizes );
+    int         MergeOrderByRunGroup( const char *pszRunFilename, int nRuns,
+                                      vsi_l_offset *panRunOffsets, 
+                                      int *panRunSizes,
+                                      FILE *fpOut, int bWriteKeys );
     void        SortIndexSection( OGRField *pasIndexFields, 
                                   int nStart, int nEntries );
     int         Compare( OGRField *pasFirst, OGRField *pasSecond );
 
     void        ClearFilters();
+
+    void      **papJoinHashes;
+
+    void       *BuildJoinHash( int iJoin );
+    OGRFeature *FetchJoinFeature( int iJoin, OGRFeature *poSrcFeat,
+                                  int *pbOwned );
+    OGRFeature *FetchJoinFeatureByFilter( int iJoin, OGRFeature *poSrcFeat );
     
   public:
                 OGRGenSQLResultsLayer( OGRDataSource *poSrcDS, 
@@ -59,6 +59,14 @@ public:
     GByte      *BuildKey( OGRField *psKey );
     long        GetFirstMatch( OGRField *psKey );
     long       *GetAllMatches( OGRField *psKey );
+    long       *GetRangeMatches( OGRField *psMin, OGRField *psMax );
+    long       *GetPrefixMatches( const char *pszPrefix );
+    int         IsExactRange( OGRField *psMin, OGRField *psMax );
+    int         IsExactPrefix( const char *pszPrefix );
+
+    int         AddRangeMatches( GByte *pabyMinKey, GByte *pabyMaxKey,
+                                 int nMaxKeyLength, long **ppanFIDList, 
+                                 int *pnFIDCount, int *pnFIDMax );
 
     OGRErr      AddEntry( OGRField *psKey, long nFID );
     OGRErr      RemoveEntry( OGRField *psKey, long nFID );
@@ -85,6 +93,9 @@ public:
 
     char        *pszMetadataFilename;
     char        *pszMIINDFilename;
+
+    /* Codepage of the string keys when values are read in UTF-8 */
+    const unsigned short *panKeyRecodeTable;
     
                 OGRMILayerAttrIndex();
     virtual     ~OGRMILayerAttrIndex();
@@ -103,6 +114,7 @@ public:
     /* custom to OGRMILayerAttrIndex */
     OGRErr      SaveConfigToXML();
     OGRErr      LoadConfigFromXML();
+    OGRErr      LoadConfigFromXML( const char *pszRawXML );
     void        AddAttrInd( int iField, int iINDIndex );
 
     OGRLayer   *GetLayer() { return poLayer; }
@@ -118,6 +130,11 @@ OGRMILayerAttrIndex::OGRMILayerAttrIndex()
     poINDFile = NULL;
     nIndexCount = 0;
     papoIndexList = NULL;
+
+    pszMetadataFilename = NULL;
+    pszMIINDFilename = NULL;
+
+    panKeyRecodeTable = NULL;
 }
 
 /************************************************************************/
@@ -158,6 +175,13 @@ OGRErr OGRMILayerAttrIndex::Initialize( const char *pszIndexPathIn,
 /* -------------------------------------------------------------------- */
     poLayer = poLayerIn;
 
+/* -------------------------------------------------------------------- */
+/*      Drivers with a native index (e.g. TABFile) pass the index       */
+/*      configuration directly as XML instead of a path.                */
+/* -------------------------------------------------------------------- */
+    if( EQUALN(pszIndexPathIn, "<OGRMILayerAttrIndex>", 21) )
+        return LoadConfigFromXML( pszIndexPathIn );
+
     pszIndexPath = CPLStrdup( pszIndexPathIn );
     
     pszMetadataFilename = CPLStrdup(
@@ -211,15 +235,67 @@ OGRErr OGRMILayerAttrIndex::LoadConfigFromXML()
 
     VSIFClose( fp );
 
+    OGRErr eErr = LoadConfigFromXML( pszRawXML );
+    CPLFree( pszRawXML );
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                         OGRMIKeyMatchesField()                       */
+/*                                                                      */
+/*      Check that the keys of a .IND index can be built from values    */
+/*      of the OGR field type: e.g. date and logical fields are         */
+/*      returned as strings but have integer index keys.                */
+/************************************************************************/
+
+static int OGRMIKeyMatchesField( OGRFieldDefn *poFldDefn, int nKeyLength )
+
+{
+    switch( poFldDefn->GetType() )
+    {
+      case OFTInteger:
+        return nKeyLength == 4 || nKeyLength == 2;
+
+      case OFTReal:
+        return nKeyLength == 8;
+
+      case OFTString:
+        /* Char keys are the field width (up to 128), logical fields    */
+        /* have a width of 1 and a 1 byte integer key.                  */
+        return poFldDefn->GetWidth() > 1 
+            && nKeyLength == MIN(poFldDefn->GetWidth(), 128);
+
+      default:
+        return FALSE;
+    }
+}
+
+/************************************************************************/
+/*                         LoadConfigFromXML()                          */
+/************************************************************************/
+
+OGRErr OGRMILayerAttrIndex::LoadConfigFromXML( const char *pszRawXML )
+
+{
+    CPLAssert( poINDFile == NULL );
+
 /* -------------------------------------------------------------------- */
 /*      Parse the XML.                                                  */
 /* -------------------------------------------------------------------- */
     CPLXMLNode *psRoot = CPLParseXMLString( pszRawXML );
-    CPLFree( pszRawXML );
 
     if( psRoot == NULL )
         return OGRERR_FAILURE;
 
+    if( pszMIINDFilename == NULL )
+        pszMIINDFilename = 
+            CPLStrdup( CPLGetXMLValue( psRoot, "MIIDFilename", "" ) );
+
+    panKeyRecodeTable = 
+        CPLGetSingleByteToUCSTable( CPLGetXMLValue( psRoot, "KeyEncoding", 
+                                                    NULL ) );
+
 /* -------------------------------------------------------------------- */
 /*      Open the index file.                                            */
 /* -------------------------------------------------------------------- */
@@ -229,7 +305,8 @@ OGRErr OGRMILayerAttrIndex::LoadConfigFromXML()
      * This change has to be observed if it doesn't cause any
      * problems in future. (mloskot)
      */
-    if( poINDFile->Open( pszMetadataFilename, "r" ) != 0 )
+    if( poINDFile->Open( pszMetadataFilename ? pszMetadataFilename
+                                             : pszMIINDFilename, "r" ) != 0 )
     {
         CPLDestroyXMLNode( psRoot );
         CPLError( CE_Failure, CPLE_OpenFailed,
@@ -263,6 +340,16 @@ OGRErr OGRMILayerAttrIndex::LoadConfigFromXML()
             continue;
         }
 
+        if( iField >= poLayer->GetLayerDefn()->GetFieldCount()
+            || !OGRMIKeyMatchesField( 
+                    poLayer->GetLayerDefn()->GetFieldDefn(iField),
+                    poINDFile->GetKeyLength(iIndexIndex) ) )
+        {
+            CPLDebug( "OGR", "Skipping index %d: keys do not match field %d.",
+                      iIndexIndex, iField );
+            continue;
+        }
+
         AddAttrInd( iField, iIndexIndex );
     }
 
@@ -270,7 +357,8 @@ OGRErr OGRMILayerAttrIndex::LoadConfigFromXML()
 
     CPLDebug( "OGR", "Restored %d field indexes for layer %s from %s on %s.",
               nIndexCount, poLayer->GetLayerDefn()->GetName(), 
-              pszMetadataFilename, pszMIINDFilename );
+              pszMetadataFilename ? pszMetadataFilename : "XML", 
+              pszMIINDFilename );
 
     return OGRERR_NONE;
 }
@@ -282,7 +370,7 @@ OGRErr OGRMILayerAttrIndex::LoadConfigFromXML()
 OGRErr OGRMILayerAttrIndex::SaveConfigToXML()
 
 {
-    if( nIndexCount == 0 )
+    if( nIndexCount == 0 || pszMetadataFilename == NULL )
         return OGRERR_NONE;
 
 /* -------------------------------------------------------------------- */
@@ -650,7 +738,7 @@ OGRErr OGRMIAttrIndex::AddEntry( OGRField *psKey, long nFID )
 {
     GByte *pabyKey = BuildKey( psKey );
 
-    if( psKey == NULL )
+    if( pabyKey == NULL )
         return OGRERR_FAILURE;
 
     if( poINDFile->AddEntry( iIndex, pabyKey, nFID+1 ) != 0 )
@@ -671,6 +759,9 @@ OGRErr OGRMIAttrIndex::RemoveEntry( OGRField * /*psKey*/, long /*nFID*/ )
 
 /************************************************************************/
 /*                              BuildKey()                              */
+/*                                                                      */
+/*      Returns NULL if the key cannot be built, e.g. a UTF-8 string    */
+/*      with characters the codepage of the keys cannot represent.      */
 /************************************************************************/
 
 GByte *OGRMIAttrIndex::BuildKey( OGRField *psKey )
@@ -687,6 +778,18 @@ GByte *OGRMIAttrIndex::BuildKey( OGRField *psKey )
         break;
 
       case OFTString:
+        if( poLIndex->panKeyRecodeTable != NULL )
+        {
+            /* Values are read in UTF-8, keys are in the file codepage */
+            char szValue[129];  /* keys are at most 128 bytes */
+
+            if( !CPLRecodeUTF8ToSingleByte( psKey->String, 
+                                            poLIndex->panKeyRecodeTable,
+                                            szValue, sizeof(szValue) ) )
+                return NULL;
+
+            return poINDFile->BuildKey( iIndex, szValue );
+        }
         return poINDFile->BuildKey( iIndex, psKey->String );
         break;
 
@@ -707,6 +810,9 @@ long OGRMIAttrIndex::GetFirstMatch( OGRField *psKey )
     GByte *pabyKey = BuildKey( psKey );
     long nFID;
 
+    if( pabyKey == NULL )
+        return OGRNullFID;
+
     nFID = poINDFile->FindFirst( iIndex, pabyKey );
     if( nFID < 1 )
         return OGRNullFID;
@@ -721,10 +827,18 @@ long OGRMIAttrIndex::GetFirstMatch( OGRField *psKey )
 long *OGRMIAttrIndex::GetAllMatches( OGRField *psKey )
 
 {
+    /* 0.0 and -0.0 have different float keys */
+    if( poFldDefn->GetType() == OFTReal && psKey->Real == 0.0 )
+        return GetRangeMatches( psKey, psKey );
+
     GByte *pabyKey = BuildKey( psKey );
     long  *panFIDList = NULL, nFID;
     int   nFIDCount=0, nFIDMax=2;
 
+    /* Let the caller evaluate the condition without the index */
+    if( pabyKey == NULL )
+        return NULL;
+
     panFIDList = (long *) CPLMalloc(sizeof(long) * 2);
 
     nFID = poINDFile->FindFirst( iIndex, pabyKey );
@@ -745,6 +859,274 @@ long *OGRMIAttrIndex::GetAllMatches( OGRField *psKey )
     return panFIDList;
 }
 
+/************************************************************************/
+/*                          AddRangeMatches()                           */
+/*                                                                      */
+/*      Append the FIDs of a .IND range search to a FID list.           */
+/*      Returns FALSE on error.                                         */
+/************************************************************************/
+
+int OGRMIAttrIndex::AddRangeMatches( GByte *pabyMinKey, GByte *pabyMaxKey,
+                                     int nMaxKeyLength, long **ppanFIDList,
+                                     int *pnFIDCount, int *pnFIDMax )
+
+{
+    long nFID;
+
+    nFID = poINDFile->FindFirstInRange( iIndex, pabyMinKey, pabyMaxKey, 
+                                        nMaxKeyLength );
+    while( nFID > 0 )
+    {
+        if( *pnFIDCount >= *pnFIDMax-1 )
+        {
+            *pnFIDMax = *pnFIDMax * 2 + 10;
+            *ppanFIDList = (long *) CPLRealloc(*ppanFIDList, 
+                                               sizeof(long) * *pnFIDMax);
+        }
+        (*ppanFIDList)[(*pnFIDCount)++] = nFID - 1;
+
+        nFID = poINDFile->FindNextInRange( iIndex );
+    }
+
+    return nFID == 0;
+}
+
+/************************************************************************/
+/*                          GetRangeMatches()                           */
+/************************************************************************/
+
+long *OGRMIAttrIndex::GetRangeMatches( OGRField *psMin, OGRField *psMax )
+
+{
+    int   nKeyLength = poINDFile->GetKeyLength( iIndex );
+    GByte abyMinKey[8], abyMaxKey[8];
+    long  *panFIDList;
+    int   nFIDCount=0, nFIDMax=2, bOK = TRUE;
+
+    panFIDList = (long *) CPLMalloc(sizeof(long) * 2);
+
+    if( poFldDefn->GetType() == OFTInteger 
+        && (nKeyLength == 4 || nKeyLength == 2) )
+    {
+/* -------------------------------------------------------------------- */
+/*      Integer keys: BuildKey() only produces correctly ordered keys   */
+/*      for non-negative values, so the range needs a lower bound >= 0  */
+/*      (negative values stored in the index may then be returned as    */
+/*      extra candidates, never missed).                                */
+/* -------------------------------------------------------------------- */
+        int nMaxValue = (nKeyLength == 2) ? 32767 : 2147483647;
+
+        if( psMin == NULL || psMin->Integer < 0 )
+        {
+            CPLFree( panFIDList );
+            return NULL;
+        }
+
+        if( psMin->Integer <= nMaxValue 
+            && (psMax == NULL || psMax->Integer >= psMin->Integer) )
+        {
+            GByte *pabyMaxKey = NULL;
+
+            memcpy( abyMinKey, poINDFile->BuildKey( iIndex, 
+                                        (GInt32) psMin->Integer ), nKeyLength );
+            if( psMax != NULL && psMax->Integer < nMaxValue )
+            {
+                memcpy( abyMaxKey, poINDFile->BuildKey( iIndex, 
+                                        (GInt32) psMax->Integer ), nKeyLength );
+                pabyMaxKey = abyMaxKey;
+            }
+
+            bOK = AddRangeMatches( abyMinKey, pabyMaxKey, 0, 
+                                   &panFIDList, &nFIDCount, &nFIDMax );
+        }
+    }
+    else if( poFldDefn->GetType() == OFTReal && nKeyLength == 8 )
+    {
+/* -------------------------------------------------------------------- */
+/*      Float keys are the MSB bytes of -value: keys of values >= 0     */
+/*      have their sign bit set and are in increasing order, and keys   */
+/*      of values <= 0 come first, in decreasing order of the values.   */
+/*      So the range is split in its >= 0 and <= 0 parts.               */
+/* -------------------------------------------------------------------- */
+        double dfMin = psMin ? psMin->Real : 0.0;
+        double dfMax = psMax ? psMax->Real : 0.0;
+
+        if( psMin != NULL && psMax != NULL && dfMax < dfMin )
+            ; /* empty range */
+        else
+        {
+            if( psMax == NULL || dfMax >= 0.0 )
+            {
+                GByte *pabyMaxKey = NULL;
+
+                memcpy( abyMinKey, poINDFile->BuildKey( iIndex, 
+                           (psMin != NULL && dfMin > 0.0) ? dfMin : 0.0 ), 8 );
+                if( psMax != NULL )
+                {
+                    memcpy( abyMaxKey, poINDFile->BuildKey(iIndex, dfMax), 8 );
+                    pabyMaxKey = abyMaxKey;
+                }
+
+                bOK = AddRangeMatches( abyMinKey, pabyMaxKey, 0,
+                                       &panFIDList, &nFIDCount, &nFIDMax );
+            }
+
+            if( bOK && (psMin == NULL || dfMin <= 0.0) )
+            {
+                GByte *pabyMinKey = NULL;
+
+                if( psMax != NULL && dfMax < 0.0 )
+                {
+                    memcpy( abyMinKey, poINDFile->BuildKey(iIndex, dfMax), 8 );
+                    pabyMinKey = abyMinKey;
+                }
+                if( psMin != NULL )
+                    memcpy( abyMaxKey, poINDFile->BuildKey(iIndex, 
+                                         (dfMin == 0.0) ? -0.0 : dfMin), 8 );
+                else
+                {
+                    /* Largest key without the sign bit (-infinity, NaN) */
+                    memset( abyMaxKey, 0xff, 8 );
+                    abyMaxKey[0] = 0x7f;
+                }
+
+                bOK = AddRangeMatches( pabyMinKey, abyMaxKey, 0,
+                                       &panFIDList, &nFIDCount, &nFIDMax );
+            }
+        }
+    }
+    else
+        bOK = FALSE;
+
+    if( !bOK )
+    {
+        CPLFree( panFIDList );
+        return NULL;
+    }
+
+    panFIDList[nFIDCount] = OGRNullFID;
+    
+    return panFIDList;
+}
+
+/************************************************************************/
+/*                          GetPrefixMatches()                          */
+/************************************************************************/
+
+long *OGRMIAttrIndex::GetPrefixMatches( const char *pszPrefix )
+
+{
+    int   nKeyLength = poINDFile->GetKeyLength( iIndex );
+    int   nPrefixLength = 0;
+    long  *panFIDList;
+    int   nFIDCount=0, nFIDMax=2;
+    GByte *pabyKey;
+    OGRField sPrefix;
+
+    if( poFldDefn->GetType() != OFTString || pszPrefix[0] == '\0' )
+        return NULL;
+
+/* -------------------------------------------------------------------- */
+/*      The '\0' padded prefix is the smallest key starting with the    */
+/*      prefix, and the search stops at the first key that does not.   */
+/*      The prefix length is counted in the key, after recoding.        */
+/* -------------------------------------------------------------------- */
+    sPrefix.String = (char *) pszPrefix;
+    pabyKey = BuildKey( &sPrefix );
+    if( pabyKey == NULL )
+        return NULL;
+
+    while( nPrefixLength < nKeyLength && pabyKey[nPrefixLength] != '\0' )
+        nPrefixLength++;
+
+    panFIDList = (long *) CPLMalloc(sizeof(long) * 2);
+
+    if( !AddRangeMatches( pabyKey, pabyKey, nPrefixLength, 
+                          &panFIDList, &nFIDCount, &nFIDMax ) )
+    {
+        CPLFree( panFIDList );
+        return NULL;
+    }
+
+    panFIDList[nFIDCount] = OGRNullFID;
+    
+    return panFIDList;
+}
+
+/************************************************************************/
+/*                            OGRMIIsASCII()                            */
+/************************************************************************/
+
+static int OGRMIIsASCII( const char *pszValue )
+
+{
+    for( ; *pszValue != '\0'; pszValue++ )
+    {
+        if( (unsigned char) *pszValue >= 0x80 )
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                            IsExactRange()                            */
+/************************************************************************/
+
+int OGRMIAttrIndex::IsExactRange( OGRField *psMin, OGRField *psMax )
+
+{
+    int   nKeyLength = poINDFile->GetKeyLength( iIndex );
+
+    switch( poFldDefn->GetType() )
+    {
+      case OFTInteger:
+/* -------------------------------------------------------------------- */
+/*      BuildKey() gives small negative values the same keys as some    */
+/*      positive values: -1 and 255 share a key, and so do -300 and     */
+/*      65492.  Only keys above all these shared keys are exact.        */
+/* -------------------------------------------------------------------- */
+        if( psMin == NULL || psMax == NULL )
+            return FALSE;
+        if( psMin->Integer == 0 && psMax->Integer == 0 )
+            return TRUE;
+        return psMin->Integer >= (nKeyLength == 2 ? 0x100 : 0x1000000);
+
+      case OFTReal:
+/* -------------------------------------------------------------------- */
+/*      Decimal fields (which have a width) used to be indexed with     */
+/*      the value before it was rounded to the field precision.         */
+/* -------------------------------------------------------------------- */
+        return poFldDefn->GetWidth() == 0;
+
+      case OFTString:
+/* -------------------------------------------------------------------- */
+/*      Keys are uppercased like EQUAL() compares, but truncated to     */
+/*      the key length, and case folding of 8 bit characters depends    */
+/*      on the locale.                                                  */
+/* -------------------------------------------------------------------- */
+        return psMin != NULL && psMax != NULL 
+            && EQUAL(psMin->String, psMax->String)
+            && (int) strlen(psMin->String) < nKeyLength
+            && OGRMIIsASCII( psMin->String );
+
+      default:
+        return FALSE;
+    }
+}
+
+/************************************************************************/
+/*                           IsExactPrefix()                            */
+/************************************************************************/
+
+int OGRMIAttrIndex::IsExactPrefix( const char *pszPrefix )
+
+{
+    return poFldDefn->GetType() == OFTString
+        && (int) strlen(pszPrefix) <= poINDFile->GetKeyLength( iIndex )
+        && OGRMIIsASCII( pszPrefix );
+}
+
 /************************************************************************/
 /*                               Clear()                                */
 /************************************************************************/
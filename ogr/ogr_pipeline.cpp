@@ -0,0 +1,399 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  OpenGIS Simple Features Reference Implementation
+ * Purpose:  Implementation of OGRFeaturePipeline, multithreaded read ->
+ *           translate -> write of a stream of features.
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, MITAB contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "ogr_pipeline.h"
+#include "cpl_conv.h"
+#include "cpl_multiproc.h"
+
+CPL_CVSID("$Id$");
+
+/* Slot states, a slot goes through them in order and back to FREE. */
+#define OGRPS_FREE              0
+#define OGRPS_READ              1       /* source feature available */
+#define OGRPS_TRANSLATING       2
+#define OGRPS_DONE              3       /* ready to be written */
+
+typedef struct
+{
+    OGRFeaturePipeline *poPipeline;
+    int                 iWorker;
+} OGRPipelineWorkerInfo;
+
+/************************************************************************/
+/*                         OGRFeaturePipeline()                         */
+/************************************************************************/
+
+OGRFeaturePipeline::OGRFeaturePipeline( OGRPipelineReadFunc pfnReadIn, 
+                                        OGRPipelineTranslateFunc pfnTransIn,
+                                        OGRPipelineWriteFunc pfnWriteIn,
+                                        void *pUserDataIn )
+
+{
+    pfnRead = pfnReadIn;
+    pfnTranslate = pfnTransIn;
+    pfnWrite = pfnWriteIn;
+    pUserData = pUserDataIn;
+
+    hMutex = NULL;
+    hCond = NULL;
+
+    nSlots = 0;
+    pasSlots = NULL;
+
+    nRead = 0;
+    nTranslated = 0;
+    nWritten = 0;
+    bEOF = FALSE;
+    bStop = FALSE;
+
+    bReaderWaiting = FALSE;
+    nWorkersWaiting = 0;
+    bWriterWaiting = FALSE;
+}
+
+/************************************************************************/
+/*                        ~OGRFeaturePipeline()                         */
+/************************************************************************/
+
+OGRFeaturePipeline::~OGRFeaturePipeline()
+
+{
+    CPLFree( pasSlots );
+}
+
+/************************************************************************/
+/*                             RunSerial()                              */
+/************************************************************************/
+
+int OGRFeaturePipeline::RunSerial()
+
+{
+    OGRFeature *poSrcFeature;
+    int        bContinue = TRUE;
+
+    while( bContinue && (poSrcFeature = pfnRead( pUserData )) != NULL )
+    {
+        OGRFeature *poDstFeature = NULL;
+        int         nStatus = 0;
+
+        if( pfnTranslate != NULL )
+            nStatus = pfnTranslate( poSrcFeature, &poDstFeature, 0, 
+                                    pUserData );
+
+        bContinue = pfnWrite( poSrcFeature, poDstFeature, nStatus, 
+                              pUserData );
+
+        OGRFeature::DestroyFeature( poSrcFeature );
+        if( poDstFeature != NULL )
+            OGRFeature::DestroyFeature( poDstFeature );
+    }
+
+    return bContinue;
+}
+
+/************************************************************************/
+/*                            ReaderThread()                            */
+/************************************************************************/
+
+void OGRFeaturePipeline::ReaderThread( void *pData )
+
+{
+    ((OGRFeaturePipeline *) pData)->ReaderMain();
+}
+
+/************************************************************************/
+/*                             ReaderMain()                             */
+/*                                                                      */
+/*      Fill free slots in order with source features, waiting          */
+/*      while the window of features in flight is full.  The writer     */
+/*      only wakes us up once half of the window is free, to avoid      */
+/*      a context switch per feature.                                   */
+/************************************************************************/
+
+void OGRFeaturePipeline::ReaderMain()
+
+{
+    OGRFeature *poSrcFeature;
+
+    CPLAcquireMutex( hMutex, 1000.0 );
+
+    while( TRUE )
+    {
+        while( !bStop && nRead - nWritten >= nSlots )
+        {
+            bReaderWaiting = TRUE;
+            CPLCondWait( hCond, hMutex );
+            bReaderWaiting = FALSE;
+        }
+
+        if( bStop )
+            break;
+
+        CPLReleaseMutex( hMutex );
+        poSrcFeature = pfnRead( pUserData );
+        CPLAcquireMutex( hMutex, 1000.0 );
+
+        if( poSrcFeature == NULL || bStop )
+        {
+            if( poSrcFeature != NULL )
+                OGRFeature::DestroyFeature( poSrcFeature );
+            break;
+        }
+
+        OGRPipelineSlot *psSlot = pasSlots + (nRead % nSlots);
+
+        psSlot->poSrcFeature = poSrcFeature;
+        psSlot->poDstFeature = NULL;
+        psSlot->nStatus = 0;
+        psSlot->nState = (pfnTranslate != NULL) ? OGRPS_READ : OGRPS_DONE;
+        nRead++;
+
+        if( nWorkersWaiting > 0 || (bWriterWaiting && pfnTranslate == NULL) )
+            CPLCondBroadcast( hCond );
+    }
+
+    bEOF = TRUE;
+    CPLCondBroadcast( hCond );
+    CPLReleaseMutex( hMutex );
+}
+
+/************************************************************************/
+/*                            WorkerThread()                            */
+/************************************************************************/
+
+void OGRFeaturePipeline::WorkerThread( void *pData )
+
+{
+    OGRPipelineWorkerInfo *psInfo = (OGRPipelineWorkerInfo *) pData;
+
+    psInfo->poPipeline->WorkerMain( psInfo->iWorker );
+}
+
+/************************************************************************/
+/*                             WorkerMain()                             */
+/*                                                                      */
+/*      Translate read features in the order they were read.  The       */
+/*      results complete out of order but stay in their slot until      */
+/*      the writer gets to them.                                        */
+/************************************************************************/
+
+void OGRFeaturePipeline::WorkerMain( int iWorker )
+
+{
+    CPLAcquireMutex( hMutex, 1000.0 );
+
+    while( TRUE )
+    {
+        while( !bStop && !bEOF && nTranslated >= nRead )
+        {
+            nWorkersWaiting++;
+            CPLCondWait( hCond, hMutex );
+            nWorkersWaiting--;
+        }
+
+        if( bStop || nTranslated >= nRead )
+            break;
+
+        int         iSeq = nTranslated;
+        OGRPipelineSlot *psSlot = pasSlots + (iSeq % nSlots);
+        OGRFeature *poDstFeature = NULL;
+        int         nStatus;
+
+        CPLAssert( psSlot->nState == OGRPS_READ );
+        psSlot->nState = OGRPS_TRANSLATING;
+        nTranslated++;
+
+        CPLReleaseMutex( hMutex );
+        nStatus = pfnTranslate( psSlot->poSrcFeature, &poDstFeature, 
+                                iWorker, pUserData );
+        CPLAcquireMutex( hMutex, 1000.0 );
+
+        psSlot->poDstFeature = poDstFeature;
+        psSlot->nStatus = nStatus;
+        psSlot->nState = OGRPS_DONE;
+
+        /* The writer only waits for the oldest feature in flight */
+        if( bWriterWaiting && iSeq == nWritten )
+            CPLCondBroadcast( hCond );
+    }
+
+    CPLReleaseMutex( hMutex );
+}
+
+/************************************************************************/
+/*                                Run()                                 */
+/*                                                                      */
+/*      Process all the features with nWorkers translation threads      */
+/*      and at most nQueueSize features in flight (default 64 per       */
+/*      worker).  Returns FALSE if the write function stopped the       */
+/*      pipeline, TRUE otherwise.                                       */
+/************************************************************************/
+
+int OGRFeaturePipeline::Run( int nWorkers, int nQueueSize )
+
+{
+    OGRPipelineWorkerInfo *pasWorkers;
+    void        *hReaderThread;
+    void        **pahWorkerThreads;
+    int         nWorkerThreads = 0, bContinue = TRUE, i;
+
+    if( nWorkers < 1 )
+        return RunSerial();
+
+    if( pfnTranslate == NULL )
+        nWorkers = 0;
+
+    hCond = CPLCreateCond();
+    if( hCond == NULL )
+        return RunSerial();
+
+    hMutex = CPLCreateMutex();
+
+    if( nQueueSize < 1 )
+        nQueueSize = 64 * MAX(nWorkers,1);
+
+    nSlots = nQueueSize;
+    pasSlots = (OGRPipelineSlot *) 
+        CPLCalloc( sizeof(OGRPipelineSlot), nSlots );
+    nRead = nTranslated = nWritten = 0;
+    bEOF = bStop = FALSE;
+    bReaderWaiting = bWriterWaiting = FALSE;
+    nWorkersWaiting = 0;
+
+/* -------------------------------------------------------------------- */
+/*      Start the reader and the workers.  The mutex is still held      */
+/*      from its creation, so they wait until we are ready.             */
+/* -------------------------------------------------------------------- */
+    pasWorkers = (OGRPipelineWorkerInfo *) 
+        CPLCalloc( sizeof(OGRPipelineWorkerInfo), MAX(nWorkers,1) );
+    pahWorkerThreads = (void **) CPLCalloc( sizeof(void*), MAX(nWorkers,1) );
+
+    hReaderThread = CPLCreateJoinableThread( ReaderThread, this );
+
+    for( i = 0; hReaderThread != NULL && i < nWorkers; i++ )
+    {
+        pasWorkers[i].poPipeline = this;
+        pasWorkers[i].iWorker = i;
+        pahWorkerThreads[i] = 
+            CPLCreateJoinableThread( WorkerThread, pasWorkers + i );
+        if( pahWorkerThreads[i] == NULL )
+            break;
+        nWorkerThreads++;
+    }
+
+    if( hReaderThread == NULL || (nWorkers > 0 && nWorkerThreads == 0) )
+    {
+        /* Could not start the pipeline, stop the reader if any. */
+        bStop = TRUE;
+        CPLReleaseMutex( hMutex );
+        CPLJoinThread( hReaderThread );
+
+        CPLFree( pasWorkers );
+        CPLFree( pahWorkerThreads );
+        CPLFree( pasSlots );
+        pasSlots = NULL;
+        CPLDestroyMutex( hMutex );
+        CPLDestroyCond( hCond );
+        hMutex = hCond = NULL;
+
+        return RunSerial();
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Write the features in order as they complete.                   */
+/* -------------------------------------------------------------------- */
+    while( TRUE )
+    {
+        OGRPipelineSlot *psSlot = pasSlots + (nWritten % nSlots);
+
+        while( !(nWritten < nRead && psSlot->nState == OGRPS_DONE)
+               && !(bEOF && nWritten >= nRead) )
+        {
+            bWriterWaiting = TRUE;
+            CPLCondWait( hCond, hMutex );
+            bWriterWaiting = FALSE;
+        }
+
+        if( nWritten >= nRead )
+            break;
+
+        CPLReleaseMutex( hMutex );
+        bContinue = pfnWrite( psSlot->poSrcFeature, psSlot->poDstFeature, 
+                              psSlot->nStatus, pUserData );
+
+        OGRFeature::DestroyFeature( psSlot->poSrcFeature );
+        if( psSlot->poDstFeature != NULL )
+            OGRFeature::DestroyFeature( psSlot->poDstFeature );
+        CPLAcquireMutex( hMutex, 1000.0 );
+
+        psSlot->poSrcFeature = NULL;
+        psSlot->poDstFeature = NULL;
+        psSlot->nState = OGRPS_FREE;
+        nWritten++;
+
+        if( !bContinue )
+        {
+            bStop = TRUE;
+            CPLCondBroadcast( hCond );
+            break;
+        }
+
+        if( bReaderWaiting && nRead - nWritten <= nSlots / 2 )
+            CPLCondBroadcast( hCond );
+    }
+
+    CPLReleaseMutex( hMutex );
+
+/* -------------------------------------------------------------------- */
+/*      Wait for the threads and discard what was not written.          */
+/* -------------------------------------------------------------------- */
+    CPLJoinThread( hReaderThread );
+    for( i = 0; i < nWorkerThreads; i++ )
+        CPLJoinThread( pahWorkerThreads[i] );
+
+    for( ; nWritten < nRead; nWritten++ )
+    {
+        OGRPipelineSlot *psSlot = pasSlots + (nWritten % nSlots);
+
+        if( psSlot->poSrcFeature != NULL )
+            OGRFeature::DestroyFeature( psSlot->poSrcFeature );
+        if( psSlot->poDstFeature != NULL )
+            OGRFeature::DestroyFeature( psSlot->poDstFeature );
+    }
+
+    CPLFree( pasWorkers );
+    CPLFree( pahWorkerThreads );
+    CPLFree( pasSlots );
+    pasSlots = NULL;
+    CPLDestroyMutex( hMutex );
+    CPLDestroyCond( hCond );
+    hMutex = hCond = NULL;
+
+    return bContinue;
+}
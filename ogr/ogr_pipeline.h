@@ -0,0 +1,110 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  OpenGIS Simple Features Reference Implementation
+ * Purpose:  Classes related to multithreaded feature translation.
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, MITAB contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef _OGR_PIPELINE_H_INCLUDED
+#define _OGR_PIPELINE_H_INCLUDED
+
+#include "ogr_feature.h"
+
+/* Returns the next source feature, or NULL when done. */
+typedef OGRFeature *(*OGRPipelineReadFunc)( void *pUserData );
+
+/* Translates one source feature, called concurrently with iWorker in     */
+/* [0,nWorkers).  Sets *ppoDstFeature and returns a status passed as is   */
+/* to the write function.                                               */
+typedef int (*OGRPipelineTranslateFunc)( OGRFeature *poSrcFeature,
+                                         OGRFeature **ppoDstFeature,
+                                         int iWorker, void *pUserData );
+
+/* Writes one translated feature, in source order.  Returns FALSE to stop. */
+typedef int (*OGRPipelineWriteFunc)( OGRFeature *poSrcFeature,
+                                     OGRFeature *poDstFeature,
+                                     int nStatus, void *pUserData );
+
+/************************************************************************/
+/*                          OGRFeaturePipeline                          */
+/*                                                                      */
+/*      Runs read -> translate -> write over a stream of features.      */
+/*      The read function runs on a reader thread, the translate        */
+/*      function on a pool of worker threads and the write function     */
+/*      in the calling thread, in source order.  The stages are         */
+/*      linked by a bounded window of features in flight, so a slow     */
+/*      stage holds back the others.  Without thread support, or        */
+/*      with nWorkers < 1, the stages run one feature at a time in      */
+/*      the calling thread.                                             */
+/************************************************************************/
+
+typedef struct
+{
+    int          nState;
+    OGRFeature  *poSrcFeature;
+    OGRFeature  *poDstFeature;
+    int          nStatus;
+} OGRPipelineSlot;
+
+class CPL_DLL OGRFeaturePipeline
+{
+    OGRPipelineReadFunc      pfnRead;
+    OGRPipelineTranslateFunc pfnTranslate;
+    OGRPipelineWriteFunc     pfnWrite;
+    void                    *pUserData;
+
+    void                *hMutex;
+    void                *hCond;
+
+    int                 nSlots;
+    OGRPipelineSlot     *pasSlots;
+
+    int                 nRead;          /* features read so far */
+    int                 nTranslated;    /* features handed to workers */
+    int                 nWritten;       /* features written so far */
+    int                 bEOF;
+    int                 bStop;
+
+    int                 bReaderWaiting; /* to only signal when needed */
+    int                 nWorkersWaiting;
+    int                 bWriterWaiting;
+
+    int                 RunSerial();
+    void                ReaderMain();
+    void                WorkerMain( int iWorker );
+
+    static void         ReaderThread( void * );
+    static void         WorkerThread( void * );
+
+  public:
+                        OGRFeaturePipeline( OGRPipelineReadFunc, 
+                                            OGRPipelineTranslateFunc,
+                                            OGRPipelineWriteFunc,
+                                            void *pUserData );
+                        ~OGRFeaturePipeline();
+
+    int                 Run( int nWorkers, int nQueueSize = 0 );
+};
+
+#endif /* ndef _OGR_PIPELINE_H_INCLUDED */
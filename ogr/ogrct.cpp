@@ -36,6 +36,9 @@
 
 #ifdef PROJ_STATIC
 #include "proj_api.h"
+#if PJ_VERSION < 480
+#define projCtx void *
+#endif
 #endif
 
 CPL_CVSID("$Id: ogrct.cpp 18520 2010-01-11 03:59:14Z warmerdam $");
@@ -47,6 +50,7 @@ CPL_CVSID("$Id: ogrct.cpp 18520 2010-01-11 03:59:14Z warmerdam $");
 typedef struct { double u, v; } projUV;
 
 #define projPJ void *
+#define projCtx void *
 
 #define RAD_TO_DEG      57.29577951308232
 #define DEG_TO_RAD      .0174532925199432958
@@ -67,6 +71,13 @@ static char        *(*pfn_pj_strerrno)(int) = NULL;
 static char        *(*pfn_pj_get_def)(projPJ,int) = NULL;
 static void         (*pfn_pj_dalloc)(void *) = NULL;
 
+/* PROJ 4.8 contexts: a projPJ bound to its own context can be used */
+/* without hPROJMutex, as long as only one thread uses it at a time. */
+static projCtx      (*pfn_pj_ctx_alloc)(void) = NULL;
+static void         (*pfn_pj_ctx_free)(projCtx) = NULL;
+static projPJ       (*pfn_pj_init_plus_ctx)(projCtx, const char *) = NULL;
+static int          (*pfn_pj_ctx_get_errno)(projCtx) = NULL;
+
 #if (defined(WIN32) || defined(WIN32CE)) && !defined(__MINGW32__)
 #  define LIBNAME      "proj.dll"
 #elif defined(__MINGW32__)
@@ -108,11 +119,17 @@ class OGRProj4CT : public OGRCoordinateTransformation
     int         bTargetWrap;
     double      dfTargetWrapLong;
 
+    projCtx     pjctx;
+
     int         nErrorCount;
     
     int         bCheckWithInvertProj;
     double      dfThreshold;
 
+    projPJ      InitProj4( const char *pszProj4Defn );
+    int         TransformWithProj4( int nCount, 
+                                    double *x, double *y, double *z );
+
 public:
                 OGRProj4CT();
     virtual     ~OGRProj4CT();
@@ -175,6 +192,12 @@ static int LoadProjLibrary()
 #if PJ_VERSION >= 446
     pfn_pj_get_def = pj_get_def;
 #endif    
+#if PJ_VERSION >= 480
+    pfn_pj_ctx_alloc = pj_ctx_alloc;
+    pfn_pj_ctx_free = pj_ctx_free;
+    pfn_pj_init_plus_ctx = pj_init_plus_ctx;
+    pfn_pj_ctx_get_errno = pj_ctx_get_errno;
+#endif
 #else
     CPLPushErrorHandler( CPLQuietErrorHandler );
 
@@ -206,6 +229,24 @@ static int LoadProjLibrary()
         CPLGetSymbol( pszLibName, "pj_get_def" );
     pfn_pj_dalloc = (void (*)(void*))
         CPLGetSymbol( pszLibName, "pj_dalloc" );
+
+    /* Only use contexts if the whole set is available (PROJ >= 4.8) */
+    pfn_pj_ctx_alloc = (projCtx (*)(void))
+        CPLGetSymbol( pszLibName, "pj_ctx_alloc" );
+    pfn_pj_ctx_free = (void (*)(projCtx))
+        CPLGetSymbol( pszLibName, "pj_ctx_free" );
+    pfn_pj_init_plus_ctx = (projPJ (*)(projCtx, const char *))
+        CPLGetSymbol( pszLibName, "pj_init_plus_ctx" );
+    pfn_pj_ctx_get_errno = (int (*)(projCtx))
+        CPLGetSymbol( pszLibName, "pj_ctx_get_errno" );
+    if( pfn_pj_ctx_alloc == NULL || pfn_pj_ctx_free == NULL
+        || pfn_pj_init_plus_ctx == NULL || pfn_pj_ctx_get_errno == NULL )
+    {
+        pfn_pj_ctx_alloc = NULL;
+        pfn_pj_ctx_free = NULL;
+        pfn_pj_init_plus_ctx = NULL;
+        pfn_pj_ctx_get_errno = NULL;
+    }
     CPLPopErrorHandler();
 
 #endif
@@ -381,6 +422,7 @@ OGRProj4CT::OGRProj4CT()
     poSRSTarget = NULL;
     psPJSource = NULL;
     psPJTarget = NULL;
+    pjctx = NULL;
     
     nErrorCount = 0;
     
@@ -414,6 +456,50 @@ OGRProj4CT::~OGRProj4CT()
 
     if( psPJTarget != NULL )
         pfn_pj_free( psPJTarget );
+
+    if( pjctx != NULL )
+        pfn_pj_ctx_free( pjctx );
+}
+
+/************************************************************************/
+/*                             InitProj4()                              */
+/*                                                                      */
+/*      Create a PROJ.4 handle, in this transformation's own context    */
+/*      when PROJ.4 supports them.                                      */
+/************************************************************************/
+
+projPJ OGRProj4CT::InitProj4( const char *pszProj4Defn )
+
+{
+    projPJ      psPJ;
+    int         nErrno = 0;
+
+    if( pjctx != NULL )
+    {
+        psPJ = pfn_pj_init_plus_ctx( pjctx, pszProj4Defn );
+        if( psPJ == NULL )
+            nErrno = pfn_pj_ctx_get_errno( pjctx );
+    }
+    else
+    {
+        psPJ = pfn_pj_init_plus( pszProj4Defn );
+        if( psPJ == NULL && pfn_pj_get_errno_ref != NULL )
+            nErrno = *(pfn_pj_get_errno_ref());
+    }
+
+    if( psPJ == NULL )
+    {
+        if( nErrno != 0 && pfn_pj_strerrno != NULL )
+            CPLError( CE_Failure, CPLE_NotSupported, 
+                      "Failed to initialize PROJ.4 with `%s'.\n%s", 
+                      pszProj4Defn, pfn_pj_strerrno(nErrno) );
+        else
+            CPLError( CE_Failure, CPLE_NotSupported, 
+                      "Failed to initialize PROJ.4 with `%s'.\n", 
+                      pszProj4Defn );
+    }
+
+    return psPJ;
 }
 
 /************************************************************************/
@@ -432,6 +518,9 @@ int OGRProj4CT::Initialize( OGRSpatialReference * poSourceIn,
     poSRSSource = poSourceIn->Clone();
     poSRSTarget = poTargetIn->Clone();
 
+    if( pfn_pj_ctx_alloc != NULL )
+        pjctx = pfn_pj_ctx_alloc();
+
     bSourceLatLong = poSRSSource->IsGeographic();
     bTargetLatLong = poSRSTarget->IsGeographic();
 
@@ -539,26 +628,7 @@ int OGRProj4CT::Initialize( OGRSpatialReference * poSourceIn,
         return FALSE;
     }
 
-    psPJSource = pfn_pj_init_plus( pszProj4Defn );
-    
-    if( psPJSource == NULL )
-    {
-        if( pfn_pj_get_errno_ref != NULL
-            && pfn_pj_strerrno != NULL )
-        {
-            int *p_pj_errno = pfn_pj_get_errno_ref();
-
-            CPLError( CE_Failure, CPLE_NotSupported, 
-                      "Failed to initialize PROJ.4 with `%s'.\n%s", 
-                      pszProj4Defn, pfn_pj_strerrno(*p_pj_errno) );
-        }
-        else
-        {
-            CPLError( CE_Failure, CPLE_NotSupported, 
-                      "Failed to initialize PROJ.4 with `%s'.\n", 
-                      pszProj4Defn );
-        }
-    }
+    psPJSource = InitProj4( pszProj4Defn );
     
     if( nDebugReportCount < 10 )
         CPLDebug( "OGRCT", "Source: %s", pszProj4Defn );
@@ -588,12 +658,7 @@ int OGRProj4CT::Initialize( OGRSpatialReference * poSourceIn,
         return FALSE;
     }
 
-    psPJTarget = pfn_pj_init_plus( pszProj4Defn );
-    
-    if( psPJTarget == NULL )
-        CPLError( CE_Failure, CPLE_NotSupported, 
-                  "Failed to initialize PROJ.4 with `%s'.", 
-                  pszProj4Defn );
+    psPJTarget = InitProj4( pszProj4Defn );
     
     if( nDebugReportCount < 10 )
     {
@@ -670,49 +735,19 @@ int CPL_STDCALL OCTTransform( OGRCoordinateTransformationH hTransform,
 }
 
 /************************************************************************/
-/*                            TransformEx()                             */
+/*                         TransformWithProj4()                         */
+/*                                                                      */
+/*      Run pj_transform() on radians/projected coordinates, checking   */
+/*      with the inverse transformation if needed.  Returns the PROJ.4  */
+/*      error code.                                                     */
 /************************************************************************/
 
-int OGRProj4CT::TransformEx( int nCount, double *x, double *y, double *z,
-                             int *pabSuccess )
+int OGRProj4CT::TransformWithProj4( int nCount, 
+                                    double *x, double *y, double *z )
 
 {
     int   err, i;
 
-/* -------------------------------------------------------------------- */
-/*      Potentially transform to radians.                               */
-/* -------------------------------------------------------------------- */
-    if( bSourceLatLong )
-    {
-        if( bSourceWrap )
-        {
-            for( i = 0; i < nCount; i++ )
-            {
-                if( x[i] != HUGE_VAL && y[i] != HUGE_VAL )
-                {
-                    if( x[i] < dfSourceWrapLong - 180.0 )
-                        x[i] += 360.0;
-                    else if( x[i] > dfSourceWrapLong + 180 )
-                        x[i] -= 360.0;
-                }
-            }
-        }
-
-        for( i = 0; i < nCount; i++ )
-        {
-            if( x[i] != HUGE_VAL )
-            {
-                x[i] *= dfSourceToRadians;
-                y[i] *= dfSourceToRadians;
-            }
-        }
-    }
-    
-/* -------------------------------------------------------------------- */
-/*      Do the transformation using PROJ.4.                             */
-/* -------------------------------------------------------------------- */
-    CPLMutexHolderD( &hPROJMutex );
-        
     if (bCheckWithInvertProj)
     {
         /* For some projections, we cannot detect if we are trying to reproject */
@@ -774,6 +809,60 @@ int OGRProj4CT::TransformEx( int nCount, double *x, double *y, double *z,
         err = pfn_pj_transform( psPJSource, psPJTarget, nCount, 1, x, y, z );
     }
 
+    return err;
+}
+
+/************************************************************************/
+/*                            TransformEx()                             */
+/************************************************************************/
+
+int OGRProj4CT::TransformEx( int nCount, double *x, double *y, double *z,
+                             int *pabSuccess )
+
+{
+    int   err, i;
+
+/* -------------------------------------------------------------------- */
+/*      Potentially transform to radians.                               */
+/* -------------------------------------------------------------------- */
+    if( bSourceLatLong )
+    {
+        if( bSourceWrap )
+        {
+            for( i = 0; i < nCount; i++ )
+            {
+                if( x[i] != HUGE_VAL && y[i] != HUGE_VAL )
+                {
+                    if( x[i] < dfSourceWrapLong - 180.0 )
+                        x[i] += 360.0;
+                    else if( x[i] > dfSourceWrapLong + 180 )
+                        x[i] -= 360.0;
+                }
+            }
+        }
+
+        for( i = 0; i < nCount; i++ )
+        {
+            if( x[i] != HUGE_VAL )
+            {
+                x[i] *= dfSourceToRadians;
+                y[i] *= dfSourceToRadians;
+            }
+        }
+    }
+    
+/* -------------------------------------------------------------------- */
+/*      Do the transformation using PROJ.4.  Handles in the default     */
+/*      context are shared by all threads and must be serialized.       */
+/* -------------------------------------------------------------------- */
+    if( pjctx != NULL )
+        err = TransformWithProj4( nCount, x, y, z );
+    else
+    {
+        CPLMutexHolderD( &hPROJMutex );
+        err = TransformWithProj4( nCount, x, y, z );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Try to report an error through CPL.  Get proj.4 error string    */
 /*      if possible.  Try to avoid reporting thousands of error         */
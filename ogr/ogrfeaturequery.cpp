@@ -29,6 +29,7 @@
  ****************************************************************************/
 
 #include <assert.h>
+#include <limits.h>
 #include "ogr_feature.h"
 #include "ogr_p.h"
 #include "ogr_attrind.h"
@@ -44,6 +45,12 @@ const char* SpecialFieldNames[SPECIAL_FIELD_COUNT]
 const swq_field_type SpecialFieldTypes[SPECIAL_FIELD_COUNT] 
 = {SWQ_INTEGER, SWQ_STRING, SWQ_STRING, SWQ_STRING, SWQ_FLOAT};
 
+typedef struct _OGRQueryProgram OGRQueryProgram;
+
+static OGRQueryProgram *OGRQueryProgramBuild( swq_expr *, OGRFeatureDefn * );
+static void OGRQueryProgramFree( OGRQueryProgram * );
+static int  OGRQueryProgramRun( OGRQueryProgram *, OGRFeature * );
+
 /************************************************************************/
 /*                          OGRFeatureQuery()                           */
 /************************************************************************/
@@ -53,6 +60,7 @@ OGRFeatureQuery::OGRFeatureQuery()
 {
     poTargetDefn = NULL;
     pSWQExpr = NULL;
+    pProgram = NULL;
 }
 
 /************************************************************************/
@@ -64,6 +72,8 @@ OGRFeatureQuery::~OGRFeatureQuery()
 {
     if( pSWQExpr != NULL )
         swq_expr_free( (swq_expr *) pSWQExpr );
+
+    OGRQueryProgramFree( (OGRQueryProgram *) pProgram );
 }
 
 /************************************************************************/
@@ -80,6 +90,9 @@ OGRErr OGRFeatureQuery::Compile( OGRFeatureDefn *poDefn,
     if( pSWQExpr != NULL )
         swq_expr_free( (swq_expr *) pSWQExpr );
 
+    OGRQueryProgramFree( (OGRQueryProgram *) pProgram );
+    pProgram = NULL;
+
 /* -------------------------------------------------------------------- */
 /*      Build list of fields.                                           */
 /* -------------------------------------------------------------------- */
@@ -144,6 +157,10 @@ OGRErr OGRFeatureQuery::Compile( OGRFeatureDefn *poDefn,
         eErr = OGRERR_CORRUPT_DATA;
         pSWQExpr = NULL;
     }
+    else
+    {
+        pProgram = OGRQueryProgramBuild( (swq_expr *) pSWQExpr, poDefn );
+    }
 
     CPLFree( papszFieldNames );
     CPLFree( paeFieldTypes );
@@ -397,6 +414,550 @@ static int OGRFeatureQueryEvaluator( swq_field_op *op, OGRFeature *poFeature )
     }
 }
 
+/************************************************************************/
+/*                 Compiled form of the WHERE expression                */
+/*                                                                      */
+/*      The swq_expr tree is flattened into a sequence of instructions  */
+/*      specialized on the operation and field type.  Each test sets   */
+/*      a single result flag, AND/OR are turned into conditional jumps  */
+/*      over their second operand, and IN lists are turned into sorted  */
+/*      arrays searched with bsearch().  Tests that have no specialized */
+/*      form (special fields, unusual operations) are delegated to      */
+/*      OGRFeatureQueryEvaluator().                                     */
+/************************************************************************/
+
+/* Shorter string IN lists are scanned with EQUAL(), which is faster. */
+#define OGRQ_STR_IN_BSEARCH_MIN 16
+
+typedef enum {
+    OGRQ_GENERIC,
+    OGRQ_JUMP_IF_FALSE,
+    OGRQ_JUMP_IF_TRUE,
+    OGRQ_NOT,
+    OGRQ_ISNULL,
+    OGRQ_INT_EQ,
+    OGRQ_INT_NE,
+    OGRQ_INT_LT,
+    OGRQ_INT_GT,
+    OGRQ_INT_LE,
+    OGRQ_INT_GE,
+    OGRQ_INT_IN,
+    OGRQ_REAL_EQ,
+    OGRQ_REAL_NE,
+    OGRQ_REAL_LT,
+    OGRQ_REAL_GT,
+    OGRQ_REAL_LE,
+    OGRQ_REAL_GE,
+    OGRQ_REAL_IN,
+    OGRQ_STR_EQ,
+    OGRQ_STR_NE,
+    OGRQ_STR_LT,
+    OGRQ_STR_GT,
+    OGRQ_STR_LE,
+    OGRQ_STR_GE,
+    OGRQ_STR_LIKE,
+    OGRQ_STR_LIKE_EXACT,
+    OGRQ_STR_LIKE_PREFIX,
+    OGRQ_STR_IN
+} OGRQueryOpcode;
+
+typedef struct
+{
+    OGRQueryOpcode eOpcode;
+    int            iField;
+    int            nJump;        /* target of OGRQ_JUMP_IF_* */
+
+    int            nValue;       /* int value, or LIKE prefix length */
+    double         dfValue;
+    const char    *pszValue;     /* points into the swq_expr */
+
+    int            nValues;      /* sorted IN lists, owned */
+    int           *panValues;
+    double        *padfValues;
+    const char   **papszValues;  /* strings point into the swq_expr */
+
+    swq_field_op  *psOp;         /* for OGRQ_GENERIC */
+} OGRQueryInstr;
+
+struct _OGRQueryProgram
+{
+    int            nInstrs;
+    int            nMaxInstrs;
+    OGRQueryInstr *pasInstrs;
+};
+
+/************************************************************************/
+/*                      OGRQuery*Compare() helpers                      */
+/************************************************************************/
+
+static int OGRQueryIntCompare( const void *pA, const void *pB )
+
+{
+    int nA = *((const int *) pA);
+    int nB = *((const int *) pB);
+
+    return (nA < nB) ? -1 : (nA > nB) ? 1 : 0;
+}
+
+static int OGRQueryRealCompare( const void *pA, const void *pB )
+
+{
+    double dfA = *((const double *) pA);
+    double dfB = *((const double *) pB);
+
+    return (dfA < dfB) ? -1 : (dfA > dfB) ? 1 : 0;
+}
+
+/* Same ordering as strcasecmp(), so that a match is EQUAL(). */
+static int OGRQueryStrCompare( const void *pA, const void *pB )
+
+{
+    const unsigned char *pszA = *((const unsigned char **) pA);
+    const unsigned char *pszB = *((const unsigned char **) pB);
+
+    while( *pszA != '\0' && tolower(*pszA) == tolower(*pszB) )
+    {
+        pszA++;
+        pszB++;
+    }
+
+    return tolower(*pszA) - tolower(*pszB);
+}
+
+/************************************************************************/
+/*                        OGRQueryProgramAdd()                          */
+/************************************************************************/
+
+static int OGRQueryProgramAdd( OGRQueryProgram *psProgram, 
+                               OGRQueryOpcode eOpcode )
+
+{
+    if( psProgram->nInstrs == psProgram->nMaxInstrs )
+    {
+        psProgram->nMaxInstrs = psProgram->nMaxInstrs * 2 + 8;
+        psProgram->pasInstrs = (OGRQueryInstr *)
+            CPLRealloc( psProgram->pasInstrs, 
+                        sizeof(OGRQueryInstr) * psProgram->nMaxInstrs );
+    }
+
+    OGRQueryInstr *psInstr = psProgram->pasInstrs + psProgram->nInstrs;
+
+    memset( psInstr, 0, sizeof(OGRQueryInstr) );
+    psInstr->eOpcode = eOpcode;
+
+    return psProgram->nInstrs++;
+}
+
+/************************************************************************/
+/*                      OGRQueryProgramEmitTest()                       */
+/*                                                                      */
+/*      Emit the instruction for a single field test.                   */
+/************************************************************************/
+
+static void OGRQueryProgramEmitTest( OGRQueryProgram *psProgram,
+                                     swq_field_op *op, int nFieldCount )
+
+{
+    OGRQueryOpcode eOpcode = OGRQ_GENERIC;
+    int            iInstr;
+    OGRQueryInstr *psInstr;
+
+    if( op->field_index < 0 || op->field_index >= nFieldCount )
+        eOpcode = OGRQ_GENERIC;
+    else if( op->operation == SWQ_ISNULL )
+        eOpcode = OGRQ_ISNULL;
+    else if( op->field_type == SWQ_INTEGER )
+    {
+        switch( op->operation )
+        {
+          case SWQ_EQ: eOpcode = OGRQ_INT_EQ; break;
+          case SWQ_NE: eOpcode = OGRQ_INT_NE; break;
+          case SWQ_LT: eOpcode = OGRQ_INT_LT; break;
+          case SWQ_GT: eOpcode = OGRQ_INT_GT; break;
+          case SWQ_LE: eOpcode = OGRQ_INT_LE; break;
+          case SWQ_GE: eOpcode = OGRQ_INT_GE; break;
+          case SWQ_IN: eOpcode = OGRQ_INT_IN; break;
+          default: break;
+        }
+    }
+    else if( op->field_type == SWQ_FLOAT )
+    {
+        switch( op->operation )
+        {
+          case SWQ_EQ: eOpcode = OGRQ_REAL_EQ; break;
+          case SWQ_NE: eOpcode = OGRQ_REAL_NE; break;
+          case SWQ_LT: eOpcode = OGRQ_REAL_LT; break;
+          case SWQ_GT: eOpcode = OGRQ_REAL_GT; break;
+          case SWQ_LE: eOpcode = OGRQ_REAL_LE; break;
+          case SWQ_GE: eOpcode = OGRQ_REAL_GE; break;
+          case SWQ_IN: eOpcode = OGRQ_REAL_IN; break;
+          default: break;
+        }
+    }
+    else if( op->field_type == SWQ_STRING )
+    {
+        switch( op->operation )
+        {
+          case SWQ_EQ: eOpcode = OGRQ_STR_EQ; break;
+          case SWQ_NE: eOpcode = OGRQ_STR_NE; break;
+          case SWQ_LT: eOpcode = OGRQ_STR_LT; break;
+          case SWQ_GT: eOpcode = OGRQ_STR_GT; break;
+          case SWQ_LE: eOpcode = OGRQ_STR_LE; break;
+          case SWQ_GE: eOpcode = OGRQ_STR_GE; break;
+          case SWQ_LIKE: eOpcode = OGRQ_STR_LIKE; break;
+          case SWQ_IN: eOpcode = OGRQ_STR_IN; break;
+          default: break;
+        }
+    }
+
+    iInstr = OGRQueryProgramAdd( psProgram, eOpcode );
+    psInstr = psProgram->pasInstrs + iInstr;
+    psInstr->iField = op->field_index;
+    psInstr->nValue = op->int_value;
+    psInstr->dfValue = op->float_value;
+    psInstr->pszValue = op->string_value;
+    psInstr->psOp = op;
+
+/* -------------------------------------------------------------------- */
+/*      LIKE patterns without '_' and with at most a trailing '%'       */
+/*      are plain (case insensitive) equality or prefix tests.          */
+/* -------------------------------------------------------------------- */
+    if( eOpcode == OGRQ_STR_LIKE && op->string_value != NULL )
+    {
+        int nLen = strcspn( op->string_value, "%_" );
+
+        if( op->string_value[nLen] == '\0' )
+            psInstr->eOpcode = OGRQ_STR_LIKE_EXACT;
+        else if( strcmp(op->string_value + nLen, "%") == 0 )
+        {
+            psInstr->eOpcode = OGRQ_STR_LIKE_PREFIX;
+            psInstr->nValue = nLen;
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Turn IN lists into sorted arrays.                               */
+/* -------------------------------------------------------------------- */
+    if( eOpcode == OGRQ_INT_IN || eOpcode == OGRQ_REAL_IN
+        || eOpcode == OGRQ_STR_IN )
+    {
+        const char *pszSrc;
+        int         nValues = 0;
+
+        for( pszSrc = op->string_value; *pszSrc != '\0'; 
+             pszSrc += strlen(pszSrc) + 1 )
+            nValues++;
+
+        if( eOpcode == OGRQ_INT_IN )
+            psInstr->panValues = (int *) CPLMalloc(sizeof(int) * (nValues+1));
+        else if( eOpcode == OGRQ_REAL_IN )
+            psInstr->padfValues = (double *) 
+                CPLMalloc(sizeof(double) * (nValues+1));
+        else
+            psInstr->papszValues = (const char **) 
+                CPLMalloc(sizeof(char *) * (nValues+1));
+
+        for( pszSrc = op->string_value; *pszSrc != '\0'; 
+             pszSrc += strlen(pszSrc) + 1 )
+        {
+            if( eOpcode == OGRQ_INT_IN )
+                psInstr->panValues[psInstr->nValues++] = atoi(pszSrc);
+            else if( eOpcode == OGRQ_STR_IN )
+                psInstr->papszValues[psInstr->nValues++] = pszSrc;
+            else
+            {
+                double dfValue = atof(pszSrc);
+
+                // NaN never compares equal, and would break the sort.
+                if( dfValue == dfValue )
+                    psInstr->padfValues[psInstr->nValues++] = dfValue;
+            }
+        }
+
+        if( eOpcode == OGRQ_INT_IN )
+            qsort( psInstr->panValues, psInstr->nValues, sizeof(int),
+                   OGRQueryIntCompare );
+        else if( eOpcode == OGRQ_REAL_IN )
+            qsort( psInstr->padfValues, psInstr->nValues, sizeof(double),
+                   OGRQueryRealCompare );
+        else
+            qsort( psInstr->papszValues, psInstr->nValues, sizeof(char *),
+                   OGRQueryStrCompare );
+    }
+}
+
+/************************************************************************/
+/*                        OGRQueryProgramEmit()                         */
+/************************************************************************/
+
+static void OGRQueryProgramEmit( OGRQueryProgram *psProgram,
+                                 swq_expr *op, int nFieldCount )
+
+{
+    if( op->operation == SWQ_AND || op->operation == SWQ_OR )
+    {
+        int iJump;
+
+        OGRQueryProgramEmit( psProgram, (swq_expr *) op->first_sub_expr, 
+                             nFieldCount );
+        iJump = OGRQueryProgramAdd( psProgram, 
+                                    op->operation == SWQ_AND ? 
+                                    OGRQ_JUMP_IF_FALSE : OGRQ_JUMP_IF_TRUE );
+        OGRQueryProgramEmit( psProgram, (swq_expr *) op->second_sub_expr, 
+                             nFieldCount );
+        psProgram->pasInstrs[iJump].nJump = psProgram->nInstrs;
+    }
+    else if( op->operation == SWQ_NOT )
+    {
+        OGRQueryProgramEmit( psProgram, (swq_expr *) op->second_sub_expr, 
+                             nFieldCount );
+        OGRQueryProgramAdd( psProgram, OGRQ_NOT );
+    }
+    else
+        OGRQueryProgramEmitTest( psProgram, op, nFieldCount );
+}
+
+/************************************************************************/
+/*                        OGRQueryProgramFree()                         */
+/************************************************************************/
+
+static void OGRQueryProgramFree( OGRQueryProgram *psProgram )
+
+{
+    int i;
+
+    if( psProgram == NULL )
+        return;
+
+    for( i = 0; i < psProgram->nInstrs; i++ )
+    {
+        CPLFree( psProgram->pasInstrs[i].panValues );
+        CPLFree( psProgram->pasInstrs[i].padfValues );
+        CPLFree( psProgram->pasInstrs[i].papszValues );
+    }
+
+    CPLFree( psProgram->pasInstrs );
+    CPLFree( psProgram );
+}
+
+/************************************************************************/
+/*                        OGRQueryProgramBuild()                        */
+/************************************************************************/
+
+static OGRQueryProgram *OGRQueryProgramBuild( swq_expr *psExpr,
+                                              OGRFeatureDefn *poDefn )
+
+{
+    OGRQueryProgram *psProgram;
+    int              i;
+
+    if( psExpr == NULL )
+        return NULL;
+
+    psProgram = (OGRQueryProgram *) CPLCalloc( 1, sizeof(OGRQueryProgram) );
+
+    OGRQueryProgramEmit( psProgram, psExpr, poDefn->GetFieldCount() );
+
+/* -------------------------------------------------------------------- */
+/*      A jump landing on a jump of the same kind is taken again right  */
+/*      away (e.g. in A AND B AND C), so go directly to its target.     */
+/* -------------------------------------------------------------------- */
+    for( i = psProgram->nInstrs - 1; i >= 0; i-- )
+    {
+        OGRQueryInstr *psInstr = psProgram->pasInstrs + i;
+
+        if( psInstr->eOpcode != OGRQ_JUMP_IF_FALSE
+            && psInstr->eOpcode != OGRQ_JUMP_IF_TRUE )
+            continue;
+
+        if( psInstr->nJump < psProgram->nInstrs
+            && psProgram->pasInstrs[psInstr->nJump].eOpcode 
+               == psInstr->eOpcode )
+            psInstr->nJump = psProgram->pasInstrs[psInstr->nJump].nJump;
+    }
+
+    return psProgram;
+}
+
+/************************************************************************/
+/*                         OGRQueryProgramRun()                         */
+/************************************************************************/
+
+static int OGRQueryProgramRun( OGRQueryProgram *psProgram, 
+                               OGRFeature *poFeature )
+
+{
+    OGRQueryInstr *pasInstrs = psProgram->pasInstrs;
+    int            nInstrs = psProgram->nInstrs;
+    int            iInstr = 0;
+    int            bResult = FALSE;
+
+    while( iInstr < nInstrs )
+    {
+        OGRQueryInstr *psInstr = pasInstrs + iInstr++;
+        OGRField      *psField;
+        int            bSet;
+
+        switch( psInstr->eOpcode )
+        {
+          case OGRQ_JUMP_IF_FALSE:
+            if( !bResult )
+                iInstr = psInstr->nJump;
+            continue;
+
+          case OGRQ_JUMP_IF_TRUE:
+            if( bResult )
+                iInstr = psInstr->nJump;
+            continue;
+
+          case OGRQ_NOT:
+            bResult = !bResult;
+            continue;
+
+          case OGRQ_GENERIC:
+            bResult = OGRFeatureQueryEvaluator( psInstr->psOp, poFeature );
+            continue;
+
+          default:
+            break;
+        }
+
+        psField = poFeature->GetRawFieldRef( psInstr->iField );
+        bSet = psField->Set.nMarker1 != OGRUnsetMarker
+            || psField->Set.nMarker2 != OGRUnsetMarker;
+
+        switch( psInstr->eOpcode )
+        {
+          case OGRQ_ISNULL:
+            bResult = !bSet;
+            break;
+
+          case OGRQ_INT_EQ:
+            bResult = psField->Integer == psInstr->nValue;
+            break;
+          case OGRQ_INT_NE:
+            bResult = psField->Integer != psInstr->nValue;
+            break;
+          case OGRQ_INT_LT:
+            bResult = psField->Integer < psInstr->nValue;
+            break;
+          case OGRQ_INT_GT:
+            bResult = psField->Integer > psInstr->nValue;
+            break;
+          case OGRQ_INT_LE:
+            bResult = psField->Integer <= psInstr->nValue;
+            break;
+          case OGRQ_INT_GE:
+            bResult = psField->Integer >= psInstr->nValue;
+            break;
+          case OGRQ_INT_IN:
+            bResult = bsearch( &(psField->Integer), psInstr->panValues, 
+                               psInstr->nValues, sizeof(int),
+                               OGRQueryIntCompare ) != NULL;
+            break;
+
+          case OGRQ_REAL_EQ:
+            bResult = psField->Real == psInstr->dfValue;
+            break;
+          case OGRQ_REAL_NE:
+            bResult = psField->Real != psInstr->dfValue;
+            break;
+          case OGRQ_REAL_LT:
+            bResult = psField->Real < psInstr->dfValue;
+            break;
+          case OGRQ_REAL_GT:
+            bResult = psField->Real > psInstr->dfValue;
+            break;
+          case OGRQ_REAL_LE:
+            bResult = psField->Real <= psInstr->dfValue;
+            break;
+          case OGRQ_REAL_GE:
+            bResult = psField->Real >= psInstr->dfValue;
+            break;
+          case OGRQ_REAL_IN:
+            bResult = psField->Real == psField->Real
+                && bsearch( &(psField->Real), psInstr->padfValues, 
+                            psInstr->nValues, sizeof(double),
+                            OGRQueryRealCompare ) != NULL;
+            break;
+
+          case OGRQ_STR_EQ:
+            if( !bSet )
+                bResult = psInstr->pszValue[0] == '\0';
+            else
+                bResult = EQUAL(psField->String, psInstr->pszValue);
+            break;
+          case OGRQ_STR_NE:
+            if( !bSet )
+                bResult = psInstr->pszValue[0] != '\0';
+            else
+                bResult = !EQUAL(psField->String, psInstr->pszValue);
+            break;
+          case OGRQ_STR_LT:
+            if( !bSet )
+                bResult = psInstr->pszValue[0] != '\0';
+            else
+                bResult = strcmp(psField->String, psInstr->pszValue) < 0;
+            break;
+          case OGRQ_STR_GT:
+            if( !bSet )
+                bResult = psInstr->pszValue[0] != '\0';
+            else
+                bResult = strcmp(psField->String, psInstr->pszValue) > 0;
+            break;
+          case OGRQ_STR_LE:
+            if( !bSet )
+                bResult = psInstr->pszValue[0] != '\0';
+            else
+                bResult = strcmp(psField->String, psInstr->pszValue) <= 0;
+            break;
+          case OGRQ_STR_GE:
+            if( !bSet )
+                bResult = psInstr->pszValue[0] != '\0';
+            else
+                bResult = strcmp(psField->String, psInstr->pszValue) >= 0;
+            break;
+
+          case OGRQ_STR_LIKE:
+            bResult = bSet 
+                && swq_test_like(psField->String, psInstr->pszValue);
+            break;
+          case OGRQ_STR_LIKE_EXACT:
+            bResult = bSet && EQUAL(psField->String, psInstr->pszValue);
+            break;
+          case OGRQ_STR_LIKE_PREFIX:
+            bResult = bSet && EQUALN(psField->String, psInstr->pszValue,
+                                     psInstr->nValue);
+            break;
+
+          case OGRQ_STR_IN:
+            if( !bSet )
+                bResult = FALSE;
+            else if( psInstr->nValues < OGRQ_STR_IN_BSEARCH_MIN )
+            {
+                int i;
+
+                bResult = FALSE;
+                for( i = 0; !bResult && i < psInstr->nValues; i++ )
+                    bResult = EQUAL(psField->String, 
+                                    psInstr->papszValues[i]);
+            }
+            else
+                bResult = bsearch( &(psField->String), psInstr->papszValues, 
+                                   psInstr->nValues, sizeof(char *),
+                                   OGRQueryStrCompare ) != NULL;
+            break;
+
+          default:
+            CPLAssert( FALSE );
+            bResult = FALSE;
+            break;
+        }
+    }
+
+    return bResult;
+}
+
 /************************************************************************/
 /*                              Evaluate()                              */
 /************************************************************************/
@@ -407,75 +968,493 @@ int OGRFeatureQuery::Evaluate( OGRFeature *poFeature )
     if( pSWQExpr == NULL )
         return FALSE;
 
+/* -------------------------------------------------------------------- */
+/*      Run the compiled program if the feature is of the type it was   */
+/*      compiled for, otherwise walk the expression tree.               */
+/* -------------------------------------------------------------------- */
+    if( pProgram != NULL && poFeature->GetDefnRef() == poTargetDefn )
+        return OGRQueryProgramRun( (OGRQueryProgram *) pProgram, poFeature );
+
     return swq_expr_evaluate( (swq_expr *) pSWQExpr, 
                               (swq_op_evaluator) OGRFeatureQueryEvaluator, 
                               (void *) poFeature );
 }
 
 /************************************************************************/
-/*                       EvaluateAgainstIndices()                       */
+/*                         OGRFIDListCompare()                          */
+/************************************************************************/
+
+static int OGRFIDListCompare( const void *pA, const void *pB )
+
+{
+    long nA = *((const long *) pA);
+    long nB = *((const long *) pB);
+
+    return (nA < nB) ? -1 : (nA > nB) ? 1 : 0;
+}
+
+/************************************************************************/
+/*                          OGRFIDListSort()                            */
 /*                                                                      */
-/*      Attempt to return a list of FIDs matching the given             */
-/*      attribute query conditions utilizing attribute indices.         */
-/*      Returns NULL if the result cannot be computed from the          */
-/*      available indices, or an "OGRNullFID" terminated list of        */
-/*      FIDs if it can.                                                 */
+/*      Sort an "OGRNullFID" terminated FID list in place and remove    */
+/*      the duplicates.                                                 */
+/************************************************************************/
+
+static long *OGRFIDListSort( long *panFIDList )
+
+{
+    int nCount = 0, i, nOut = 0;
+
+    if( panFIDList == NULL )
+        return NULL;
+
+    while( panFIDList[nCount] != OGRNullFID )
+        nCount++;
+
+    qsort( panFIDList, nCount, sizeof(long), OGRFIDListCompare );
+
+    for( i = 0; i < nCount; i++ )
+    {
+        if( nOut == 0 || panFIDList[nOut-1] != panFIDList[i] )
+            panFIDList[nOut++] = panFIDList[i];
+    }
+    panFIDList[nOut] = OGRNullFID;
+
+    return panFIDList;
+}
+
+/************************************************************************/
+/*                          OGRFIDListMerge()                           */
 /*                                                                      */
-/*      For now we only support equality tests on a single indexed      */
-/*      attribute field.  Eventually we should make this support        */
-/*      multi-part queries with ranges.                                 */
+/*      Intersect (bUnion=FALSE) or union two sorted FID lists.  The    */
+/*      input lists are freed.                                          */
 /************************************************************************/
 
-long *OGRFeatureQuery::EvaluateAgainstIndices( OGRLayer *poLayer, 
-                                               OGRErr *peErr )
+static long *OGRFIDListMerge( long *panA, long *panB, int bUnion )
 
 {
-    swq_expr *psExpr = (swq_expr *) pSWQExpr;
-    OGRAttrIndex *poIndex;
+    int nCountA = 0, nCountB = 0, iA = 0, iB = 0, nOut = 0;
+    long *panOut;
 
-    if( peErr != NULL )
-        *peErr = OGRERR_NONE;
+    while( panA[nCountA] != OGRNullFID )
+        nCountA++;
+    while( panB[nCountB] != OGRNullFID )
+        nCountB++;
+
+    panOut = (long *) CPLMalloc(sizeof(long) * (nCountA + nCountB + 1));
+
+    while( iA < nCountA && iB < nCountB )
+    {
+        if( panA[iA] < panB[iB] )
+        {
+            if( bUnion )
+                panOut[nOut++] = panA[iA];
+            iA++;
+        }
+        else if( panA[iA] > panB[iB] )
+        {
+            if( bUnion )
+                panOut[nOut++] = panB[iB];
+            iB++;
+        }
+        else
+        {
+            panOut[nOut++] = panA[iA];
+            iA++;
+            iB++;
+        }
+    }
+
+    if( bUnion )
+    {
+        while( iA < nCountA )
+            panOut[nOut++] = panA[iA++];
+        while( iB < nCountB )
+            panOut[nOut++] = panB[iB++];
+    }
+
+    panOut[nOut] = OGRNullFID;
+
+    CPLFree( panA );
+    CPLFree( panB );
+
+    return panOut;
+}
+
+/************************************************************************/
+/*                         OGRSetIndexValue()                           */
+/*                                                                      */
+/*      Convert a query value to an OGRField of the indexed field       */
+/*      type.  Returns FALSE if the field type is not supported.        */
+/************************************************************************/
+
+static int OGRSetIndexValue( OGRFieldType eType, const char *pszValue,
+                             OGRField *psValue )
+
+{
+    switch( eType )
+    {
+      case OFTInteger:
+        psValue->Integer = atoi(pszValue);
+        return TRUE;
+
+      case OFTReal:
+        psValue->Real = atof(pszValue);
+        return TRUE;
+
+      case OFTString:
+        psValue->String = (char *) pszValue;
+        return TRUE;
+
+      default:
+        return FALSE;
+    }
+}
+
+/************************************************************************/
+/*                         OGRSetIndexBound()                           */
+/*                                                                      */
+/*      Tighten the [psMin,psMax] range of a numeric field with a       */
+/*      comparison.  Returns FALSE if psExpr is not a comparison that   */
+/*      can be expressed as a range.  *pbExact is cleared if the        */
+/*      range is wider than the comparison.                             */
+/************************************************************************/
+
+static int OGRSetIndexBound( swq_expr *psExpr, OGRFieldType eType,
+                             OGRField *psMin, int *pbHasMin,
+                             OGRField *psMax, int *pbHasMax, int *pbExact )
+
+{
+    OGRField sValue;
+    int      bIsMin;
+
+    switch( psExpr->operation )
+    {
+      case SWQ_GT:
+      case SWQ_GE:
+        bIsMin = TRUE;
+        break;
+
+      case SWQ_LT:
+      case SWQ_LE:
+        bIsMin = FALSE;
+        break;
+
+      default:
+        return FALSE;
+    }
+
+    if( eType == OFTInteger )
+    {
+        sValue.Integer = psExpr->int_value;
+        if( psExpr->operation == SWQ_LT && sValue.Integer > INT_MIN )
+            sValue.Integer--;
+        else if( psExpr->operation == SWQ_GT && sValue.Integer < INT_MAX )
+            sValue.Integer++;
+
+        if( bIsMin && (!*pbHasMin || sValue.Integer > psMin->Integer) )
+            *psMin = sValue;
+        else if( !bIsMin && (!*pbHasMax || sValue.Integer < psMax->Integer) )
+            *psMax = sValue;
+    }
+    else if( eType == OFTReal )
+    {
+        /* Bounds are inclusive, strict comparisons are rechecked later */
+        sValue.Real = psExpr->float_value;
+        if( psExpr->operation == SWQ_LT || psExpr->operation == SWQ_GT )
+            *pbExact = FALSE;
+
+        if( bIsMin && (!*pbHasMin || sValue.Real > psMin->Real) )
+            *psMin = sValue;
+        else if( !bIsMin && (!*pbHasMax || sValue.Real < psMax->Real) )
+            *psMax = sValue;
+    }
+    else
+        return FALSE;
+
+    if( bIsMin )
+        *pbHasMin = TRUE;
+    else
+        *pbHasMax = TRUE;
+
+    return TRUE;
+}
 
+/************************************************************************/
+/*                        OGREvaluateIndexExpr()                        */
+/*                                                                      */
+/*      Recursive helper for EvaluateAgainstIndices(): returns a        */
+/*      sorted "OGRNullFID" terminated list of candidate FIDs for       */
+/*      psExpr, or NULL if it cannot be computed from the indices.      */
+/*                                                                      */
+/*      The list may be a superset of the matching features (e.g. an    */
+/*      AND with only one indexed side, or index keys that are          */
+/*      uppercased or truncated).  In that case *pbExact is set to      */
+/*      FALSE and the query has to be evaluated against each returned   */
+/*      feature.                                                        */
+/************************************************************************/
+
+static long *OGREvaluateIndexExpr( swq_expr *psExpr, OGRLayer *poLayer,
+                                   int *pbExact )
+
+{
 /* -------------------------------------------------------------------- */
-/*      Does the expression meet our requirements?  Do we have an       */
-/*      index on the targetted field?                                   */
+/*      Logical operators: intersect or union the FID lists.  For an    */
+/*      AND, one indexed side is enough to restrict the candidates.     */
 /* -------------------------------------------------------------------- */
-    if( psExpr == NULL || psExpr->operation != SWQ_EQ 
-        || poLayer->GetIndex() == NULL )
-        return NULL;
+    if( psExpr->operation == SWQ_AND || psExpr->operation == SWQ_OR )
+    {
+        long *panA, *panB;
+        swq_expr *psA = (swq_expr *) psExpr->first_sub_expr;
+        swq_expr *psB = (swq_expr *) psExpr->second_sub_expr;
 
-    poIndex = poLayer->GetIndex()->GetFieldIndex( psExpr->field_index );
-    if( poIndex == NULL )
-        return NULL;
+/* -------------------------------------------------------------------- */
+/*      Two bounds on the same indexed field ("x >= a AND x < b")      */
+/*      make a single range search.                                     */
+/* -------------------------------------------------------------------- */
+        if( psExpr->operation == SWQ_AND 
+            && psA->field_index == psB->field_index 
+            && psA->table_index == 0 && psB->table_index == 0
+            && psA->field_index >= 0 
+            && psA->field_index < poLayer->GetLayerDefn()->GetFieldCount()
+            && poLayer->GetIndex()->GetFieldIndex(psA->field_index) != NULL )
+        {
+            OGRFieldType eType = poLayer->GetLayerDefn()->
+                                   GetFieldDefn(psA->field_index)->GetType();
+            OGRField sMin, sMax;
+            int      bHasMin = FALSE, bHasMax = FALSE;
+
+            int      bExact = TRUE;
+
+            if( OGRSetIndexBound( psA, eType, &sMin, &bHasMin, 
+                                  &sMax, &bHasMax, &bExact )
+                && OGRSetIndexBound( psB, eType, &sMin, &bHasMin, 
+                                     &sMax, &bHasMax, &bExact ) )
+            {
+                OGRAttrIndex *poIndex = 
+                    poLayer->GetIndex()->GetFieldIndex( psA->field_index );
+
+                if( !bExact || !poIndex->IsExactRange( 
+                                            bHasMin ? &sMin : NULL,
+                                            bHasMax ? &sMax : NULL ) )
+                    *pbExact = FALSE;
+
+                return OGRFIDListSort( poIndex->GetRangeMatches( 
+                                            bHasMin ? &sMin : NULL,
+                                            bHasMax ? &sMax : NULL ) );
+            }
+        }
+
+        panA = OGREvaluateIndexExpr( (swq_expr *) psExpr->first_sub_expr,
+                                     poLayer, pbExact );
+        if( panA == NULL && psExpr->operation == SWQ_OR )
+            return NULL;
+
+        panB = OGREvaluateIndexExpr( (swq_expr *) psExpr->second_sub_expr,
+                                     poLayer, pbExact );
+        if( panA == NULL || panB == NULL )
+        {
+            /* The other side of the AND still has to be evaluated */
+            *pbExact = FALSE;
+
+            if( psExpr->operation == SWQ_AND )
+                return panA ? panA : panB;
+
+            CPLFree( panA );
+            CPLFree( panB );
+            return NULL;
+        }
+
+        return OGRFIDListMerge( panA, panB, psExpr->operation == SWQ_OR );
+    }
 
 /* -------------------------------------------------------------------- */
-/*      OK, we have an index, now we need to query it.                  */
+/*      Field comparison: do we have an index on the targetted field?   */
 /* -------------------------------------------------------------------- */
-    OGRField sValue;
+    OGRAttrIndex *poIndex;
     OGRFieldDefn *poFieldDefn;
+    OGRFieldType eType;
+    OGRField sValue;
+
+    if( psExpr->table_index != 0 || psExpr->field_index < 0
+        || psExpr->field_index >= poLayer->GetLayerDefn()->GetFieldCount() )
+        return NULL;
+
+    poIndex = poLayer->GetIndex()->GetFieldIndex( psExpr->field_index );
+    if( poIndex == NULL )
+        return NULL;
 
     poFieldDefn = poLayer->GetLayerDefn()->GetFieldDefn(psExpr->field_index);
+    eType = poFieldDefn->GetType();
 
-    switch( poFieldDefn->GetType() )
+    switch( psExpr->operation )
     {
-      case OFTInteger:
-        sValue.Integer = psExpr->int_value;
-        break;
+      case SWQ_EQ:
+        switch( eType )
+        {
+          case OFTInteger:
+            sValue.Integer = psExpr->int_value;
+            break;
 
-      case OFTReal:
-        sValue.Real = psExpr->float_value;
-        break;
+          case OFTReal:
+            sValue.Real = psExpr->float_value;
+            break;
 
-      case OFTString:
-        sValue.String = psExpr->string_value;
-        break;
+          case OFTString:
+            sValue.String = psExpr->string_value;
+            break;
+
+          default:
+            return NULL;
+        }
+        if( !poIndex->IsExactRange( &sValue, &sValue ) )
+            *pbExact = FALSE;
+        return OGRFIDListSort( poIndex->GetAllMatches( &sValue ) );
+
+      case SWQ_IN:
+      {
+          const char *pszSrc = psExpr->string_value;
+          long *panFIDList = NULL;
+
+          while( *pszSrc != '\0' )
+          {
+              long *panMatches;
+
+              if( !OGRSetIndexValue( eType, pszSrc, &sValue ) )
+              {
+                  CPLFree( panFIDList );
+                  return NULL;
+              }
+
+              if( !poIndex->IsExactRange( &sValue, &sValue ) )
+                  *pbExact = FALSE;
+
+              panMatches = OGRFIDListSort( poIndex->GetAllMatches(&sValue) );
+              if( panMatches == NULL )
+              {
+                  CPLFree( panFIDList );
+                  return NULL;
+              }
+
+              if( panFIDList == NULL )
+                  panFIDList = panMatches;
+              else
+                  panFIDList = OGRFIDListMerge( panFIDList, panMatches, TRUE );
+
+              pszSrc += strlen(pszSrc) + 1;
+          }
+
+          if( panFIDList == NULL )
+          {
+              panFIDList = (long *) CPLMalloc(sizeof(long));
+              panFIDList[0] = OGRNullFID;
+          }
+
+          return panFIDList;
+      }
+
+      case SWQ_LT:
+      case SWQ_LE:
+      case SWQ_GT:
+      case SWQ_GE:
+      {
+          /* Strings are compared with strcmp() by the query but index    */
+          /* keys are uppercased, so ranges are used on numbers only.     */
+          OGRField sMin, sMax;
+          int      bHasMin = FALSE, bHasMax = FALSE, bExact = TRUE;
+
+          if( !OGRSetIndexBound( psExpr, eType, &sMin, &bHasMin, 
+                                 &sMax, &bHasMax, &bExact ) )
+              return NULL;
+
+          if( !bExact || !poIndex->IsExactRange( bHasMin ? &sMin : NULL,
+                                                 bHasMax ? &sMax : NULL ) )
+              *pbExact = FALSE;
+
+          return OGRFIDListSort( poIndex->GetRangeMatches( 
+                                            bHasMin ? &sMin : NULL,
+                                            bHasMax ? &sMax : NULL ) );
+      }
+
+      case SWQ_LIKE:
+      {
+          /* Only 'abc%' style patterns: use the part before the first    */
+          /* wildcard as a key prefix.                                    */
+          int nPrefixLen = 0;
+          char *pszPrefix;
+          long *panFIDList;
+
+          if( eType != OFTString )
+              return NULL;
+
+          while( psExpr->string_value[nPrefixLen] != '\0'
+                 && psExpr->string_value[nPrefixLen] != '%'
+                 && psExpr->string_value[nPrefixLen] != '_' )
+              nPrefixLen++;
+
+          if( nPrefixLen == 0 )
+              return NULL;
+
+          pszPrefix = CPLStrdup( psExpr->string_value );
+          pszPrefix[nPrefixLen] = '\0';
+
+          /* Exact only for a single trailing '%' */
+          if( !EQUAL(psExpr->string_value + nPrefixLen, "%")
+              || !poIndex->IsExactPrefix( pszPrefix ) )
+              *pbExact = FALSE;
+          panFIDList = OGRFIDListSort( poIndex->GetPrefixMatches(pszPrefix) );
+          CPLFree( pszPrefix );
+
+          return panFIDList;
+      }
 
       default:
-        CPLAssert( FALSE );
         return NULL;
     }
+}
+
+/************************************************************************/
+/*                       EvaluateAgainstIndices()                       */
+/*                                                                      */
+/*      Attempt to return a list of FIDs matching the given             */
+/*      attribute query conditions utilizing attribute indices.         */
+/*      Returns NULL if the result cannot be computed from the          */
+/*      available indices, or an "OGRNullFID" terminated list of        */
+/*      FIDs if it can.                                                 */
+/*                                                                      */
+/*      Equality, IN, numeric range and 'prefix%' LIKE tests on         */
+/*      indexed fields are supported, combined with AND/OR.  The        */
+/*      returned list is sorted and may contain candidates that do     */
+/*      not match the query, so it should still be evaluated against    */
+/*      the returned features, unless *pbExact is set to TRUE.          */
+/************************************************************************/
+
+long *OGRFeatureQuery::EvaluateAgainstIndices( OGRLayer *poLayer, 
+                                               OGRErr *peErr,
+                                               int *pbExact )
+
+{
+    swq_expr *psExpr = (swq_expr *) pSWQExpr;
+    int      bExact = TRUE;
+    long     *panFIDList;
+
+    if( peErr != NULL )
+        *peErr = OGRERR_NONE;
+    if( pbExact != NULL )
+        *pbExact = FALSE;
+
+/* -------------------------------------------------------------------- */
+/*      Do we have any index on this layer?                             */
+/* -------------------------------------------------------------------- */
+    if( psExpr == NULL || poLayer->GetIndex() == NULL )
+        return NULL;
+
+    panFIDList = OGREvaluateIndexExpr( psExpr, poLayer, &bExact );
+
+    if( pbExact != NULL && panFIDList != NULL )
+        *pbExact = bExact;
 
-    return poIndex->GetAllMatches( &sValue );
+    return panFIDList;
 }
 
 /************************************************************************/
@@ -508,7 +1487,8 @@ char **OGRFeatureQuery::FieldCollector( void *pBareOp,
 
     if( op->field_index >= poTargetDefn->GetFieldCount()
         && op->field_index < poTargetDefn->GetFieldCount() + SPECIAL_FIELD_COUNT) 
-        pszFieldName = SpecialFieldNames[op->field_index];
+        pszFieldName = SpecialFieldNames[op->field_index 
+                                         - poTargetDefn->GetFieldCount()];
     else if( op->field_index >= 0 
              && op->field_index < poTargetDefn->GetFieldCount() )
         pszFieldName = 
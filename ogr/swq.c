@@ -1067,7 +1067,9 @@ SELECT <field-list> FROM <table_def>
      [LEFT JOIN <table_def> 
       ON [<table_ref>.]<key_field> = [<table_ref>.].<key_field>]*
      [WHERE <where-expr>] 
+     [GROUP BY <field_ref> [ { , <field_ref> }... ]]
      [ORDER BY <sort specification list>]
+     [LIMIT <number>]
 
 <field-list> ::= <column-spec> [ { , <column-spec> }... ]
 
@@ -1156,6 +1158,7 @@ const char *swq_select_preparse( const char *select_statement,
 /* -------------------------------------------------------------------- */
     select_info = (swq_select *) SWQ_MALLOC(sizeof(swq_select));
     memset( select_info, 0, sizeof(swq_select) );
+    select_info->limit = -1;
 
     select_info->raw_select = swq_strdup( select_statement );
 
@@ -1468,7 +1471,9 @@ const char *swq_select_preparse( const char *select_statement,
         token = swq_token( input, &input, &is_literal );
         while( token != NULL )
         {
-            if( strcasecmp(token,"ORDER") == 0 && !is_literal )
+            if( (strcasecmp(token,"ORDER") == 0 
+                 || strcasecmp(token,"GROUP") == 0
+                 || strcasecmp(token,"LIMIT") == 0) && !is_literal )
             {
                 break;
             }
@@ -1492,6 +1497,63 @@ const char *swq_select_preparse( const char *select_statement,
         }
     }
 
+/* -------------------------------------------------------------------- */
+/*      Parse GROUP BY clause.                                          */
+/* -------------------------------------------------------------------- */
+    if( token != NULL && strcasecmp(token,"GROUP") == 0 && !is_literal )
+    {
+        SWQ_FREE( token );
+        
+        token = swq_token( input, &input, &is_literal );
+
+        if( token == NULL || strcasecmp(token,"BY") != 0 )
+        {
+            if( token != NULL )
+                SWQ_FREE( token );
+
+            SNPRINTF_ERR1( "GROUP BY clause missing BY keyword." );
+            swq_select_free( select_info );
+            return swq_get_errbuf();
+        }
+
+        SWQ_FREE( token );
+        token = swq_token( input, &input, &is_literal );
+        while( token != NULL 
+               && (select_info->group_specs == 0 
+                   || strcasecmp(token,",") == 0) )
+        {
+            swq_group_def  *def;
+
+            if( select_info->group_specs != 0 )
+            {
+                SWQ_FREE( token );
+                token = swq_token( input, &input, &is_literal );
+                if( token == NULL )
+                    break;
+            }
+
+            select_info->group_defs = (swq_group_def *) 
+                swq_realloc( select_info->group_defs, 
+                             sizeof(swq_group_def)*select_info->group_specs,
+                             sizeof(swq_group_def)*(select_info->group_specs+1) );
+
+            def = select_info->group_defs + select_info->group_specs;
+            memset( def, 0, sizeof(swq_group_def) );
+            def->field_name = token;
+
+            select_info->group_specs++;
+
+            token = swq_token( input, &input, &is_literal );
+        }
+
+        if( select_info->group_specs == 0 )
+        {
+            SNPRINTF_ERR1( "GROUP BY clause missing field list." );
+            swq_select_free( select_info );
+            return swq_get_errbuf();
+        }
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Parse ORDER BY clause.                                          */
 /* -------------------------------------------------------------------- */
@@ -1559,6 +1621,32 @@ const char *swq_select_preparse( const char *select_statement,
         }
     }
 
+/* -------------------------------------------------------------------- */
+/*      Parse LIMIT clause.                                             */
+/* -------------------------------------------------------------------- */
+    if( token != NULL && strcasecmp(token,"LIMIT") == 0 && !is_literal )
+    {
+        SWQ_FREE( token );
+        
+        token = swq_token( input, &input, &is_literal );
+
+        if( token == NULL || is_literal
+            || strspn(token,"0123456789") != strlen(token) )
+        {
+            if( token != NULL )
+                SWQ_FREE( token );
+
+            SNPRINTF_ERR1( "LIMIT clause missing or invalid row count." );
+            swq_select_free( select_info );
+            return swq_get_errbuf();
+        }
+
+        select_info->limit = atoi(token);
+
+        SWQ_FREE( token );
+        token = swq_token( input, &input, &is_literal );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      If we have anything left it indicates an error!                 */
 /* -------------------------------------------------------------------- */
@@ -1770,6 +1858,8 @@ static int swq_parse_table_def( swq_select *select_info,
         && strcasecmp(*token,"ON") != 0
         && strcasecmp(*token,"ORDER") != 0
         && strcasecmp(*token,"WHERE") != 0
+        && strcasecmp(*token,"LIMIT") != 0
+        && strcasecmp(*token,"GROUP") != 0
         && strcasecmp(*token,"LEFT") != 0
         && strcasecmp(*token,"JOIN") != 0 )
     {
@@ -2017,6 +2107,82 @@ const char *swq_select_expand_wildcard( swq_select *select_info,
     return NULL;
 }
 
+/************************************************************************/
+/*                     swq_select_parse_group_by()                      */
+/*                                                                      */
+/*      Identify the GROUP BY fields, and verify that every result      */
+/*      column is either an aggregate or one of the grouping fields.    */
+/************************************************************************/
+
+static const char *swq_select_parse_group_by( swq_select *select_info,
+                                              swq_field_list *field_list )
+
+{
+    int  i, j;
+
+    for( i = 0; i < select_info->group_specs; i++ )
+    {
+        swq_group_def *def = select_info->group_defs + i;
+
+        def->field_index = swq_identify_field( def->field_name, field_list,
+                                               &(def->field_type),
+                                               &(def->table_index) );
+        if( def->field_index == -1 )
+        {
+            SNPRINTF_ERR2( "Unrecognised field name %s in GROUP BY.", 
+                           def->field_name );
+            return swq_get_errbuf();
+        }
+
+        if( def->table_index != 0 )
+        {
+            SNPRINTF_ERR2( "GROUP BY field %s must come from the primary table.",
+                           def->field_name );
+            return swq_get_errbuf();
+        }
+    }
+
+    for( i = 0; i < select_info->result_columns; i++ )
+    {
+        swq_col_def *def = select_info->column_defs + i;
+
+        if( def->col_func != SWQCF_NONE )
+        {
+            if( def->col_func == SWQCF_CUSTOM )
+            {
+                SNPRINTF_ERR2( "Field function %s not supported with GROUP BY.",
+                               def->col_func_name );
+                return swq_get_errbuf();
+            }
+            if( def->field_index != -1 && def->table_index != 0 )
+            {
+                SNPRINTF_ERR2( "Aggregated field %s must come from the primary table with GROUP BY.",
+                               def->field_name );
+                return swq_get_errbuf();
+            }
+            continue;
+        }
+
+        for( j = 0; j < select_info->group_specs; j++ )
+        {
+            if( select_info->group_defs[j].field_index == def->field_index
+                && def->table_index == 0 )
+                break;
+        }
+
+        if( j == select_info->group_specs || def->distinct_flag )
+        {
+            SNPRINTF_ERR2( "Field %s must appear in GROUP BY or be used in an aggregate function.",
+                           def->field_name );
+            return swq_get_errbuf();
+        }
+    }
+
+    select_info->query_mode = SWQM_GROUPED_SUMMARY;
+
+    return NULL;
+}
+
 /************************************************************************/
 /*                          swq_select_parse()                          */
 /************************************************************************/
@@ -2121,9 +2287,11 @@ const char *swq_select_parse( swq_select *select_info,
                 this_indicator = SWQM_RECORDSET;
         }
 
+        /* with GROUP BY, plain columns are checked against the groups */
         if( this_indicator != select_info->query_mode
              && this_indicator != -1
-            && select_info->query_mode != -1 )
+            && select_info->query_mode != -1 
+            && select_info->group_specs == 0 )
         {
             return "Field list implies mixture of regular recordset mode, summary mode or distinct field list mode.";
         }
@@ -2132,7 +2300,14 @@ const char *swq_select_parse( swq_select *select_info,
             select_info->query_mode = this_indicator;
     }
 
-    if( select_info->result_columns > 1 
+    if( select_info->group_specs > 0 )
+    {
+        const char *error = swq_select_parse_group_by( select_info, 
+                                                       field_list );
+        if( error != NULL )
+            return error;
+    }
+    else if( select_info->result_columns > 1 
         && select_info->query_mode == SWQM_DISTINCT_LIST )
     {
         return "SELECTing more than one DISTINCT field is a query not supported.";
@@ -2208,6 +2383,26 @@ const char *swq_select_parse( swq_select *select_info,
                      def->field_name );
             return swq_get_errbuf();
         }
+
+        /* grouped results can only be ordered on the grouping fields */
+        if( select_info->query_mode == SWQM_GROUPED_SUMMARY )
+        {
+            int  j;
+
+            for( j = 0; j < select_info->group_specs; j++ )
+            {
+                if( select_info->group_defs[j].field_index == def->field_index
+                    && def->table_index == 0 )
+                    break;
+            }
+
+            if( j == select_info->group_specs )
+            {
+                SNPRINTF_ERR2( "ORDER BY field %s must appear in GROUP BY.", 
+                               def->field_name );
+                return swq_get_errbuf();
+            }
+        }
     }
 
 /* -------------------------------------------------------------------- */
@@ -2227,6 +2422,141 @@ const char *swq_select_parse( swq_select *select_info,
     return NULL;
 }
 
+/************************************************************************/
+/*                        swq_hash_set_create()                         */
+/************************************************************************/
+
+swq_hash_set *swq_hash_set_create()
+
+{
+    swq_hash_set *set;
+
+    set = (swq_hash_set *) SWQ_MALLOC(sizeof(swq_hash_set));
+    memset( set, 0, sizeof(swq_hash_set) );
+
+    return set;
+}
+
+/************************************************************************/
+/*                         swq_hash_set_hash()                          */
+/************************************************************************/
+
+static unsigned int swq_hash_set_hash( const char *value )
+
+{
+    unsigned int hash = 2166136261U;
+
+    while( *value != '\0' )
+    {
+        hash ^= (unsigned char) *(value++);
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+/************************************************************************/
+/*                        swq_hash_set_insert()                         */
+/*                                                                      */
+/*      Add a value to the set if it is not already there.  Returns     */
+/*      the index of the value in set->values[], and sets *is_new if    */
+/*      it was just added.                                              */
+/************************************************************************/
+
+int swq_hash_set_insert( swq_hash_set *set, const char *value, int *is_new )
+
+{
+    unsigned int  hash = swq_hash_set_hash( value );
+    int           slot;
+
+/* -------------------------------------------------------------------- */
+/*      Grow the table, rehashing existing values, once it passes       */
+/*      half full.                                                      */
+/* -------------------------------------------------------------------- */
+    if( (set->count + 1) * 2 > set->hash_size )
+    {
+        int  new_size = set->hash_size == 0 ? 64 : set->hash_size * 2;
+        int  i;
+
+        if( set->hash != NULL )
+            SWQ_FREE( set->hash );
+
+        set->hash_size = new_size;
+        set->hash = (int *) SWQ_MALLOC(sizeof(int) * new_size);
+        memset( set->hash, 0, sizeof(int) * new_size );
+
+        for( i = 0; i < set->count; i++ )
+        {
+            slot = swq_hash_set_hash( set->values[i] ) & (new_size - 1);
+            while( set->hash[slot] != 0 )
+                slot = (slot + 1) & (new_size - 1);
+            set->hash[slot] = i + 1;
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Probe for an existing entry.                                    */
+/* -------------------------------------------------------------------- */
+    slot = hash & (set->hash_size - 1);
+    while( set->hash[slot] != 0 )
+    {
+        if( strcmp(set->values[set->hash[slot]-1], value) == 0 )
+        {
+            if( is_new != NULL )
+                *is_new = 0;
+            return set->hash[slot] - 1;
+        }
+        slot = (slot + 1) & (set->hash_size - 1);
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Append the new value.                                           */
+/* -------------------------------------------------------------------- */
+    if( set->count == set->max_count )
+    {
+        int  new_max = set->max_count == 0 ? 16 : set->max_count * 2;
+
+        set->values = (char **) 
+            swq_realloc( set->values, sizeof(char *) * set->max_count,
+                         sizeof(char *) * new_max );
+        set->max_count = new_max;
+    }
+
+    set->values[set->count] = swq_strdup( value );
+    set->hash[slot] = ++set->count;
+
+    if( is_new != NULL )
+        *is_new = 1;
+
+    return set->count - 1;
+}
+
+/************************************************************************/
+/*                         swq_hash_set_free()                          */
+/************************************************************************/
+
+void swq_hash_set_free( swq_hash_set *set, int free_values )
+
+{
+    int  i;
+
+    if( set == NULL )
+        return;
+
+    if( free_values )
+    {
+        for( i = 0; i < set->count; i++ )
+            SWQ_FREE( set->values[i] );
+        if( set->values != NULL )
+            SWQ_FREE( set->values );
+    }
+
+    if( set->hash != NULL )
+        SWQ_FREE( set->hash );
+
+    SWQ_FREE( set );
+}
+
 /************************************************************************/
 /*                        swq_select_summarize()                        */
 /************************************************************************/
@@ -2278,29 +2608,14 @@ swq_select_summarize( swq_select *select_info,
     
     if( def->distinct_flag )
     {
-        int  i;
+        if( summary->distinct_set == NULL )
+            summary->distinct_set = swq_hash_set_create();
 
-        /* This should be implemented with a much more complicated
-           data structure to achieve any sort of efficiency. */
-        for( i = 0; i < summary->count; i++ )
-        {
-            if( strcmp(value,summary->distinct_list[i]) == 0 )
-                break;
-        }
-        
-        if( i == summary->count )
-        {
-            char  **old_list = summary->distinct_list;
-            
-            summary->distinct_list = (char **) 
-                SWQ_MALLOC(sizeof(char *) * (summary->count+1));
-            memcpy( summary->distinct_list, old_list, 
-                    sizeof(char *) * summary->count );
-            summary->distinct_list[(summary->count)++] = 
-                swq_strdup( value );
+        swq_hash_set_insert( summary->distinct_set, value, NULL );
 
-            SWQ_FREE(old_list);
-        }
+        /* the list is the set's own value array, in first seen order */
+        summary->distinct_list = summary->distinct_set->values;
+        summary->count = summary->distinct_set->count;
     }
 
 /* -------------------------------------------------------------------- */
@@ -2499,6 +2814,10 @@ void swq_select_free( swq_select *select_info )
 
             SWQ_FREE( select_info->column_summary[i].distinct_list );
         }
+
+        if( select_info->column_summary != NULL )
+            swq_hash_set_free( select_info->column_summary[i].distinct_set,
+                               FALSE );
     }
 
     if( select_info->column_defs != NULL )
@@ -2516,6 +2835,15 @@ void swq_select_free( swq_select *select_info )
     if( select_info->order_defs != NULL )
         SWQ_FREE( select_info->order_defs );
 
+    for( i = 0; i < select_info->group_specs; i++ )
+    {
+        if( select_info->group_defs[i].field_name != NULL )
+            SWQ_FREE( select_info->group_defs[i].field_name );
+    }
+    
+    if( select_info->group_defs != NULL )
+        SWQ_FREE( select_info->group_defs );
+
     for( i = 0; i < select_info->join_count; i++ )
     {
         SWQ_FREE( select_info->join_defs[i].primary_field_name );
@@ -2612,6 +2940,28 @@ const char *swq_reform_command( swq_select *select_info )
                  select_info->whole_where_clause );
     }
 
+/* -------------------------------------------------------------------- */
+/*      Add group by clause(s) if appropriate.                          */
+/* -------------------------------------------------------------------- */
+    for( i = 0; i < select_info->group_specs; i++ )
+    {
+        swq_group_def *def = select_info->group_defs + i;
+
+        if( i == 0 )
+        {
+            CHECK_COMMAND( 12 );
+            sprintf( command + cmd_size, " GROUP BY " );
+        }
+        else
+        {
+            CHECK_COMMAND( 3 );
+            sprintf( command + cmd_size, ", " );
+        }
+
+        CHECK_COMMAND( strlen(def->field_name)+3 );
+        sprintf( command + cmd_size, "\"%s\"", def->field_name );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Add order by clause(s) if appropriate.                          */
 /* -------------------------------------------------------------------- */
@@ -2640,6 +2990,15 @@ const char *swq_reform_command( swq_select *select_info )
             strcat( command + cmd_size, " DESC" );
     }
 
+/* -------------------------------------------------------------------- */
+/*      Add LIMIT clause if there is one.                               */
+/* -------------------------------------------------------------------- */
+    if( select_info->limit >= 0 )
+    {
+        CHECK_COMMAND( 20 );
+        sprintf( command + cmd_size, " LIMIT %d", select_info->limit );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Assign back to the select info.                                 */
 /* -------------------------------------------------------------------- */
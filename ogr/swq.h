@@ -120,6 +120,7 @@ int swq_test_like( const char *input, const char *pattern );
 #define SWQM_SUMMARY_RECORD  1
 #define SWQM_RECORDSET       2
 #define SWQM_DISTINCT_LIST   3
+#define SWQM_GROUPED_SUMMARY 4
 
 typedef enum {
     SWQCF_NONE,
@@ -145,13 +146,29 @@ typedef struct {
     int          distinct_flag;
 } swq_col_def;
 
+/* Set of distinct strings, kept in insertion order in values[]. */
+typedef struct {
+    int         count;
+    int         max_count;
+    char        **values;
+
+    int         hash_size;      /* power of 2 */
+    int         *hash;          /* index in values[] plus one, 0 if empty */
+} swq_hash_set;
+
+swq_hash_set *swq_hash_set_create( void );
+int swq_hash_set_insert( swq_hash_set *set, const char *value, int *is_new );
+void swq_hash_set_free( swq_hash_set *set, int free_values );
+
 typedef struct {
     int         count;
     
-    char        **distinct_list;
+    char        **distinct_list;    /* values of distinct_set */
     double      sum;
     double      min;
     double      max;
+
+    swq_hash_set *distinct_set;
 } swq_summary;
 
 typedef struct {
@@ -161,6 +178,13 @@ typedef struct {
     int   ascending_flag;
 } swq_order_def;
 
+typedef struct {
+    char *field_name;
+    int   table_index;
+    int   field_index;
+    swq_field_type field_type;
+} swq_group_def;
+
 typedef struct {
     int        secondary_table;
 
@@ -191,8 +215,13 @@ typedef struct {
     char        *whole_where_clause;
     swq_expr    *where_expr;
 
+    int         group_specs;
+    swq_group_def *group_defs;
+
     int         order_specs;
     swq_order_def *order_defs;    
+
+    int         limit;          /* -1 if there is no LIMIT clause */
 } swq_select;
 
 const char *swq_select_preparse( const char *select_statement, 